@@ -0,0 +1,90 @@
+#include "benchmark.hpp"
+
+#include <base/logger/logger.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+#include <format>
+
+namespace vrts::benchmark
+{
+    static std::string escape(std::string_view str)
+    {
+        std::string escaped;
+        escaped.reserve(str.size());
+
+        for (auto c: str)
+        {
+            if (c == '"' || c == '\\')
+                escaped.push_back('\\');
+
+            escaped.push_back(c);
+        }
+
+        return escaped;
+    }
+
+    Result& Result::counter(std::string_view name, double value)
+    {
+        counters.emplace_back(name, value);
+
+        log::info("[Benchmark]\t - {}: {:.3f}", name, value);
+
+        return *this;
+    }
+
+    Result& Suite::add(std::string_view name, std::span<const double> times_ms)
+    {
+        auto& result = _results.emplace_back();
+
+        result.name             = name;
+        result.iteration_count  = static_cast<uint32_t>(times_ms.size());
+
+        if (!times_ms.empty())
+        {
+            const auto [min, max] = std::ranges::minmax_element(times_ms);
+
+            result.min_ms   = *min;
+            result.max_ms   = *max;
+            result.mean_ms  = std::accumulate(times_ms.begin(), times_ms.end(), 0.0) / static_cast<double>(times_ms.size());
+        }
+
+        log::info("[Benchmark] {}: mean {:.3f} ms, min {:.3f} ms, max {:.3f} ms", result.name, result.mean_ms, result.min_ms, result.max_ms);
+
+        return result;
+    }
+
+    void Suite::writeJson(const std::filesystem::path& path) const
+    {
+        std::ofstream file (path);
+
+        if (!file)
+            log::error("[Benchmark] Failed open file: {}", path.string());
+
+        file << "{\n    \"benchmarks\": [\n";
+
+        for (size_t i = 0; i < _results.size(); ++i)
+        {
+            const auto& result = _results[i];
+
+            file << std::format(
+                "        {{ \"name\": \"{}\", \"iterations\": {}, \"mean_ms\": {:.6f}, \"min_ms\": {:.6f}, \"max_ms\": {:.6f}",
+                escape(result.name),
+                result.iteration_count,
+                result.mean_ms,
+                result.min_ms,
+                result.max_ms
+            );
+
+            for (const auto& [name, value]: result.counters)
+                file << std::format(", \"{}\": {:.6f}", escape(name), value);
+
+            file << (i + 1 < _results.size() ? " },\n" : " }\n");
+        }
+
+        file << "    ]\n}\n";
+
+        log::info("[Benchmark] Results: {}", path.string());
+    }
+}
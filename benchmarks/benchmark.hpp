@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <vector>
+#include <span>
+#include <utility>
+
+#include <filesystem>
+
+#include <chrono>
+#include <ranges>
+
+namespace vrts::benchmark
+{
+    struct Result
+    {
+        std::string name;
+
+        uint32_t iteration_count = 0;
+
+        double min_ms   = 0.0;
+        double mean_ms  = 0.0;
+        double max_ms   = 0.0;
+
+        std::vector<std::pair<std::string, double>> counters;
+
+        Result& counter(std::string_view name, double value);
+    };
+
+    class Suite
+    {
+    public:
+        Suite() = default;
+
+        Suite(Suite&& suite)        = delete;
+        Suite(const Suite& suite)   = delete;
+
+        Suite& operator = (Suite&& suite)       = delete;
+        Suite& operator = (const Suite& suite)  = delete;
+
+        template<typename Func>
+        Result& run(std::string_view name, uint32_t iteration_count, Func&& func);
+
+        void writeJson(const std::filesystem::path& path) const;
+
+    private:
+        Result& add(std::string_view name, std::span<const double> times_ms);
+
+    private:
+        std::vector<Result> _results;
+    };
+}
+
+#include "benchmark.inl"
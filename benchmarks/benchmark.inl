@@ -0,0 +1,22 @@
+namespace vrts::benchmark
+{
+    template<typename Func>
+    Result& Suite::run(std::string_view name, uint32_t iteration_count, Func&& func)
+    {
+        func();
+
+        std::vector<double> times_ms;
+        times_ms.reserve(iteration_count);
+
+        for ([[maybe_unused]] auto i: std::views::iota(0u, iteration_count))
+        {
+            const auto begin = std::chrono::steady_clock::now();
+            func();
+            const auto end = std::chrono::steady_clock::now();
+
+            times_ms.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+        }
+
+        return add(name, times_ms);
+    }
+}
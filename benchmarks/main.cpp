@@ -0,0 +1,1021 @@
+#include "benchmark.hpp"
+
+#include <base/scene/scene_data.hpp>
+#include <base/scene/mesh_data.hpp>
+#include <base/scene/mesh_lod.hpp>
+#include <base/scene/animator.hpp>
+#include <base/scene/texture.hpp>
+#include <base/scene/bvh.hpp>
+#include <base/scene/wide_bvh.hpp>
+#include <base/scene/two_level_bvh.hpp>
+#include <base/scene/synthetic_scene.hpp>
+#include <base/scene/environment_map.hpp>
+#include <base/scene/assimp_cast.hpp>
+
+#include <base/shader_compiler.hpp>
+#include <base/job_system.hpp>
+#include <base/configuration.hpp>
+#include <base/logger/logger.hpp>
+
+#include <junk_shop/atrous_denoiser.hpp>
+
+#include <glm/gtc/constants.hpp>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <ranges>
+#include <map>
+#include <format>
+#include <cmath>
+
+namespace vrts::benchmark
+{
+    const auto dancing_penguin_path = project_dir / "content/dancing_penguin.glb";
+
+    /// Те же настройки, что и в Scene::Importer::import.
+    const aiScene* readScene(Assimp::Importer& importer, const std::filesystem::path& path)
+    {
+        importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT);
+        importer.SetPropertyBool(AI_CONFIG_IMPORT_COLLADA_IGNORE_UP_DIRECTION, true);
+
+        constexpr auto assimp_read_flags =
+                aiProcess_GenNormals
+            |   aiProcess_CalcTangentSpace
+            |   aiProcess_GenUVCoords
+            |   aiProcess_JoinIdenticalVertices
+            |   aiProcess_Triangulate;
+
+        const auto ptr_scene = importer.ReadFile(path.string(), assimp_read_flags);
+
+        if (!ptr_scene || !ptr_scene->mRootNode)
+            log::error("[Benchmark] {}", importer.GetErrorString());
+
+        return ptr_scene;
+    }
+
+    [[nodiscard]]
+    size_t getTriangleCount(std::span<const MeshData> meshes_data) noexcept
+    {
+        size_t triangle_count = 0;
+
+        for (const auto& mesh_data: meshes_data)
+            triangle_count += mesh_data.indices.size() / 3;
+
+        return triangle_count;
+    }
+
+    [[nodiscard]]
+    double getPerSecond(double count, const Result& result) noexcept
+    {
+        constexpr auto milliseconds_per_second = 1000.0;
+        return result.mean_ms > 0.0 ? count * milliseconds_per_second / result.mean_ms : 0.0;
+    }
+}
+
+/// Аниматор из сцены assimp без Context: кости и иерархия регистрируются в том же порядке, что и в Scene::Importer.
+namespace vrts::benchmark
+{
+    void processBones(const aiScene* ptr_scene, const aiNode* ptr_node, BoneRegistry& bone_registry, AnimationHierarchiry::Node& hierarchy_node)
+    {
+        hierarchy_node.name         = ptr_node->mName.C_Str();
+        hierarchy_node.transform    = utils::cast(ptr_node->mTransformation);
+
+        for (auto i: std::views::iota(0u, ptr_node->mNumMeshes))
+        {
+            const auto ptr_mesh = ptr_scene->mMeshes[ptr_node->mMeshes[i]];
+
+            if (!mesh_conversion::isSupported(ptr_mesh))
+                continue;
+
+            for (const auto ptr_bone: std::span(ptr_mesh->mBones, ptr_mesh->mNumBones))
+            {
+                if (bone_registry.get(ptr_bone->mName.C_Str()))
+                    continue;
+
+                BoneInfo bone_info;
+                bone_info.id        = static_cast<uint32_t>(bone_registry.boneCount());
+                bone_info.offset    = glm::transpose(utils::cast(ptr_bone->mOffsetMatrix));
+
+                bone_registry.add(ptr_bone->mName.C_Str(), bone_info);
+            }
+        }
+
+        for (auto i: std::views::iota(0u, ptr_node->mNumChildren))
+            processBones(ptr_scene, ptr_node->mChildren[i], bone_registry, hierarchy_node.children.emplace_back());
+    }
+
+    [[nodiscard]]
+    BoneTransformTrack getTrack(const aiNodeAnim* ptr_channel)
+    {
+        BoneTransformTrack track;
+
+        for (const auto& pos: std::span(ptr_channel->mPositionKeys, ptr_channel->mNumPositionKeys))
+            track.position_keys.emplace_back(utils::cast(pos.mValue), static_cast<float>(pos.mTime));
+
+        for (const auto& rot: std::span(ptr_channel->mRotationKeys, ptr_channel->mNumRotationKeys))
+            track.rotation_keys.emplace_back(utils::cast(rot.mValue), static_cast<float>(rot.mTime));
+
+        for (const auto& scale: std::span(ptr_channel->mScalingKeys, ptr_channel->mNumScalingKeys))
+            track.scale_keys.emplace_back(utils::cast(scale.mValue), static_cast<float>(scale.mTime));
+
+        return track;
+    }
+
+    [[nodiscard]]
+    Animator loadAnimator(const aiScene* ptr_scene)
+    {
+        if (!ptr_scene->mNumAnimations)
+            log::error("[Benchmark] Scene hasn't animations");
+
+        BoneRegistry                bone_registry;
+        AnimationHierarchiry::Node  root_node;
+
+        processBones(ptr_scene, ptr_scene->mRootNode, bone_registry, root_node);
+
+        const auto ptr_animation = ptr_scene->mAnimations[0];
+
+        std::vector<Bone> bones;
+
+        for (const auto ptr_channel: std::span(ptr_animation->mChannels, ptr_animation->mNumChannels))
+        {
+            const auto bone_info = bone_registry.get(ptr_channel->mNodeName.C_Str());
+
+            if (!bone_info)
+                continue;
+
+            auto track = getTrack(ptr_channel);
+
+            bones.push_back(
+                Bone::Builder()
+                    .name(ptr_channel->mNodeName.C_Str())
+                    .id(bone_info->id)
+                    .positionKeys(std::move(track.position_keys))
+                    .rotationKeys(std::move(track.rotation_keys))
+                    .scaleKeys(std::move(track.scale_keys))
+                    .build()
+            );
+        }
+
+        auto ticks_per_second = static_cast<float>(ptr_animation->mTicksPerSecond);
+
+        if (constexpr auto eps = 0.001f; ticks_per_second < eps)
+            ticks_per_second = 25.0f;
+
+        return Animator::Builder()
+            .bones(std::move(bones))
+            .boneRegistry(std::move(bone_registry))
+            .animationHierarchiryRootNode(std::move(root_node))
+            .time(static_cast<float>(ptr_animation->mDuration), ticks_per_second)
+            .skinningPalette(SkinningPaletteType::affine)
+            .build();
+    }
+}
+
+/// Лучи для замеров обхода BVH.
+namespace vrts::benchmark
+{
+    [[nodiscard]]
+    AABB getBounds(const MeshData& mesh_data) noexcept
+    {
+        AABB bounds;
+
+        for (const auto& attributes: mesh_data.attributes)
+            bounds.extend(glm::vec3(attributes.pos));
+
+        return bounds;
+    }
+
+    /// Первичные лучи камеры над +z, по тайлам 8x8: соседние лучи (и пакеты WideBVH) идут почти параллельно.
+    [[nodiscard]]
+    std::vector<Ray> makeCoherentRays(const AABB& bounds, uint32_t rays_per_side)
+    {
+        constexpr uint32_t tile_size = 8;
+
+        const auto size     = bounds.max - bounds.min;
+        const auto center   = bounds.getCenter();
+        const auto eye      = glm::vec3(center.x, center.y, bounds.max.z + glm::length(size));
+
+        std::vector<Ray> rays;
+        rays.reserve(rays_per_side * rays_per_side);
+
+        for (auto tile_y: std::views::iota(0u, rays_per_side / tile_size))
+        {
+            for (auto tile_x: std::views::iota(0u, rays_per_side / tile_size))
+            {
+                for (auto y: std::views::iota(tile_y * tile_size, (tile_y + 1) * tile_size))
+                {
+                    for (auto x: std::views::iota(tile_x * tile_size, (tile_x + 1) * tile_size))
+                    {
+                        const auto uv       = (glm::vec2(x, y) + 0.5f) / static_cast<float>(rays_per_side);
+                        const auto target   = glm::vec3(bounds.min.x + uv.x * size.x, bounds.min.y + uv.y * size.y, center.z);
+
+                        rays.push_back(Ray { .origin = eye, .dir = glm::normalize(target - eye) });
+                    }
+                }
+            }
+        }
+
+        return rays;
+    }
+
+    /// Лучи со сферы вокруг bounds в случайные точки внутри: худший случай для пакетов.
+    [[nodiscard]]
+    std::vector<Ray> makeIncoherentRays(const AABB& bounds, uint32_t ray_count, uint32_t seed)
+    {
+        std::mt19937 generator (seed);
+
+        std::uniform_real_distribution<float> distribution (0.0f, 1.0f);
+        std::normal_distribution<float>       normal_distribution;
+
+        const auto center = bounds.getCenter();
+        const auto radius = glm::length(bounds.max - bounds.min);
+
+        std::vector<Ray> rays;
+        rays.reserve(ray_count);
+
+        for ([[maybe_unused]] auto i: std::views::iota(0u, ray_count))
+        {
+            const auto dir = glm::normalize(glm::vec3(normal_distribution(generator), normal_distribution(generator), normal_distribution(generator)));
+
+            const auto origin = center + dir * radius;
+            const auto target = glm::mix(bounds.min, bounds.max, glm::vec3(distribution(generator), distribution(generator), distribution(generator)));
+
+            rays.push_back(Ray { .origin = origin, .dir = glm::normalize(target - origin) });
+        }
+
+        return rays;
+    }
+
+    template<typename Intersect>
+    void traceRays(std::span<const Ray> rays, Intersect&& intersect)
+    {
+        size_t hit_count = 0;
+
+        for (const auto& ray: rays)
+            hit_count += intersect(ray).has_value();
+
+        if (hit_count > rays.size())
+            log::error("[Benchmark] Invalid hit count");
+    }
+}
+
+namespace vrts::benchmark
+{
+    /// Сцена assimp из mesh_count копий волнистой сетки, как после ReadFile: треугольники, UV, нормали и касательные.
+    std::unique_ptr<aiScene> makeScene(uint32_t mesh_count, uint32_t triangle_count)
+    {
+        constexpr auto wave_amplitude = 0.05f;
+        constexpr auto wave_frequency = 3.0f;
+
+        const auto quads_per_side       = std::max(1u, static_cast<uint32_t>(std::sqrt(triangle_count / 2.0f)));
+        const auto vertices_per_side    = quads_per_side + 1;
+
+        const auto vertex_count = vertices_per_side * vertices_per_side;
+        const auto face_count   = quads_per_side * quads_per_side * 2;
+
+        const auto omega = glm::two_pi<float>() * wave_frequency;
+
+        std::vector<aiVector3D> positions;
+        std::vector<aiVector3D> normals;
+        std::vector<aiVector3D> tangents;
+
+        for (auto j: std::views::iota(0u, vertices_per_side))
+        {
+            for (auto i: std::views::iota(0u, vertices_per_side))
+            {
+                const auto x = static_cast<float>(i) / static_cast<float>(quads_per_side);
+                const auto y = static_cast<float>(j) / static_cast<float>(quads_per_side);
+
+                const auto z    = wave_amplitude * std::sin(omega * x) * std::sin(omega * y);
+                const auto dzdx = wave_amplitude * omega * std::cos(omega * x) * std::sin(omega * y);
+                const auto dzdy = wave_amplitude * omega * std::sin(omega * x) * std::cos(omega * y);
+
+                positions.emplace_back(x, y, z);
+                normals.push_back(aiVector3D(-dzdx, -dzdy, 1.0f).Normalize());
+                tangents.push_back(aiVector3D(1.0f, 0.0f, dzdx).Normalize());
+            }
+        }
+
+        std::vector<uint32_t> indices;
+
+        for (auto j: std::views::iota(0u, quads_per_side))
+        {
+            for (auto i: std::views::iota(0u, quads_per_side))
+            {
+                const auto v0 = j * vertices_per_side + i;
+                const auto v1 = v0 + 1;
+                const auto v2 = v0 + vertices_per_side;
+                const auto v3 = v2 + 1;
+
+                indices.insert(indices.end(), {v0, v1, v2, v1, v3, v2});
+            }
+        }
+
+        auto ptr_scene = std::make_unique<aiScene>();
+
+        ptr_scene->mNumMeshes   = mesh_count;
+        ptr_scene->mMeshes      = new aiMesh* [mesh_count];
+
+        for (auto mesh_id: std::views::iota(0u, mesh_count))
+        {
+            auto ptr_mesh = new aiMesh();
+            ptr_scene->mMeshes[mesh_id] = ptr_mesh;
+
+            ptr_mesh->mName             = std::format("synthetic_{}", mesh_id);
+            ptr_mesh->mPrimitiveTypes   = aiPrimitiveType_TRIANGLE;
+
+            ptr_mesh->mNumVertices          = vertex_count;
+            ptr_mesh->mVertices             = new aiVector3D [vertex_count];
+            ptr_mesh->mNormals              = new aiVector3D [vertex_count];
+            ptr_mesh->mTangents             = new aiVector3D [vertex_count];
+            ptr_mesh->mTextureCoords[0]     = new aiVector3D [vertex_count];
+            ptr_mesh->mNumUVComponents[0]   = 2;
+
+            std::ranges::copy(positions, ptr_mesh->mVertices);
+            std::ranges::copy(normals, ptr_mesh->mNormals);
+            std::ranges::copy(tangents, ptr_mesh->mTangents);
+
+            for (auto i: std::views::iota(0u, vertex_count))
+                ptr_mesh->mTextureCoords[0][i] = aiVector3D(positions[i].x, positions[i].y, 0.0f);
+
+            ptr_mesh->mNumFaces = face_count;
+            ptr_mesh->mFaces    = new aiFace [face_count];
+
+            for (auto i: std::views::iota(0u, face_count))
+            {
+                auto& face = ptr_mesh->mFaces[i];
+
+                face.mNumIndices    = 3;
+                face.mIndices       = new unsigned int [3];
+
+                std::copy_n(indices.begin() + i * 3, 3, face.mIndices);
+            }
+        }
+
+        return ptr_scene;
+    }
+
+    void benchmarkImport(Suite& suite)
+    {
+        suite.run("import/assimp_read/dancing_penguin", 5, []
+        {
+            Assimp::Importer importer;
+            std::ignore = readScene(importer, dancing_penguin_path);
+        });
+
+        Assimp::Importer importer;
+        const auto ptr_scene = readScene(importer, dancing_penguin_path);
+
+        std::vector<MeshData> meshes_data;
+
+        suite.run("import/mesh_conversion/dancing_penguin", 5, [ptr_scene, &meshes_data]
+        {
+            meshes_data = mesh_conversion::convert(ptr_scene);
+        })
+        .counter("triangles", static_cast<double>(getTriangleCount(meshes_data)));
+
+        suite.run("import/scene_data/dancing_penguin", 3, []
+        {
+            std::ignore = SceneData::Loader()
+                .path(dancing_penguin_path)
+                .load();
+        });
+
+        {
+            /// Несколько миллионов треугольников в независимых мешах: меряем параллельную конвертацию вместе с LOD.
+            constexpr uint32_t synthetic_mesh_count     = 16;
+            constexpr uint32_t synthetic_triangle_count = 262144;
+
+            const auto ptr_synthetic_scene = makeScene(synthetic_mesh_count, synthetic_triangle_count);
+
+            std::vector<MeshData> synthetic_meshes_data;
+
+            suite.run(std::format("import/mesh_conversion/synthetic_{}x{}", synthetic_mesh_count, synthetic_triangle_count), 3, [&ptr_synthetic_scene, &synthetic_meshes_data]
+            {
+                synthetic_meshes_data = mesh_conversion::convert(ptr_synthetic_scene.get());
+            })
+            .counter("triangles", static_cast<double>(getTriangleCount(synthetic_meshes_data)));
+
+            if (getTriangleCount(synthetic_meshes_data) != static_cast<size_t>(synthetic_mesh_count) * ptr_synthetic_scene->mMeshes[0]->mNumFaces)
+                log::error("[Benchmark] Synthetic scene lost triangles");
+        }
+
+        /// У пингвина все меши скелетные, LOD для них не строятся, поэтому цепочку меряем на процедурном меше.
+        constexpr uint32_t lod_triangle_count = 131072;
+
+        const auto mesh_data = synthetic::makeMesh(lod_triangle_count);
+
+        std::vector<mesh_lod::Lod> lods;
+
+        auto& result = suite.run(std::format("import/lod_chain/synthetic_{}", lod_triangle_count), 3, [&mesh_data, &lods]
+        {
+            lods = mesh_lod::buildChain(mesh_data.indices, mesh_data.attributes);
+        });
+
+        if (lods.empty())
+            log::error("[Benchmark] Synthetic mesh isn't simplified");
+
+        /// Ошибки LOD растут вдоль цепочки, поэтому достаточно проверить последний.
+        const auto max_error        = mesh_lod::getMaxError(mesh_data.attributes);
+        const auto measured_error   = mesh_lod::measureError(mesh_data.indices, mesh_data.attributes, lods.back(), 256);
+
+        if (lods.back().error > max_error || measured_error > max_error)
+            log::error("[Benchmark] LOD error {} (measured {}) exceeds {}", lods.back().error, measured_error, max_error);
+
+        result
+            .counter("lod_count", static_cast<double>(lods.size()))
+            .counter("error_bound_ratio", lods.back().error / max_error)
+            .counter("measured_error_ratio", measured_error / max_error);
+    }
+
+    void benchmarkAnimation(Suite& suite)
+    {
+        Assimp::Importer importer;
+        const auto ptr_scene = readScene(importer, dancing_penguin_path);
+
+        auto animator = loadAnimator(ptr_scene);
+
+        constexpr auto delta_time = 1.0f / 60.0f;
+
+        suite.run("animation/animator_update/dancing_penguin", 200, [&animator]
+        {
+            animator.update(delta_time);
+        })
+        .counter("bones", static_cast<double>(animator.getSkinningPalette().getBoneCount()));
+
+        /// Трек с наибольшим числом ключей: поиск ключа в getTransform зависит от их количества.
+        const auto ptr_animation = ptr_scene->mAnimations[0];
+
+        const auto channels     = std::span(ptr_animation->mChannels, ptr_animation->mNumChannels);
+        const auto ptr_channel  = *std::ranges::max_element(channels, std::less(), [] (const aiNodeAnim* ptr_channel)
+        {
+            return ptr_channel->mNumPositionKeys + ptr_channel->mNumRotationKeys + ptr_channel->mNumScalingKeys;
+        });
+
+        AnimationSampler sampler (getTrack(ptr_channel));
+
+        constexpr uint32_t sample_count = 10000;
+
+        const auto duration = static_cast<float>(ptr_animation->mDuration);
+
+        auto& result = suite.run("animation/sampler_get_transform/dancing_penguin", 20, [&sampler, duration, sample_count]
+        {
+            auto sum = glm::mat4(0.0f);
+
+            for (auto i: std::views::iota(0u, sample_count))
+                sum += sampler.getTransform(duration * static_cast<float>(i) / static_cast<float>(sample_count));
+
+            if (!std::isfinite(sum[3][3]))
+                log::error("[Benchmark] Invalid bone transform");
+        });
+
+        result.counter("msamples_per_second", getPerSecond(sample_count, result) * 1e-6);
+    }
+
+    void benchmarkTextureDecode(Suite& suite)
+    {
+        Assimp::Importer importer;
+        const auto ptr_scene = readScene(importer, dancing_penguin_path);
+
+        const auto textures = std::span(ptr_scene->mTextures, ptr_scene->mNumTextures);
+
+        if (textures.empty())
+        {
+            log::warning("[Benchmark] Scene hasn't embedded textures, texture decode is skipped");
+            return ;
+        }
+
+        double pixel_count = 0.0;
+
+        auto& result = suite.run("texture_decode/dancing_penguin", 5, [textures, &pixel_count]
+        {
+            pixel_count = 0.0;
+
+            for (const auto ptr_texture: textures)
+            {
+                const auto compressed_image_size = ptr_texture->mHeight == 0 ?
+                    ptr_texture->mWidth :
+                    ptr_texture->mWidth * ptr_texture->mHeight;
+
+                const auto texture = Texture::decode(
+                    std::span(reinterpret_cast<const uint8_t*>(ptr_texture->pcData), compressed_image_size),
+                    4,
+                    TextureFilter::linear
+                );
+
+                pixel_count += static_cast<double>(texture.getWidth()) * static_cast<double>(texture.getHeight());
+            }
+        });
+
+        result
+            .counter("textures", static_cast<double>(textures.size()))
+            .counter("mpixels_per_second", getPerSecond(pixel_count, result) * 1e-6);
+    }
+
+    void benchmarkBVH(Suite& suite)
+    {
+        {
+            Assimp::Importer importer;
+            const auto ptr_scene    = readScene(importer, dancing_penguin_path);
+            const auto meshes_data  = mesh_conversion::convert(ptr_scene);
+
+            suite.run("bvh/build/dancing_penguin", 10, [&meshes_data]
+            {
+                for (const auto& mesh_data: meshes_data)
+                {
+                    if (!mesh_data.indices.empty())
+                        std::ignore = BVH::build(mesh_data);
+                }
+            })
+            .counter("triangles", static_cast<double>(getTriangleCount(meshes_data)));
+        }
+
+        for (auto triangle_count: {2048u, 32768u, 131072u})
+        {
+            const auto mesh_data = synthetic::makeMesh(triangle_count);
+
+            std::optional<BVH> bvh;
+
+            auto& build_result = suite.run(std::format("bvh/build/synthetic_{}", triangle_count), 10, [&mesh_data, &bvh]
+            {
+                bvh = BVH::build(mesh_data);
+            });
+
+            build_result.counter("sah_cost", bvh->getStatistics().sah_cost);
+
+            const auto build_time = build_result.mean_ms;
+
+            auto& refit_result = suite.run(std::format("bvh/refit/synthetic_{}", triangle_count), 10, [&mesh_data, &bvh]
+            {
+                bvh->refit(mesh_data);
+            });
+
+            refit_result.counter("speedup_over_build", refit_result.mean_ms > 0.0 ? build_time / refit_result.mean_ms : 0.0);
+
+            suite.run(std::format("bvh/collapse_wide/synthetic_{}", triangle_count), 10, [&bvh]
+            {
+                std::ignore = WideBVH<simd::max_width>::collapse(*bvh);
+            });
+        }
+    }
+
+    void benchmarkRayQueries(Suite& suite)
+    {
+        constexpr uint32_t triangle_count   = 131072;
+        constexpr uint32_t rays_per_side    = 256;
+        constexpr uint32_t ray_count        = rays_per_side * rays_per_side;
+
+        const auto mesh_data = synthetic::makeMesh(triangle_count);
+
+        const auto bvh      = BVH::build(mesh_data);
+        const auto wide_bvh = WideBVH<simd::max_width>::collapse(bvh);
+
+        const auto bounds = getBounds(mesh_data);
+
+        const std::map<std::string, std::vector<Ray>> ray_sets
+        {
+            { "coherent",   makeCoherentRays(bounds, rays_per_side)     },
+            { "incoherent", makeIncoherentRays(bounds, ray_count, 1)    }
+        };
+
+        for (const auto& [ray_set_name, rays]: ray_sets)
+        {
+            auto& scalar_result = suite.run(std::format("rays/scalar/{}/synthetic_{}", ray_set_name, triangle_count), 5, [&bvh, &rays]
+            {
+                traceRays(rays, [&bvh] (const Ray& ray) { return bvh.intersect(ray); });
+            });
+
+            scalar_result.counter("mrays_per_second", getPerSecond(ray_count, scalar_result) * 1e-6);
+
+            auto& wide_result = suite.run(std::format("rays/wide/{}/synthetic_{}", ray_set_name, triangle_count), 5, [&wide_bvh, &rays]
+            {
+                traceRays(rays, [&wide_bvh] (const Ray& ray) { return wide_bvh.intersect(ray); });
+            });
+
+            wide_result.counter("mrays_per_second", getPerSecond(ray_count, wide_result) * 1e-6);
+
+            std::vector<std::optional<RayHit>> hits (rays.size());
+
+            auto& packet_result = suite.run(std::format("rays/wide_batched/{}/synthetic_{}", ray_set_name, triangle_count), 5, [&wide_bvh, &rays, &hits]
+            {
+                wide_bvh.intersect(rays, hits);
+            });
+
+            packet_result.counter("mrays_per_second", getPerSecond(ray_count, packet_result) * 1e-6);
+        }
+
+        /// Инстансы одного BLAS, как Scene::Generator раскладывает их по решётке.
+        constexpr uint32_t instance_count           = 1024;
+        constexpr uint32_t instance_triangle_count  = 2048;
+
+        const auto instance_mesh_data = synthetic::makeMesh(instance_triangle_count);
+
+        TwoLevelBVH two_level_bvh;
+
+        const auto blas_id = two_level_bvh.addBLAS(BVH::build(instance_mesh_data));
+
+        AABB scene_bounds;
+
+        for (auto instance_id: std::views::iota(0u, instance_count))
+        {
+            const auto object_to_world = synthetic::makeTransform(instance_id, instance_count, 0);
+
+            std::ignore = two_level_bvh.addInstance(blas_id, object_to_world);
+            scene_bounds.extend(getBounds(instance_mesh_data).transform(object_to_world));
+        }
+
+        suite.run(std::format("bvh/tlas_build/{}_instances", instance_count), 10, [&two_level_bvh]
+        {
+            two_level_bvh.build();
+        });
+
+        const auto rays = makeIncoherentRays(scene_bounds, ray_count, 2);
+
+        auto& two_level_result = suite.run(std::format("rays/two_level/incoherent/{}x{}", instance_count, instance_triangle_count), 5, [&two_level_bvh, &rays]
+        {
+            traceRays(rays, [&two_level_bvh] (const Ray& ray) { return two_level_bvh.intersect(ray); });
+        });
+
+        two_level_result.counter("mrays_per_second", getPerSecond(ray_count, two_level_result) * 1e-6);
+    }
+
+    [[nodiscard]]
+    junk_shop::atrous::FeatureBuffers makeFeatureBuffers(uint32_t width, uint32_t height)
+    {
+        junk_shop::atrous::FeatureBuffers features;
+
+        features.width  = width;
+        features.height = height;
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            for (auto x: std::views::iota(0u, width))
+            {
+                const auto u = (static_cast<float>(x) + 0.5f) / static_cast<float>(width);
+                const auto v = (static_cast<float>(y) + 0.5f) / static_cast<float>(height);
+
+                const auto is_sky   = v < 0.2f;
+                const auto is_floor = v > 0.6f;
+                const auto is_left  = u < 0.5f;
+
+                const auto normal = is_floor ? glm::vec3(0, 1, 0) : glm::normalize(glm::vec3(is_left ? 1.0f : -1.0f, 0, 1));
+
+                const auto checker  = (static_cast<uint32_t>(u * 8.0f) + static_cast<uint32_t>(v * 8.0f)) % 2;
+                const auto albedo   = is_floor && checker ? glm::vec3(0.8f) : glm::vec3(0.3f, 0.5f, 0.7f);
+
+                features.albedo.push_back(is_sky ? glm::vec3(0.0f) : albedo);
+                features.normal.push_back(is_sky ? glm::vec3(0.0f) : normal);
+                features.depth.push_back(is_sky ? 0.0f : 10.0f + 5.0f * v + (is_floor ? 0.0f : std::abs(u - 0.5f) * 4.0f));
+            }
+        }
+
+        return features;
+    }
+
+    void benchmarkDenoiser(Suite& suite)
+    {
+        constexpr uint32_t width        = 512;
+        constexpr uint32_t height       = 256;
+        constexpr uint32_t sample_count = 4;
+
+        const auto features = makeFeatureBuffers(width, height);
+
+        const auto light_dir = glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f));
+
+        std::vector<glm::vec3> reference;
+        std::vector<glm::vec3> noisy;
+
+        std::mt19937                    generator (3);
+        std::normal_distribution<float> noise_distribution (0.0f, 0.3f / std::sqrt(static_cast<float>(sample_count)));
+
+        for (auto i: std::views::iota(0u, width * height))
+        {
+            const auto color = features.depth[i] > 0.0f ?
+                    features.albedo[i] * (0.2f + std::max(glm::dot(features.normal[i], light_dir), 0.0f))
+                :   glm::vec3(0.4f, 0.6f, 0.9f);
+
+            reference.push_back(color);
+            noisy.push_back(features.depth[i] > 0.0f ? color + glm::vec3(noise_distribution(generator)) : color);
+        }
+
+        std::vector<glm::vec3> denoised;
+
+        auto& result = suite.run(std::format("denoiser/atrous/{}x{}", width, height), 10, [&noisy, &features, &denoised]
+        {
+            denoised = junk_shop::atrous::denoise(noisy, static_cast<float>(sample_count), features);
+        });
+
+        result
+            .counter("mpixels_per_second", getPerSecond(width * height, result) * 1e-6)
+            .counter("noisy_rmse", junk_shop::atrous::getRmse(noisy, reference))
+            .counter("denoised_rmse", junk_shop::atrous::getRmse(denoised, reference));
+    }
+
+    [[nodiscard]]
+    std::vector<glm::vec3> makeEnvironmentPixels(uint32_t width, uint32_t height)
+    {
+        std::vector<glm::vec3> pixels;
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            for (auto x: std::views::iota(0u, width))
+            {
+                const auto u = (static_cast<float>(x) + 0.5f) / static_cast<float>(width);
+                const auto v = (static_cast<float>(y) + 0.5f) / static_cast<float>(height);
+
+                const auto is_sun = std::abs(u - 0.3f) < 0.005f && std::abs(v - 0.25f) < 0.01f;
+
+                pixels.push_back(is_sun ? glm::vec3(5000.0f) : glm::vec3(0.2f + 0.5f * u, 0.4f * (1.0f - v), 0.6f * (1.0f - v)));
+            }
+        }
+
+        return pixels;
+    }
+
+    void benchmarkEnvironmentMap(Suite& suite)
+    {
+        constexpr uint32_t width        = 1024;
+        constexpr uint32_t height       = 512;
+        constexpr uint32_t sample_count = 1u << 22;
+        constexpr uint32_t bin_size     = 8;
+        constexpr uint32_t bin_count_x  = width / bin_size;
+
+        const auto pixels = makeEnvironmentPixels(width, height);
+
+        EnvironmentMap environment_map;
+
+        auto& build_result = suite.run(std::format("environment_map/build/{}x{}", width, height), 5, [&pixels, &environment_map]
+        {
+            environment_map = EnvironmentMap::build(width, height, pixels);
+        });
+
+        build_result.counter("mpixels_per_second", getPerSecond(width * height, build_result) * 1e-6);
+
+        const auto luminance = [] (const glm::vec3& color) { return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f)); };
+
+        std::vector<double> expected (static_cast<size_t>(bin_count_x) * (height / bin_size));
+
+        double total_weight = 0.0;
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            const auto sin_theta = std::sin((static_cast<double>(y) + 0.5) / height * glm::pi<double>());
+
+            for (auto x: std::views::iota(0u, width))
+            {
+                const auto weight = luminance(pixels[y * width + x]) * sin_theta;
+
+                expected[(y / bin_size) * bin_count_x + x / bin_size]   += weight;
+                total_weight                                            += weight;
+            }
+        }
+
+        std::vector<uint32_t> histogram (expected.size());
+
+        double luminance_estimate = 0.0;
+
+        auto& sample_result = suite.run(std::format("environment_map/sample/{}x{}", width, height), 1, [&]
+        {
+            std::mt19937                            generator (7);
+            std::uniform_real_distribution<float>   distribution (0.0f, std::nextafter(1.0f, 0.0f));
+
+            std::ranges::fill(histogram, 0);
+            luminance_estimate = 0.0;
+
+            for ([[maybe_unused]] auto i: std::views::iota(0u, sample_count))
+            {
+                const auto sample = environment_map.sample(glm::vec4(
+                    distribution(generator), distribution(generator), 
+                    distribution(generator), distribution(generator)
+                ));
+
+                const auto x = sample.pixel % width;
+                const auto y = sample.pixel / width;
+
+                ++histogram[(y / bin_size) * bin_count_x + x / bin_size];
+
+                if (sample.pdf > 0.0f)
+                    luminance_estimate += luminance(sample.radiance) / sample.pdf;
+            }
+        });
+
+        double      chi_square          = 0.0;
+        uint32_t    degrees_of_freedom  = 0;
+
+        for (auto i: std::views::iota(0u, expected.size()))
+        {
+            const auto expected_count = expected[i] / total_weight * sample_count;
+
+            if (expected_count < 5.0)
+                continue;
+
+            const auto diff = static_cast<double>(histogram[i]) - expected_count;
+
+            chi_square += diff * diff / expected_count;
+            ++degrees_of_freedom;
+        }
+
+        const auto reference_integral = total_weight * 2.0 * glm::pi<double>() * glm::pi<double>() / (width * height);
+
+        sample_result
+            .counter("msamples_per_second", getPerSecond(sample_count, sample_result) * 1e-6)
+            .counter("chi_square_per_dof", chi_square / std::max(degrees_of_freedom, 1u))
+            .counter("integral_relative_error", std::abs(luminance_estimate / sample_count - reference_integral) / reference_integral);
+    }
+
+    [[nodiscard]]
+    std::optional<shader::Type> getShaderType(const std::filesystem::path& path)
+    {
+        static const std::map<std::string, shader::Type> types
+        {
+            { ".comp",  shader::Type::compute       },
+            { ".rgen",  shader::Type::raygen        },
+            { ".rint",  shader::Type::intersection  },
+            { ".rahit", shader::Type::anyhit        },
+            { ".rchit", shader::Type::closesthit    },
+            { ".rmiss", shader::Type::miss          },
+            { ".rcall", shader::Type::callable      }
+        };
+
+        if (auto type = types.find(path.extension().string()); type != types.end())
+            return type->second;
+
+        return std::nullopt;
+    }
+
+    void benchmarkShaderCompiler(Suite& suite)
+    {
+        const auto shaders_dir = project_dir / "shaders";
+
+        std::vector<std::filesystem::path> paths;
+
+        for (const auto& entry: std::filesystem::recursive_directory_iterator(shaders_dir))
+        {
+            if (entry.is_regular_file() && getShaderType(entry.path()))
+                paths.push_back(entry.path());
+        }
+
+        std::ranges::sort(paths);
+
+        shader::Compiler::init();
+
+        for (const auto& path: paths)
+        {
+            const auto type = *getShaderType(path);
+
+            size_t word_count = 0;
+
+            suite.run(std::format("shader_compile/{}", path.lexically_relative(shaders_dir).generic_string()), 3, [&path, type, &word_count]
+            {
+                word_count = shader::Compiler::createIL(path, type).size();
+            })
+            .counter("spirv_words", static_cast<double>(word_count));
+        }
+
+        shader::Compiler::finalize();
+    }
+
+    uint64_t hashRange(size_t first, size_t last)
+    {
+        constexpr uint32_t round_count = 64;
+
+        uint64_t sum = 0;
+
+        for (auto i: std::views::iota(first, last))
+        {
+            auto x = static_cast<uint64_t>(i);
+
+            for (uint32_t round = 0; round < round_count; ++round)
+            {
+                x = x * 6364136223846793005ull + 1442695040888963407ull;
+                x ^= x >> 33;
+            }
+
+            sum += x;
+        }
+
+        return sum;
+    }
+
+    void benchmarkJobSystem(Suite& suite)
+    {
+        constexpr size_t element_count = 1 << 20;
+
+        const auto expected_sum = hashRange(0, element_count);
+
+        const auto max_thread_count = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+        std::vector<uint32_t> thread_counts;
+
+        for (uint32_t thread_count = 0; thread_count < max_thread_count; thread_count = thread_count * 2 + 1)
+            thread_counts.push_back(thread_count);
+
+        thread_counts.push_back(max_thread_count);
+
+        double serial_time = 0.0;
+
+        for (auto thread_count: thread_counts)
+        {
+            JobSystem job_system (thread_count);
+
+            std::atomic<uint64_t> sum = 0;
+
+            auto& result = suite.run(std::format("job_system/parallel_for/threads_{}", thread_count + 1), 10, [&job_system, &sum]
+            {
+                sum = 0;
+
+                job_system.parallelFor(0, element_count, 1024, [&sum] (size_t first, size_t last)
+                {
+                    sum += hashRange(first, last);
+                });
+            });
+
+            if (sum != expected_sum)
+                log::error("[Benchmark] JobSystem with {} threads lost work", thread_count);
+
+            if (thread_count == 0)
+                serial_time = result.mean_ms;
+
+            result.counter("speedup", result.mean_ms > 0.0 ? serial_time / result.mean_ms : 0.0);
+        }
+
+        constexpr uint32_t group_count      = 512;
+        constexpr uint32_t fan_out          = 16;
+        constexpr size_t   nested_count     = 256;
+
+        auto& job_system = JobSystem::get();
+
+        std::atomic<uint64_t> leaf_count    = 0;
+        std::atomic<uint32_t> joined_count  = 0;
+
+        suite.run("job_system/stress/dependency_graph", 10, [&job_system, &leaf_count, &joined_count]
+        {
+            leaf_count      = 0;
+            joined_count    = 0;
+
+            std::vector<JobSystem::JobHandle> joins;
+            joins.reserve(group_count);
+
+            std::vector<JobSystem::JobHandle> leaves (fan_out);
+
+            for (uint32_t group_id = 0; group_id < group_count; ++group_id)
+            {
+                std::ranges::generate(leaves, [&job_system, &leaf_count]
+                {
+                    return job_system.submit([&job_system, &leaf_count]
+                    {
+                        job_system.parallelFor(0, nested_count, 16, [&leaf_count] (size_t first, size_t last)
+                        {
+                            leaf_count += last - first;
+                        });
+                    });
+                });
+
+                joins.push_back(job_system.submit([&joined_count] { ++joined_count; }, leaves));
+            }
+
+            job_system.wait(joins);
+        })
+        .counter("jobs", static_cast<double>(group_count * (fan_out + 1)))
+        .counter("threads", static_cast<double>(job_system.getThreadCount() + 1));
+
+        if (leaf_count != group_count * fan_out * nested_count || joined_count != group_count)
+            log::error("[Benchmark] JobSystem lost jobs: {} leaves, {} joins", leaf_count.load(), joined_count.load());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace vrts;
+
+    const auto output_path = argc > 1 ? std::filesystem::path(argv[1]) : std::filesystem::path("benchmarks.json");
+
+    try
+    {
+        benchmark::Suite suite;
+
+        benchmark::benchmarkImport(suite);
+        benchmark::benchmarkAnimation(suite);
+        benchmark::benchmarkTextureDecode(suite);
+        benchmark::benchmarkBVH(suite);
+        benchmark::benchmarkRayQueries(suite);
+        benchmark::benchmarkDenoiser(suite);
+        benchmark::benchmarkEnvironmentMap(suite);
+        benchmark::benchmarkShaderCompiler(suite);
+        benchmark::benchmarkJobSystem(suite);
+
+        suite.writeJson(output_path);
+    }
+    catch (...)
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
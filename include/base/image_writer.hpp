@@ -0,0 +1,27 @@
+#pragma once
+
+#include <base/math.hpp>
+
+#include <filesystem>
+#include <span>
+
+namespace vrts::image_writer
+{
+    /// pixels - width * height значений построчно сверху вниз.
+
+    /// 8 бит на канал, значения ограничиваются [0, 1] без гамма-коррекции.
+    void writePng(
+        const std::filesystem::path&    path, 
+        uint32_t                        width, 
+        uint32_t                        height, 
+        std::span<const glm::vec3>      pixels
+    );
+
+    /// Несжатый scanline OpenEXR с FLOAT-каналами, значения пишутся как есть.
+    void writeExr(
+        const std::filesystem::path&    path, 
+        uint32_t                        width, 
+        uint32_t                        height, 
+        std::span<const glm::vec3>      pixels
+    );
+}
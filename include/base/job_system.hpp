@@ -0,0 +1,111 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <vector>
+#include <deque>
+#include <span>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <exception>
+
+namespace vrts
+{
+    class JobSystem
+    {
+    public:
+        class Job;
+
+        using JobHandle = std::shared_ptr<Job>;
+
+    private:
+        struct WorkQueue
+        {
+            std::mutex              mutex;
+            std::deque<JobHandle>   jobs;
+        };
+
+        void enqueue(const JobHandle& ptr_job);
+        void execute(const JobHandle& ptr_job);
+
+        [[nodiscard]] JobHandle pop();
+        [[nodiscard]] bool      tryRunPendingJob();
+
+        void workerLoop(size_t queue_index);
+
+        [[nodiscard]] size_t getQueueIndex() const noexcept;
+
+    public:
+        /// thread_count - число рабочих потоков помимо вызывающего.
+        explicit JobSystem(size_t thread_count);
+
+        JobSystem(JobSystem&& job_system)       = delete;
+        JobSystem(const JobSystem& job_system)  = delete;
+
+        ~JobSystem();
+
+        JobSystem& operator = (JobSystem&& job_system)      = delete;
+        JobSystem& operator = (const JobSystem& job_system) = delete;
+
+        [[nodiscard]]
+        static JobSystem& get();
+
+        JobHandle submit(std::function<void ()>&& func, std::span<const JobHandle> dependencies = { });
+
+        void wait(const JobHandle& ptr_job);
+        void wait(std::span<const JobHandle> jobs);
+
+        void parallelFor(
+            size_t                                      begin,
+            size_t                                      end,
+            size_t                                      grain_size,
+            const std::function<void (size_t, size_t)>& func
+        );
+
+        [[nodiscard]]
+        size_t getThreadCount() const noexcept;
+
+    private:
+        std::vector<std::unique_ptr<WorkQueue>> _queues;
+        std::vector<std::jthread>               _threads;
+
+        std::mutex              _sleep_mutex;
+        std::condition_variable _wake_condition;
+        std::condition_variable _finish_condition;
+        std::atomic<size_t>     _queued_job_count   = 0;
+        bool                    _is_stopped         = false;
+    };
+
+    class JobSystem::Job
+    {
+        friend class JobSystem;
+
+    public:
+        explicit Job(std::function<void ()>&& func);
+
+        Job(Job&& job)      = delete;
+        Job(const Job& job) = delete;
+
+        Job& operator = (Job&& job)         = delete;
+        Job& operator = (const Job& job)    = delete;
+
+        [[nodiscard]]
+        bool isFinished() const noexcept;
+
+    private:
+        std::function<void ()> _func;
+
+        std::atomic<uint32_t>   _pending_dependency_count   = 1;
+        std::atomic<bool>       _is_finished                = false;
+
+        std::mutex              _continuations_mutex;
+        std::vector<JobHandle>  _continuations;
+
+        std::exception_ptr _exception;
+    };
+}
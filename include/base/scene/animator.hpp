@@ -1,6 +1,7 @@
 #pragma once
 
 #include <base/math.hpp>
+#include <base/scene/skinning_palette.hpp>
 
 #include <string>
 #include <string_view>
@@ -192,10 +193,14 @@ namespace vrts
 
         std::span<const glm::mat4> getFinalBoneMatrices() const;
 
+        [[nodiscard]]
+        const SkinningPalette& getSkinningPalette() const noexcept;
+
     private:
         std::vector<Bone>       _bones;
         BoneRegistry            _bone_registry;
         std::vector<glm::mat4>  _final_bones_matrices;
+        SkinningPalette         _skinning_palette;
 
         AnimationHierarchiry::Node _root_node;
         
@@ -221,6 +226,7 @@ namespace vrts
         Builder& boneRegistry(BoneRegistry&& bone_registry);
         Builder& animationHierarchiryRootNode(AnimationHierarchiry::Node&& root_node);
         Builder& time(float duration, float ticks_per_second);
+        Builder& skinningPalette(SkinningPaletteType type);
 
         Animator build();
 
@@ -228,6 +234,7 @@ namespace vrts
         std::vector<Bone>           _bones;
         BoneRegistry                _bone_registry;
         AnimationHierarchiry::Node  _root_node;
+        SkinningPaletteType         _skinning_palette_type = SkinningPaletteType::mat4;
 
         float _duration         = 0.0f; 
         float _ticks_per_second = 0.0f;
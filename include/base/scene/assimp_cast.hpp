@@ -0,0 +1,15 @@
+#pragma once
+
+#include <base/math.hpp>
+
+#include <assimp/types.h>
+
+namespace vrts::utils
+{
+    /// Типы assimp в типы glm. Векторы и цвета дополняются нулями до vec4.
+    [[nodiscard]] glm::mat4 cast(const aiMatrix4x4& matrix);
+    [[nodiscard]] glm::vec4 cast(const aiVector2D& vec);
+    [[nodiscard]] glm::vec4 cast(const aiVector3D& vec);
+    [[nodiscard]] glm::vec4 cast(const aiColor3D& col);
+    [[nodiscard]] glm::quat cast(const aiQuaternion& quat);
+}
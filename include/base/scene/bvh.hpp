@@ -0,0 +1,170 @@
+#pragma once
+
+#include <base/scene/mesh_data.hpp>
+
+#include <base/math.hpp>
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <limits>
+#include <atomic>
+
+namespace vrts
+{
+    struct AABB
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        void extend(const glm::vec3& point) noexcept;
+        void extend(const AABB& aabb)       noexcept;
+
+        [[nodiscard]] glm::vec3 getCenter()         const noexcept;
+        [[nodiscard]] float     getSurfaceArea()    const noexcept;
+        [[nodiscard]] bool      isValid()           const noexcept;
+
+        /// Объём, содержащий этот после преобразования matrix.
+        [[nodiscard]] AABB transform(const glm::mat4& matrix) const noexcept;
+    };
+
+    struct Ray
+    {
+        glm::vec3   origin;
+        glm::vec3   dir;
+        float       t_min = 0.0f;
+        float       t_max = std::numeric_limits<float>::infinity();
+    };
+
+    struct RayHit
+    {
+        float       t               = std::numeric_limits<float>::infinity();
+        glm::vec2   barycentric     = glm::vec2(0.0f);  ///< как hitAttributeEXT: p = (1 - x - y) * p0 + x * p1 + y * p2
+        uint32_t    primitive_id    = std::numeric_limits<uint32_t>::max();
+        uint32_t    instance_id     = std::numeric_limits<uint32_t>::max();     ///< Заполняет только TwoLevelBVH.
+    };
+
+    /// Расстояние входа луча в bounds на отрезке [ray.t_min, t_max] или бесконечность, если луч его не задевает.
+    [[nodiscard]]
+    float intersectBounds(const AABB& bounds, const Ray& ray, const glm::vec3& inv_dir, float t_max) noexcept;
+
+    class BVH
+    {
+    public:
+        /// Корень - глубина 1. Глубже max_depth узлы не делятся.
+        static constexpr uint32_t max_depth = 64;
+
+        /// Внутренний узел - count == 0, дети лежат в first и first + 1.
+        struct Node
+        {
+            AABB        bounds;
+            uint32_t    first = 0;
+            uint32_t    count = 0;
+        };
+
+        struct Statistics
+        {
+            double      build_time_ms       = 0.0;
+            double      refit_time_ms       = 0.0;      ///< Время последнего refit.
+            float       sah_cost            = 0.0f;     ///< Ожидаемая стоимость луча относительно площади корня (на момент build).
+            uint32_t    node_count          = 0;
+            uint32_t    leaf_count          = 0;
+            uint32_t    max_depth           = 0;
+            float       average_leaf_size   = 0.0f;
+        };
+
+    private:
+        struct BuildPrimitive
+        {
+            AABB        bounds;
+            uint32_t    primitive_id = 0;
+        };
+
+        struct BuildState
+        {
+            std::vector<BuildPrimitive> primitives;
+            std::atomic<uint32_t>       node_count = 0;
+        };
+
+        struct Split
+        {
+            int32_t     axis    = -1;
+            uint32_t    bin     = 0;
+            float       cost    = std::numeric_limits<float>::max();
+        };
+
+        /// Строит узлы по state.primitives и заполняет _primitive_ids в порядке листьев.
+        void buildNodes(BuildState& state);
+
+        void build(
+            BuildState&             state,
+            uint32_t                node_id, 
+            uint32_t                first, 
+            uint32_t                count,
+            uint32_t                depth
+        );
+
+        [[nodiscard]]
+        Split findSplit(
+            const BuildState&       state,
+            const AABB&             centroid_bounds,
+            uint32_t                first, 
+            uint32_t                count
+        ) const;
+
+        [[nodiscard]] Statistics computeStatistics() const;
+
+        void refitNode(uint32_t node_id, uint32_t depth);
+
+        [[nodiscard]]
+        bool intersect(const Ray& ray, uint32_t triangle_id, RayHit& hit) const;
+
+        template<bool any_hit>
+        [[nodiscard]] std::optional<RayHit> traverse(const Ray& ray) const;
+
+        BVH() = default;
+
+    public:
+        BVH(BVH&& bvh)      = default;
+        BVH(const BVH& bvh) = delete;
+
+        BVH& operator = (BVH&& bvh)         = default;
+        BVH& operator = (const BVH& bvh)    = delete;
+
+        /// positions - по 3 вершины на треугольник, primitive_id = индекс треугольника.
+        [[nodiscard]]
+        static BVH build(std::vector<glm::vec3>&& positions);
+
+        [[nodiscard]]
+        static BVH build(const MeshData& mesh_data);
+
+        /// BVH без треугольников: листья ссылаются на индексы bounds через getPrimitiveIds().
+        /// intersect() для неё ничего не находит, обход делает владелец (например, TwoLevelBVH).
+        [[nodiscard]]
+        static BVH build(std::span<const AABB> bounds);
+
+        /// Обновляет позиции и объёмы узлов снизу вверх за O(n), не меняя топологию дерева.
+        /// Подходит для скиннинга: при сильных деформациях качество SAH падает, тогда дешевле пересобрать.
+        /// positions - в том же порядке, что и при build.
+        void refit(std::span<const glm::vec3> positions);
+        void refit(const MeshData& mesh_data);
+
+        [[nodiscard]] std::optional<RayHit> intersect(const Ray& ray)   const;
+        [[nodiscard]] bool                  isOccluded(const Ray& ray)  const;
+
+        [[nodiscard]] std::span<const Node>         getNodes()          const noexcept;
+        [[nodiscard]] std::span<const glm::vec3>    getPositions()      const noexcept;
+        [[nodiscard]] std::span<const uint32_t>     getPrimitiveIds()   const noexcept;
+        [[nodiscard]] size_t                        getTriangleCount()  const noexcept;
+        [[nodiscard]] const Statistics&             getStatistics()     const noexcept;
+
+    private:
+        std::vector<Node>       _nodes;
+        std::vector<uint32_t>   _primitive_ids;
+        std::vector<glm::vec3>  _positions;
+
+        Statistics _statistics;
+    };
+}
+
+#include <base/scene/bvh.inl>
\ No newline at end of file
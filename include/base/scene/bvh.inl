@@ -0,0 +1,68 @@
+namespace vrts
+{
+    inline void AABB::extend(const glm::vec3& point) noexcept
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    inline void AABB::extend(const AABB& aabb) noexcept
+    {
+        min = glm::min(min, aabb.min);
+        max = glm::max(max, aabb.max);
+    }
+
+    inline glm::vec3 AABB::getCenter() const noexcept
+    {
+        return (min + max) * 0.5f;
+    }
+
+    inline float AABB::getSurfaceArea() const noexcept
+    {
+        if (!isValid())
+            return 0.0f;
+
+        const auto size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    inline bool AABB::isValid() const noexcept
+    {
+        return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+    }
+
+    inline AABB AABB::transform(const glm::mat4& matrix) const noexcept
+    {
+        AABB result;
+
+        if (!isValid())
+            return result;
+
+        for (auto corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec3 point (
+                corner & 1 ? max.x : min.x,
+                corner & 2 ? max.y : min.y,
+                corner & 4 ? max.z : min.z
+            );
+
+            result.extend(glm::vec3(matrix * glm::vec4(point, 1.0f)));
+        }
+
+        return result;
+    }
+
+    inline float intersectBounds(const AABB& bounds, const Ray& ray, const glm::vec3& inv_dir, float t_max) noexcept
+    {
+        const auto t0 = (bounds.min - ray.origin) * inv_dir;
+        const auto t1 = (bounds.max - ray.origin) * inv_dir;
+
+        const auto t_near   = glm::min(t0, t1);
+        const auto t_far    = glm::max(t0, t1);
+
+        const auto t_enter  = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, ray.t_min));
+        const auto t_exit   = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, t_max));
+
+        return t_enter <= t_exit ? t_enter : std::numeric_limits<float>::infinity();
+    }
+}
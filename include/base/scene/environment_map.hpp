@@ -0,0 +1,74 @@
+#pragma once
+
+#include <base/scene/light_sampler.hpp>
+
+#include <base/math.hpp>
+
+#include <filesystem>
+#include <vector>
+#include <span>
+
+namespace vrts
+{
+    /// Равнопромежуточная HDR-карта окружения: строка 0 - зенит (+Y), u растёт вместе с atan2(z, x).
+    /// Совпадает с shaders/utils/environment_sampling.glsl.
+    class EnvironmentMap
+    {
+    public:
+        struct Sample
+        {
+            glm::vec3   direction;
+            glm::vec3   radiance;
+            float       pdf         = 0.0f;     ///< По телесному углу.
+            uint32_t    pixel       = 0;
+        };
+
+    public:
+        EnvironmentMap() = default;
+
+        EnvironmentMap(EnvironmentMap&& environment_map)        = default;
+        EnvironmentMap(const EnvironmentMap& environment_map)   = delete;
+
+        EnvironmentMap& operator = (EnvironmentMap&& environment_map)       = default;
+        EnvironmentMap& operator = (const EnvironmentMap& environment_map)  = delete;
+
+        [[nodiscard]]
+        static EnvironmentMap build(uint32_t width, uint32_t height, std::vector<glm::vec3> pixels);
+
+        [[nodiscard]]
+        static EnvironmentMap load(const std::filesystem::path& path);
+
+        [[nodiscard]] Sample    sample(const glm::vec4& u)                  const noexcept;
+        [[nodiscard]] float     getPdf(const glm::vec3& direction)          const noexcept;
+        [[nodiscard]] glm::vec3 getRadiance(const glm::vec3& direction)     const noexcept;
+
+        [[nodiscard]] static glm::vec2 directionToUv(const glm::vec3& direction)    noexcept;
+        [[nodiscard]] static glm::vec3 uvToDirection(const glm::vec2& uv)           noexcept;
+
+        [[nodiscard]] uint32_t getWidth()   const noexcept;
+        [[nodiscard]] uint32_t getHeight()  const noexcept;
+
+        [[nodiscard]] std::span<const glm::vec3>            getPixels()             const noexcept;
+        [[nodiscard]] std::span<const AliasTable::Entry>    getMarginalTable()      const noexcept;
+
+        /// Условные таблицы всех строк подряд, alias - номер пикселя внутри строки.
+        [[nodiscard]] std::span<const AliasTable::Entry>    getConditionalTables()  const noexcept;
+
+        [[nodiscard]] std::span<const float>                getPixelPdfs()          const noexcept;
+
+        [[nodiscard]] bool empty() const noexcept;
+
+    private:
+        [[nodiscard]] uint32_t getPixel(const glm::vec2& uv) const noexcept;
+
+    private:
+        uint32_t _width     = 0;
+        uint32_t _height    = 0;
+
+        std::vector<glm::vec3> _pixels;
+
+        AliasTable                      _marginal;
+        std::vector<AliasTable::Entry>  _conditional;
+        std::vector<float>              _pixel_pdfs;
+    };
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <base/math.hpp>
+
+namespace vrts
+{
+    struct Light
+    {
+        alignas(16) glm::vec3 pos;
+        alignas(16) glm::vec3 col;
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <base/scene/light.hpp>
+
+#include <base/math.hpp>
+
+#include <vector>
+#include <span>
+#include <limits>
+
+namespace vrts
+{
+    /// Alias-таблица Уолкера, построение по Vose.
+    class AliasTable
+    {
+    public:
+        /// Совпадает с alias_entry_t в shaders/utils/light_sampling.glsl.
+        struct Entry
+        {
+            float       threshold   = 1.0f;     ///< Дробная часть u * size() меньше порога - сам элемент, иначе alias.
+            uint32_t    alias       = 0;
+        };
+
+    public:
+        AliasTable() = default;
+
+        AliasTable(AliasTable&& table)      = default;
+        AliasTable(const AliasTable& table) = delete;
+
+        AliasTable& operator = (AliasTable&& table)         = default;
+        AliasTable& operator = (const AliasTable& table)    = delete;
+
+        [[nodiscard]]
+        static AliasTable build(std::span<const float> weights);
+
+        [[nodiscard]] uint32_t  sample(float u)         const noexcept;
+        [[nodiscard]] float     getPdf(uint32_t id)     const;
+
+        [[nodiscard]] std::span<const Entry>    getEntries()    const noexcept;
+        [[nodiscard]] std::span<const float>    getPdfs()       const noexcept;
+        [[nodiscard]] double                    getTotalWeight() const noexcept;
+
+        [[nodiscard]] size_t    size()  const noexcept;
+        [[nodiscard]] bool      empty() const noexcept;
+
+    private:
+        std::vector<Entry> _entries;
+        std::vector<float> _pdfs;
+
+        double _total_weight = 0.0;
+    };
+
+    /// Совпадает с light_t в shaders/utils/light_sampling.glsl.
+    struct LightSource
+    {
+        glm::vec3   pos;
+        uint32_t    mesh_id;
+        glm::vec3   edge_1;             ///< У точечного источника - его цвет.
+        uint32_t    primitive_id;
+        glm::vec3   edge_2;
+        float       pdf;
+    };
+
+    class LightSampler
+    {
+    public:
+        class Builder;
+
+        static constexpr uint32_t point_light_mesh_id = std::numeric_limits<uint32_t>::max();
+
+    private:
+        LightSampler() = default;
+
+    public:
+        LightSampler(LightSampler&& light_sampler)      = default;
+        LightSampler(const LightSampler& light_sampler) = delete;
+
+        LightSampler& operator = (LightSampler&& light_sampler)         = default;
+        LightSampler& operator = (const LightSampler& light_sampler)    = delete;
+
+        [[nodiscard]] uint32_t sample(float u) const noexcept;
+
+        [[nodiscard]] float getAreaPdf(uint32_t mesh_id) const noexcept;
+
+        [[nodiscard]] std::span<const LightSource>          getLights()     const noexcept;
+        [[nodiscard]] std::span<const AliasTable::Entry>    getAliasTable() const noexcept;
+        [[nodiscard]] std::span<const float>                getAreaPdfs()   const noexcept;
+
+        [[nodiscard]] double getTotalPower() const noexcept;
+
+        [[nodiscard]] bool empty() const noexcept;
+
+    private:
+        std::vector<LightSource> _lights;
+        std::vector<float>       _area_pdfs;
+
+        AliasTable _alias_table;
+    };
+
+    class LightSampler::Builder
+    {
+        struct MeshLights
+        {
+            uint32_t    mesh_id;
+            glm::vec3   emission;
+        };
+
+    public:
+        Builder() = default;
+
+        Builder(Builder&& builder)      = delete;
+        Builder(const Builder& builder) = delete;
+
+        Builder& operator = (Builder&& builder)         = delete;
+        Builder& operator = (const Builder& builder)    = delete;
+
+        Builder& addMesh(
+            uint32_t                    mesh_id,
+            std::span<const glm::vec3>  positions,
+            std::span<const uint32_t>   primitive_ids,
+            const glm::vec3&            emission
+        );
+
+        Builder& addPointLight(const Light& light);
+
+        [[nodiscard]] LightSampler build();
+
+    private:
+        std::vector<LightSource>    _lights;
+        std::vector<float>          _weights;
+        std::vector<MeshLights>     _meshes;
+    };
+}
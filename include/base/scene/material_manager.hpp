@@ -17,8 +17,12 @@ namespace vrts
         std::optional<Image> metallic;
         std::optional<Image> roughness;
         std::optional<Image> emissive;
+
+        glm::vec3 average_emissive = glm::vec3(0.0f);
     };
 
+    /// Материалы хранятся один раз, инстанс ссылается на материал по индексу. 
+    /// Инстансы нумеруются в порядке bind(), как и меши в TLAS (индекс меша в шейдерах).
     class MaterialManager
     {
     public:
@@ -30,11 +34,23 @@ namespace vrts
         MaterialManager& operator = (MaterialManager&& material_manager)        = default;
         MaterialManager& operator = (const MaterialManager& material_manager)   = delete;
 
+        /// Уникальные материалы.
         [[nodiscard]] std::span<const Material> getMaterials() const;
 
+        [[nodiscard]] size_t            getInstanceCount()                      const noexcept;
+        [[nodiscard]] const Material&   getInstanceMaterial(size_t instance_id) const;
+
+        [[nodiscard]]
+        uint32_t create(Material&& material);
+
+        /// Назначает материал следующему инстансу.
+        void bind(uint32_t material_id);
+
+        /// Материал, который использует только один инстанс.
         void add(Material&& material);
 
     private:
         std::vector<Material> _materials;
+        std::vector<uint32_t> _instance_material_ids;
     };    
-}
\ No newline at end of file
+}
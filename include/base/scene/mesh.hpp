@@ -2,34 +2,37 @@
 
 #include <base/vulkan/buffer.hpp>
 
+#include <base/scene/vertex.hpp>
+#include <base/scene/skinning_data.hpp>
+
 #include <base/math.hpp>
 
+#include <vector>
+
 #include <optional>
 
 namespace vrts
 {
-    /// @todo
-    struct Attributes
+    struct MeshLod
     {
-        glm::vec4 pos;
-        glm::vec4 normal;
-        glm::vec4 tangent;
-        glm::vec4 uv;
+        std::optional<Buffer> index_buffer;
+        size_t index_count = 0;
+
+        float error = 0.0f;
     };
 
     struct Mesh
     {
         std::optional<Buffer> index_buffer;
         size_t index_count = 0;
+        VkIndexType index_type = VK_INDEX_TYPE_UINT32;
 
         std::optional<Buffer> vertex_buffer;
         size_t vertex_count = 0;
-    };
 
-    struct SkinningData
-    {
-        glm::ivec4  bone_ids    = glm::ivec4(-1);
-        glm::vec4   weights     = glm::vec4(-1.0f);
+        std::vector<MeshLod> lods;
+
+        glm::vec4 bounding_sphere = glm::vec4(0.0f);
     };
 
     struct SkinnedMesh
@@ -38,8 +41,11 @@ namespace vrts
         std::optional<Buffer> processed_vertex_buffer;
         std::optional<Buffer> skinning_buffer;
         size_t vertex_count = 0;
+
+        BoneIndexFormat bone_index_format = BoneIndexFormat::uint8;
         
         std::optional<Buffer> index_buffer;
         size_t index_count = 0;
+        VkIndexType index_type = VK_INDEX_TYPE_UINT32;
     };
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <base/scene/vertex.hpp>
+#include <base/scene/mesh_lod.hpp>
+
+#include <assimp/scene.h>
+
+#include <vector>
+
+namespace vrts
+{
+    /// Геометрия меша на CPU, подготовленная до любой работы с GPU.
+    struct MeshData
+    {
+        std::vector<uint32_t>   indices;
+        std::vector<Attributes> attributes;
+
+        /// Новый индекс вершины по её индексу в aiMesh. Пуст, если вершины не переставлялись.
+        std::vector<uint32_t> vertex_remap;
+
+        std::vector<mesh_lod::Lod> lods;
+    };
+}
+
+namespace vrts::mesh_conversion
+{
+    struct Locality
+    {
+        float acmr                      = 0.0f;     ///< Промахи FIFO-кэша на 32 вершины на треугольник.
+        float average_index_distance    = 0.0f;
+    };
+
+    [[nodiscard]]
+    bool isSupported(const aiMesh* ptr_mesh) noexcept;
+
+    [[nodiscard]]
+    Locality computeLocality(const MeshData& mesh_data);
+
+    /// Сортирует треугольники вдоль кривой Мортона по центроидам и нумерует вершины в порядке первого использования.
+    void optimizeLocality(MeshData& mesh_data);
+
+    /// Размеры выходных массивов вычисляются заранее, потоки атрибутов копируются отдельными циклами.
+    [[nodiscard]]
+    MeshData convert(const aiMesh* ptr_mesh);
+
+    /// Конвертирует все меши сцены параллельно. Результат индексируется так же, как aiScene::mMeshes,
+    /// для неподдерживаемых мешей данные пустые.
+    [[nodiscard]]
+    std::vector<MeshData> convert(const aiScene* ptr_scene);
+}
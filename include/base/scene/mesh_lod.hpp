@@ -0,0 +1,53 @@
+#pragma once
+
+#include <base/scene/vertex.hpp>
+
+#include <base/math.hpp>
+
+#include <vector>
+#include <span>
+
+namespace vrts::mesh_lod
+{
+    /// Должны совпадать с константами в shaders/utils/scene_geometry.glsl.
+    /// LOD инстанса хранится в старших битах gl_InstanceCustomIndexEXT, индекс меша - в младших.
+    constexpr uint32_t max_lod_count            = 4;
+    constexpr uint32_t custom_index_lod_shift   = 22;
+
+    struct Lod
+    {
+        std::vector<uint32_t> indices;
+
+        float error = 0.0f;
+    };
+
+    /// Garland-Heckbert. Граница меша (в том числе швы UV) сдвигается только вдоль себя.
+    [[nodiscard]]
+    Lod simplify(
+        std::span<const uint32_t>   indices,
+        std::span<const Attributes> attributes,
+        size_t                      target_index_count,
+        float                       max_error
+    );
+
+    [[nodiscard]]
+    std::vector<Lod> buildChain(std::span<const uint32_t> indices, std::span<const Attributes> attributes);
+
+    [[nodiscard]]
+    glm::vec4 getBoundingSphere(std::span<const Attributes> attributes);
+
+    [[nodiscard]]
+    float getMaxError(std::span<const Attributes> attributes);
+
+    [[nodiscard]]
+    float measureError(
+        std::span<const uint32_t>   indices,
+        std::span<const Attributes> attributes,
+        const Lod&                  lod,
+        size_t                      sample_count
+    );
+
+    /// errors[i] - ошибка LOD i + 1 в мировых единицах.
+    [[nodiscard]]
+    uint32_t select(std::span<const float> errors, float distance, float max_angular_error) noexcept;
+}
@@ -3,6 +3,7 @@
 #include <base/scene/node.hpp>
 #include <base/scene/material_manager.hpp>
 #include <base/scene/animator.hpp>
+#include <base/scene/transform_hierarchy.hpp>
 
 #include <base/math.hpp>
 
@@ -20,6 +21,8 @@ namespace vrts
 
         explicit Model(std::unique_ptr<Node>&& ptr_node, MaterialManager&& material_manager);
 
+        void registerNode(Node* ptr_node, uint32_t parent_id);
+
     public:
         template<IsNodeVisitor T>
         void visit(const std::unique_ptr<T>& ptr_visitor)
@@ -40,8 +43,16 @@ namespace vrts
 
         void addNode(std::unique_ptr<Node>&& ptr_child);
 
+        /// Пересчитывает мировые матрицы изменившихся поддеревьев. 
+        /// Возвращает transform_id узлов, чьи инстансы в TLAS нужно обновить.
+        std::span<const uint32_t> updateTransforms();
+
+        [[nodiscard]]
+        const TransformHierarchy& getTransformHierarchy() const noexcept;
+
     private:
         std::unique_ptr<Node>   _ptr_node;
         MaterialManager         _material_manager;
+        TransformHierarchy      _transforms;
     };
 }
\ No newline at end of file
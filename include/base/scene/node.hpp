@@ -4,6 +4,7 @@
 
 #include <base/scene/mesh.hpp>
 #include <base/scene/material_manager.hpp>
+#include <base/scene/transform_hierarchy.hpp>
 
 #include <base/scene/visitors/node_visitor.hpp>
 
@@ -11,9 +12,30 @@
 #include <optional>
 #include <string_view>
 #include <memory>
+#include <unordered_map>
 
 namespace vrts
 {
+    struct Node;
+
+    /// Входные данные TLAS узла, которые ASBuilder хранит между обходами, чтобы обновлять TLAS на месте.
+    struct TlasInstances
+    {
+        std::vector<const Node*>                        nodes;
+        std::vector<VkAccelerationStructureInstanceKHR> instances;
+
+        /// transform_id узла -> индекс его инстанса.
+        std::unordered_map<uint32_t, uint32_t> instance_ids;
+
+        uint32_t first_custom_index = 0;
+
+        /// TransformHierarchy::getUpdateCount() на момент последней записи инстансов.
+        uint64_t transforms_update_count = 0;
+
+        std::optional<Buffer> instances_buffer;
+        std::optional<Buffer> scratch_buffer;
+    };
+
     enum class NodeType
     {
         Base,
@@ -45,6 +67,10 @@ namespace vrts
         glm::mat4                               transform;
         std::vector<std::unique_ptr<Node>>      children;
         std::optional<AccelerationStructure>    acceleation_structure;
+        std::optional<TlasInstances>            tlas_instances;
+
+        /// Индекс в TransformHierarchy модели, назначается при добавлении узла в Model.
+        uint32_t transform_id = TransformHierarchy::invalid_id;
 
     protected:
         NodeType _type;
@@ -56,6 +82,8 @@ namespace vrts
         explicit MeshNode(const std::string_view name, const glm::mat4& transform, Mesh&& mesh);
 
         Mesh mesh;
+
+        uint32_t lod = 0;
     };
 
     struct SkinnedMeshNode final :
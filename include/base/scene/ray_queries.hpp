@@ -0,0 +1,103 @@
+#pragma once
+
+#include <base/scene/two_level_bvh.hpp>
+#include <base/scene/transform_hierarchy.hpp>
+#include <base/scene/skinning_palette.hpp>
+#include <base/scene/mesh_lod.hpp>
+
+#include <vector>
+#include <span>
+#include <optional>
+
+namespace vrts
+{
+    struct Node;
+
+    class ASBuilder;
+}
+
+namespace vrts
+{
+    /// CPU-копия геометрии сцены для запросов лучей: выбор мышью, проверка коллизий и т.п.
+    /// Меши добавляются в том же порядке, что и инстансы в TLAS у ASBuilder, поэтому mesh_id совпадает с gl_InstanceCustomIndexEXT.
+    class RayQueries
+    {
+    public:
+        struct Hit
+        {
+            const Node* ptr_node        = nullptr;
+            uint32_t    mesh_id         = 0;                    ///< gl_InstanceCustomIndexEXT
+            uint32_t    primitive_id    = 0;                    ///< gl_PrimitiveID
+            glm::vec2   barycentric     = glm::vec2(0.0f);      ///< Как hitAttributeEXT.
+            float       t               = 0.0f;
+            glm::vec3   pos             = glm::vec3(0.0f);      ///< В мировом пространстве.
+        };
+
+    private:
+        struct PendingMesh
+        {
+            std::span<const uint32_t>       indices;
+            std::span<const Attributes>     attributes;
+            std::span<const mesh_lod::Lod>  lods;
+        };
+
+        /// Для анимированных мешей храним позу привязки: update() скинит её на CPU и делает refit BVH.
+        struct SkinnedGeometry
+        {
+            uint32_t                    mesh_id;
+            std::vector<Attributes>     attributes;
+            std::vector<SkinningData>   skinning_data;
+            MeshData                    skinned_mesh_data;
+        };
+
+        [[nodiscard]] Hit getHit(const Ray& ray, const RayHit& hit) const;
+
+    public:
+        RayQueries() = default;
+
+        RayQueries(RayQueries&& ray_queries)        = default;
+        RayQueries(const RayQueries& ray_queries)   = delete;
+
+        RayQueries& operator = (RayQueries&& ray_queries)       = default;
+        RayQueries& operator = (const RayQueries& ray_queries)  = delete;
+
+        void add(
+            const Node*                     ptr_node,
+            std::span<const uint32_t>       indices,
+            std::span<const Attributes>     attributes,
+            std::span<const SkinningData>   skinning_data   = { },
+            std::span<const mesh_lod::Lod>  lods            = { }
+        );
+
+        /// Параллельно строит BVH мешей, добавленных после предыдущего build().
+        void build();
+
+        /// Переносит мировые матрицы узлов в инстансы и пересобирает верхний уровень.
+        /// Если передана палитра костей, анимированные меши скинятся на CPU, а их BVH обновляются через refit.
+        void update(const TransformHierarchy& transforms, const SkinningPalette* ptr_palette = nullptr);
+
+        void selectLods(const ASBuilder& as_builder);
+
+        [[nodiscard]] std::optional<Hit>    intersect(const Ray& ray)   const;
+        [[nodiscard]] bool                  isOccluded(const Ray& ray)  const;
+
+        /// Лучи распределяются по потокам JobSystem.
+        void intersect(std::span<const Ray> rays, std::span<std::optional<Hit>> hits) const;
+
+        [[nodiscard]] size_t getMeshCount() const noexcept;
+
+        [[nodiscard]] const TwoLevelBVH& getBVH() const noexcept;
+
+        [[nodiscard]] const BVH& getMeshBVH(uint32_t mesh_id, uint32_t lod = 0) const;
+
+    private:
+        TwoLevelBVH _bvh;
+
+        std::vector<const Node*> _nodes;    ///< По mesh_id.
+
+        std::vector<std::vector<uint32_t>> _lod_blas_ids;
+
+        std::vector<PendingMesh>        _pending_meshes;
+        std::vector<SkinnedGeometry>    _skinned_geometries;
+    };
+}
@@ -2,6 +2,10 @@
 
 #include <base/scene/model.hpp>
 #include <base/scene/mesh.hpp>
+#include <base/scene/mesh_data.hpp>
+#include <base/scene/light.hpp>
+#include <base/scene/ray_queries.hpp>
+#include <base/scene/light_sampler.hpp>
 
 #include <base/camera.hpp>
 
@@ -17,6 +21,8 @@
 #include <tuple>
 #include <map>
 
+#include <chrono>
+
 namespace vrts
 {
     struct Context;
@@ -25,16 +31,11 @@ namespace vrts
 
 namespace vrts
 {
-    struct Light
-    {
-        alignas(16) glm::vec3 pos;
-        alignas(16) glm::vec3 col;
-    };
-
     class Scene
     {
     public:
         class Importer;
+        class Generator;
 
     public:
         [[nodiscard]] Model&                    getModel()              noexcept;
@@ -48,11 +49,26 @@ namespace vrts
         [[nodiscard]]
         Animator& getAnimator();
 
+        /// Правая кнопка мыши поворачивает камеру к точке под курсором.
         void processEvent(const SDL_Event* ptr_event);
         void updateCamera();
 
         void applyTransform(const glm::mat4& transform);
 
+        /// Переносит текущие трансформации (и позу анимации, если есть аниматор) в CPU-структуру для запросов лучей.
+        /// Иерархия трансформаций не должна быть грязной: сначала Model::updateTransforms().
+        void updateRayQueries();
+
+        void selectRayQueryLods(const ASBuilder& as_builder);
+
+        /// Запросы лучей в мировом пространстве по состоянию на последний updateRayQueries().
+        [[nodiscard]] std::optional<RayQueries::Hit>    intersect(const Ray& ray)   const;
+        [[nodiscard]] bool                              isOccluded(const Ray& ray)  const;
+
+        void intersect(std::span<const Ray> rays, std::span<std::optional<RayQueries::Hit>> hits) const;
+
+        [[nodiscard]] LightSampler createLightSampler() const;
+
         void addRect(
             const Context*      ptr_context,
             const glm::vec3&    color,
@@ -65,15 +81,22 @@ namespace vrts
             Model&&                     model, 
             std::vector<Light>&&        lights, 
             const Camera&               camera,
-            std::optional<Animator>&&   animator
+            std::optional<Animator>&&   animator,
+            RayQueries&&                ray_queries
         );
 
+        [[nodiscard]]
+        static MeshData getRectMeshData();
+
         [[nodiscard]]
         static std::unique_ptr<MeshNode> makeRectNode(
             const Context*      ptr_context,
             const glm::mat4&    transform
         );
 
+        /// x, y - координаты курсора в окне.
+        void focus(int32_t x, int32_t y);
+
     private:
         Model _model;
 
@@ -82,6 +105,11 @@ namespace vrts
         CameraController _camera_controller; 
 
         std::optional<Animator> _animator;
+
+        RayQueries _ray_queries;
+
+        /// Общая геометрия прямоугольников addRect: запросы лучей читают её при отложенном build().
+        MeshData _rect_mesh_data = getRectMeshData();
     };
 
     class Scene::Importer
@@ -102,6 +130,7 @@ namespace vrts
         Importer& path(const std::filesystem::path path);
         Importer& vkMemoryTypeIndex(uint32_t memory_type_index) noexcept;
         Importer& viewport(uint32_t width, uint32_t heigth)     noexcept;
+        Importer& skinningPalette(SkinningPaletteType type)     noexcept;
 
         [[nodiscard]] Scene import();
 
@@ -109,28 +138,16 @@ namespace vrts
         size_t getMeshCount() const;
 
         void processMaterial(const aiScene* ptr_scene, const aiMaterial* ptr_material);
-        void processAnimation(const aiMesh* ptr_mesh, std::span<SkinningData> skinning_data);
+        void processAnimation(
+            const aiMesh*               ptr_mesh, 
+            std::span<const uint32_t>   vertex_remap, 
+            std::span<SkinningData>     skinning_data
+        );
         void processNode(const aiScene* ptr_scene, const aiNode* ptr_node);
 
         void getKeyFrames(const aiAnimation* ptr_animation);
         void getAnimation(const aiScene* ptr_scene);
 
-        [[nodiscard]]
-        Mesh createMesh (
-            const std::string_view      name,
-            const std::span<uint32_t>   indices,
-            const std::span<Attributes> attributes
-        ) const;
-        
-        [[nodiscard]]
-        SkinnedMesh createMesh (
-            const std::string_view          name,
-            const std::span<uint32_t>       indices,
-            const std::span<Attributes>     attributes,
-            const std::span<SkinningData>   skinning_data
-        ) const;
-
-
         [[nodiscard]]
         Image getImage(
             const aiTexture*    ptr_texture, 
@@ -150,11 +167,15 @@ namespace vrts
             VkFilter            filter
         );
 
+        [[nodiscard]]
+        glm::vec3 getAverageEmissive(const aiScene* ptr_scene, const aiMaterial* ptr_material) const;
+
         void add(
-            const std::string_view          name, 
-            const std::span<uint32_t>       indices, 
-            const std::span<Attributes>     attributes, 
-            const std::span<SkinningData>   skinning_data
+            const std::string_view                  name, 
+            const std::span<uint32_t>               indices, 
+            const std::span<Attributes>             attributes, 
+            const std::span<SkinningData>           skinning_data,
+            const std::span<const mesh_lod::Lod>    lods
         );
 
         void add(const aiLight* ptr_light);
@@ -175,6 +196,10 @@ namespace vrts
         
         std::unique_ptr<Node> _ptr_root_node;
 
+        std::vector<MeshData> _meshes_data;
+
+        RayQueries _ray_queries;
+
         std::vector<Light>                      _processed_lights;
         std::map<std::string, const aiLight*>   _scene_lights;
 
@@ -192,6 +217,65 @@ namespace vrts
             AnimationHierarchiry::Node* ptr_current_node = &root_node;
 
             std::optional<Animator> animator;
+
+            SkinningPaletteType skinning_palette_type = SkinningPaletteType::mat4;
         } _animation;
     };
-}
\ No newline at end of file
+
+    class Scene::Generator
+    {
+    public:
+        /// Затраты на создание сцены: время на CPU (вместе с синхронной загрузкой буферов) и объём данных на GPU.
+        struct Statistics
+        {
+            std::chrono::duration<float, std::milli> generate_time { };
+
+            size_t triangle_count       = 0;
+            size_t geometry_size        = 0;    ///< Байты буферов индексов, вершин и скиннинга.
+            size_t material_size        = 0;    ///< Байты изображений материалов без учёта выравнивания драйвером.
+        };
+
+    public:
+        Generator(const Context* ptr_context) noexcept;
+
+        Generator(Generator&& generator)        = delete;
+        Generator(const Generator& generator)   = delete;
+
+        Generator& operator = (Generator&& generator)       = delete;
+        Generator& operator = (const Generator& generator)  = delete;
+
+        Generator& instanceCount(uint32_t instance_count)                   noexcept;
+        Generator& triangleCount(uint32_t triangle_count)                   noexcept;
+        Generator& materialCount(uint32_t material_count)                   noexcept;
+        Generator& skinnedInstanceCount(uint32_t skinned_instance_count)    noexcept;
+        Generator& skinningPalette(SkinningPaletteType type)                noexcept;
+        Generator& viewport(uint32_t width, uint32_t heigth)                noexcept;
+        Generator& seed(uint32_t seed)                                      noexcept;
+
+        /// Меши без костей и скелетные копии (если есть) раскладываются по общей решётке.
+        /// Инстансы не делят буферы и BLAS: каждый получает свою копию меша, как отдельный узел при импорте.
+        [[nodiscard]] Scene generate();
+
+        [[nodiscard]]
+        const Statistics& getStatistics() const noexcept;
+
+    private:
+        void validate() const;
+
+    private:
+        const Context* _ptr_context;
+
+        uint32_t _instance_count            = 1;
+        uint32_t _triangle_count            = 2;
+        uint32_t _material_count            = 1;
+        uint32_t _skinned_instance_count    = 0;
+        uint32_t _seed                      = 0;
+
+        uint32_t _width     = 0;
+        uint32_t _height    = 0;
+
+        SkinningPaletteType _skinning_palette_type = SkinningPaletteType::mat4;
+
+        Statistics _statistics;
+    };
+}
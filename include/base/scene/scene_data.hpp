@@ -0,0 +1,116 @@
+#pragma once
+
+#include <base/scene/mesh_data.hpp>
+#include <base/scene/texture.hpp>
+#include <base/scene/light.hpp>
+
+#include <base/math.hpp>
+
+#include <assimp/scene.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <span>
+#include <map>
+
+namespace vrts
+{
+    struct MaterialData
+    {
+        Texture albedo;
+        Texture normal_map;
+        Texture metallic;
+        Texture roughness;
+        Texture emissive;
+    };
+
+    struct MeshInstance
+    {
+        std::string name;
+        MeshData    mesh;
+        glm::mat4   transform = glm::mat4(1.0f);    ///< В той же (транспонированной) записи, что и Node::transform.
+    };
+
+    /// Сцена только в памяти CPU: без Context, буферов и AS. 
+    /// Меши и материалы лежат в том же порядке, что и на GPU (материал i == gl_InstanceCustomIndexEXT меша i).
+    class SceneData
+    {
+    public:
+        class Loader;
+
+    private:
+        SceneData() = default;
+
+    public:
+        SceneData(SceneData&& scene_data)       = default;
+        SceneData(const SceneData& scene_data)  = delete;
+
+        SceneData& operator = (SceneData&& scene_data)      = default;
+        SceneData& operator = (const SceneData& scene_data) = delete;
+
+        /// Аналог Scene::applyTransform.
+        void applyTransform(const glm::mat4& transform);
+
+        /// Аналог Scene::addRect.
+        void addRect(
+            const glm::vec3& color,
+            const glm::vec3& emissive,
+            const glm::mat4& transform
+        );
+
+        [[nodiscard]] std::span<const MeshInstance> getMeshes()      const noexcept;
+        [[nodiscard]] std::span<const MaterialData> getMaterials()   const noexcept;
+        [[nodiscard]] std::span<const Light>        getLights()      const noexcept;
+
+        /// Матрица, которую шейдеры видят как gl_ObjectToWorldEXT.
+        [[nodiscard]]
+        glm::mat4 getObjectToWorld(size_t mesh_id) const;
+
+    private:
+        std::vector<MeshInstance>   _meshes;
+        std::vector<MaterialData>   _materials;
+        std::vector<Light>          _lights;
+
+        glm::mat4 _root_transform = glm::mat4(1.0f);
+    };
+
+    /// Повторяет Scene::Importer (те же флаги assimp, обход узлов и текстуры материалов), но ничего не загружает на GPU.
+    class SceneData::Loader
+    {
+    public:
+        Loader() = default;
+
+        Loader(Loader&& loader)         = delete;
+        Loader(const Loader& loader)    = delete;
+
+        Loader& operator = (Loader&& loader)        = delete;
+        Loader& operator = (const Loader& loader)   = delete;
+
+        Loader& path(const std::filesystem::path& path);
+
+        [[nodiscard]] SceneData load();
+
+    private:
+        void validate() const;
+
+        void processNode(const aiScene* ptr_scene, const aiNode* ptr_node, const glm::mat4& parent_transform);
+
+        [[nodiscard]]
+        static Texture getTexture(
+            const aiScene*      ptr_scene, 
+            const aiMaterial*   ptr_material, 
+            aiTextureType       texture_type,
+            int32_t             channels_per_pixel,
+            TextureFilter       filter
+        );
+
+    private:
+        std::filesystem::path _path;
+
+        SceneData               _scene_data;
+        std::vector<MeshData>   _meshes_data;
+
+        std::map<std::string, const aiLight*> _scene_lights;
+    };
+}
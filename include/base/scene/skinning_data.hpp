@@ -0,0 +1,40 @@
+#pragma once
+
+#include <base/scene/vertex.hpp>
+
+#include <vector>
+#include <span>
+
+namespace vrts
+{
+    /// Разрядность индексов костей в упакованных данных скиннинга.
+    /// Значения должны совпадать с константами bone_index_format_* в shaders/utils/skinning.glsl.
+    enum class BoneIndexFormat :
+        uint32_t
+    {
+        uint8,  ///< 8 байт на вершину: 4 x uint8 индекса + 4 x unorm8 веса.
+        uint16  ///< 12 байт на вершину: 4 x uint16 индекса + 4 x unorm8 веса.
+    };
+}
+
+namespace vrts::skinning
+{
+    /// Оставляет 4 влияния с наибольшими весами независимо от порядка, в котором их отдаёт Assimp.
+    void addInfluence(SkinningData& skinning_data, int32_t bone_id, float weight);
+
+    /// Сортирует влияния по убыванию веса и нормирует их сумму к 1.
+    void normalize(SkinningData& skinning_data);
+
+    [[nodiscard]] BoneIndexFormat   getBoneIndexFormat(std::span<const SkinningData> skinning_data);
+    [[nodiscard]] size_t            getWordsPerVertex(BoneIndexFormat format) noexcept;
+
+    [[nodiscard]]
+    std::vector<uint32_t> pack(std::span<const SkinningData> skinning_data, BoneIndexFormat format);
+
+    [[nodiscard]]
+    SkinningData unpack(
+        std::span<const uint32_t>   packed_skinning_data, 
+        BoneIndexFormat             format, 
+        size_t                      vertex_id
+    );
+}
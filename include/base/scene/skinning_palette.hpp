@@ -0,0 +1,60 @@
+#pragma once
+
+#include <base/scene/vertex.hpp>
+
+#include <base/math.hpp>
+
+#include <vector>
+#include <span>
+
+namespace vrts
+{
+    /// Значения должны совпадать с константами skinning_palette_* в shaders/utils/skinning.glsl.
+    enum class SkinningPaletteType :
+        uint32_t
+    {
+        mat4,
+        affine,
+        dual_quaternion
+    };
+
+    struct DualQuaternion
+    {
+        glm::vec4 real = glm::vec4(0, 0, 0, 1);
+        glm::vec4 dual = glm::vec4(0);
+    };
+
+    class SkinningPalette
+    {
+    public:
+        explicit SkinningPalette(SkinningPaletteType type = SkinningPaletteType::mat4) noexcept;
+
+        void update(std::span<const glm::mat4> final_bones_matrices);
+
+        [[nodiscard]] SkinningPaletteType       getType()       const noexcept;
+        [[nodiscard]] std::span<const glm::vec4> getData()      const noexcept;
+        [[nodiscard]] size_t                    getBoneCount()  const noexcept;
+
+        [[nodiscard]]
+        static size_t getVec4PerBone(SkinningPaletteType type) noexcept;
+
+    private:
+        SkinningPaletteType     _type;
+        std::vector<glm::vec4>  _data;
+
+        bool _is_scale_reported = false;
+    };
+}
+
+namespace vrts::skinning
+{
+    [[nodiscard]] glm::mat3x4       toAffine(const glm::mat4& matrix);
+    [[nodiscard]] DualQuaternion    toDualQuaternion(const glm::mat4& matrix);
+
+    [[nodiscard]]
+    Attributes skin(
+        const Attributes&           attributes,
+        const SkinningData&         skinning_data,
+        const SkinningPalette&      palette
+    );
+}
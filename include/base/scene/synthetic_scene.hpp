@@ -0,0 +1,37 @@
+#pragma once
+
+#include <base/scene/mesh_data.hpp>
+#include <base/scene/animator.hpp>
+
+#include <base/math.hpp>
+
+#include <vector>
+
+/// CPU-часть процедурных сцен для замеров масштабирования (см. Scene::Generator).
+/// Всё детерминировано: одинаковые параметры дают одинаковую сцену.
+namespace vrts::synthetic
+{
+    /// Волнистая сетка над [0, 1]^2 в плоскости z = 0, около triangle_count треугольников (не меньше 2).
+    /// Цепочка LOD строится так же, как при импорте меша без костей.
+    [[nodiscard]]
+    MeshData makeMesh(uint32_t triangle_count);
+
+    /// Две кости: 0 - неподвижный корень, 1 - верхняя половина сетки, которая качается вокруг y = 0.5.
+    [[nodiscard]]
+    std::vector<SkinningData> makeSkinningData(std::span<const Attributes> attributes);
+
+    [[nodiscard]]
+    Animator makeAnimator(SkinningPaletteType skinning_palette_type);
+
+    /// Инстансы раскладываются по кубической решётке со случайным поворотом вокруг y и масштабом.
+    [[nodiscard]]
+    glm::mat4 makeTransform(uint32_t instance_id, uint32_t instance_count, uint32_t seed);
+
+    /// Длина ребра решётки, в которую makeTransform раскладывает instance_count инстансов.
+    [[nodiscard]]
+    float getLatticeSize(uint32_t instance_count) noexcept;
+
+    /// Хорошо различимые цвета: оттенок сдвигается на золотое сечение.
+    [[nodiscard]]
+    glm::vec3 makeColor(uint32_t material_id) noexcept;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <base/math.hpp>
+
+#include <vector>
+#include <span>
+
+namespace vrts
+{
+    enum class TextureFilter
+    {
+        nearest,
+        linear
+    };
+
+    /// CPU-копия текстуры материала: те же форматы, mip-цепочка и адресация (repeat), что и у Image на GPU.
+    class Texture
+    {
+        struct Level
+        {
+            uint32_t                width   = 0;
+            uint32_t                height  = 0;
+            std::vector<uint8_t>    texels;
+        };
+
+        [[nodiscard]] glm::vec4 fetch(const Level& level, int32_t x, int32_t y)   const;
+        [[nodiscard]] glm::vec4 sample(const Level& level, const glm::vec2& uv)   const;
+
+        Texture() = default;
+
+    public:
+        Texture(Texture&& texture)      = default;
+        Texture(const Texture& texture) = delete;
+
+        Texture& operator = (Texture&& texture)         = default;
+        Texture& operator = (const Texture& texture)    = delete;
+
+        /// Текстура 1x1, в т.ч. с HDR-значениями (например, emissive у addRect).
+        [[nodiscard]]
+        static Texture fromColor(const glm::vec4& color);
+
+        [[nodiscard]]
+        static Texture decode(
+            std::span<const uint8_t>    compressed_image, 
+            int32_t                     channels_per_pixel, 
+            TextureFilter               filter
+        );
+
+        /// Аналог textureGrad с изотропными производными uv_footprint.
+        [[nodiscard]]
+        glm::vec4 sampleGrad(const glm::vec2& uv, float uv_footprint) const;
+
+        [[nodiscard]]
+        glm::vec4 getAverage() const;
+
+        [[nodiscard]] uint32_t getWidth()       const noexcept;
+        [[nodiscard]] uint32_t getHeight()      const noexcept;
+        [[nodiscard]] size_t   getLevelCount()  const noexcept;
+
+    private:
+        std::vector<Level> _levels;
+
+        int32_t         _channels_per_pixel = 4;
+        TextureFilter   _filter             = TextureFilter::linear;
+
+        glm::vec4 _color = glm::vec4(0.0f);
+    };
+}
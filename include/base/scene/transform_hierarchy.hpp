@@ -0,0 +1,60 @@
+#pragma once
+
+#include <base/math.hpp>
+
+#include <vector>
+#include <span>
+#include <limits>
+
+namespace vrts
+{
+    /// Плоская иерархия трансформаций в виде SoA.
+    /// Родитель всегда лежит раньше потомков, поэтому мировые матрицы пересчитываются одним линейным проходом,
+    /// и только для изменившихся поддеревьев.
+    /// Матрицы хранятся в той же (транспонированной) форме, что и Node::transform: world = local * parent_world.
+    class TransformHierarchy
+    {
+    public:
+        static constexpr auto invalid_id = std::numeric_limits<uint32_t>::max();
+
+        TransformHierarchy() = default;
+
+        TransformHierarchy(TransformHierarchy&& transforms)         = default;
+        TransformHierarchy(const TransformHierarchy& transforms)    = delete;
+
+        TransformHierarchy& operator = (TransformHierarchy&& transforms)        = default;
+        TransformHierarchy& operator = (const TransformHierarchy& transforms)   = delete;
+
+        uint32_t add(uint32_t parent_id, const glm::mat4& local_transform);
+
+        void setLocal(uint32_t id, const glm::mat4& local_transform);
+
+        /// Пересчитывает мировые матрицы грязных узлов и их потомков.
+        /// Возвращает узлы, у которых изменилась мировая матрица.
+        std::span<const uint32_t> update();
+
+        [[nodiscard]] const glm::mat4&  getLocal(uint32_t id)   const;
+        [[nodiscard]] const glm::mat4&  getWorld(uint32_t id)   const;
+        [[nodiscard]] uint32_t          getParent(uint32_t id)  const;
+
+        [[nodiscard]] std::span<const uint32_t> getChangedNodes() const noexcept;
+
+        /// Сколько раз вызывался update(). getChangedNodes() описывает только последний вызов.
+        [[nodiscard]] uint64_t getUpdateCount() const noexcept;
+
+        [[nodiscard]] size_t size()     const noexcept;
+        [[nodiscard]] bool   isDirty()  const noexcept;
+
+    private:
+        std::vector<uint32_t>   _parents;
+        std::vector<glm::mat4>  _local_transforms;
+        std::vector<glm::mat4>  _world_transforms;
+        std::vector<uint8_t>    _dirty;
+
+        std::vector<uint32_t> _changed_nodes;
+
+        uint32_t _first_dirty = invalid_id;
+
+        uint64_t _update_count = 0;
+    };
+}
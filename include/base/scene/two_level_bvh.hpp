@@ -0,0 +1,71 @@
+#pragma once
+
+#include <base/scene/bvh.hpp>
+
+#include <vector>
+#include <span>
+#include <optional>
+
+namespace vrts
+{
+    /// CPU-аналог разделения BLAS/TLAS в ASBuilder: BVH мешей в пространстве объекта
+    /// и верхняя BVH над их инстансами в мировом пространстве.
+    /// Движение инстансов требует только пересборки верхнего уровня, скиннинг - refit BVH меша.
+    class TwoLevelBVH
+    {
+    public:
+        struct Instance
+        {
+            uint32_t    blas_id;
+            glm::mat4   object_to_world;
+            glm::mat4   world_to_object;
+            AABB        bounds;             ///< В мировом пространстве, обновляется в build().
+        };
+
+    private:
+        template<bool any_hit>
+        [[nodiscard]] std::optional<RayHit> traverse(const Ray& ray) const;
+
+    public:
+        TwoLevelBVH() = default;
+
+        TwoLevelBVH(TwoLevelBVH&& bvh)      = default;
+        TwoLevelBVH(const TwoLevelBVH& bvh) = delete;
+
+        TwoLevelBVH& operator = (TwoLevelBVH&& bvh)         = default;
+        TwoLevelBVH& operator = (const TwoLevelBVH& bvh)    = delete;
+
+        /// Возвращает blas_id.
+        [[nodiscard]] uint32_t addBLAS(BVH&& bvh);
+
+        /// Возвращает instance_id, он же RayHit::instance_id.
+        [[nodiscard]] uint32_t addInstance(uint32_t blas_id, const glm::mat4& object_to_world);
+
+        void setTransform(uint32_t instance_id, const glm::mat4& object_to_world);
+
+        void setBLAS(uint32_t instance_id, uint32_t blas_id);
+
+        /// Обновляет BVH меша по новым позициям вершин за O(n). Индексы должны совпадать с теми, что были при построении.
+        void refit(uint32_t blas_id, const MeshData& mesh_data);
+        void refit(uint32_t blas_id, std::span<const glm::vec3> positions);
+
+        /// Пересобирает верхний уровень по текущим трансформациям и объёмам BLAS.
+        /// Инстансов мало, поэтому полная пересборка дешевле refit и не ухудшает качество дерева.
+        void build();
+
+        /// Пересечение с RayHit::instance_id. primitive_id - индекс треугольника в меше инстанса.
+        [[nodiscard]] std::optional<RayHit> intersect(const Ray& ray)   const;
+        [[nodiscard]] bool                  isOccluded(const Ray& ray)  const;
+
+        [[nodiscard]] const BVH&                getBLAS(uint32_t blas_id)   const;
+        [[nodiscard]] std::span<const Instance> getInstances()              const noexcept;
+
+    private:
+        std::vector<BVH>        _blases;
+        std::vector<Instance>   _instances;
+
+        std::optional<BVH> _tlas;
+
+        bool _is_dirty = false;
+    };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <base/math.hpp>
+
+namespace vrts
+{
+    /// @todo
+    struct Attributes
+    {
+        glm::vec4 pos;
+        glm::vec4 normal;
+        glm::vec4 tangent;
+        glm::vec4 uv;
+    };
+
+    struct SkinningData
+    {
+        glm::ivec4  bone_ids    = glm::ivec4(-1);
+        glm::vec4   weights     = glm::vec4(-1.0f);
+    };
+}
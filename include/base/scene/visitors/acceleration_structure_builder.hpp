@@ -4,13 +4,29 @@
 
 #include <base/scene/visitors/node_visitor.hpp>
 
+#include <base/math.hpp>
+
 #include <string_view>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace vrts
 {
     struct Context;
     struct Mesh;
     struct Buffer;
+
+    class TransformHierarchy;
+}
+
+namespace vrts
+{
+    struct LodPolicy
+    {
+        glm::vec3   eye;
+        float       max_angular_error = 0.001f;
+    };
 }
 
 namespace vrts
@@ -23,21 +39,49 @@ namespace vrts
             const Buffer&       vertex_buffer,
             uint32_t            vertex_count,
             const Buffer&       index_buffer,
-            uint32_t            index_count
+            uint32_t            index_count,
+            VkIndexType         index_type
         );
 
+        [[nodiscard]]
+        uint32_t selectLod(const MeshNode* ptr_node) const;
+
+        [[nodiscard]]
+        VkAccelerationStructureInstanceKHR getInstance(const Node* ptr_node, uint32_t custom_index) const;
+
+        void buildTLAS(Node* ptr_node, std::vector<const Node*>&& instance_nodes, uint32_t first_custom_index);
+
+        /// Переписывает инстансы узлов, у которых сменилась мировая матрица или BLAS, и обновляет TLAS без пересборки.
+        void updateTLAS(Node* ptr_node);
+
         void process(Node* ptr_node)            override;
         void process(MeshNode* ptr_node)        override;
         void process(SkinnedMeshNode* ptr_node) override;
 
     public:
-        ASBuilder(const Context* ptr_context);
+        ASBuilder(
+            const Context*              ptr_context, 
+            const TransformHierarchy&   transforms, 
+            std::optional<LodPolicy>    lod_policy = std::nullopt
+        );
+
+        [[nodiscard]]
+        uint32_t getSelectedLod(const Node* ptr_node) const noexcept;
 
     private:
         const Context* _ptr_context;
 
+        const TransformHierarchy* _ptr_transforms;
+
         uint32_t _custom_index = 0;
 
+        std::optional<LodPolicy> _lod_policy;
+
+        std::unordered_map<const Node*, uint32_t> _selected_lods;
+
+        /// Узлы, чей BLAS пересобран в этом обходе: адрес BLAS в их инстансах устарел.
+        std::vector<const Node*> _rebuilt_blas_nodes;
+
         std::optional<Buffer> _identity_matrix;
     };
 }
\ No newline at end of file
@@ -19,11 +19,20 @@ namespace vrts
     class SceneGeometryReferencesGetter final :
         public NodeVisitor
     {
+        /// Должна совпадать с index_buffer_reference_t в shaders/utils/scene_geometry.glsl.
+        struct IndexBufferReference
+        {
+            VkDeviceAddress address;
+            VkIndexType     index_type;
+            uint32_t        padding = 0;
+        };
+
         void process(Node* ptr_node)            override;
         void process(MeshNode* ptr_node)        override;
         void process(SkinnedMeshNode* ptr_node) override;
 
-        Buffer createBuffer(const std::vector<VkDeviceAddress>& references, const std::string_view name) const;
+        template<typename T>
+        Buffer createBuffer(const std::vector<T>& references, const std::string_view name) const;
 
     public:
         SceneGeometryReferencesGetter(const Context* ptr_context);
@@ -34,8 +43,8 @@ namespace vrts
         [[nodiscard]] Buffer getIndexBuffersReferences()    const;
 
     private:
-        std::vector<VkDeviceAddress> _vertex_buffers_references;
-        std::vector<VkDeviceAddress> _index_buffers_references;
+        std::vector<VkDeviceAddress>        _vertex_buffers_references;
+        std::vector<IndexBufferReference>   _index_buffers_references;
 
         const Context* _ptr_context = nullptr;
     };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <base/scene/bvh.hpp>
+#include <base/simd.hpp>
+
+#include <array>
+#include <vector>
+#include <span>
+#include <optional>
+
+namespace vrts
+{
+    template<uint32_t width>
+    class WideBVH
+    {
+    public:
+        static constexpr uint32_t leaf_flag     = 0x80000000u;
+        static constexpr uint32_t invalid_id    = std::numeric_limits<uint32_t>::max();
+
+        struct Node
+        {
+            std::array<float, width> min_x;
+            std::array<float, width> min_y;
+            std::array<float, width> min_z;
+            std::array<float, width> max_x;
+            std::array<float, width> max_y;
+            std::array<float, width> max_z;
+
+            std::array<uint32_t, width> children;       ///< Индекс узла или leaf_flag | первый блок треугольников.
+            std::array<uint32_t, width> block_counts;
+
+            uint32_t child_count = 0;
+        };
+
+        /// width треугольников: p0 и рёбра p1 - p0, p2 - p0. Пустые дорожки имеют нулевые рёбра и не пересекаются.
+        struct TriangleBlock
+        {
+            std::array<std::array<float, width>, 3> p0;
+            std::array<std::array<float, width>, 3> edge_1;
+            std::array<std::array<float, width>, 3> edge_2;
+
+            std::array<uint32_t, width> primitive_ids;
+        };
+
+    private:
+        static constexpr size_t max_stack_size = (BVH::max_depth - 1) * (width - 1) + 1;
+
+        [[nodiscard]] uint32_t collapse(const BVH& bvh, uint32_t node_id);
+        [[nodiscard]] uint32_t addLeaf(const BVH& bvh, const BVH::Node& node);
+
+        template<bool any_hit>
+        [[nodiscard]] std::optional<RayHit> traverse(const Ray& ray) const;
+
+        void intersectPacket(std::span<const Ray> rays, std::span<std::optional<RayHit>> hits) const;
+
+        WideBVH() = default;
+
+    public:
+        WideBVH(WideBVH&& bvh)      = default;
+        WideBVH(const WideBVH& bvh) = delete;
+
+        WideBVH& operator = (WideBVH&& bvh)         = default;
+        WideBVH& operator = (const WideBVH& bvh)    = delete;
+
+        [[nodiscard]]
+        static WideBVH collapse(const BVH& bvh);
+
+        [[nodiscard]] std::optional<RayHit> intersect(const Ray& ray)   const;
+        [[nodiscard]] bool                  isOccluded(const Ray& ray)  const;
+
+        void intersect(std::span<const Ray> rays, std::span<std::optional<RayHit>> hits) const;
+
+        [[nodiscard]] std::span<const Node>             getNodes()  const noexcept;
+        [[nodiscard]] std::span<const TriangleBlock>    getBlocks() const noexcept;
+
+    private:
+        std::vector<Node>           _nodes;
+        std::vector<TriangleBlock>  _blocks;
+    };
+
+    using WideBVH4 = WideBVH<4>;
+
+#if defined(__AVX2__) || defined(__AVX__)
+    using WideBVH8 = WideBVH<8>;
+#endif
+}
@@ -37,13 +37,14 @@ namespace vrts::shader
         Compiler& operator = (Compiler&& compiler)      = delete;
         Compiler& operator = (const Compiler& compiler) = delete;
 
-        [[nodiscard]]
-        static std::vector<uint32_t> createIL(const std::filesystem::path& filename, Type type);
-
     public:
         static void init();
         static void finalize() noexcept;
 
+        /// SPIR-V без создания VkShaderModule, устройство не нужно (например, для бенчмарков).
+        [[nodiscard]]
+        static std::vector<uint32_t> createIL(const std::filesystem::path& filename, Type type);
+
         [[nodiscard]]
         static VkShaderModule createShaderModule(
             VkDevice                        device_handle, 
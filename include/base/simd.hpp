@@ -0,0 +1,84 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+namespace vrts::simd
+{
+#if defined(__AVX2__) || defined(__AVX__)
+    constexpr uint32_t max_width = 8;
+#else
+    constexpr uint32_t max_width = 4;
+#endif
+
+    template<uint32_t width>
+    struct Float;
+
+    template<>
+    struct Float<4>
+    {
+        __m128 v;
+
+        [[nodiscard]] static Float load(const float* ptr_data)  noexcept { return {_mm_loadu_ps(ptr_data)}; }
+        [[nodiscard]] static Float broadcast(float value)       noexcept { return {_mm_set1_ps(value)}; }
+
+        void store(float* ptr_data) const noexcept { _mm_storeu_ps(ptr_data, v); }
+
+        friend Float operator + (Float a, Float b) noexcept { return {_mm_add_ps(a.v, b.v)}; }
+        friend Float operator - (Float a, Float b) noexcept { return {_mm_sub_ps(a.v, b.v)}; }
+        friend Float operator * (Float a, Float b) noexcept { return {_mm_mul_ps(a.v, b.v)}; }
+        friend Float operator / (Float a, Float b) noexcept { return {_mm_div_ps(a.v, b.v)}; }
+        friend Float operator & (Float a, Float b) noexcept { return {_mm_and_ps(a.v, b.v)}; }
+        friend Float operator | (Float a, Float b) noexcept { return {_mm_or_ps(a.v, b.v)}; }
+
+        friend Float operator <  (Float a, Float b) noexcept { return {_mm_cmplt_ps(a.v, b.v)}; }
+        friend Float operator <= (Float a, Float b) noexcept { return {_mm_cmple_ps(a.v, b.v)}; }
+        friend Float operator >  (Float a, Float b) noexcept { return {_mm_cmpgt_ps(a.v, b.v)}; }
+        friend Float operator >= (Float a, Float b) noexcept { return {_mm_cmpge_ps(a.v, b.v)}; }
+
+        friend Float min(Float a, Float b) noexcept { return {_mm_min_ps(a.v, b.v)}; }
+        friend Float max(Float a, Float b) noexcept { return {_mm_max_ps(a.v, b.v)}; }
+        friend Float abs(Float a)          noexcept { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+
+        friend Float select(Float mask, Float a, Float b) noexcept 
+        { 
+            return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))}; 
+        }
+
+        friend uint32_t movemask(Float mask) noexcept { return static_cast<uint32_t>(_mm_movemask_ps(mask.v)); }
+    };
+
+#if defined(__AVX2__) || defined(__AVX__)
+    template<>
+    struct Float<8>
+    {
+        __m256 v;
+
+        [[nodiscard]] static Float load(const float* ptr_data)  noexcept { return {_mm256_loadu_ps(ptr_data)}; }
+        [[nodiscard]] static Float broadcast(float value)       noexcept { return {_mm256_set1_ps(value)}; }
+
+        void store(float* ptr_data) const noexcept { _mm256_storeu_ps(ptr_data, v); }
+
+        friend Float operator + (Float a, Float b) noexcept { return {_mm256_add_ps(a.v, b.v)}; }
+        friend Float operator - (Float a, Float b) noexcept { return {_mm256_sub_ps(a.v, b.v)}; }
+        friend Float operator * (Float a, Float b) noexcept { return {_mm256_mul_ps(a.v, b.v)}; }
+        friend Float operator / (Float a, Float b) noexcept { return {_mm256_div_ps(a.v, b.v)}; }
+        friend Float operator & (Float a, Float b) noexcept { return {_mm256_and_ps(a.v, b.v)}; }
+        friend Float operator | (Float a, Float b) noexcept { return {_mm256_or_ps(a.v, b.v)}; }
+
+        friend Float operator <  (Float a, Float b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+        friend Float operator <= (Float a, Float b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+        friend Float operator >  (Float a, Float b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+        friend Float operator >= (Float a, Float b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+
+        friend Float min(Float a, Float b) noexcept { return {_mm256_min_ps(a.v, b.v)}; }
+        friend Float max(Float a, Float b) noexcept { return {_mm256_max_ps(a.v, b.v)}; }
+        friend Float abs(Float a)          noexcept { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+
+        friend Float select(Float mask, Float a, Float b) noexcept { return {_mm256_blendv_ps(b.v, a.v, mask.v)}; }
+
+        friend uint32_t movemask(Float mask) noexcept { return static_cast<uint32_t>(_mm256_movemask_ps(mask.v)); }
+    };
+#endif
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <base/math.hpp>
+
+#include <array>
+
+/// Последовательность Соболя с Owen-скрэмблингом на хешах (Burley, "Practical Hash-based Owen Scrambling", 2020).
+/// Совпадает с shaders/utils/sobol.glsl: таблица направляющих чисел считается здесь и загружается на GPU.
+namespace vrts::sobol
+{
+    /// Таблица хранит 4 измерения. Следующие четвёрки получаются из тех же 4 измерений
+    /// со своим seed: перемешивание индекса делает их независимыми друг от друга.
+    constexpr uint32_t dimension_count  = 4;
+    constexpr uint32_t bit_count        = 32;
+
+    using Directions = std::array<uint32_t, dimension_count * bit_count>;
+
+    [[nodiscard]] const Directions& getDirections() noexcept;
+
+    [[nodiscard]] uint32_t sample(uint32_t index, uint32_t dimension) noexcept;
+
+    [[nodiscard]] uint32_t hash(uint32_t x) noexcept;
+    [[nodiscard]] uint32_t hashCombine(uint32_t seed, uint32_t value) noexcept;
+
+    [[nodiscard]] uint32_t nestedUniformScramble(uint32_t x, uint32_t seed) noexcept;
+
+    [[nodiscard]] uint32_t getPixelSeed(uint32_t x, uint32_t y) noexcept;
+
+    [[nodiscard]] uint32_t getDimensionSeed(uint32_t pixel_seed, uint32_t dimension) noexcept;
+
+    [[nodiscard]] glm::vec4 getSample(uint32_t index, uint32_t seed) noexcept;
+}
@@ -13,6 +13,7 @@ namespace vrts
     {
         inline static const glm::vec3 write_data_in_buffer  = utils::generateColor(1);
         inline static const glm::vec3 write_data_in_image   = utils::generateColor(2);
+        inline static const glm::vec3 read_data_from_image  = utils::generateColor(9);
 
         inline static const glm::vec3 build_tlas = utils::generateColor(3);
         inline static const glm::vec3 build_blas = utils::generateColor(4);
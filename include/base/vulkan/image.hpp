@@ -45,6 +45,9 @@ namespace vrts
 
         void writeData(const ImageWriteData& write_data);
 
+        /// Изображение должно быть в GENERAL.
+        void readData(const ImageWriteData& read_data) const;
+
         static void init() noexcept;
 
     public:
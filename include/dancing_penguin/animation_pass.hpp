@@ -1,6 +1,7 @@
 #pragma once
 
 #include <base/scene/mesh.hpp>
+#include <base/scene/skinning_palette.hpp>
 #include <base/scene/visitors/node_visitor.hpp>
 
 #include <base/math.hpp>
@@ -31,12 +32,19 @@ namespace vrts::dancing_penguin
                 final_bones_matrices
             };
         };
+
+        /// Должны совпадать с push_constants в animation_pass.glsl.comp.
+        struct PushConstants
+        {
+            BoneIndexFormat bone_index_format;
+            VkIndexType     index_type;
+        };
         
         explicit AnimationPass(const Context* ptr_context);
 
         void bindMesh(const SkinnedMesh* ptr_mesh);
 
-        void updateMatrices(std::span<const glm::mat4> matrices);
+        void updateMatrices(std::span<const glm::vec4> palette);
 
     public:
         class Builder;
@@ -49,7 +57,7 @@ namespace vrts::dancing_penguin
         AnimationPass& operator = (AnimationPass&& animation_pass);
         AnimationPass& operator = (const AnimationPass& animation_pass) = delete;
 
-        void process(std::span<const glm::mat4> final_bones_matrices);
+        void process(const SkinningPalette& skinning_palette);
 
     private:
         std::vector<SkinnedMesh*> _meshes;
@@ -63,6 +71,8 @@ namespace vrts::dancing_penguin
 
         std::optional<Buffer> _final_bones_matrices;
 
+        SkinningPaletteType _skinning_palette_type = SkinningPaletteType::mat4;
+
         const Context* _ptr_context;
     };
 
@@ -90,11 +100,15 @@ namespace vrts::dancing_penguin
         Builder& operator = (Builder&& builder)         = delete;
         Builder& operator = (const Builder& builder)    = delete;
 
+        Builder& skinningPaletteType(SkinningPaletteType type) noexcept;
+
         AnimationPass build();
 
     private:
         const Context* _ptr_context;
 
+        SkinningPaletteType _skinning_palette_type = SkinningPaletteType::mat4;
+
         std::vector<SkinnedMesh*> _meshes;
 
         VkPipeline              _pipeline_handle        = VK_NULL_HANDLE;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <base/math.hpp>
+
+#include <vector>
+#include <span>
+
+/// À-trous с весами по AOV первого пересечения (Dammertz et al. 2010).
+/// CPU-версия shaders/junk_shop/atrous.glsl.comp.
+namespace vrts::junk_shop::atrous
+{
+    /// Совпадает с push_constants в atrous.glsl.comp (кроме номеров изображений и шага).
+    struct Parameters
+    {
+        uint32_t    iteration_count = 5;
+        float       color_sigma     = 0.5f;     ///< Делится на sqrt(числа кадров).
+        float       normal_sigma    = 128.0f;   ///< Степень косинуса между нормалями.
+        float       depth_sigma     = 0.01f;
+        float       albedo_sigma    = 0.1f;
+    };
+
+    struct FeatureBuffers
+    {
+        uint32_t width  = 0;
+        uint32_t height = 0;
+
+        std::vector<glm::vec3>  albedo;
+        std::vector<glm::vec3>  normal;
+        std::vector<float>      depth;
+    };
+
+    [[nodiscard]]
+    std::vector<glm::vec3> denoise(
+        std::span<const glm::vec3>  color,
+        float                       sample_count,
+        const FeatureBuffers&       features,
+        const Parameters&           parameters = { }
+    );
+
+    [[nodiscard]]
+    double getRmse(std::span<const glm::vec3> image, std::span<const glm::vec3> reference);
+}
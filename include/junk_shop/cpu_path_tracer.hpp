@@ -0,0 +1,162 @@
+#pragma once
+
+#include <base/scene/scene_data.hpp>
+#include <base/scene/wide_bvh.hpp>
+#include <base/scene/light_sampler.hpp>
+#include <base/scene/environment_map.hpp>
+
+#include <base/camera.hpp>
+
+#include <junk_shop/atrous_denoiser.hpp>
+
+#include <filesystem>
+#include <vector>
+#include <span>
+#include <array>
+#include <optional>
+
+namespace vrts::junk_shop
+{
+    /// CPU-версия junk_shop.glsl.rgen/rchit/rmiss: та же последовательность Соболя, BRDF из pbr.glsl, тонмаппинг и накопление кадров.
+    /// Нужна для проверки изображения и замеров без GPU с поддержкой трассировки лучей.
+    class CpuPathTracer
+    {
+        struct Surface
+        {
+            glm::vec3 pos;
+            glm::vec3 normal;       ///< В пространстве объекта, как surface.normal в шейдере.
+            glm::vec3 tangent;
+            glm::vec2 uv;
+
+            std::array<glm::vec3, 3> positions;
+            std::array<glm::vec2, 3> uvs;
+        };
+
+        struct Material
+        {
+            glm::vec3   albedo;
+            glm::vec3   emissive;
+            glm::vec3   shading_normal;
+            float       metallic;
+            float       roughness;
+        };
+
+        struct MeshTransform
+        {
+            glm::mat4 object_to_world;
+            glm::mat3 normal_matrix;
+        };
+
+        struct PathStatistics
+        {
+            uint64_t bounce_count           = 0;
+            uint64_t shadow_ray_count       = 0;
+            uint64_t terminated_path_count  = 0;
+
+            PathStatistics& operator += (const PathStatistics& statistics) noexcept;
+        };
+
+        [[nodiscard]] Surface   getSurface(const RayHit& hit, uint32_t mesh_id) const;
+        [[nodiscard]] Material  getMaterial(const Ray& ray, const RayHit& hit, uint32_t mesh_id, const Surface& surface) const;
+
+        [[nodiscard]] Ray       getPrimaryRay(uint32_t x, uint32_t y) const;
+
+        [[nodiscard]] uint32_t  getMeshId(uint32_t primitive_id) const;
+
+        /// junk_shop.glsl.rchit: get_emission_mis_weight
+        [[nodiscard]] float getEmissionMisWeight(const Ray& ray, const RayHit& hit, uint32_t mesh_id, const Surface& surface, float brdf_pdf) const;
+
+        /// shading.glsl: get_environment_mis_weight
+        [[nodiscard]] float getEnvironmentMisWeight(const glm::vec3& dir, float brdf_pdf) const;
+
+        /// shading.glsl: sample_environment_light
+        [[nodiscard]]
+        std::pair<glm::vec3, bool> sampleEnvironmentLight(const Material& material, const glm::vec3& v, const glm::vec3& origin, const glm::vec4& u) const;
+
+        /// junk_shop.glsl.rchit: sample_direct_light
+        [[nodiscard]]
+        std::pair<glm::vec3, bool> sampleDirectLight(const Material& material, const glm::vec3& v, const glm::vec3& origin, const glm::vec4& u) const;
+
+        /// Возвращает накопленную яркость пути и число выпущенных лучей.
+        [[nodiscard]]
+        std::pair<glm::vec3, PathStatistics> tracePath(uint32_t x, uint32_t y, uint32_t frame, const std::optional<RayHit>& primary_hit) const;
+
+        [[nodiscard]]
+        PathStatistics renderTile(uint32_t tile_id, uint32_t first_frame, uint32_t sample_count);
+
+    public:
+        CpuPathTracer(const SceneData& scene_data, const Camera& camera);
+
+        CpuPathTracer(CpuPathTracer&& path_tracer)      = delete;
+        CpuPathTracer(const CpuPathTracer& path_tracer) = delete;
+
+        CpuPathTracer& operator = (CpuPathTracer&& path_tracer)         = delete;
+        CpuPathTracer& operator = (const CpuPathTracer& path_tracer)    = delete;
+
+        void setRussianRouletteMinBounces(uint32_t min_bounces) noexcept;
+
+        /// Добавляет sample_count кадров к уже накопленным.
+        void render(uint32_t sample_count);
+
+        /// То, что junk_shop.glsl.rgen пишет в result: среднее тонмапленных кадров, строки сверху вниз.
+        [[nodiscard]] std::vector<glm::vec3> getResult() const;
+
+        /// Средняя яркость до тонмаппинга.
+        [[nodiscard]] std::vector<glm::vec3> getRadiance() const;
+
+        [[nodiscard]] const atrous::FeatureBuffers& getFeatures() const noexcept;
+
+        /// *.png - getResult(), *.exr - getRadiance().
+        void save(const std::filesystem::path& path) const;
+
+        void saveFeatures(const std::filesystem::path& path) const;
+
+        [[nodiscard]] uint32_t getAccumulatedFramesCount() const noexcept;
+
+    private:
+        const SceneData& _scene_data;
+
+        uint32_t _width;
+        uint32_t _height;
+
+        glm::mat4   _inv_view_matrix;
+        glm::mat4   _inv_projection_matrix;
+        float       _eye_to_pixel_cone_spread_angle;
+
+        std::vector<MeshTransform>  _mesh_transforms;
+        std::vector<uint32_t>       _first_primitive_ids;   ///< Префиксные суммы числа треугольников мешей.
+
+        std::optional<WideBVH<simd::max_width>> _bvh;
+        std::optional<LightSampler>             _light_sampler;
+
+        EnvironmentMap  _environment_map;
+        float           _environment_selection_probability = 0.0f;
+
+        std::vector<glm::vec3> _accumulated_color;
+        std::vector<glm::vec3> _accumulated_radiance;
+
+        atrous::FeatureBuffers _features;
+
+        uint32_t _accumulated_frames_count = 0;
+
+        uint32_t _russian_roulette_min_bounces = 3;
+    };
+
+    [[nodiscard]]
+    glm::vec3 getSkyColor(const glm::vec3& direction) noexcept;
+
+    /// content/environment.hdr, если он есть, иначе запечённое getSkyColor.
+    [[nodiscard]]
+    EnvironmentMap createEnvironmentMap();
+
+    [[nodiscard]]
+    float getEnvironmentSelectionProbability(const EnvironmentMap& environment_map, size_t light_count) noexcept;
+
+    /// Рендерит сцену JunkShop (та же сцена, прямоугольный источник и камера) и сохраняет результат в output_path.
+    void renderReference(
+        const std::filesystem::path&    output_path, 
+        uint32_t                        width, 
+        uint32_t                        height, 
+        uint32_t                        sample_count
+    );
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <junk_shop/atrous_denoiser.hpp>
+
+#include <base/vulkan/image.hpp>
+
+#include <array>
+#include <optional>
+
+namespace vrts
+{
+    struct Context;
+}
+
+namespace vrts::junk_shop
+{
+    /// GPU-версия atrous::denoise.
+    class DenoisePass
+    {
+        struct Bindings
+        {
+            enum :
+                size_t
+            {
+                colors,
+                albedo,
+                normal,
+                depth,
+
+                count
+            };
+        };
+
+        /// Индексы в массиве colors в atrous.glsl.comp.
+        struct Images
+        {
+            enum :
+                uint32_t
+            {
+                source,
+                ping,
+                pong,
+                result,
+
+                count
+            };
+        };
+
+        /// Должны совпадать с push_constants в atrous.glsl.comp.
+        struct PushConstants
+        {
+            uint32_t    src;
+            uint32_t    dst;
+            int32_t     step_size;
+            float       color_sigma;
+            float       normal_sigma;
+            float       depth_sigma;
+            float       albedo_sigma;
+        };
+
+        explicit DenoisePass(const Context* ptr_context);
+
+        void createIntermediateImages();
+
+    public:
+        class Builder;
+
+        DenoisePass(DenoisePass&& denoise_pass);
+        DenoisePass(const DenoisePass& denoise_pass) = delete;
+
+        ~DenoisePass();
+
+        DenoisePass& operator = (DenoisePass&& denoise_pass);
+        DenoisePass& operator = (const DenoisePass& denoise_pass) = delete;
+
+        /// Пересоздаёт промежуточные изображения. После него нужен updateDescriptorSet.
+        void resize(uint32_t width, uint32_t height);
+
+        void updateDescriptorSet(
+            VkImageView source,
+            VkImageView albedo,
+            VkImageView normal,
+            VkImageView depth,
+            VkImageView result
+        );
+
+        void process(VkCommandBuffer command_buffer_handle) const;
+
+    private:
+        atrous::Parameters _parameters;
+
+        uint32_t _width     = 0;
+        uint32_t _height    = 0;
+
+        std::array<std::optional<Image>, 2> _intermediate_images;
+
+        VkPipeline              _pipeline_handle        = VK_NULL_HANDLE;
+        VkPipelineLayout        _pipeline_layout        = VK_NULL_HANDLE;
+        VkDescriptorSetLayout   _descriptor_set_layout  = VK_NULL_HANDLE;
+
+        VkDescriptorPool    _descriptor_pool_handle = VK_NULL_HANDLE;
+        VkDescriptorSet     _descriptor_set_handle  = VK_NULL_HANDLE;
+
+        const Context* _ptr_context;
+    };
+
+    class DenoisePass::Builder
+    {
+        void createPipelineLayout();
+        void createPipeline();
+
+        void createDescriptorPool();
+        void allocateDescriptorSet();
+
+    public:
+        Builder(const Context* ptr_context);
+
+        Builder(Builder&& builder)      = delete;
+        Builder(const Builder& builder) = delete;
+
+        ~Builder();
+
+        Builder& operator = (Builder&& builder)         = delete;
+        Builder& operator = (const Builder& builder)    = delete;
+
+        Builder& parameters(const atrous::Parameters& parameters) noexcept;
+        Builder& size(uint32_t width, uint32_t height) noexcept;
+
+        DenoisePass build();
+
+    private:
+        const Context* _ptr_context;
+
+        atrous::Parameters _parameters;
+
+        uint32_t _width     = 0;
+        uint32_t _height    = 0;
+
+        VkPipeline              _pipeline_handle        = VK_NULL_HANDLE;
+        VkPipelineLayout        _pipeline_layout        = VK_NULL_HANDLE;
+        VkDescriptorSetLayout   _descriptor_set_layout  = VK_NULL_HANDLE;
+
+        VkDescriptorPool    _descriptor_pool_handle = VK_NULL_HANDLE;
+        VkDescriptorSet     _descriptor_set_handle  = VK_NULL_HANDLE;
+
+        VkShaderModule _compute_shader_handle = VK_NULL_HANDLE;
+    };
+}
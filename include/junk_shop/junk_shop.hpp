@@ -4,7 +4,13 @@
 
 #include <base/scene/scene.hpp>
 
+#include <junk_shop/denoise_pass.hpp>
+#include <junk_shop/wavefront_pass.hpp>
+
 #include <array>
+#include <limits>
+#include <chrono>
+#include <filesystem>
 
 using namespace vrts;
 
@@ -29,11 +35,16 @@ namespace vrts::junk_shop
         {
             CameraData  camera_data;
             uint32_t    accumulated_frames_count    = 0;
+            uint32_t    is_aovs_enabled             = 0;
+            glm::ivec2  tile_offset                 = glm::ivec2(0);    ///< gl_LaunchIDEXT считается от него.
+            uint32_t    is_radiance_accumulated     = 0;
+            uint32_t    render_scale                = 1;    ///< Один путь на блок render_scale x render_scale пикселей.
         } rgen_consts;
 
         struct ClosestHit
         {
-            float eye_to_pixel_cone_spread_angle = 0.0f;
+            float       eye_to_pixel_cone_spread_angle  = 0.0f;
+            uint32_t    russian_roulette_min_bounces    = 0;
         } chit_consts;
     };
 
@@ -44,6 +55,7 @@ namespace vrts::junk_shop
             ray_gen,
             chit,
             miss,
+            shadow_miss,
 
             count
         };
@@ -66,10 +78,108 @@ namespace vrts::junk_shop
             roughness,
             emissive,
 
+            light_sampler,
+
+            sobol,
+
+            path_statistics,
+
+            history_buffer,
+            depth_buffer,
+            history_depth_buffer,
+            reprojection,
+
+            albedo_aov,
+            normal_aov,
+
+            moments_buffer,
+            history_moments_buffer,
+            adaptive_sampling,
+            tile_errors,
+            history_tile_errors,
+
+            environment,
+
             count
         };
     };
 
+    /// Совпадает с light_sampler_b в junk_shop.glsl.rchit.
+    struct LightSamplerInfo
+    {
+        VkDeviceAddress lights          = 0;
+        VkDeviceAddress alias_table     = 0;
+        VkDeviceAddress area_pdfs       = 0;
+        uint32_t        light_count     = 0;
+        uint32_t        area_pdf_count  = 0;
+    };
+
+    /// Совпадает с environment_t в shaders/utils/environment_sampling.glsl.
+    struct EnvironmentInfo
+    {
+        VkDeviceAddress pixels                  = 0;
+        VkDeviceAddress marginal                = 0;
+        VkDeviceAddress conditional             = 0;
+        VkDeviceAddress pixel_pdfs              = 0;
+        uint32_t        width                   = 0;
+        uint32_t        height                  = 0;
+        float           selection_probability   = 0.0f;
+        uint32_t        padding                 = 0;
+    };
+
+    /// Совпадает с path_statistics_b в junk_shop.glsl.rgen.
+    struct PathStatistics
+    {
+        uint32_t bounce_count           = 0;
+        uint32_t terminated_path_count  = 0;
+        uint32_t path_count             = 0;
+        uint32_t shadow_ray_count       = 0;
+    };
+
+    /// Как adaptive_tile_size и tile_error_scale в shared.glsl.
+    constexpr uint32_t  adaptive_tile_size  = 16;
+    constexpr float     tile_error_scale    = 65536.0f;
+
+    /// Совпадает с adaptive_sampling_b в junk_shop.glsl.rgen.
+    struct AdaptiveSamplingData
+    {
+        float       target_error        = 0.01f;    ///< Относительная стандартная ошибка яркости, при которой тайл считается сошедшимся.
+        uint32_t    min_sample_count    = 16;
+        uint32_t    is_enabled          = 0;
+        uint32_t    tile_count_x        = 0;
+    };
+
+    /// Совпадает с reprojection_b в junk_shop.glsl.rgen.
+    struct ReprojectionData
+    {
+        glm::mat4   prev_view_projection    = glm::mat4(1.0f);
+        glm::vec4   prev_eye                = glm::vec4(0.0f);
+        uint32_t    history_limit           = std::numeric_limits<uint32_t>::max();
+        uint32_t    is_enabled              = 1;
+        uint32_t    is_camera_moved         = 0;
+        uint32_t    padding                 = 0;
+    };
+
+    /// Пока камера движется, разрешение трассировки держит время кадра в бюджете.
+    struct RenderScaleSettings
+    {
+        float       frame_time_budget   = 1.0f / 30.0f;     ///< В секундах.
+        uint32_t    max_scale           = 4;
+        uint32_t    moving_scale        = 2;
+    };
+
+    struct OfflineSettings
+    {
+        std::filesystem::path output_path;      ///< Без расширения: пишутся .exr с яркостью и .png с тонмаппингом.
+        std::filesystem::path checkpoint_path;  ///< Если файл есть, рендер продолжается с него. Пустой путь - без контрольных точек.
+
+        uint32_t width              = 1920;
+        uint32_t height             = 1080;
+        uint32_t sample_count       = 1024;
+        uint32_t tile_size          = 256;
+        uint32_t checkpoint_period  = 64;   ///< 0 - только при прерывании и в конце.
+    };
+
     using PoolSizes                 = std::array<VkDescriptorPoolSize, junk_shop::DescriptorSets::count>;
     using DescriptorSetsBindings    = std::array<VkDescriptorSetLayoutBinding, junk_shop::DescriptorSets::count>;
 }
@@ -85,6 +195,9 @@ class JunkShop final :
 public:
     ~JunkShop();
 
+    /// Сам вызывает init. При закрытии окна сохраняет контрольную точку и выходит.
+    void renderOffline(const junk_shop::OfflineSettings& settings);
+
 private:
     void createPipelineLayout();
     void createPipeline();
@@ -92,7 +205,20 @@ private:
     void createShaderBindingTable();
     void createDescriptorSets();
     void createAS();
-    void createAccumulationBuffer();
+
+    void updateLods();
+    void createAccumulationBuffers();
+    void createReprojectionBuffer();
+    void createAovImages();
+    void createDenoisePass();
+    void createWavefrontPass();
+    void createAdaptiveSamplingBuffers();
+
+    void updateAdaptiveSamplingData();
+    void createLightSampler();
+    void createEnvironment();
+    void createSobolDirections();
+    void createPathStatisticsBuffer();
 
     void importScene();
     void initVertexBuffersReferences();
@@ -104,11 +230,39 @@ private:
 
     void buildCommandBuffers();
 
-    void updateDescriptorSet(uint32_t image_index);
+    void updateDescriptorSet(VkImageView result_view_handle);
+
+    void clearFrameCounters(VkCommandBuffer command_buffer_handle) const;
+
+    void traceRays(VkCommandBuffer command_buffer_handle, const junk_shop::PushConstants& push_constants, uint32_t width, uint32_t height) const;
+
+    [[nodiscard]]
+    std::vector<glm::vec4> readAccumulationBuffer() const;
+
+    void saveCheckpoint(const std::filesystem::path& path) const;
+
+    [[nodiscard]]
+    bool loadCheckpoint(const std::filesystem::path& path);
+
+
+    junk_shop::PathStatistics processPathStatistics();
+
+    void processQueueStatistics();
+
+    void updateReprojection();
+
+    void processTileErrors(const junk_shop::PathStatistics& statistics);
+
+    void restartConvergenceTimer();
+
+    void updateRenderScale();
 
     [[nodiscard]]
     junk_shop::PushConstants getPushConstantData();
 
+    [[nodiscard]]
+    junk_shop::WavefrontPass::PushConstants getWavefrontPushConstantData();
+
     [[nodiscard]]
     bool processEvents();
 
@@ -153,6 +307,18 @@ private:
 
     uint32_t _accumulated_frames_count = 0;
 
+    uint32_t _russian_roulette_min_bounces = 3;
+
+    struct
+    {
+        std::optional<Buffer> buffer;
+
+        uint64_t bounce_count           = 0;
+        uint64_t terminated_path_count  = 0;
+        uint64_t path_count             = 0;
+        uint32_t frame_count            = 0;
+    } _path_statistics;
+
     struct 
     {
         std::optional<Buffer> scene_geometries_ref;
@@ -161,9 +327,105 @@ private:
         std::optional<Buffer> scene_info_reference;
     } _vertex_buffers_references;
 
+    struct
+    {
+        std::optional<Buffer> lights;
+        std::optional<Buffer> alias_table;
+        std::optional<Buffer> area_pdfs;
+
+        std::optional<Buffer> info;
+
+        uint32_t light_count = 0;
+    } _light_sampler;
+
+    struct
+    {
+        std::optional<Buffer> pixels;
+        std::optional<Buffer> marginal;
+        std::optional<Buffer> conditional;
+        std::optional<Buffer> pixel_pdfs;
+
+        std::optional<Buffer> info;
+    } _environment;
+
+    struct
+    {
+        std::optional<Buffer> directions;
+        std::optional<Buffer> reference;
+    } _sobol;
+
     junk_shop::DrawStay _draw_stay = junk_shop::DrawStay::draw;
     
-    std::optional<Image> _accumulation_buffer;
+    std::array<std::optional<Image>, 2> _accumulation_buffers;
+    std::array<std::optional<Image>, 2> _depth_buffers;
+    std::array<std::optional<Image>, 2> _moment_buffers;
+
+    uint32_t _current_buffer_index = 0;
+
+    struct
+    {
+        std::optional<Buffer> buffer;
+
+        glm::mat4 view_projection   = glm::mat4(1.0f);
+        glm::vec3 eye               = glm::vec3(0.0f);
+
+        bool is_enabled         = true;
+        bool is_camera_moved    = false;
+    } _reprojection;
+
+    glm::vec3 _lod_eye = glm::vec3(0.0f);
+
+    struct
+    {
+        std::optional<Buffer> data;
+
+        std::array<std::optional<Buffer>, 2> tile_errors;
+
+        junk_shop::AdaptiveSamplingData settings;
+
+        uint32_t tile_count = 0;
+
+        std::chrono::steady_clock::time_point start_time;
+
+        uint32_t frame_count        = 0;
+        uint64_t traced_path_count  = 0;
+        bool     is_target_reached  = false;
+    } _adaptive_sampling;
+
+    struct
+    {
+        std::optional<junk_shop::DenoisePass> pass;
+
+        std::optional<Image> albedo_aov;
+        std::optional<Image> normal_aov;
+
+        bool is_enabled = true;
+    } _denoiser;
+
+    /// Репроекция, адаптивные семплы, шумоподавление и пониженное разрешение в wavefront-режиме не работают.
+    struct
+    {
+        std::optional<junk_shop::WavefrontPass> pass;
+
+        std::array<uint64_t, junk_shop::WavefrontPass::max_bounce_count> ray_counts         = { };
+        std::array<uint64_t, junk_shop::WavefrontPass::max_bounce_count> hit_counts         = { };
+        std::array<uint64_t, junk_shop::WavefrontPass::max_bounce_count> shadow_ray_counts  = { };
+
+        uint32_t frame_count = 0;
+
+        bool is_enabled = false;
+    } _wavefront;
+
+    struct
+    {
+        junk_shop::RenderScaleSettings settings;
+
+        uint32_t scale = 1;
+
+        std::chrono::steady_clock::time_point last_frame_time;
+
+        bool is_enabled = true;
+    } _render_scale;
 
     struct
     {
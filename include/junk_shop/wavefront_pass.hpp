@@ -0,0 +1,207 @@
+#pragma once
+
+#include <base/vulkan/buffer.hpp>
+
+#include <base/math.hpp>
+
+#include <array>
+#include <optional>
+
+namespace vrts
+{
+    struct Context;
+}
+
+namespace vrts::junk_shop
+{
+    /// Те же пути, что у rgen и rchit JunkShop, но отскок разбит на compute-стадии (Laine et al. 2013).
+    class WavefrontPass
+    {
+        struct Bindings
+        {
+            enum :
+                size_t
+            {
+                queues,
+                paths,
+                hits,
+                ray_queues,
+                hit_queue,
+                sorted_hit_queue,
+                shadow_queue,
+                material_bins,
+
+                count
+            };
+        };
+
+        struct Stages
+        {
+            enum :
+                size_t
+            {
+                generate,
+                extend,
+                scan,
+                sort,
+                shade,
+                connect,
+                resolve,
+
+                count
+            };
+        };
+
+        /// Индексы в queues_b в wavefront.glsl.
+        struct Queues
+        {
+            enum :
+                uint32_t
+            {
+                even_rays,
+                odd_rays,
+                hits,
+                shadow_rays,
+
+                count
+            };
+        };
+
+        /// Совпадает с queue_t в wavefront.glsl.
+        struct Queue
+        {
+            uint32_t                    count;
+            VkDispatchIndirectCommand   group_count;
+        };
+
+        /// Совпадают с path_t, hit_record_t и shadow_ray_t в wavefront.glsl.
+        static constexpr VkDeviceSize path_size         = 64;
+        static constexpr VkDeviceSize hit_record_size   = 80;
+        static constexpr VkDeviceSize shadow_ray_size   = 48;
+
+        /// Совпадает с material_bin_t в wavefront.glsl.
+        struct MaterialBin
+        {
+            uint32_t count;
+            uint32_t offset;
+        };
+
+    public:
+        /// Как wavefront_group_size и max_recursive в shared.glsl.
+        static constexpr uint32_t group_size        = 256;
+        static constexpr uint32_t max_bounce_count  = 7;
+
+        /// Должны совпадать с push_constants в wavefront.glsl.
+        struct PushConstants
+        {
+            glm::mat4   inv_view_matrix                 = glm::mat4(1.0f);
+            glm::mat4   inv_projection_matrix           = glm::mat4(1.0f);
+            uint32_t    accumulated_frames_count        = 0;
+            uint32_t    bounce                          = 0;
+            uint32_t    width                           = 0;
+            uint32_t    height                          = 0;
+            uint32_t    material_count                  = 0;
+            uint32_t    russian_roulette_min_bounces    = 0;
+            float       eye_to_pixel_cone_spread_angle  = 0.0f;
+            uint32_t    is_radiance_accumulated         = 0;
+        };
+
+        struct QueueStatistics
+        {
+            uint32_t ray_count          = 0;
+            uint32_t hit_count          = 0;
+            uint32_t shadow_ray_count   = 0;
+        };
+
+    private:
+        explicit WavefrontPass(const Context* ptr_context);
+
+        void createBuffers();
+        void updateDescriptorSet();
+
+    public:
+        class Builder;
+
+        WavefrontPass(WavefrontPass&& wavefront_pass);
+        WavefrontPass(const WavefrontPass& wavefront_pass) = delete;
+
+        ~WavefrontPass();
+
+        WavefrontPass& operator = (WavefrontPass&& wavefront_pass);
+        WavefrontPass& operator = (const WavefrontPass& wavefront_pass) = delete;
+
+        void resize(uint32_t width, uint32_t height);
+
+        void process(VkCommandBuffer command_buffer_handle, VkDescriptorSet scene_descriptor_set, const PushConstants& push_constants) const;
+
+        /// Только после того, как командный буфер последнего process отработал.
+        [[nodiscard]]
+        std::array<QueueStatistics, max_bounce_count> readQueueStatistics() const;
+
+    private:
+        uint32_t _width             = 0;
+        uint32_t _height            = 0;
+        uint32_t _material_count    = 0;
+
+        std::array<std::optional<Buffer>, Bindings::count> _buffers;
+
+        std::optional<Buffer> _statistics_buffer;
+
+        std::array<VkPipeline, Stages::count> _pipeline_handles { };
+
+        VkPipelineLayout        _pipeline_layout        = VK_NULL_HANDLE;
+        VkDescriptorSetLayout   _descriptor_set_layout  = VK_NULL_HANDLE;
+
+        VkDescriptorPool    _descriptor_pool_handle = VK_NULL_HANDLE;
+        VkDescriptorSet     _descriptor_set_handle  = VK_NULL_HANDLE;
+
+        const Context* _ptr_context;
+    };
+
+    class WavefrontPass::Builder
+    {
+        void createPipelineLayout();
+        void createPipelines();
+
+        void createDescriptorPool();
+        void allocateDescriptorSet();
+
+    public:
+        Builder(const Context* ptr_context);
+
+        Builder(Builder&& builder)      = delete;
+        Builder(const Builder& builder) = delete;
+
+        ~Builder();
+
+        Builder& operator = (Builder&& builder)         = delete;
+        Builder& operator = (const Builder& builder)    = delete;
+
+        Builder& sceneDescriptorSetLayout(VkDescriptorSetLayout descriptor_set_layout) noexcept;
+
+        Builder& materialCount(uint32_t material_count) noexcept;
+        Builder& size(uint32_t width, uint32_t height) noexcept;
+
+        WavefrontPass build();
+
+    private:
+        const Context* _ptr_context;
+
+        VkDescriptorSetLayout _scene_descriptor_set_layout = VK_NULL_HANDLE;
+
+        uint32_t _material_count = 0;
+
+        uint32_t _width     = 0;
+        uint32_t _height    = 0;
+
+        std::array<VkPipeline, Stages::count> _pipeline_handles { };
+
+        VkPipelineLayout        _pipeline_layout        = VK_NULL_HANDLE;
+        VkDescriptorSetLayout   _descriptor_set_layout  = VK_NULL_HANDLE;
+
+        VkDescriptorPool    _descriptor_pool_handle = VK_NULL_HANDLE;
+        VkDescriptorSet     _descriptor_set_handle  = VK_NULL_HANDLE;
+
+        std::array<VkShaderModule, Stages::count> _compute_shader_handles { };
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <base/raytracing_base.hpp>
+#include <base/scene/scene.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace vrts;
+
+namespace vrts::scene_scaling
+{
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+
+    struct Configuration
+    {
+        std::string dimension;
+
+        uint32_t instance_count         = 64;
+        uint32_t triangle_count         = 2048;
+        uint32_t material_count         = 8;
+        uint32_t skinned_instance_count = 0;
+    };
+
+    struct Result
+    {
+        Configuration configuration;
+
+        Scene::Generator::Statistics generator_statistics;
+
+        Milliseconds as_build_time          { };
+        Milliseconds references_time        { };
+        Milliseconds descriptors_time       { };
+        Milliseconds animation_build_time   { };
+        Milliseconds animation_process_time { };
+
+        size_t acceleration_structures_size = 0;
+    };
+}
+
+/// Замеры масштабирования по процедурным сценам (Scene::Generator): время импорта, построения AS,
+/// ссылок на геометрию, дескрипторов материалов и анимации при росте одного измерения сцены.
+/// Окно используется только ради контекста Vulkan, show() печатает таблицу в лог и завершается.
+class SceneScaling final :
+    public RayTracingBase
+{
+    void init() override;
+    void show() override;
+
+    void resizeWindow() override;
+
+    [[nodiscard]]
+    scene_scaling::Result run(const scene_scaling::Configuration& configuration);
+
+    [[nodiscard]] scene_scaling::Milliseconds measureDescriptors(const Scene& scene);
+    [[nodiscard]] scene_scaling::Milliseconds measureReferences(Scene& scene);
+
+    static void print(std::span<const scene_scaling::Result> results);
+
+public:
+    SceneScaling() = default;
+
+    SceneScaling(SceneScaling&& scene_scaling)      = delete;
+    SceneScaling(const SceneScaling& scene_scaling) = delete;
+
+    SceneScaling& operator = (SceneScaling&& scene_scaling)         = delete;
+    SceneScaling& operator = (const SceneScaling& scene_scaling)    = delete;
+
+private:
+    std::vector<scene_scaling::Configuration> _configurations;
+};
@@ -1,6 +1,8 @@
 #include <hello_triangle/hello_triangle.hpp>
 #include <junk_shop/junk_shop.hpp>
+#include <junk_shop/cpu_path_tracer.hpp>
 #include <dancing_penguin/dancing_penguin.hpp>
+#include <scene_scaling/scene_scaling.hpp>
 
 #include <base/math.hpp>
 
@@ -8,7 +10,10 @@ enum class Samples
 {
     HelloTriangle,
     JunkShop,
-    DancingPenguin
+    DancingPenguin,
+    JunkShopCpuReference,   ///< Эталонный кадр JunkShop на CPU, без окна и GPU.
+    JunkShopOffline,        ///< Кадр JunkShop на GPU до заданного числа семплов, с контрольными точками.
+    SceneScaling            ///< Замеры на процедурных сценах, результат - таблица в логе.
 };
 
 int main(int argc, char* argv[])
@@ -17,6 +22,26 @@ int main(int argc, char* argv[])
 
     try
     {
+        if constexpr (sample == Samples::JunkShopCpuReference)
+        {
+            junk_shop::renderReference(project_dir / "junk_shop_reference.png", 2500, 1200, 64);
+            return EXIT_SUCCESS;
+        }
+
+        if constexpr (sample == Samples::JunkShopOffline)
+        {
+            JunkShop app;
+
+            app.renderOffline(junk_shop::OfflineSettings
+            {
+                .output_path        = project_dir / "junk_shop_offline",
+                .checkpoint_path    = project_dir / "junk_shop_offline.checkpoint",
+                .sample_count       = 4096
+            });
+
+            return EXIT_SUCCESS;
+        }
+
         std::unique_ptr<RayTracingBase> pApp;
 
         switch (sample)
@@ -30,6 +55,9 @@ int main(int argc, char* argv[])
             case Samples::DancingPenguin:
                 pApp = std::make_unique<DancingPenguin>();
                 break;
+            case Samples::SceneScaling:
+                pApp = std::make_unique<SceneScaling>();
+                break;
         }
 
         pApp->init();
@@ -69,11 +69,11 @@ vec3 sampleGGVNDF(vec3 v, float ax, float ay, float r1, float r2)
     return normalize(vec3(ax * nh.x, ay * nh.y, max(0.0, nh.z)));
 }
 
-brdf_t sampleDisnayBRDF(vec2 seed, vec3 v, material_t material, out vec3 out_dir)
+brdf_t sampleDisnayBRDF(vec3 u, vec3 v, material_t material, out vec3 out_dir)
 {
     float roughness = material.roughness * material.roughness;
 
-    vec3 h = sampleGGVNDF(v, roughness, roughness, random(seed.x), random(seed.y));
+    vec3 h = sampleGGVNDF(v, roughness, roughness, u.y, u.z);
 
     float v_dot_h = max(dot(v, h), EPS);
 
@@ -87,9 +87,9 @@ brdf_t sampleDisnayBRDF(vec2 seed, vec3 v, material_t material, out vec3 out_dir
     diff_w *= inv_w;
     spec_w *= inv_w;
 
-    if (random(seed) < diff_w)
+    if (u.x < diff_w)
     {
-        out_dir = cosine_sample_hemisphere(material.shading_normal, seed);
+        out_dir = cosine_sample_hemisphere(material.shading_normal, u.yz);
         h       = normalize(out_dir + v);
 
         float n_dot_l = max(dot(material.shading_normal, out_dir), EPS);
@@ -131,4 +131,46 @@ brdf_t sampleDisnayBRDF(vec2 seed, vec3 v, material_t material, out vec3 out_dir
     return brdf_t(vec3(0), EPS);
 }
 
+brdf_t evalDisneyBRDF(vec3 v, vec3 l, material_t material)
+{
+    float n_dot_l = dot(material.shading_normal, l);
+    float n_dot_v = dot(material.shading_normal, v);
+
+    if (n_dot_l <= EPS || n_dot_v <= EPS)
+        return brdf_t(vec3(0), 0.0);
+
+    float roughness = material.roughness * material.roughness;
+
+    vec3 h = normalize(v + l);
+
+    float v_dot_h = max(dot(v, h), EPS);
+    float l_dot_h = max(dot(l, h), EPS);
+    float n_dot_h = max(dot(material.shading_normal, h), EPS);
+
+    vec3 f0 = mix(vec3(0.04), material.albedo, material.metallic);
+    vec3 F  = F_Schlick(f0, v_dot_h);
+
+    float diff_w    = (1.0 - material.metallic);
+    float spec_w    = luma(F);
+    float inv_w     = 1.0 / (diff_w + spec_w);
+
+    diff_w *= inv_w;
+    spec_w *= inv_w;
+
+    float f90   = 0.5 + 2.0 * roughness * pow(l_dot_h, 2.0);
+    float a     = F_Schlick(1.0, f90, n_dot_l);
+    float b     = F_Schlick(1.0, f90, n_dot_v);
+
+    vec3 diff = material.albedo * (a * b / PI);
+
+    float   D = D_GTR(roughness, n_dot_h, 2.0);
+    float   G = geometryTerm(n_dot_l, n_dot_v, pow(0.5 + material.roughness * 0.5, 2.0));
+
+    vec3 spec = (F * G * D) / (4.0 * n_dot_l * n_dot_v);
+
+    float pdf = diff_w * (n_dot_l / PI) + spec_w * GGXVNDPdf(n_dot_h, n_dot_v, roughness);
+
+    return brdf_t((diff + spec) * n_dot_l, pdf);
+}
+
 #endif
\ No newline at end of file
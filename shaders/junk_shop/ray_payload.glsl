@@ -5,12 +5,23 @@
 
 struct payload_t
 {
-    vec2    seed;
+    uint    sample_index;
     int     all_bounds;
     vec3    acc;
     vec3    abso;
     ray_t   ray;
     bool    is_missed;
+    bool    is_terminated;
+    float   brdf_pdf;
+    vec3    albedo;
+    vec3    normal;
+    uvec2   pixel;          ///< Задаёт скрэмблинг Соболя.
+    uint    shadow_ray_count;
+};
+
+struct shadow_payload_t
+{
+    bool is_occluded;
 };
 
 #endif
\ No newline at end of file
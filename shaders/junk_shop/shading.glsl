@@ -0,0 +1,238 @@
+#ifndef JUNK_SHOP_SHADING_GLSL
+#define JUNK_SHOP_SHADING_GLSL
+
+#include <shaders/utils/scene_geometry.glsl>
+#include <shaders/utils/normal_mapping.glsl>
+#include <shaders/utils/texture_sampling.glsl>
+#include <shaders/utils/math_constants.glsl>
+#include <shaders/utils/light_sampling.glsl>
+#include <shaders/utils/environment_sampling.glsl>
+
+#include <shaders/junk_shop/shared.glsl>
+#include <shaders/junk_shop/material.glsl>
+#include <shaders/junk_shop/pbr.glsl>
+
+/// Затенение точки пересечения, общее у junk_shop.glsl.rchit и wavefront_shade.glsl.comp.
+/// Теневые лучи трассирует вызывающий.
+
+layout(std430, set = 0, binding = scene_geometry_binding) buffer scene_geometry_b
+{
+    scene_vertices_t    scene_geometries;
+    scene_indices_t     scene_indices;
+} scene_info;
+
+layout(set = 0, binding = albedos_binding)      uniform sampler2D albedos[];
+layout(set = 0, binding = normal_maps_binding)  uniform sampler2D normal_maps[];
+layout(set = 0, binding = metallic_binding)     uniform sampler2D metallic[];
+layout(set = 0, binding = roughness_binding)    uniform sampler2D roughness[];
+layout(set = 0, binding = emissives_binding)    uniform sampler2D emissives[];
+
+layout(std430, set = 0, binding = light_sampler_binding) buffer light_sampler_b
+{
+    lights_t        lights;
+    alias_table_t   alias_table;
+    area_pdfs_t     area_pdfs;
+    uint            light_count;
+    uint            area_pdf_count;
+} light_sampler;
+
+layout(std430, set = 0, binding = environment_binding) buffer environment_b
+{
+    environment_t environment;
+};
+
+struct hit_t
+{
+    mat4x3  object_to_world;
+    vec3    ray_origin;
+    vec3    ray_dir;
+    float   t;
+    uint    custom_index;
+    uint    primitive_id;
+    vec2    bc;
+};
+
+struct light_sample_t
+{
+    vec3    dir;
+    float   t_max;
+    vec3    contribution;
+};
+
+surface_t get_hit_surface(in hit_t hit)
+{
+    return get_surface(
+        scene_info.scene_geometries, 
+        scene_info.scene_indices, 
+        hit.custom_index, 
+        hit.primitive_id, 
+        hit.object_to_world, 
+        vec3(1.0 - hit.bc.x - hit.bc.y, hit.bc.x, hit.bc.y)
+    );
+}
+
+vec4 sample_hit_texture(sampler2D image, in hit_t hit, in surface_t surface, float eye_to_pixel_cone_spread_angle)
+{
+    return textureSampling(
+        image, 
+        surface, 
+        eye_to_pixel_cone_spread_angle, 
+        hit.ray_origin, 
+        hit.ray_dir, 
+        hit.t, 
+        hit.object_to_world
+    );
+}
+
+material_t get_material(in hit_t hit, in surface_t surface, float eye_to_pixel_cone_spread_angle)
+{
+    uint mesh_id = get_mesh_id(hit.custom_index);
+
+    vec3 albedo                     = sample_hit_texture(albedos[nonuniformEXT(mesh_id)], hit, surface, eye_to_pixel_cone_spread_angle).rgb;
+    vec3 emissive                   = sample_hit_texture(emissives[nonuniformEXT(mesh_id)], hit, surface, eye_to_pixel_cone_spread_angle).rgb;
+    float metallic                  = sample_hit_texture(metallic[nonuniformEXT(mesh_id)], hit, surface, eye_to_pixel_cone_spread_angle).r;
+    float roughness                 = sample_hit_texture(roughness[nonuniformEXT(mesh_id)], hit, surface, eye_to_pixel_cone_spread_angle).r;
+    vec3 normal_from_tangent_space  = sample_hit_texture(normal_maps[nonuniformEXT(mesh_id)], hit, surface, eye_to_pixel_cone_spread_angle).xyz;
+
+    vec3 normal = get_shading_normal(
+        normal_from_tangent_space,
+        surface.uv,
+        surface.normal,
+        surface.tangent,
+        mat3(hit.object_to_world)
+    );
+
+    return material_t(albedo, emissive, normal, metallic, roughness);
+}
+
+/// Тот же путь мог построить next-event estimation на предыдущем отскоке.
+float get_emission_mis_weight(in hit_t hit, in surface_t surface, float brdf_pdf)
+{
+    uint mesh_id = get_mesh_id(hit.custom_index);
+
+    if (brdf_pdf <= 0.0 || mesh_id >= light_sampler.area_pdf_count)
+        return 1.0;
+
+    float area_pdf = light_sampler.area_pdfs.pdfs[mesh_id];
+
+    if (area_pdf <= 0.0)
+        return 1.0;
+
+    mat3 world_matrix   = mat3(hit.object_to_world);
+    vec3 edge_1         = world_matrix * (surface.triangle.positions[1] - surface.triangle.positions[0]);
+    vec3 edge_2         = world_matrix * (surface.triangle.positions[2] - surface.triangle.positions[0]);
+
+    float cos_light = abs(dot(normalize(cross(edge_1, edge_2)), hit.ray_dir));
+    float light_pdf = (1.0 - environment.selection_probability) * area_pdf * hit.t * hit.t / max(cos_light, EPS);
+
+    return power_heuristic(brdf_pdf, light_pdf);
+}
+
+float get_environment_mis_weight(vec3 dir, float brdf_pdf)
+{
+    if (brdf_pdf <= 0.0 || environment.selection_probability <= 0.0)
+        return 1.0;
+
+    return power_heuristic(brdf_pdf, environment.selection_probability * get_environment_pdf(environment, dir));
+}
+
+light_sample_t sample_environment_light(in material_t material, vec3 v, vec4 u)
+{
+    light_sample_t light_sample = light_sample_t(vec3(0), infinity, vec3(0));
+
+    vec3    emission;
+    float   light_pdf;
+
+    light_sample.dir = sample_environment(environment, u, emission, light_pdf);
+    light_pdf *= environment.selection_probability;
+
+    brdf_t brdf = evalDisneyBRDF(v, light_sample.dir, material);
+
+    if (brdf.pdf <= 0.0 || light_pdf <= 0.0 || all(equal(emission, vec3(0))))
+        return light_sample;
+
+    light_sample.contribution = brdf.result * emission * (power_heuristic(light_pdf, brdf.pdf) / light_pdf);
+
+    return light_sample;
+}
+
+light_sample_t sample_direct_light(in material_t material, vec3 v, vec3 origin, vec4 u)
+{
+    float environment_probability = environment.selection_probability;
+
+    /// u.x делится между стратегиями и растягивается обратно в [0, 1): u.w свободен и уходит окружению.
+    if (u.x < environment_probability)
+        return sample_environment_light(material, v, vec4(u.yz, u.x / environment_probability, u.w));
+
+    light_sample_t light_sample = light_sample_t(vec3(0), 0.0, vec3(0));
+
+    if (light_sampler.light_count == 0)
+        return light_sample;
+
+    float   u_light = (u.x - environment_probability) / (1.0 - environment_probability);
+    vec2    u_point = u.yz;
+
+    uint    light_id    = sample_alias_table(light_sampler.alias_table, light_sampler.light_count, u_light);
+    light_t light       = light_sampler.lights.lights[light_id];
+
+    bool is_point_light = light.mesh_id == point_light_mesh_id;
+
+    vec3 light_pos = light.pos;
+
+    if (!is_point_light)
+    {
+        vec2 bc = sample_triangle(u_point);
+        light_pos += light.edge_1 * bc.x + light.edge_2 * bc.y;
+        u_point = bc;
+    }
+
+    vec3    to_light    = light_pos - origin;
+    float   distance_2  = dot(to_light, to_light);
+    float   distance    = sqrt(distance_2);
+    vec3    l           = to_light / distance;
+
+    vec3    emission;
+    float   light_pdf;
+
+    if (is_point_light)
+    {
+        /// Дельта-источник: BRDF-семплирование в него не попадает, MIS не нужен.
+        emission    = light.edge_1 / distance_2;
+        light_pdf   = light.pdf * (1.0 - environment_probability);
+    }
+    else
+    {
+        vec3    normal      = cross(light.edge_1, light.edge_2);
+        float   area        = 0.5 * length(normal);
+        float   cos_light   = abs(dot(normal, l)) / max(2.0 * area, EPS);
+
+        if (cos_light <= EPS || area <= EPS)
+            return light_sample;
+
+        vec2 uv = get_uv(
+            scene_info.scene_geometries, 
+            scene_info.scene_indices, 
+            light.mesh_id, 
+            light.primitive_id, 
+            u_point
+        );
+
+        emission    = textureLod(emissives[nonuniformEXT(light.mesh_id)], uv, 0.0).rgb;
+        light_pdf   = light.pdf * (1.0 - environment_probability) / area * distance_2 / cos_light;
+    }
+
+    brdf_t brdf = evalDisneyBRDF(v, l, material);
+
+    if (brdf.pdf <= 0.0 || light_pdf <= 0.0 || all(equal(emission, vec3(0))))
+        return light_sample;
+
+    float weight = is_point_light ? 1.0 : power_heuristic(light_pdf, brdf.pdf);
+
+    light_sample.dir            = l;
+    light_sample.t_max          = distance * 0.999;
+    light_sample.contribution   = brdf.result * emission * (weight / light_pdf);
+
+    return light_sample;
+}
+
+#endif
@@ -16,8 +16,60 @@ const uint metallic_binding    	= 6u;
 const uint roughness_binding    = 7u;
 const uint emissives_binding    = 8u;
 
+const uint light_sampler_binding = 9u;
+
+const uint sobol_binding = 10u;
+
+const uint path_statistics_binding = 11u;
+
+const uint history_buffer_binding       = 12u;
+const uint depth_buffer_binding         = 13u;
+const uint history_depth_buffer_binding = 14u;
+const uint reprojection_binding         = 15u;
+
+const uint albedo_aov_binding = 16u;
+const uint normal_aov_binding = 17u;
+
+const uint moments_buffer_binding           = 18u;
+const uint history_moments_buffer_binding   = 19u;
+const uint adaptive_sampling_binding        = 20u;
+const uint tile_errors_binding              = 21u;
+const uint history_tile_errors_binding      = 22u;
+
+const uint environment_binding = 23u;
+
+const uint  adaptive_tile_size  = 16u;
+const float tile_error_scale    = 65536.0;
+
+/// atrous.glsl.comp: накопленное изображение, два промежуточных и result, затем AOV.
+const uint atrous_colors_binding    = 0u;
+const uint atrous_albedo_binding    = 1u;
+const uint atrous_normal_binding    = 2u;
+const uint atrous_depth_binding     = 3u;
+
+/// wavefront_*.glsl.comp, set 1 (set 0 - дескрипторы JunkShop): junk_shop::WavefrontPass::Bindings.
+const uint wavefront_queues_binding             = 0u;
+const uint wavefront_paths_binding              = 1u;
+const uint wavefront_hits_binding               = 2u;
+const uint wavefront_ray_queues_binding         = 3u;
+const uint wavefront_hit_queue_binding          = 4u;
+const uint wavefront_sorted_hit_queue_binding   = 5u;
+const uint wavefront_shadow_queue_binding       = 6u;
+const uint wavefront_material_bins_binding      = 7u;
+
+/// Как junk_shop::WavefrontPass::group_size.
+const uint wavefront_group_size = 256u;
+
 const int max_recursive = 7;
 
+/// Четвёрки измерений Соболя на отскок.
+const uint brdf_dimension           = 0u;
+const uint light_dimension          = 1u;
+const uint dimensions_per_bounce    = 2u;
+
+const uint shadow_miss_index    = 1u;
+const uint shadow_payload_index = 1u;
+
 float infinity = uintBitsToFloat(0x7F800000);
 
 #define trace(ray, scene)           \
@@ -36,4 +88,20 @@ float infinity = uintBitsToFloat(0x7F800000);
 	    );              			\
     } while (false)
 
+#define trace_shadow(origin, dir, t_max, scene)                                                             \
+    do {                                                                                                    \
+        traceRayEXT (                                                                                       \
+            scene,                                                                                          \
+            gl_RayFlagsOpaqueEXT | gl_RayFlagsTerminateOnFirstHitEXT | gl_RayFlagsSkipClosestHitShaderEXT,  \
+            0xff,                                                                                           \
+            0, 0,                                                                                           \
+            shadow_miss_index,                                                                              \
+            origin,                                                                                         \
+            0.2,                                                                                            \
+            dir,                                                                                            \
+            t_max,                                                                                          \
+            shadow_payload_index                                                                            \
+        );                                                                                                  \
+    } while (false)
+
 #endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+#ifndef JUNK_SHOP_WAVEFRONT_GLSL
+#define JUNK_SHOP_WAVEFRONT_GLSL
+
+#include <shaders/utils/camera.glsl>
+#include <shaders/utils/sobol.glsl>
+
+#include <shaders/junk_shop/shared.glsl>
+
+/// junk_shop::WavefrontPass. Номер пути - номер пикселя: y * width + x.
+
+/// Очереди лучей чередуются по чётности отскока: shade пишет в очередь следующего отскока.
+const uint hit_queue_index      = 2u;
+const uint shadow_queue_index   = 3u;
+
+/// junk_shop::WavefrontPass::Queue
+struct queue_t
+{
+    uint count;
+    uint group_count_x;
+    uint group_count_y;
+    uint group_count_z;
+};
+
+struct path_t
+{
+    vec3    radiance;
+    float   brdf_pdf;
+    vec3    throughput;
+    float   padding_0;
+    vec3    origin;
+    float   padding_1;
+    vec3    dir;
+    float   padding_2;
+};
+
+struct hit_record_t
+{
+    mat3x4  object_to_world_rows;   ///< transpose(mat4x3): у mat4x3 в std430 каждый столбец выравнивается до vec4.
+    vec2    bc;
+    float   t;
+    uint    custom_index;
+    uint    primitive_id;
+};
+
+struct shadow_ray_t
+{
+    vec3    origin;
+    float   t_max;
+    vec3    dir;
+    uint    path_id;
+    vec3    contribution;
+    float   padding;
+};
+
+/// count - пересечения материала в очереди, offset - начало его участка в отсортированной очереди.
+struct material_bin_t
+{
+    uint count;
+    uint offset;
+};
+
+layout(std430, set = 1, binding = wavefront_queues_binding) buffer queues_b
+{
+    queue_t queues[4];
+};
+
+layout(std430, set = 1, binding = wavefront_paths_binding) buffer paths_b
+{
+    path_t paths[];
+};
+
+layout(std430, set = 1, binding = wavefront_hits_binding) buffer hits_b
+{
+    hit_record_t hits[];
+};
+
+layout(std430, set = 1, binding = wavefront_ray_queues_binding) buffer ray_queues_b
+{
+    uint ray_queues[];
+};
+
+layout(std430, set = 1, binding = wavefront_hit_queue_binding) buffer hit_queue_b
+{
+    uint hit_queue[];
+};
+
+layout(std430, set = 1, binding = wavefront_sorted_hit_queue_binding) buffer sorted_hit_queue_b
+{
+    uint sorted_hit_queue[];
+};
+
+layout(std430, set = 1, binding = wavefront_shadow_queue_binding) buffer shadow_queue_b
+{
+    shadow_ray_t shadow_queue[];
+};
+
+layout(std430, set = 1, binding = wavefront_material_bins_binding) buffer material_bins_b
+{
+    material_bin_t material_bins[];
+};
+
+layout(std430, set = 0, binding = sobol_binding) buffer sobol_b
+{
+    sobol_directions_t directions;
+} sobol;
+
+/// junk_shop::WavefrontPass::PushConstants
+layout(push_constant) uniform push_constants_t
+{
+    camera_t    camera;
+    uint        accumulated_frames_count;
+    uint        bounce;
+    uint        width;
+    uint        height;
+    uint        material_count;
+    uint        russian_roulette_min_bounces;
+    float       eye_to_pixel_cone_spread_angle;
+    uint        is_radiance_accumulated;
+} push_constants;
+
+uint get_path_count()
+{
+    return push_constants.width * push_constants.height;
+}
+
+uvec2 get_path_pixel(uint path_id)
+{
+    return uvec2(path_id % push_constants.width, path_id / push_constants.width);
+}
+
+uint get_ray_queue_index(uint bounce)
+{
+    return bounce & 1u;
+}
+
+vec4 get_path_sample(uint path_id, uint strategy)
+{
+    uint dimension  = push_constants.bounce * dimensions_per_bounce + strategy;
+    uint seed       = get_dimension_seed(get_pixel_seed(get_path_pixel(path_id)), dimension);
+
+    return get_sobol_sample(sobol.directions, push_constants.accumulated_frames_count, seed);
+}
+
+/// Одно атомарное сложение на subgroup.
+/// Вызывается всеми активными потоками subgroup.
+uint allocate_queue_slot(uint queue, bool is_pushed)
+{
+    uint pushed_count   = subgroupAdd(is_pushed ? 1u : 0u);
+    uint first          = 0u;
+
+    if (subgroupElect() && pushed_count > 0u)
+    {
+        first = atomicAdd(queues[queue].count, pushed_count);
+
+        uint group_count = 
+                (first + pushed_count + wavefront_group_size - 1u) / wavefront_group_size 
+            -   (first + wavefront_group_size - 1u) / wavefront_group_size;
+
+        if (group_count > 0u)
+            atomicAdd(queues[queue].group_count_x, group_count);
+    }
+
+    return subgroupBroadcastFirst(first) + subgroupExclusiveAdd(is_pushed ? 1u : 0u);
+}
+
+#endif
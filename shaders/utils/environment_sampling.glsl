@@ -0,0 +1,92 @@
+#ifndef ENVIRONMENT_SAMPLING_GLSL
+#define ENVIRONMENT_SAMPLING_GLSL
+
+#include <shaders/utils/math_constants.glsl>
+#include <shaders/utils/light_sampling.glsl>
+
+/// vrts::EnvironmentMap
+
+layout(std430, scalar, buffer_reference, buffer_reference_align = 4) readonly buffer environment_pixels_t
+{
+    vec3 pixels[];
+};
+
+layout(std430, scalar, buffer_reference, buffer_reference_align = 4) readonly buffer environment_pdfs_t
+{
+    float pdfs[];
+};
+
+/// junk_shop::EnvironmentInfo
+struct environment_t
+{
+    environment_pixels_t    pixels;
+    alias_table_t           marginal;
+    alias_table_t           conditional;
+    environment_pdfs_t      pdfs;
+    uint                    width;
+    uint                    height;
+    float                   selection_probability;
+    uint                    padding;
+};
+
+vec2 direction_to_equirect_uv(vec3 dir)
+{
+    return vec2(
+        atan(dir.z, dir.x) / (2.0 * PI) + 0.5,
+        atan(length(dir.xz), dir.y) / PI
+    );
+}
+
+vec3 equirect_uv_to_direction(vec2 uv)
+{
+    float phi   = (uv.x - 0.5) * 2.0 * PI;
+    float theta = uv.y * PI;
+
+    return vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+}
+
+uint get_environment_pixel(in environment_t environment, vec2 uv)
+{
+    uvec2 pixel = min(uvec2(max(uv, vec2(0)) * vec2(environment.width, environment.height)), uvec2(environment.width, environment.height) - 1u);
+    return pixel.y * environment.width + pixel.x;
+}
+
+/// Пиксель занимает на сфере 2 pi^2 sin(theta) / (width * height) стерадиан.
+float to_environment_solid_angle_pdf(in environment_t environment, float pixel_pdf, float v)
+{
+    float sin_theta = sin(v * PI);
+
+    if (sin_theta <= 0.0)
+        return 0.0;
+
+    return pixel_pdf * float(environment.width * environment.height) / (2.0 * PI * PI * sin_theta);
+}
+
+vec3 get_environment_radiance(in environment_t environment, vec3 dir)
+{
+    return environment.pixels.pixels[get_environment_pixel(environment, direction_to_equirect_uv(dir))];
+}
+
+/// EnvironmentMap::getPdf, по телесному углу.
+float get_environment_pdf(in environment_t environment, vec3 dir)
+{
+    vec2 uv = direction_to_equirect_uv(dir);
+    return to_environment_solid_angle_pdf(environment, environment.pdfs.pdfs[get_environment_pixel(environment, uv)], uv.y);
+}
+
+/// EnvironmentMap::sample
+vec3 sample_environment(in environment_t environment, vec4 u, out vec3 radiance, out float pdf)
+{
+    uint row = sample_alias_table(environment.marginal, environment.height, u.x);
+    uint col = sample_alias_table(environment.conditional, row * environment.width, environment.width, u.y);
+
+    vec2 uv     = (vec2(col, row) + u.zw) / vec2(environment.width, environment.height);
+    uint pixel  = row * environment.width + col;
+
+    radiance    = environment.pixels.pixels[pixel];
+    pdf         = to_environment_solid_angle_pdf(environment, environment.pdfs.pdfs[pixel], uv.y);
+
+    return equirect_uv_to_direction(uv);
+}
+
+#endif
@@ -1,6 +1,10 @@
 #ifndef GEOMETRY_PROPERTIES_GLSL
 #define GEOMETRY_PROPERTIES_GLSL
 
+/// Значения совпадают с VkIndexType.
+const uint index_type_uint16 = 0;
+const uint index_type_uint32 = 1;
+
 struct attribute_t
 {
     vec4 pos;
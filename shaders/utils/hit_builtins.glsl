@@ -0,0 +1,58 @@
+#ifndef HIT_BUILTINS_GLSL
+#define HIT_BUILTINS_GLSL
+
+#include <shaders/utils/scene_geometry.glsl>
+#include <shaders/utils/normal_mapping.glsl>
+#include <shaders/utils/texture_sampling.glsl>
+
+
+uint get_mesh_id()
+{
+    return get_mesh_id(uint(gl_InstanceCustomIndexEXT));
+}
+
+uint get_lod()
+{
+    return get_lod(uint(gl_InstanceCustomIndexEXT));
+}
+
+surface_t get_surface (
+    in scene_vertices_t scene_geometries, 
+    in scene_indices_t  scene_indices,
+    vec3                barycentric_coordinates
+) 
+{
+    return get_surface(
+        scene_geometries, 
+        scene_indices, 
+        uint(gl_InstanceCustomIndexEXT), 
+        uint(gl_PrimitiveID), 
+        gl_ObjectToWorldEXT, 
+        barycentric_coordinates
+    );
+}
+
+vec3 get_shading_normal (
+    vec3 normal_from_tangent_space,
+    vec2 uv,
+    vec3 normal,
+    vec3 tangent
+)
+{
+    return get_shading_normal(normal_from_tangent_space, uv, normal, tangent, mat3(gl_ObjectToWorldEXT));
+}
+
+vec4 textureSampling(sampler2D image, surface_t surf, float eye_to_pixel_cone_spread_angle)
+{
+    return textureSampling(
+        image, 
+        surf, 
+        eye_to_pixel_cone_spread_angle, 
+        gl_WorldRayOriginEXT, 
+        gl_WorldRayDirectionEXT, 
+        gl_HitTEXT, 
+        gl_ObjectToWorldEXT
+    );
+}
+
+#endif
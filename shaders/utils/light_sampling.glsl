@@ -0,0 +1,77 @@
+#ifndef LIGHT_SAMPLING_GLSL
+#define LIGHT_SAMPLING_GLSL
+
+#include <shaders/utils/math_constants.glsl>
+
+/// Должна совпадать с LightSampler::point_light_mesh_id.
+const uint point_light_mesh_id = 0xffffffffu;
+
+/// vrts::LightSource
+struct light_t
+{
+    vec3    pos;
+    uint    mesh_id;
+    vec3    edge_1;
+    uint    primitive_id;
+    vec3    edge_2;
+    float   pdf;
+};
+
+/// vrts::AliasTable::Entry
+struct alias_entry_t
+{
+    float   threshold;
+    uint    alias;
+};
+
+layout(std430, scalar, buffer_reference, buffer_reference_align = 16) readonly buffer lights_t
+{
+    light_t lights[];
+};
+
+layout(std430, scalar, buffer_reference, buffer_reference_align = 8) readonly buffer alias_table_t
+{
+    alias_entry_t entries[];
+};
+
+layout(std430, scalar, buffer_reference, buffer_reference_align = 4) readonly buffer area_pdfs_t
+{
+    float pdfs[];
+};
+
+uint sample_alias_table(in alias_table_t alias_table, uint size, float u)
+{
+    float   x   = u * float(size);
+    uint    id  = min(uint(x), size - 1);
+
+    alias_entry_t entry = alias_table.entries[id];
+
+    return x - float(id) < entry.threshold ? id : entry.alias;
+}
+
+/// Таблица size элементов, лежащая в alias_table начиная с offset: alias считается от offset.
+uint sample_alias_table(in alias_table_t alias_table, uint offset, uint size, float u)
+{
+    float   x   = u * float(size);
+    uint    id  = min(uint(x), size - 1);
+
+    alias_entry_t entry = alias_table.entries[offset + id];
+
+    return x - float(id) < entry.threshold ? id : entry.alias;
+}
+
+vec2 sample_triangle(vec2 u)
+{
+    float su = sqrt(u.x);
+    return vec2(su * (1.0 - u.y), su * u.y);
+}
+
+float power_heuristic(float pdf, float other_pdf)
+{
+    float pdf_2         = pdf * pdf;
+    float other_pdf_2   = other_pdf * other_pdf;
+
+    return pdf_2 / max(pdf_2 + other_pdf_2, EPS);
+}
+
+#endif
@@ -5,7 +5,8 @@ vec3 get_shading_normal (
     vec3 normal_from_tangent_space,
     vec2 uv,
     vec3 normal,
-    vec3 tangent
+    vec3 tangent,
+    mat3 object_to_world
 )
 {
     vec3 shading_normal = normal_from_tangent_space * 2.0 - 1.0;
@@ -18,7 +19,7 @@ vec3 get_shading_normal (
 
     shading_normal = normalize(tbn * shading_normal);
 
-    mat3 normal_matrix = transpose(inverse(mat3(gl_ObjectToWorldEXT)));
+    mat3 normal_matrix = transpose(inverse(object_to_world));
 
     return normalize(normal_matrix * shading_normal);
 }
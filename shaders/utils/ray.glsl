@@ -9,10 +9,10 @@ struct ray_t
 	vec3 dir;
 };
  
-ray_t get_primary_ray(in camera_t camera, ivec2 offset_in_screen_space)
+/// Без встроенных переменных ray tracing: файл подключается и в compute-шейдеры.
+ray_t get_primary_ray(in camera_t camera, vec2 pixel_center, vec2 image_size)
 {
-	const vec2 pixel_center = vec2(gl_LaunchIDEXT.xy + vec2(offset_in_screen_space)) + vec2(0.5);
-	const vec2 uv			= pixel_center / vec2(gl_LaunchSizeEXT.xy);
+	const vec2 uv = pixel_center / image_size;
 
 	vec2 d = uv * 2.0 - 1.0;
 
@@ -80,10 +80,8 @@ vec4 random2(vec2 coord)
     );
 }
 
-vec3 cosine_sample_hemisphere(vec3 n, inout vec2 seed)
+vec3 cosine_sample_hemisphere(vec3 n, vec2 u)
 {
-    vec4 u = random2(seed);
-
     float r     = sqrt(u.x);
     float theta = 2.0 * PI * u.y;
 
@@ -3,6 +3,10 @@
 
 #include <shaders/utils/geometry_properties.glsl>
 
+/// Должны совпадать с mesh_lod::max_lod_count и mesh_lod::custom_index_lod_shift.
+const uint max_lod_count            = 4;
+const uint custom_index_lod_shift   = 22;
+
 /// Vertices
 layout(std430, scalar, buffer_reference, buffer_reference_align = 16) readonly buffer vertex_buffer_t
 {
@@ -20,12 +24,38 @@ layout(std430, scalar, buffer_reference, buffer_reference_align = 16) readonly b
     uint indices[];
 };
 
+/// 16-битные индексы лежат парами в одном uint.
+struct index_buffer_reference_t
+{
+    index_buffer_t  buffer;
+    uint            index_type;
+    uint            padding;
+};
+
 layout(std430, buffer_reference, buffer_reference_align = 16) readonly buffer scene_indices_t
 {
-    index_buffer_t index_buffers[];
+    index_buffer_reference_t index_buffers[];
 };
 
 /// Helpers
+uint get_mesh_id(uint custom_index)
+{
+    return custom_index & ((1u << custom_index_lod_shift) - 1u);
+}
+
+uint get_lod(uint custom_index)
+{
+    return custom_index >> custom_index_lod_shift;
+}
+
+uint get_index(in index_buffer_reference_t index_buffer, uint i)
+{
+    if (index_buffer.index_type == index_type_uint16)
+        return (index_buffer.buffer.indices[i >> 1] >> ((i & 1) * 16)) & 0xffff;
+
+    return index_buffer.buffer.indices[i];
+}
+
 vec3 interpolate_attributes(vec3 v1, vec3 v2, vec3 v3, vec3 bc)
 {
     return v1 * bc.x + v2 * bc.y + v3 * bc.z;
@@ -36,31 +66,59 @@ vec2 interpolate_attributes(vec2 v1, vec2 v2, vec2 v3, vec3 bc)
     return v1 * bc.x + v2 * bc.y + v3 * bc.z;
 }
 
+vec2 get_uv (
+    in scene_vertices_t scene_geometries, 
+    in scene_indices_t  scene_indices,
+    uint                mesh_id,
+    uint                primitive_id,
+    vec2                bc
+)
+{
+    index_buffer_reference_t index_buffer = scene_indices.index_buffers[mesh_id * max_lod_count];
+
+    uint index_1 = get_index(index_buffer, primitive_id * 3 + 0);
+    uint index_2 = get_index(index_buffer, primitive_id * 3 + 1);
+    uint index_3 = get_index(index_buffer, primitive_id * 3 + 2);
+
+    vec2 uv_1 = scene_geometries.vertex_buffers[mesh_id].attributes[index_1].uv.xy;
+    vec2 uv_2 = scene_geometries.vertex_buffers[mesh_id].attributes[index_2].uv.xy;
+    vec2 uv_3 = scene_geometries.vertex_buffers[mesh_id].attributes[index_3].uv.xy;
+
+    return interpolate_attributes(uv_1, uv_2, uv_3, vec3(1.0 - bc.x - bc.y, bc.x, bc.y));
+}
+
 surface_t get_surface (
     in scene_vertices_t scene_geometries, 
     in scene_indices_t  scene_indices,
+    uint                custom_index,
+    uint                primitive_id,
+    mat4x3              object_to_world,
     vec3                barycentric_coordinates
 ) 
 {
-    uint index_1 = scene_indices.index_buffers[gl_InstanceCustomIndexEXT].indices[gl_PrimitiveID * 3 + 0];
-    uint index_2 = scene_indices.index_buffers[gl_InstanceCustomIndexEXT].indices[gl_PrimitiveID * 3 + 1];
-    uint index_3 = scene_indices.index_buffers[gl_InstanceCustomIndexEXT].indices[gl_PrimitiveID * 3 + 2];
+    uint mesh_id = get_mesh_id(custom_index);
+
+    index_buffer_reference_t index_buffer = scene_indices.index_buffers[mesh_id * max_lod_count + get_lod(custom_index)];
+
+    uint index_1 = get_index(index_buffer, primitive_id * 3 + 0);
+    uint index_2 = get_index(index_buffer, primitive_id * 3 + 1);
+    uint index_3 = get_index(index_buffer, primitive_id * 3 + 2);
 
-    vec3 pos_1 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_1].pos.xyz;
-    vec3 pos_2 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_2].pos.xyz;
-    vec3 pos_3 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_3].pos.xyz;
+    vec3 pos_1 = scene_geometries.vertex_buffers[mesh_id].attributes[index_1].pos.xyz;
+    vec3 pos_2 = scene_geometries.vertex_buffers[mesh_id].attributes[index_2].pos.xyz;
+    vec3 pos_3 = scene_geometries.vertex_buffers[mesh_id].attributes[index_3].pos.xyz;
 
-    vec3 normal_1 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_1].normal.xyz;
-    vec3 normal_2 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_2].normal.xyz;
-    vec3 normal_3 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_3].normal.xyz;
+    vec3 normal_1 = scene_geometries.vertex_buffers[mesh_id].attributes[index_1].normal.xyz;
+    vec3 normal_2 = scene_geometries.vertex_buffers[mesh_id].attributes[index_2].normal.xyz;
+    vec3 normal_3 = scene_geometries.vertex_buffers[mesh_id].attributes[index_3].normal.xyz;
 
-    vec3 tangent_1 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_1].tangent.xyz;
-    vec3 tangent_2 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_2].tangent.xyz;
-    vec3 tangent_3 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_3].tangent.xyz;
+    vec3 tangent_1 = scene_geometries.vertex_buffers[mesh_id].attributes[index_1].tangent.xyz;
+    vec3 tangent_2 = scene_geometries.vertex_buffers[mesh_id].attributes[index_2].tangent.xyz;
+    vec3 tangent_3 = scene_geometries.vertex_buffers[mesh_id].attributes[index_3].tangent.xyz;
 
-    vec2 uv_1 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_1].uv.xy;
-    vec2 uv_2 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_2].uv.xy;
-    vec2 uv_3 = scene_geometries.vertex_buffers[gl_InstanceCustomIndexEXT].attributes[index_3].uv.xy;
+    vec2 uv_1 = scene_geometries.vertex_buffers[mesh_id].attributes[index_1].uv.xy;
+    vec2 uv_2 = scene_geometries.vertex_buffers[mesh_id].attributes[index_2].uv.xy;
+    vec2 uv_3 = scene_geometries.vertex_buffers[mesh_id].attributes[index_3].uv.xy;
 
     triangle_t triangle;
     triangle.positions  = vec3[] (pos_1, pos_2, pos_3);
@@ -69,7 +127,7 @@ surface_t get_surface (
     vec3 normal = interpolate_attributes(normal_1, normal_2, normal_3, barycentric_coordinates);
 
     vec3 position = interpolate_attributes(pos_1, pos_2, pos_3, barycentric_coordinates);
-    position = gl_ObjectToWorldEXT * vec4(position, 1);
+    position = object_to_world * vec4(position, 1);
 
     return surface_t (
         position,
@@ -0,0 +1,74 @@
+#ifndef SKINNING_GLSL
+#define SKINNING_GLSL
+
+#include <shaders/utils/geometry_properties.glsl>
+
+// Должны совпадать с vrts::SkinningPaletteType.
+const uint skinning_palette_mat4            = 0;
+const uint skinning_palette_affine          = 1;
+const uint skinning_palette_dual_quaternion = 2;
+
+// Должны совпадать с vrts::BoneIndexFormat.
+const uint bone_index_format_uint8  = 0;
+const uint bone_index_format_uint16 = 1;
+
+uint skinningDataStride(uint bone_index_format)
+{
+    return bone_index_format == bone_index_format_uint8 ? 2 : 3;
+}
+
+// Веса отсортированы по убыванию, поэтому первый нулевой вес означает конец списка влияний.
+skinning_data_t unpackSkinningData(uvec3 words, uint bone_index_format)
+{
+    uint packed_weights = bone_index_format == bone_index_format_uint8 ? words.y : words.z;
+
+    skinning_data_t skin_data;
+    skin_data.weights = unpackUnorm4x8(packed_weights);
+
+    if (bone_index_format == bone_index_format_uint8)
+        skin_data.bone_ids = ivec4((uvec4(words.x) >> uvec4(0, 8, 16, 24)) & 0xffu);
+    else
+        skin_data.bone_ids = ivec4((uvec4(words.xx, words.yy) >> uvec4(0, 16, 0, 16)) & 0xffffu);
+
+    for (uint i = 0; i < 4; ++i)
+    {
+        if (skin_data.weights[i] == 0.0)
+            skin_data.bone_ids[i] = -1;
+    }
+
+    return skin_data;
+}
+
+uint skinningPaletteStride(uint palette_type)
+{
+    if (palette_type == skinning_palette_affine)
+        return 3;
+    
+    if (palette_type == skinning_palette_dual_quaternion)
+        return 2;
+
+    return 4;
+}
+
+mat3 normalMatrix(mat3 m)
+{
+    mat3 cofactor = mat3(
+        cross(m[1], m[2]),
+        cross(m[2], m[0]),
+        cross(m[0], m[1])
+    );
+
+    return determinant(m) < 0.0 ? -cofactor : cofactor;
+}
+
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+vec3 translation(vec4 real, vec4 dual)
+{
+    return 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SOBOL_GLSL
+#define SOBOL_GLSL
+
+/// Соболь с Owen-скрэмблингом на хешах, как vrts::sobol в include/base/sobol.hpp.
+
+const uint sobol_dimension_count    = 4u;
+const uint sobol_bit_count          = 32u;
+
+/// vrts::sobol::getDirections()
+layout(std430, scalar, buffer_reference, buffer_reference_align = 4) readonly buffer sobol_directions_t
+{
+    uint directions[];
+};
+
+uint sobol_sample(in sobol_directions_t directions, uint index, uint dimension)
+{
+    uint result = 0u;
+
+    for (uint bit = 0u; index != 0u; ++bit, index >>= 1u)
+    {
+        if ((index & 1u) != 0u)
+            result ^= directions.directions[dimension * sobol_bit_count + bit];
+    }
+
+    return result;
+}
+
+uint sobol_hash(uint x)
+{
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+
+    return x;
+}
+
+uint sobol_hash_combine(uint seed, uint value)
+{
+    return seed ^ (value + 0x9e3779b9u + (seed << 6u) + (seed >> 2u));
+}
+
+uint nested_uniform_scramble(uint x, uint seed)
+{
+    x = bitfieldReverse(x);
+
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+
+    return bitfieldReverse(x);
+}
+
+uint get_pixel_seed(uvec2 pixel)
+{
+    return sobol_hash(pixel.x ^ sobol_hash(pixel.y));
+}
+
+uint get_dimension_seed(uint pixel_seed, uint dimension)
+{
+    return sobol_hash_combine(pixel_seed, sobol_hash(dimension));
+}
+
+vec4 get_sobol_sample(in sobol_directions_t directions, uint index, uint seed)
+{
+    index = nested_uniform_scramble(index, seed);
+
+    vec4 result;
+
+    for (uint dimension = 0u; dimension < sobol_dimension_count; ++dimension)
+    {
+        uint x = nested_uniform_scramble(sobol_sample(directions, index, dimension), sobol_hash_combine(seed, dimension));
+        result[dimension] = float(x >> 8u) * (1.0 / float(1u << 24u));
+    }
+
+    return result;
+}
+
+#endif
@@ -30,10 +30,18 @@ vec4 uv_derives_from_ray_cone
 	return vec4(u_length, 0, 0, u_length);
 }
 
-vec4 textureSampling(sampler2D image, surface_t surf, float eye_to_pixel_cone_spread_angle)
+vec4 textureSampling(
+    sampler2D   image, 
+    surface_t   surf, 
+    float       eye_to_pixel_cone_spread_angle,
+    vec3        ray_origin,
+    vec3        ray_dir,
+    float       t,
+    mat4x3      object_to_world
+)
 {
-    vec3 hit_position       = vec3(gl_WorldRayDirectionEXT * gl_HitTEXT + gl_WorldRayOriginEXT);
-    vec3 camera_position    = vec3(gl_WorldRayOriginEXT);
+    vec3 hit_position       = ray_dir * t + ray_origin;
+    vec3 camera_position    = ray_origin;
 
     vec2 ray_cone_at_origine = vec2(0, eye_to_pixel_cone_spread_angle);
     
@@ -42,12 +50,12 @@ vec4 textureSampling(sampler2D image, surface_t surf, float eye_to_pixel_cone_sp
         ray_cone_at_origine.y + eye_to_pixel_cone_spread_angle
     );
 
-    vec3    world_normal    = normalize(vec3(gl_ObjectToWorldEXT * vec4(surf.normal, 0)));
+    vec3    world_normal    = normalize(vec3(object_to_world * vec4(surf.normal, 0)));
     float   ray_cone_width  = ray_cone_at_hit.x;
-    mat3    world_matrix    = mat3(gl_ObjectToWorldEXT);
+    mat3    world_matrix    = mat3(object_to_world);
 
     vec4 uv_derives = uv_derives_from_ray_cone(
-        gl_WorldRayDirectionEXT.xyz, 
+        ray_dir, 
         world_normal, 
         ray_cone_width, 
         surf.triangle.uvs, 
@@ -0,0 +1,267 @@
+#include <base/image_writer.hpp>
+#include <base/logger/logger.hpp>
+
+#include <fstream>
+#include <vector>
+#include <array>
+#include <string_view>
+#include <algorithm>
+#include <ranges>
+#include <bit>
+
+namespace vrts::image_writer
+{
+    static_assert(std::endian::native == std::endian::little, "OpenEXR writer expects little-endian host");
+
+    template<typename T>
+    static void append(std::vector<uint8_t>& dst, const T& value)
+    {
+        const auto ptr_value = reinterpret_cast<const uint8_t*>(&value);
+        dst.insert(std::end(dst), ptr_value, ptr_value + sizeof(T));
+    }
+
+    static void append(std::vector<uint8_t>& dst, std::string_view str)
+    {
+        dst.insert(std::end(dst), std::begin(str), std::end(str));
+        dst.push_back(0);
+    }
+
+    static void appendBigEndian(std::vector<uint8_t>& dst, uint32_t value)
+    {
+        dst.push_back(static_cast<uint8_t>(value >> 24));
+        dst.push_back(static_cast<uint8_t>(value >> 16));
+        dst.push_back(static_cast<uint8_t>(value >> 8));
+        dst.push_back(static_cast<uint8_t>(value));
+    }
+
+    static void save(const std::filesystem::path& path, std::span<const uint8_t> data)
+    {
+        std::ofstream file (path, std::ios::binary);
+
+        if (!file)
+            log::error("[image_writer] Failed open file: {}", path.string());
+
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    static void validate(uint32_t width, uint32_t height, std::span<const glm::vec3> pixels)
+    {
+        if (!width || !height)
+            log::error("[image_writer] Image can't be with empty sizes.");
+
+        if (pixels.size() != static_cast<size_t>(width) * height)
+            log::error("[image_writer] Pixel count {} doesn't match size {}x{}.", pixels.size(), width, height);
+    }
+}
+
+namespace vrts::image_writer
+{
+    static uint32_t crc32(std::span<const uint8_t> data)
+    {
+        static const auto table = []
+        {
+            std::array<uint32_t, 256> table;
+
+            for (auto i: std::views::iota(0u, 256u))
+            {
+                auto c = i;
+
+                for (auto k = 0; k < 8; ++k)
+                    c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+
+                table[i] = c;
+            }
+
+            return table;
+        } ();
+
+        auto crc = 0xffffffffu;
+
+        for (auto byte: data)
+            crc = table[(crc ^ byte) & 0xff] ^ (crc >> 8);
+
+        return crc ^ 0xffffffffu;
+    }
+
+    static uint32_t adler32(std::span<const uint8_t> data)
+    {
+        constexpr uint32_t mod = 65521;
+
+        uint32_t a = 1;
+        uint32_t b = 0;
+
+        for (auto byte: data)
+        {
+            a = (a + byte) % mod;
+            b = (b + a) % mod;
+        }
+
+        return (b << 16) | a;
+    }
+
+    static void appendChunk(std::vector<uint8_t>& png, std::string_view type, std::span<const uint8_t> data)
+    {
+        appendBigEndian(png, static_cast<uint32_t>(data.size()));
+
+        const auto crc_begin = png.size();
+
+        png.insert(std::end(png), std::begin(type), std::end(type));
+        png.insert(std::end(png), std::begin(data), std::end(data));
+
+        appendBigEndian(png, crc32(std::span(png).subspan(crc_begin)));
+    }
+
+    void writePng(
+        const std::filesystem::path&    path, 
+        uint32_t                        width, 
+        uint32_t                        height, 
+        std::span<const glm::vec3>      pixels
+    )
+    {
+        validate(width, height, pixels);
+
+        /// Каждая строка: байт фильтра (0 - без фильтра) + RGB.
+        std::vector<uint8_t> raw_data;
+        raw_data.reserve(height * (width * 3 + 1));
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            raw_data.push_back(0);
+
+            for (const auto& pixel: pixels.subspan(y * width, width))
+            {
+                const auto color = glm::clamp(pixel, 0.0f, 1.0f) * 255.0f + 0.5f;
+
+                raw_data.push_back(static_cast<uint8_t>(color.r));
+                raw_data.push_back(static_cast<uint8_t>(color.g));
+                raw_data.push_back(static_cast<uint8_t>(color.b));
+            }
+        }
+
+        /// zlib-поток из несжатых deflate-блоков: кодировщик не нужен, а размер файла для эталона не важен.
+        constexpr size_t max_stored_block_size = 65535;
+
+        std::vector<uint8_t> zlib_data = {0x78, 0x01};
+
+        for (size_t offset = 0; offset < raw_data.size(); offset += max_stored_block_size)
+        {
+            const auto size     = static_cast<uint16_t>(std::min(max_stored_block_size, raw_data.size() - offset));
+            const auto is_final = offset + size == raw_data.size();
+
+            zlib_data.push_back(is_final ? 1 : 0);
+            append(zlib_data, size);
+            append(zlib_data, static_cast<uint16_t>(~size));
+
+            zlib_data.insert(std::end(zlib_data), raw_data.begin() + offset, raw_data.begin() + offset + size);
+        }
+
+        appendBigEndian(zlib_data, adler32(raw_data));
+
+        std::vector<uint8_t> header;
+        appendBigEndian(header, width);
+        appendBigEndian(header, height);
+        header.insert(std::end(header), {8, 2, 0, 0, 0});   ///< 8 бит, RGB, deflate, фильтр 0, без interlace.
+
+        std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+        appendChunk(png, "IHDR", header);
+        appendChunk(png, "IDAT", zlib_data);
+        appendChunk(png, "IEND", { });
+
+        save(path, png);
+    }
+}
+
+namespace vrts::image_writer
+{
+    static void appendAttribute(std::vector<uint8_t>& exr, std::string_view name, std::string_view type, std::span<const uint8_t> value)
+    {
+        append(exr, name);
+        append(exr, type);
+        append(exr, static_cast<int32_t>(value.size()));
+
+        exr.insert(std::end(exr), std::begin(value), std::end(value));
+    }
+
+    void writeExr(
+        const std::filesystem::path&    path, 
+        uint32_t                        width, 
+        uint32_t                        height, 
+        std::span<const glm::vec3>      pixels
+    )
+    {
+        validate(width, height, pixels);
+
+        constexpr int32_t pixel_type_float = 2;
+
+        /// Каналы в заголовке и в данных строки идут в алфавитном порядке.
+        constexpr std::array channels = {'B', 'G', 'R'};
+        constexpr std::array components = {2, 1, 0};
+
+        std::vector<uint8_t> exr;
+
+        append(exr, 20000630);
+        append(exr, 2);
+
+        std::vector<uint8_t> value;
+
+        for (auto channel: channels)
+        {
+            append(value, std::string_view(&channel, 1));
+            append(value, pixel_type_float);
+            value.insert(std::end(value), {0, 0, 0, 0});    ///< pLinear + reserved.
+            append(value, 1);
+            append(value, 1);
+        }
+
+        value.push_back(0);
+        appendAttribute(exr, "channels", "chlist", value);
+
+        value = {0};
+        appendAttribute(exr, "compression", "compression", value);
+
+        value.clear();
+        append(value, std::array<int32_t, 4> {0, 0, static_cast<int32_t>(width) - 1, static_cast<int32_t>(height) - 1});
+        appendAttribute(exr, "dataWindow", "box2i", value);
+        appendAttribute(exr, "displayWindow", "box2i", value);
+
+        value = {0};
+        appendAttribute(exr, "lineOrder", "lineOrder", value);
+
+        value.clear();
+        append(value, 1.0f);
+        appendAttribute(exr, "pixelAspectRatio", "float", value);
+
+        value.clear();
+        append(value, glm::vec2(0.0f));
+        appendAttribute(exr, "screenWindowCenter", "v2f", value);
+
+        value.clear();
+        append(value, 1.0f);
+        appendAttribute(exr, "screenWindowWidth", "float", value);
+
+        exr.push_back(0);
+
+        const auto line_size    = static_cast<int32_t>(width * channels.size() * sizeof(float));
+        const auto table_offset = exr.size();
+
+        for (auto y: std::views::iota(0u, height))
+            append(exr, static_cast<uint64_t>(table_offset + height * sizeof(uint64_t) + y * (2 * sizeof(int32_t) + line_size)));
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            append(exr, static_cast<int32_t>(y));
+            append(exr, line_size);
+
+            const auto line = pixels.subspan(y * width, width);
+
+            for (auto component: components)
+            {
+                for (const auto& pixel: line)
+                    append(exr, pixel[component]);
+            }
+        }
+
+        save(path, exr);
+    }
+}
@@ -0,0 +1,304 @@
+#include <base/job_system.hpp>
+#include <base/logger/logger.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+
+namespace vrts
+{
+    /// Пул, которому принадлежит текущий поток, и индекс его очереди. Потоки вне пулов работают с общей очередью 0.
+    static thread_local const JobSystem*        current_pool        = nullptr;
+    static thread_local size_t                  current_queue_index = 0;
+}
+
+namespace vrts
+{
+    JobSystem::Job::Job(std::function<void ()>&& func) :
+        _func (std::move(func))
+    { }
+
+    bool JobSystem::Job::isFinished() const noexcept
+    {
+        return _is_finished.load(std::memory_order_acquire);
+    }
+}
+
+namespace vrts
+{
+    JobSystem::JobSystem(size_t thread_count)
+    {
+        _queues.reserve(thread_count + 1);
+
+        std::generate_n(std::back_inserter(_queues), thread_count + 1, []
+        {
+            return std::make_unique<WorkQueue>();
+        });
+
+        _threads.reserve(thread_count);
+
+        for (auto i: std::views::iota(1u, thread_count + 1))
+            _threads.emplace_back(&JobSystem::workerLoop, this, i);
+
+        log::info("[JobSystem] Worker thread count: {}", thread_count);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard lock (_sleep_mutex);
+            _is_stopped = true;
+        }
+
+        _wake_condition.notify_all();
+
+        _threads.clear();
+    }
+
+    JobSystem& JobSystem::get()
+    {
+        static JobSystem job_system (std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        return job_system;
+    }
+
+    size_t JobSystem::getThreadCount() const noexcept
+    {
+        return _threads.size();
+    }
+
+    void JobSystem::enqueue(const JobHandle& ptr_job)
+    {
+        auto& queue = *_queues[getQueueIndex()];
+
+        {
+            std::lock_guard lock (queue.mutex);
+            queue.jobs.push_back(ptr_job);
+        }
+
+        {
+            std::lock_guard lock (_sleep_mutex);
+            ++_queued_job_count;
+        }
+
+        _wake_condition.notify_one();
+
+        _finish_condition.notify_all();
+    }
+
+    JobSystem::JobHandle JobSystem::pop()
+    {
+        const auto queue_index = getQueueIndex();
+
+        /// Свою очередь разбираем с конца (LIFO, данные ещё в кэше), чужие - с начала.
+        {
+            auto& queue = *_queues[queue_index];
+
+            std::lock_guard lock (queue.mutex);
+
+            if (!queue.jobs.empty())
+            {
+                auto ptr_job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                --_queued_job_count;
+                return ptr_job;
+            }
+        }
+
+        for (auto offset: std::views::iota(1u, _queues.size()))
+        {
+            auto& queue = *_queues[(queue_index + offset) % _queues.size()];
+
+            std::lock_guard lock (queue.mutex);
+
+            if (!queue.jobs.empty())
+            {
+                auto ptr_job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                --_queued_job_count;
+                return ptr_job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void JobSystem::execute(const JobHandle& ptr_job)
+    {
+        try
+        {
+            ptr_job->_func();
+        }
+        catch (...)
+        {
+            ptr_job->_exception = std::current_exception();
+        }
+
+        ptr_job->_func = nullptr;
+
+        std::vector<JobHandle> continuations;
+
+        {
+            std::lock_guard lock (ptr_job->_continuations_mutex);
+            ptr_job->_is_finished.store(true, std::memory_order_release);
+            std::swap(continuations, ptr_job->_continuations);
+        }
+
+        for (const auto& ptr_continuation: continuations)
+        {
+            if (ptr_continuation->_pending_dependency_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                enqueue(ptr_continuation);
+        }
+
+        /// Пустая критическая секция: ждущий в wait() либо ещё не проверил _is_finished, либо уже спит.
+        {
+            std::lock_guard lock (_sleep_mutex);
+        }
+
+        _finish_condition.notify_all();
+    }
+
+    bool JobSystem::tryRunPendingJob()
+    {
+        if (auto ptr_job = pop(); ptr_job)
+        {
+            execute(ptr_job);
+            return true;
+        }
+
+        return false;
+    }
+
+    void JobSystem::workerLoop(size_t queue_index)
+    {
+        current_pool        = this;
+        current_queue_index = queue_index;
+
+        while (true)
+        {
+            if (tryRunPendingJob())
+                continue;
+
+            std::unique_lock lock (_sleep_mutex);
+            _wake_condition.wait(lock, [this]
+            {
+                return _is_stopped || _queued_job_count > 0;
+            });
+
+            if (_is_stopped)
+                return ;
+        }
+    }
+
+    size_t JobSystem::getQueueIndex() const noexcept
+    {
+        return current_pool == this ? current_queue_index : 0;
+    }
+
+    JobSystem::JobHandle JobSystem::submit(std::function<void ()>&& func, std::span<const JobHandle> dependencies)
+    {
+        auto ptr_job = std::make_shared<Job>(std::move(func));
+
+        /// +1 не даёт задаче стартовать, пока не обработаны все зависимости.
+        ptr_job->_pending_dependency_count.store(static_cast<uint32_t>(dependencies.size() + 1), std::memory_order_relaxed);
+
+        for (const auto& ptr_dependency: dependencies)
+        {
+            std::lock_guard lock (ptr_dependency->_continuations_mutex);
+
+            if (ptr_dependency->isFinished())
+                ptr_job->_pending_dependency_count.fetch_sub(1, std::memory_order_acq_rel);
+            else
+                ptr_dependency->_continuations.push_back(ptr_job);
+        }
+
+        if (ptr_job->_pending_dependency_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            enqueue(ptr_job);
+
+        return ptr_job;
+    }
+
+    void JobSystem::wait(const JobHandle& ptr_job)
+    {
+        while (!ptr_job->isFinished())
+        {
+            if (tryRunPendingJob())
+                continue;
+
+            std::unique_lock lock (_sleep_mutex);
+            _finish_condition.wait(lock, [this, &ptr_job]
+            {
+                return ptr_job->isFinished() || _queued_job_count > 0;
+            });
+        }
+
+        if (ptr_job->_exception)
+            std::rethrow_exception(ptr_job->_exception);
+    }
+
+    void JobSystem::wait(std::span<const JobHandle> jobs)
+    {
+        for (const auto& ptr_job: jobs)
+            wait(ptr_job);
+    }
+
+    void JobSystem::parallelFor(
+        size_t                                      begin,
+        size_t                                      end,
+        size_t                                      grain_size,
+        const std::function<void (size_t, size_t)>& func
+    )
+    {
+        if (begin >= end)
+            return ;
+
+        grain_size = std::max<size_t>(grain_size, 1);
+
+        const auto count        = end - begin;
+        const auto chunk_count  = std::min((count + grain_size - 1) / grain_size, (_threads.size() + 1) * 4);
+
+        if (chunk_count <= 1)
+        {
+            func(begin, end);
+            return ;
+        }
+
+        const auto chunk_size = (count + chunk_count - 1) / chunk_count;
+
+        std::vector<JobHandle> jobs;
+        jobs.reserve(chunk_count);
+
+        for (auto first = begin + chunk_size; first < end; first += chunk_size)
+        {
+            const auto last = std::min(first + chunk_size, end);
+            jobs.push_back(submit([&func, first, last] { func(first, last); }));
+        }
+
+        std::exception_ptr exception;
+
+        try
+        {
+            func(begin, std::min(begin + chunk_size, end));
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        /// Дожидаемся всех кусков даже при ошибке: они ссылаются на func.
+        for (const auto& ptr_job: jobs)
+        {
+            try
+            {
+                wait(ptr_job);
+            }
+            catch (...)
+            {
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+}
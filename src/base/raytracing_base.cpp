@@ -358,6 +358,7 @@ namespace vrts
             VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
             VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
             VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
+            VK_KHR_RAY_QUERY_EXTENSION_NAME,
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
             VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
             VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME
@@ -392,10 +393,17 @@ namespace vrts
             .descriptorBindingAccelerationStructureUpdateAfterBind  = VK_TRUE
         };
 
+        VkPhysicalDeviceRayQueryFeaturesKHR ray_query_features
+        {
+            .sType      = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR,
+            .pNext      = &as_features,
+            .rayQuery   = VK_TRUE
+        };
+
         VkPhysicalDeviceRayTracingPipelineFeaturesKHR ray_tracing_pipeline_features 
         { 
             .sType                                  = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR,
-            .pNext                                  = &as_features,
+            .pNext                                  = &ray_query_features,
             .rayTracingPipeline                     = VK_TRUE,
             .rayTracingPipelineTraceRaysIndirect    = VK_TRUE,
             .rayTraversalPrimitiveCulling           = VK_TRUE
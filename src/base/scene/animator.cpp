@@ -1,7 +1,9 @@
 #include <base/scene/animator.hpp>
 #include <base/logger/logger.hpp>
+#include <base/job_system.hpp>
 
 #include <algorithm>
+#include <ranges>
 
 namespace vrts
 {
@@ -189,12 +191,22 @@ namespace vrts
 
 namespace vrts
 {
+    static constexpr size_t bones_per_job = 32;
+
     void Animator::update(float delta_time)
     {
         _current_time += _ticks_per_second * delta_time;
         _current_time = std::fmod(_current_time, _duration);
 
+        JobSystem::get().parallelFor(0, _bones.size(), bones_per_job, [this] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                _bones[i].update(_current_time);
+        });
+
         calculateBoneTransform(_root_node, glm::mat4(1.0f));
+
+        _skinning_palette.update(_final_bones_matrices);
     }
 
     std::span<const glm::mat4> Animator::getFinalBoneMatrices() const
@@ -202,6 +214,11 @@ namespace vrts
         return _final_bones_matrices;
     }
 
+    const SkinningPalette& Animator::getSkinningPalette() const noexcept
+    {
+        return _skinning_palette;
+    }
+
     void Animator::calculateBoneTransform(const AnimationHierarchiry::Node& node, const glm::mat4& parent_transform)
     {
         auto node_transform     = node.transform;
@@ -213,10 +230,7 @@ namespace vrts
         });
 
         if (bone != std::end(_bones)) 
-        {
-            bone->update(_current_time);
             node_transform = bone->getTransform();
-        }
 
         const auto transform = parent_transform * node_transform;
 
@@ -255,6 +269,12 @@ namespace vrts
         return *this;
     }
 
+    Animator::Builder& Animator::Builder::skinningPalette(SkinningPaletteType type)
+    {
+        _skinning_palette_type = type;
+        return *this;
+    }
+
     void Animator::Builder::validate() const
     {
         if (_bones.empty()) 
@@ -279,8 +299,10 @@ namespace vrts
         animator._root_node                 = std::move(_root_node);
         animator._duration                  = _duration;
         animator._ticks_per_second          = _ticks_per_second;
+        animator._skinning_palette          = SkinningPalette(_skinning_palette_type);
 
         animator._final_bones_matrices.resize(animator._bone_registry.boneCount(), glm::mat4(1.0f));
+        animator._skinning_palette.update(animator._final_bones_matrices);
 
         return animator;
     }
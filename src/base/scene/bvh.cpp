@@ -0,0 +1,544 @@
+#include <base/scene/bvh.hpp>
+#include <base/job_system.hpp>
+#include <base/logger/logger.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ranges>
+
+namespace vrts
+{
+    static_assert(sizeof(BVH::Node) == 32);
+
+    static constexpr uint32_t bin_count                 = 16;
+    static constexpr uint32_t max_triangles_per_leaf    = 8;
+
+    static constexpr float traversal_cost       = 1.0f;
+    static constexpr float intersection_cost    = 1.0f;
+
+    static constexpr uint32_t   parallel_build_threshold    = 4096;
+    static constexpr size_t     primitives_per_job          = 16 * 1024;
+
+    /// Refit верхних уровней дерева распределяется по задачам, глубже - выполняется в текущем потоке.
+    static constexpr uint32_t parallel_refit_depth = 5;
+
+    void BVH::buildNodes(BuildState& state)
+    {
+        const auto primitive_count = static_cast<uint32_t>(state.primitives.size());
+
+        /// У бинарного дерева с листьями по одному примитиву не больше 2N - 1 узлов.
+        _nodes.resize(2 * primitive_count - 1);
+        state.node_count = 1;
+
+        build(state, 0, 0, primitive_count, 1);
+
+        _nodes.resize(state.node_count);
+        _nodes.shrink_to_fit();
+
+        _primitive_ids.resize(primitive_count);
+
+        std::ranges::transform(state.primitives, std::begin(_primitive_ids), [] (const BuildPrimitive& primitive)
+        {
+            return primitive.primitive_id;
+        });
+    }
+
+    BVH BVH::build(std::vector<glm::vec3>&& positions)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+
+        BVH bvh;
+
+        const auto triangle_count = static_cast<uint32_t>(positions.size() / 3);
+
+        if (triangle_count == 0)
+            return bvh;
+
+        BuildState state;
+        state.primitives.resize(triangle_count);
+
+        JobSystem::get().parallelFor(0, triangle_count, primitives_per_job, [&positions, &state] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+            {
+                auto& primitive = state.primitives[i];
+
+                primitive.bounds.extend(positions[i * 3]);
+                primitive.bounds.extend(positions[i * 3 + 1]);
+                primitive.bounds.extend(positions[i * 3 + 2]);
+                primitive.primitive_id = static_cast<uint32_t>(i);
+            }
+        });
+
+        bvh.buildNodes(state);
+
+        bvh._positions.resize(positions.size());
+
+        JobSystem::get().parallelFor(0, triangle_count, primitives_per_job, [&bvh, &positions] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                std::copy_n(positions.begin() + bvh._primitive_ids[i] * 3, 3, bvh._positions.begin() + i * 3);
+        });
+
+        positions.clear();
+
+        const std::chrono::duration<double, std::milli> build_time = std::chrono::steady_clock::now() - start_time;
+
+        bvh._statistics = bvh.computeStatistics();
+        bvh._statistics.build_time_ms = build_time.count();
+
+        return bvh;
+    }
+
+    BVH BVH::build(const MeshData& mesh_data)
+    {
+        std::vector<glm::vec3> positions (mesh_data.indices.size());
+
+        std::ranges::transform(mesh_data.indices, std::begin(positions), [&mesh_data] (uint32_t index)
+        {
+            return glm::vec3(mesh_data.attributes[index].pos);
+        });
+
+        return build(std::move(positions));
+    }
+
+    BVH BVH::build(std::span<const AABB> bounds)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+
+        BVH bvh;
+
+        if (bounds.empty())
+            return bvh;
+
+        BuildState state;
+        state.primitives.resize(bounds.size());
+
+        for (auto i: std::views::iota(0u, bounds.size()))
+            state.primitives[i] = BuildPrimitive {bounds[i], static_cast<uint32_t>(i)};
+
+        bvh.buildNodes(state);
+
+        const std::chrono::duration<double, std::milli> build_time = std::chrono::steady_clock::now() - start_time;
+
+        bvh._statistics = bvh.computeStatistics();
+        bvh._statistics.build_time_ms = build_time.count();
+
+        return bvh;
+    }
+
+    void BVH::refit(std::span<const glm::vec3> positions)
+    {
+        if (positions.size() != _positions.size())
+            log::error("[BVH] Refit expects {} vertices, got {}.", _positions.size(), positions.size());
+
+        const auto start_time = std::chrono::steady_clock::now();
+
+        JobSystem::get().parallelFor(0, _primitive_ids.size(), primitives_per_job, [this, positions] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                std::copy_n(positions.begin() + _primitive_ids[i] * 3, 3, _positions.begin() + i * 3);
+        });
+
+        if (!_nodes.empty())
+            refitNode(0, 0);
+
+        const std::chrono::duration<double, std::milli> refit_time = std::chrono::steady_clock::now() - start_time;
+        _statistics.refit_time_ms = refit_time.count();
+    }
+
+    void BVH::refit(const MeshData& mesh_data)
+    {
+        if (mesh_data.indices.size() != _positions.size())
+            log::error("[BVH] Refit expects {} indices, got {}.", _positions.size(), mesh_data.indices.size());
+
+        const auto start_time = std::chrono::steady_clock::now();
+
+        JobSystem::get().parallelFor(0, _primitive_ids.size(), primitives_per_job, [this, &mesh_data] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+            {
+                for (auto vertex: std::views::iota(0u, 3u))
+                {
+                    const auto index = mesh_data.indices[_primitive_ids[i] * 3 + vertex];
+                    _positions[i * 3 + vertex] = glm::vec3(mesh_data.attributes[index].pos);
+                }
+            }
+        });
+
+        if (!_nodes.empty())
+            refitNode(0, 0);
+
+        const std::chrono::duration<double, std::milli> refit_time = std::chrono::steady_clock::now() - start_time;
+        _statistics.refit_time_ms = refit_time.count();
+    }
+
+    void BVH::refitNode(uint32_t node_id, uint32_t depth)
+    {
+        auto& node = _nodes[node_id];
+
+        if (node.count > 0)
+        {
+            node.bounds = { };
+
+            for (const auto& position: std::span(_positions).subspan(node.first * 3, node.count * 3))
+                node.bounds.extend(position);
+
+            return ;
+        }
+
+        if (depth < parallel_refit_depth)
+        {
+            auto& job_system = JobSystem::get();
+
+            auto right_job = job_system.submit([this, &node, depth]
+            {
+                refitNode(node.first + 1, depth + 1);
+            });
+
+            refitNode(node.first, depth + 1);
+
+            job_system.wait(right_job);
+        }
+        else
+        {
+            refitNode(node.first,     depth + 1);
+            refitNode(node.first + 1, depth + 1);
+        }
+
+        node.bounds = _nodes[node.first].bounds;
+        node.bounds.extend(_nodes[node.first + 1].bounds);
+    }
+
+    auto BVH::findSplit(
+        const BuildState&   state,
+        const AABB&         centroid_bounds,
+        uint32_t            first, 
+        uint32_t            count
+    ) const -> Split
+    {
+        struct Bin
+        {
+            AABB        bounds;
+            uint32_t    count = 0;
+        };
+
+        Split best_split;
+
+        const auto extent = centroid_bounds.max - centroid_bounds.min;
+
+        for (auto axis: std::views::iota(0, 3))
+        {
+            if (extent[axis] <= 0.0f)
+                continue;
+
+            std::array<Bin, bin_count> bins;
+
+            const auto scale = static_cast<float>(bin_count) / extent[axis];
+
+            for (const auto& primitive: std::span(state.primitives).subspan(first, count))
+            {
+                const auto bin_id = std::min(
+                    static_cast<uint32_t>((primitive.bounds.getCenter()[axis] - centroid_bounds.min[axis]) * scale), 
+                    bin_count - 1
+                );
+
+                bins[bin_id].bounds.extend(primitive.bounds);
+                ++bins[bin_id].count;
+            }
+
+            std::array<float, bin_count - 1> right_costs;
+
+            AABB        right_bounds;
+            uint32_t    right_count = 0;
+
+            for (auto i = bin_count - 1; i > 0; --i)
+            {
+                right_bounds.extend(bins[i].bounds);
+                right_count += bins[i].count;
+
+                right_costs[i - 1] = right_count > 0 ? right_bounds.getSurfaceArea() * static_cast<float>(right_count) : -1.0f;
+            }
+
+            AABB        left_bounds;
+            uint32_t    left_count = 0;
+
+            for (auto i: std::views::iota(0u, bin_count - 1))
+            {
+                left_bounds.extend(bins[i].bounds);
+                left_count += bins[i].count;
+
+                if (left_count == 0 || right_costs[i] < 0.0f)
+                    continue;
+
+                const auto cost = left_bounds.getSurfaceArea() * static_cast<float>(left_count) + right_costs[i];
+
+                if (cost < best_split.cost)
+                {
+                    best_split.axis = axis;
+                    best_split.bin  = i;
+                    best_split.cost = cost;
+                }
+            }
+        }
+
+        return best_split;
+    }
+
+    void BVH::build(
+        BuildState& state,
+        uint32_t    node_id, 
+        uint32_t    first, 
+        uint32_t    count,
+        uint32_t    depth
+    )
+    {
+        AABB bounds;
+        AABB centroid_bounds;
+
+        for (const auto& primitive: std::span(state.primitives).subspan(first, count))
+        {
+            bounds.extend(primitive.bounds);
+            centroid_bounds.extend(primitive.bounds.getCenter());
+        }
+
+        auto& node = _nodes[node_id];
+        node.bounds = bounds;
+
+        const auto make_leaf = [&node, first, count]
+        {
+            node.first = first;
+            node.count = count;
+        };
+
+        if (count == 1 || depth == max_depth)
+            return make_leaf();
+
+        const auto split        = findSplit(state, centroid_bounds, first, count);
+        const auto leaf_cost    = intersection_cost * static_cast<float>(count);
+        const auto split_cost   = traversal_cost + intersection_cost * split.cost / std::max(bounds.getSurfaceArea(), std::numeric_limits<float>::min());
+
+        if (count <= max_triangles_per_leaf && leaf_cost <= split_cost)
+            return make_leaf();
+
+        const auto begin = std::begin(state.primitives) + first;
+
+        auto left_count = count / 2;
+
+        if (split.axis >= 0)
+        {
+            const auto axis     = split.axis;
+            const auto scale    = static_cast<float>(bin_count) / (centroid_bounds.max[axis] - centroid_bounds.min[axis]);
+
+            const auto middle = std::partition(begin, begin + count, [&centroid_bounds, axis, scale, &split] (const BuildPrimitive& primitive)
+            {
+                const auto bin_id = std::min(
+                    static_cast<uint32_t>((primitive.bounds.getCenter()[axis] - centroid_bounds.min[axis]) * scale), 
+                    bin_count - 1
+                );
+
+                return bin_id <= split.bin;
+            });
+
+            left_count = static_cast<uint32_t>(std::distance(begin, middle));
+        }
+
+        const auto left_child_id = state.node_count.fetch_add(2, std::memory_order_relaxed);
+
+        node.first = left_child_id;
+        node.count = 0;
+
+        if (count >= parallel_build_threshold)
+        {
+            auto& job_system = JobSystem::get();
+
+            auto right_job = job_system.submit([this, &state, left_child_id, first, count, left_count, depth]
+            {
+                build(state, left_child_id + 1, first + left_count, count - left_count, depth + 1);
+            });
+
+            build(state, left_child_id, first, left_count, depth + 1);
+
+            job_system.wait(right_job);
+        }
+        else
+        {
+            build(state, left_child_id,     first,              left_count,         depth + 1);
+            build(state, left_child_id + 1, first + left_count, count - left_count, depth + 1);
+        }
+    }
+
+    auto BVH::computeStatistics() const
+        -> Statistics
+    {
+        Statistics statistics;
+        statistics.node_count = static_cast<uint32_t>(_nodes.size());
+
+        if (_nodes.empty())
+            return statistics;
+
+        const auto root_area = std::max(_nodes.front().bounds.getSurfaceArea(), std::numeric_limits<float>::min());
+
+        std::vector<std::pair<uint32_t, uint32_t>> stack = {{0, 1}};
+
+        while (!stack.empty())
+        {
+            const auto [node_id, depth] = stack.back();
+            stack.pop_back();
+
+            const auto& node = _nodes[node_id];
+            const auto  area = node.bounds.getSurfaceArea() / root_area;
+
+            statistics.max_depth = std::max(statistics.max_depth, depth);
+
+            if (node.count > 0)
+            {
+                ++statistics.leaf_count;
+                statistics.sah_cost += area * intersection_cost * static_cast<float>(node.count);
+                continue;
+            }
+
+            statistics.sah_cost += area * traversal_cost;
+
+            stack.emplace_back(node.first, depth + 1);
+            stack.emplace_back(node.first + 1, depth + 1);
+        }
+
+        statistics.average_leaf_size = static_cast<float>(_primitive_ids.size()) / static_cast<float>(statistics.leaf_count);
+
+        return statistics;
+    }
+
+    bool BVH::intersect(const Ray& ray, uint32_t triangle_id, RayHit& hit) const
+    {
+        /// Möller-Trumbore, двусторонний: в junk_shop отсечение граней выключено.
+        const auto& p0 = _positions[triangle_id * 3];
+        const auto& p1 = _positions[triangle_id * 3 + 1];
+        const auto& p2 = _positions[triangle_id * 3 + 2];
+
+        const auto edge_1 = p1 - p0;
+        const auto edge_2 = p2 - p0;
+        const auto p_vec  = glm::cross(ray.dir, edge_2);
+        const auto det    = glm::dot(edge_1, p_vec);
+
+        if (std::abs(det) < std::numeric_limits<float>::min())
+            return false;
+
+        const auto inv_det  = 1.0f / det;
+        const auto t_vec    = ray.origin - p0;
+        const auto u        = glm::dot(t_vec, p_vec) * inv_det;
+
+        if (u < 0.0f || u > 1.0f)
+            return false;
+
+        const auto q_vec    = glm::cross(t_vec, edge_1);
+        const auto v        = glm::dot(ray.dir, q_vec) * inv_det;
+
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+
+        const auto t = glm::dot(edge_2, q_vec) * inv_det;
+
+        if (t < ray.t_min || t >= hit.t)
+            return false;
+
+        hit.t               = t;
+        hit.barycentric     = glm::vec2(u, v);
+        hit.primitive_id    = _primitive_ids[triangle_id];
+
+        return true;
+    }
+
+    template<bool any_hit>
+    std::optional<RayHit> BVH::traverse(const Ray& ray) const
+    {
+        if (_positions.empty())
+            return std::nullopt;
+
+        const auto inv_dir = 1.0f / ray.dir;
+
+        RayHit hit;
+        hit.t = ray.t_max;
+
+        std::array<uint32_t, max_depth> stack;
+        size_t stack_size = 0;
+
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const auto& node = _nodes[stack[--stack_size]];
+
+            if (intersectBounds(node.bounds, ray, inv_dir, hit.t) == std::numeric_limits<float>::infinity())
+                continue;
+
+            if (node.count > 0)
+            {
+                for (auto i = node.first; i < node.first + node.count; ++i)
+                {
+                    if (intersect(ray, i, hit) && any_hit)
+                        return hit;
+                }
+
+                continue;
+            }
+
+            /// Ближний ребёнок кладётся в стек последним, чтобы обойти его первым.
+            const auto t_left   = intersectBounds(_nodes[node.first].bounds, ray, inv_dir, hit.t);
+            const auto t_right  = intersectBounds(_nodes[node.first + 1].bounds, ray, inv_dir, hit.t);
+
+            if (t_left <= t_right)
+            {
+                stack[stack_size++] = node.first + 1;
+                stack[stack_size++] = node.first;
+            }
+            else
+            {
+                stack[stack_size++] = node.first;
+                stack[stack_size++] = node.first + 1;
+            }
+        }
+
+        if (hit.primitive_id == std::numeric_limits<uint32_t>::max())
+            return std::nullopt;
+
+        return hit;
+    }
+
+    std::optional<RayHit> BVH::intersect(const Ray& ray) const
+    {
+        return traverse<false>(ray);
+    }
+
+    bool BVH::isOccluded(const Ray& ray) const
+    {
+        return traverse<true>(ray).has_value();
+    }
+
+    std::span<const BVH::Node> BVH::getNodes() const noexcept
+    {
+        return _nodes;
+    }
+
+    std::span<const glm::vec3> BVH::getPositions() const noexcept
+    {
+        return _positions;
+    }
+
+    std::span<const uint32_t> BVH::getPrimitiveIds() const noexcept
+    {
+        return _primitive_ids;
+    }
+
+    size_t BVH::getTriangleCount() const noexcept
+    {
+        return _positions.size() / 3;
+    }
+
+    auto BVH::getStatistics() const noexcept
+        -> const Statistics&
+    {
+        return _statistics;
+    }
+}
@@ -0,0 +1,242 @@
+#include <base/scene/environment_map.hpp>
+#include <base/logger/logger.hpp>
+
+#include <base/private/stb.hpp>
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <ranges>
+#include <cmath>
+
+namespace vrts
+{
+    /// Как в shaders/utils/tone_mapping.glsl.
+    static float luminance(const glm::vec3& color) noexcept
+    {
+        return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    }
+
+    static uint32_t sampleRow(std::span<const AliasTable::Entry> entries, float u) noexcept
+    {
+        const auto size = static_cast<uint32_t>(entries.size());
+
+        const auto x    = u * static_cast<float>(size);
+        const auto id   = std::min(static_cast<uint32_t>(x), size - 1);
+
+        return x - static_cast<float>(id) < entries[id].threshold ? id : entries[id].alias;
+    }
+
+    static float toSolidAnglePdf(float pixel_pdf, float v, uint32_t width, uint32_t height) noexcept
+    {
+        const auto sin_theta = std::sin(v * glm::pi<float>());
+
+        if (sin_theta <= 0.0f)
+            return 0.0f;
+
+        return pixel_pdf * static_cast<float>(width) * static_cast<float>(height) / (2.0f * glm::pi<float>() * glm::pi<float>() * sin_theta);
+    }
+}
+
+namespace vrts
+{
+    EnvironmentMap EnvironmentMap::build(uint32_t width, uint32_t height, std::vector<glm::vec3> pixels)
+    {
+        if (width == 0 || height == 0 || pixels.size() != static_cast<size_t>(width) * height)
+            log::error("[EnvironmentMap] {} pixels for {}x{} map.", pixels.size(), width, height);
+
+        EnvironmentMap environment_map;
+
+        environment_map._width  = width;
+        environment_map._height = height;
+        environment_map._pixels = std::move(pixels);
+
+        std::vector<float> weights      (environment_map._pixels.size());
+        std::vector<float> row_weights  (height);
+
+        double total_weight = 0.0;
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            const auto sin_theta = std::sin((static_cast<float>(y) + 0.5f) / static_cast<float>(height) * glm::pi<float>());
+
+            double row_weight = 0.0;
+
+            for (auto x: std::views::iota(0u, width))
+            {
+                const auto pixel    = y * width + x;
+                const auto& color   = environment_map._pixels[pixel];
+
+                if (!std::isfinite(color.r) || !std::isfinite(color.g) || !std::isfinite(color.b) || glm::any(glm::lessThan(color, glm::vec3(0.0f))))
+                    log::error("[EnvironmentMap] Pixel ({}, {}) must be finite and non-negative.", x, y);
+
+                weights[pixel]  = luminance(color) * sin_theta;
+                row_weight      += weights[pixel];
+            }
+
+            row_weights[y]  = static_cast<float>(row_weight);
+            total_weight    += row_weight;
+        }
+
+        environment_map._marginal = AliasTable::build(row_weights);
+
+        if (environment_map._marginal.empty())
+        {
+            log::warning("[EnvironmentMap] Map is black, it won't be sampled.");
+            return environment_map;
+        }
+
+        environment_map._conditional.resize(environment_map._pixels.size());
+        environment_map._pixel_pdfs.resize(environment_map._pixels.size());
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            const auto row_begin = static_cast<size_t>(y) * width;
+
+            const auto row_table    = AliasTable::build(std::span(weights).subspan(row_begin, width));
+            const auto entries      = row_table.getEntries();
+
+            for (auto x: std::views::iota(0u, width))
+            {
+                environment_map._conditional[row_begin + x] = row_table.empty() ? AliasTable::Entry { .threshold = 1.0f, .alias = x } : entries[x];
+                environment_map._pixel_pdfs[row_begin + x]  = static_cast<float>(weights[row_begin + x] / total_weight);
+            }
+        }
+
+        return environment_map;
+    }
+
+    EnvironmentMap EnvironmentMap::load(const std::filesystem::path& path)
+    {
+        int32_t width       = 0;
+        int32_t height      = 0;
+        int32_t channels    = 0;
+
+        constexpr int32_t channels_per_pixel = 3;
+
+        stbi_set_flip_vertically_on_load(false);
+
+        auto ptr_data = stbi_loadf(path.string().c_str(), &width, &height, &channels, channels_per_pixel);
+
+        if (!ptr_data)
+            log::error("[EnvironmentMap] Failed load {}: {}", path.string(), stbi_failure_reason());
+
+        const auto pixel_count = static_cast<size_t>(width) * static_cast<size_t>(height);
+
+        std::vector<glm::vec3> pixels (pixel_count);
+
+        for (auto i: std::views::iota(0u, pixel_count))
+            pixels[i] = glm::vec3(ptr_data[i * 3], ptr_data[i * 3 + 1], ptr_data[i * 3 + 2]);
+
+        stbi_image_free(ptr_data);
+
+        log::info("[EnvironmentMap] {}: {}x{}", path.filename().string(), width, height);
+
+        return build(static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::move(pixels));
+    }
+
+    auto EnvironmentMap::sample(const glm::vec4& u) const noexcept
+        -> Sample
+    {
+        const auto row = _marginal.sample(u.x);
+        const auto col = sampleRow(std::span(_conditional).subspan(static_cast<size_t>(row) * _width, _width), u.y);
+
+        const glm::vec2 uv
+        (
+            (static_cast<float>(col) + u.z) / static_cast<float>(_width),
+            (static_cast<float>(row) + u.w) / static_cast<float>(_height)
+        );
+
+        const auto pixel = row * _width + col;
+
+        return Sample
+        {
+            .direction  = uvToDirection(uv),
+            .radiance   = _pixels[pixel],
+            .pdf        = toSolidAnglePdf(_pixel_pdfs[pixel], uv.y, _width, _height),
+            .pixel      = pixel
+        };
+    }
+
+    float EnvironmentMap::getPdf(const glm::vec3& direction) const noexcept
+    {
+        if (empty())
+            return 0.0f;
+
+        const auto uv = directionToUv(direction);
+
+        return toSolidAnglePdf(_pixel_pdfs[getPixel(uv)], uv.y, _width, _height);
+    }
+
+    glm::vec3 EnvironmentMap::getRadiance(const glm::vec3& direction) const noexcept
+    {
+        if (_pixels.empty())
+            return glm::vec3(0.0f);
+
+        return _pixels[getPixel(directionToUv(direction))];
+    }
+
+    /// theta через atan2, а не acos(y): у полюсов acos во float теряет точность, и pdf расходится с sample().
+    glm::vec2 EnvironmentMap::directionToUv(const glm::vec3& direction) noexcept
+    {
+        return glm::vec2(
+            std::atan2(direction.z, direction.x) / (2.0f * glm::pi<float>()) + 0.5f,
+            std::atan2(std::hypot(direction.x, direction.z), direction.y) / glm::pi<float>()
+        );
+    }
+
+    glm::vec3 EnvironmentMap::uvToDirection(const glm::vec2& uv) noexcept
+    {
+        const auto phi      = (uv.x - 0.5f) * 2.0f * glm::pi<float>();
+        const auto theta    = uv.y * glm::pi<float>();
+
+        return glm::vec3(
+            std::sin(theta) * std::cos(phi),
+            std::cos(theta),
+            std::sin(theta) * std::sin(phi)
+        );
+    }
+
+    uint32_t EnvironmentMap::getPixel(const glm::vec2& uv) const noexcept
+    {
+        const auto x = std::min(static_cast<uint32_t>(std::max(uv.x, 0.0f) * static_cast<float>(_width)), _width - 1);
+        const auto y = std::min(static_cast<uint32_t>(std::max(uv.y, 0.0f) * static_cast<float>(_height)), _height - 1);
+
+        return y * _width + x;
+    }
+
+    uint32_t EnvironmentMap::getWidth() const noexcept
+    {
+        return _width;
+    }
+
+    uint32_t EnvironmentMap::getHeight() const noexcept
+    {
+        return _height;
+    }
+
+    std::span<const glm::vec3> EnvironmentMap::getPixels() const noexcept
+    {
+        return _pixels;
+    }
+
+    std::span<const AliasTable::Entry> EnvironmentMap::getMarginalTable() const noexcept
+    {
+        return _marginal.getEntries();
+    }
+
+    std::span<const AliasTable::Entry> EnvironmentMap::getConditionalTables() const noexcept
+    {
+        return _conditional;
+    }
+
+    std::span<const float> EnvironmentMap::getPixelPdfs() const noexcept
+    {
+        return _pixel_pdfs;
+    }
+
+    bool EnvironmentMap::empty() const noexcept
+    {
+        return _marginal.empty();
+    }
+}
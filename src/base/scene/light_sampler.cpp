@@ -0,0 +1,276 @@
+#include <base/scene/light_sampler.hpp>
+#include <base/logger/logger.hpp>
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <ranges>
+#include <cmath>
+
+namespace vrts
+{
+    static float luminance(const glm::vec3& color) noexcept
+    {
+        return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    }
+}
+
+namespace vrts
+{
+    AliasTable AliasTable::build(std::span<const float> weights)
+    {
+        AliasTable table;
+
+        for (auto weight: weights)
+        {
+            if (!std::isfinite(weight) || weight < 0.0f)
+                log::error("[AliasTable] Weight must be finite and non-negative: {}", weight);
+
+            table._total_weight += weight;
+        }
+
+        if (table._total_weight <= 0.0)
+            return table;
+
+        const auto size = weights.size();
+
+        table._entries.resize(size);
+        table._pdfs.resize(size);
+
+        std::vector<double>     scaled_weights  (size);
+        std::vector<uint32_t>   small;
+        std::vector<uint32_t>   large;
+
+        for (auto i: std::views::iota(0u, static_cast<uint32_t>(size)))
+        {
+            table._pdfs[i]      = static_cast<float>(weights[i] / table._total_weight);
+            scaled_weights[i]   = weights[i] * static_cast<double>(size) / table._total_weight;
+
+            if (scaled_weights[i] < 1.0)
+                small.push_back(i);
+            else
+                large.push_back(i);
+        }
+
+        while (!small.empty() && !large.empty())
+        {
+            const auto small_id = small.back();
+            const auto large_id = large.back();
+
+            small.pop_back();
+
+            table._entries[small_id] = Entry
+            {
+                .threshold  = static_cast<float>(scaled_weights[small_id]),
+                .alias      = large_id
+            };
+
+            scaled_weights[large_id] -= 1.0 - scaled_weights[small_id];
+
+            if (scaled_weights[large_id] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(large_id);
+            }
+        }
+
+        for (auto id: small)
+            table._entries[id] = Entry { .threshold = 1.0f, .alias = id };
+
+        for (auto id: large)
+            table._entries[id] = Entry { .threshold = 1.0f, .alias = id };
+
+        return table;
+    }
+
+    uint32_t AliasTable::sample(float u) const noexcept
+    {
+        const auto size = static_cast<uint32_t>(_entries.size());
+
+        const auto x    = u * static_cast<float>(size);
+        const auto id   = std::min(static_cast<uint32_t>(x), size - 1);
+
+        const auto& entry = _entries[id];
+
+        return x - static_cast<float>(id) < entry.threshold ? id : entry.alias;
+    }
+
+    float AliasTable::getPdf(uint32_t id) const
+    {
+        if (id >= _pdfs.size())
+            log::error("[AliasTable] Id {} is out of range [0, {}).", id, _pdfs.size());
+
+        return _pdfs[id];
+    }
+
+    auto AliasTable::getEntries() const noexcept
+        -> std::span<const Entry>
+    {
+        return _entries;
+    }
+
+    std::span<const float> AliasTable::getPdfs() const noexcept
+    {
+        return _pdfs;
+    }
+
+    double AliasTable::getTotalWeight() const noexcept
+    {
+        return _total_weight;
+    }
+
+    size_t AliasTable::size() const noexcept
+    {
+        return _entries.size();
+    }
+
+    bool AliasTable::empty() const noexcept
+    {
+        return _entries.empty();
+    }
+}
+
+namespace vrts
+{
+    uint32_t LightSampler::sample(float u) const noexcept
+    {
+        return _alias_table.sample(u);
+    }
+
+    float LightSampler::getAreaPdf(uint32_t mesh_id) const noexcept
+    {
+        return mesh_id < _area_pdfs.size() ? _area_pdfs[mesh_id] : 0.0f;
+    }
+
+    std::span<const LightSource> LightSampler::getLights() const noexcept
+    {
+        return _lights;
+    }
+
+    std::span<const AliasTable::Entry> LightSampler::getAliasTable() const noexcept
+    {
+        return _alias_table.getEntries();
+    }
+
+    std::span<const float> LightSampler::getAreaPdfs() const noexcept
+    {
+        return _area_pdfs;
+    }
+
+    double LightSampler::getTotalPower() const noexcept
+    {
+        return _alias_table.getTotalWeight();
+    }
+
+    bool LightSampler::empty() const noexcept
+    {
+        return _alias_table.empty();
+    }
+}
+
+namespace vrts
+{
+    LightSampler::Builder& LightSampler::Builder::addMesh(
+        uint32_t                    mesh_id,
+        std::span<const glm::vec3>  positions,
+        std::span<const uint32_t>   primitive_ids,
+        const glm::vec3&            emission
+    )
+    {
+        if (positions.size() != primitive_ids.size() * 3)
+            log::error("[LightSampler] Mesh {}: {} positions for {} triangles.", mesh_id, positions.size(), primitive_ids.size());
+
+        if (mesh_id == point_light_mesh_id)
+            log::error("[LightSampler] Mesh id {} is reserved for point lights.", mesh_id);
+
+        const auto radiance = luminance(emission);
+
+        if (radiance <= 0.0f)
+            return *this;
+
+        _meshes.push_back(MeshLights { mesh_id, emission });
+
+        for (auto i: std::views::iota(0u, primitive_ids.size()))
+        {
+            const auto& p0 = positions[i * 3];
+
+            const LightSource light
+            {
+                .pos            = p0,
+                .mesh_id        = mesh_id,
+                .edge_1         = positions[i * 3 + 1] - p0,
+                .primitive_id   = primitive_ids[i],
+                .edge_2         = positions[i * 3 + 2] - p0,
+                .pdf            = 0.0f
+            };
+
+            const auto area = 0.5f * glm::length(glm::cross(light.edge_1, light.edge_2));
+
+            _lights.push_back(light);
+            _weights.push_back(glm::pi<float>() * radiance * area);
+        }
+
+        return *this;
+    }
+
+    LightSampler::Builder& LightSampler::Builder::addPointLight(const Light& light)
+    {
+        const auto intensity = luminance(light.col);
+
+        if (intensity <= 0.0f)
+            return *this;
+
+        _lights.push_back(LightSource
+        {
+            .pos            = light.pos,
+            .mesh_id        = point_light_mesh_id,
+            .edge_1         = light.col,
+            .primitive_id   = 0,
+            .edge_2         = glm::vec3(0.0f),
+            .pdf            = 0.0f
+        });
+
+        _weights.push_back(4.0f * glm::pi<float>() * intensity);
+
+        return *this;
+    }
+
+    LightSampler LightSampler::Builder::build()
+    {
+        LightSampler light_sampler;
+
+        light_sampler._alias_table = AliasTable::build(_weights);
+
+        if (light_sampler._alias_table.empty())
+        {
+            log::info("[LightSampler] Scene hasn't lights for next-event estimation.");
+            return light_sampler;
+        }
+
+        const auto pdfs = light_sampler._alias_table.getPdfs();
+
+        for (auto i: std::views::iota(0u, _lights.size()))
+            _lights[i].pdf = pdfs[i];
+
+        const auto total_power = light_sampler._alias_table.getTotalWeight();
+
+        for (const auto& mesh: _meshes)
+        {
+            if (light_sampler._area_pdfs.size() <= mesh.mesh_id)
+                light_sampler._area_pdfs.resize(mesh.mesh_id + 1, 0.0f);
+
+            light_sampler._area_pdfs[mesh.mesh_id] = static_cast<float>(glm::pi<double>() * luminance(mesh.emission) / total_power);
+        }
+
+        log::info(
+            "[LightSampler] {} lights ({} emissive meshes), total power {:.2f}",
+            _lights.size(),
+            _meshes.size(),
+            total_power
+        );
+
+        light_sampler._lights = std::move(_lights);
+
+        return light_sampler;
+    }
+}
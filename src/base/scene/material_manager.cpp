@@ -1,16 +1,41 @@
 #include <base/scene/material_manager.hpp>
+#include <base/logger/logger.hpp>
 
 #include <base/vulkan/context.hpp>
 
 namespace vrts
 {
-    void MaterialManager::add(Material&& material)
+    uint32_t MaterialManager::create(Material&& material)
     {
         _materials.push_back(std::move(material));
+        return static_cast<uint32_t>(_materials.size() - 1);
+    }
+
+    void MaterialManager::bind(uint32_t material_id)
+    {
+        if (material_id >= _materials.size())
+            log::error("[MaterialManager] Material id out of range: {} >= {}", material_id, _materials.size());
+
+        _instance_material_ids.push_back(material_id);
+    }
+
+    void MaterialManager::add(Material&& material)
+    {
+        bind(create(std::move(material)));
     }
 
     std::span<const Material> MaterialManager::getMaterials() const
     {
         return _materials;
     }
-}
\ No newline at end of file
+
+    size_t MaterialManager::getInstanceCount() const noexcept
+    {
+        return _instance_material_ids.size();
+    }
+
+    const Material& MaterialManager::getInstanceMaterial(size_t instance_id) const
+    {
+        return _materials[_instance_material_ids[instance_id]];
+    }
+}
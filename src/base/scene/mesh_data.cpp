@@ -0,0 +1,266 @@
+#include <base/scene/mesh_data.hpp>
+#include <base/job_system.hpp>
+#include <base/logger/logger.hpp>
+
+#include <algorithm>
+#include <ranges>
+#include <span>
+#include <limits>
+
+namespace vrts::mesh_conversion
+{
+    static constexpr size_t vertices_per_job = 16 * 1024;
+    static constexpr size_t faces_per_job    = 16 * 1024;
+
+    static constexpr size_t locality_cache_size = 32;
+
+    /// Один поток атрибутов за проход: без вызовов и ветвлений в теле цикла, чтобы компилятор его векторизовал.
+    template<glm::vec4 Attributes::* member>
+    static void copyStream(const aiVector3D* ptr_src, std::span<Attributes> dst, size_t first)
+    {
+        if (!ptr_src)
+        {
+            for (auto& attributes: dst)
+                attributes.*member = glm::vec4(0.0f);
+
+            return ;
+        }
+
+        ptr_src += first;
+
+        for (size_t i = 0; i < dst.size(); ++i)
+            dst[i].*member = glm::vec4(ptr_src[i].x, ptr_src[i].y, ptr_src[i].z, 0.0f);
+    }
+
+    static size_t getTriangleCount(const aiMesh* ptr_mesh)
+    {
+        if (ptr_mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE)
+            return ptr_mesh->mNumFaces;
+
+        const std::span faces (ptr_mesh->mFaces, ptr_mesh->mNumFaces);
+        return std::ranges::count_if(faces, [] (const aiFace& face) { return face.mNumIndices == 3; });
+    }
+
+    static uint32_t expandBits(uint32_t value)
+    {
+        value = (value * 0x00010001u) & 0xff0000ffu;
+        value = (value * 0x00000101u) & 0x0f00f00fu;
+        value = (value * 0x00000011u) & 0xc30c30c3u;
+        value = (value * 0x00000005u) & 0x49249249u;
+
+        return value;
+    }
+
+    static uint32_t getMortonCode(const glm::vec3& point)
+    {
+        const auto cell = glm::uvec3(glm::clamp(point * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f)));
+        return (expandBits(cell.x) << 2) | (expandBits(cell.y) << 1) | expandBits(cell.z);
+    }
+
+    bool isSupported(const aiMesh* ptr_mesh) noexcept
+    {
+        return ptr_mesh->HasFaces() && ptr_mesh->HasPositions() && ptr_mesh->HasTextureCoords(0);
+    }
+
+    Locality computeLocality(const MeshData& mesh_data)
+    {
+        Locality locality;
+
+        if (mesh_data.indices.empty())
+            return locality;
+
+        std::vector<uint32_t> load_time (mesh_data.attributes.size(), std::numeric_limits<uint32_t>::max());
+
+        uint32_t    miss_count      = 0;
+        uint64_t    index_distance  = 0;
+        uint32_t    prev_index      = mesh_data.indices.front();
+
+        for (auto index: mesh_data.indices)
+        {
+            if (load_time[index] == std::numeric_limits<uint32_t>::max() || miss_count - load_time[index] >= locality_cache_size)
+                load_time[index] = miss_count++;
+
+            index_distance += index > prev_index ? index - prev_index : prev_index - index;
+            prev_index = index;
+        }
+
+        const auto triangle_count = static_cast<float>(mesh_data.indices.size() / 3);
+
+        locality.acmr                   = static_cast<float>(miss_count) / triangle_count;
+        locality.average_index_distance = static_cast<float>(index_distance) / static_cast<float>(mesh_data.indices.size());
+
+        return locality;
+    }
+
+    void optimizeLocality(MeshData& mesh_data)
+    {
+        const auto triangle_count   = mesh_data.indices.size() / 3;
+        const auto vertex_count     = mesh_data.attributes.size();
+
+        if (triangle_count == 0)
+            return ;
+
+        glm::vec3 min_pos (std::numeric_limits<float>::max());
+        glm::vec3 max_pos (std::numeric_limits<float>::lowest());
+
+        for (const auto& attributes: mesh_data.attributes)
+        {
+            min_pos = glm::min(min_pos, glm::vec3(attributes.pos));
+            max_pos = glm::max(max_pos, glm::vec3(attributes.pos));
+        }
+
+        const auto inv_extent = 1.0f / glm::max(max_pos - min_pos, glm::vec3(std::numeric_limits<float>::min()));
+
+        std::vector<uint64_t> keys (triangle_count);
+
+        JobSystem::get().parallelFor(0, triangle_count, faces_per_job, [&mesh_data, &keys, &min_pos, &inv_extent] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+            {
+                const auto& p0 = mesh_data.attributes[mesh_data.indices[i * 3]].pos;
+                const auto& p1 = mesh_data.attributes[mesh_data.indices[i * 3 + 1]].pos;
+                const auto& p2 = mesh_data.attributes[mesh_data.indices[i * 3 + 2]].pos;
+
+                const auto centroid = (glm::vec3(p0) + glm::vec3(p1) + glm::vec3(p2)) / 3.0f;
+
+                keys[i] = (static_cast<uint64_t>(getMortonCode((centroid - min_pos) * inv_extent)) << 32) | i;
+            }
+        });
+
+        std::ranges::sort(keys);
+
+        std::vector<uint32_t> indices       (mesh_data.indices.size());
+        std::vector<uint32_t> vertex_remap  (vertex_count, std::numeric_limits<uint32_t>::max());
+
+        uint32_t next_vertex = 0;
+
+        for (auto i: std::views::iota(0u, triangle_count))
+        {
+            const auto triangle_id = static_cast<uint32_t>(keys[i] & 0xffffffffu);
+
+            for (auto vertex: std::views::iota(0u, 3u))
+            {
+                const auto old_index = mesh_data.indices[triangle_id * 3 + vertex];
+
+                if (vertex_remap[old_index] == std::numeric_limits<uint32_t>::max())
+                    vertex_remap[old_index] = next_vertex++;
+
+                indices[i * 3 + vertex] = vertex_remap[old_index];
+            }
+        }
+
+        for (auto& new_index: vertex_remap)
+        {
+            if (new_index == std::numeric_limits<uint32_t>::max())
+                new_index = next_vertex++;
+        }
+
+        std::vector<Attributes> attributes (vertex_count);
+
+        JobSystem::get().parallelFor(0, vertex_count, vertices_per_job, [&mesh_data, &attributes, &vertex_remap] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                attributes[vertex_remap[i]] = mesh_data.attributes[i];
+        });
+
+        mesh_data.indices       = std::move(indices);
+        mesh_data.attributes    = std::move(attributes);
+        mesh_data.vertex_remap  = std::move(vertex_remap);
+    }
+
+    MeshData convert(const aiMesh* ptr_mesh)
+    {
+        MeshData mesh_data;
+
+        if (!isSupported(ptr_mesh))
+            return mesh_data;
+
+        mesh_data.attributes.resize(ptr_mesh->mNumVertices);
+
+        JobSystem::get().parallelFor(0, ptr_mesh->mNumVertices, vertices_per_job, [ptr_mesh, &mesh_data] (size_t first, size_t last)
+        {
+            const auto dst = std::span(mesh_data.attributes).subspan(first, last - first);
+
+            copyStream<&Attributes::pos>(ptr_mesh->mVertices, dst, first);
+            copyStream<&Attributes::normal>(ptr_mesh->mNormals, dst, first);
+            copyStream<&Attributes::tangent>(ptr_mesh->mTangents, dst, first);
+            copyStream<&Attributes::uv>(ptr_mesh->mTextureCoords[0], dst, first);
+        });
+
+        const auto triangle_count = getTriangleCount(ptr_mesh);
+
+        mesh_data.indices.resize(triangle_count * 3);
+
+        if (triangle_count == ptr_mesh->mNumFaces)
+        {
+            JobSystem::get().parallelFor(0, ptr_mesh->mNumFaces, faces_per_job, [ptr_mesh, &mesh_data] (size_t first, size_t last)
+            {
+                for (auto i: std::views::iota(first, last))
+                    std::copy_n(ptr_mesh->mFaces[i].mIndices, 3, mesh_data.indices.begin() + i * 3);
+            });
+        }
+        else
+        {
+            log::warning(
+                "[MeshConversion] Mesh '{}' has {} non-triangle faces, skip them", 
+                ptr_mesh->mName.C_Str(), 
+                ptr_mesh->mNumFaces - triangle_count
+            );
+
+            auto dst = mesh_data.indices.begin();
+
+            for (const auto& face: std::span(ptr_mesh->mFaces, ptr_mesh->mNumFaces))
+            {
+                if (face.mNumIndices == 3)
+                    dst = std::copy_n(face.mIndices, 3, dst);
+            }
+        }
+
+        const auto locality_before = computeLocality(mesh_data);
+
+        optimizeLocality(mesh_data);
+
+        const auto locality_after = computeLocality(mesh_data);
+
+        log::info(
+            "[MeshConversion] Mesh '{}': ACMR {:.3f} -> {:.3f}, average index distance {:.1f} -> {:.1f}", 
+            ptr_mesh->mName.C_Str(), 
+            locality_before.acmr, 
+            locality_after.acmr, 
+            locality_before.average_index_distance, 
+            locality_after.average_index_distance
+        );
+
+        /// Вершины скелетного меша двигаются каждый кадр, ошибка упрощения в bind pose для них ничего не гарантирует.
+        if (!ptr_mesh->HasBones())
+        {
+            mesh_data.lods = mesh_lod::buildChain(mesh_data.indices, mesh_data.attributes);
+
+            for (auto lod_id: std::views::iota(0u, mesh_data.lods.size()))
+            {
+                log::info(
+                    "[MeshConversion] Mesh '{}': LOD {} - {} triangles, error {:.4f}", 
+                    ptr_mesh->mName.C_Str(), 
+                    lod_id + 1, 
+                    mesh_data.lods[lod_id].indices.size() / 3, 
+                    mesh_data.lods[lod_id].error
+                );
+            }
+        }
+
+        return mesh_data;
+    }
+
+    std::vector<MeshData> convert(const aiScene* ptr_scene)
+    {
+        std::vector<MeshData> meshes_data (ptr_scene->mNumMeshes);
+
+        JobSystem::get().parallelFor(0, ptr_scene->mNumMeshes, 1, [ptr_scene, &meshes_data] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                meshes_data[i] = convert(ptr_scene->mMeshes[i]);
+        });
+
+        return meshes_data;
+    }
+}
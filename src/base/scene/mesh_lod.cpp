@@ -0,0 +1,530 @@
+#include <base/scene/mesh_lod.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <ranges>
+#include <limits>
+
+namespace vrts::mesh_lod
+{
+    static constexpr size_t min_lod_triangle_count = 128;
+
+    static constexpr float max_relative_error = 0.05f;
+
+    static constexpr float min_lod_reduction = 0.75f;
+
+    static constexpr double border_weight = 10.0;
+
+    static constexpr double min_normal_cos = 0.25;
+
+    struct Quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+        double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+        double a22 = 0.0, a23 = 0.0;
+        double a33 = 0.0;
+
+        static Quadric fromPlane(const glm::dvec3& normal, double d, double weight) noexcept
+        {
+            return Quadric
+            {
+                weight * normal.x * normal.x, weight * normal.x * normal.y, weight * normal.x * normal.z, weight * normal.x * d,
+                weight * normal.y * normal.y, weight * normal.y * normal.z, weight * normal.y * d,
+                weight * normal.z * normal.z, weight * normal.z * d,
+                weight * d * d
+            };
+        }
+
+        Quadric& operator += (const Quadric& quadric) noexcept
+        {
+            a00 += quadric.a00; a01 += quadric.a01; a02 += quadric.a02; a03 += quadric.a03;
+            a11 += quadric.a11; a12 += quadric.a12; a13 += quadric.a13;
+            a22 += quadric.a22; a23 += quadric.a23;
+            a33 += quadric.a33;
+
+            return *this;
+        }
+
+        [[nodiscard]]
+        double evaluate(const glm::dvec3& p) const noexcept
+        {
+            const auto value =
+                    a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z + 2.0 * a03 * p.x
+                +   a11 * p.y * p.y + 2.0 * a12 * p.y * p.z + 2.0 * a13 * p.y
+                +   a22 * p.z * p.z + 2.0 * a23 * p.z
+                +   a33;
+
+            return std::max(value, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        double      cost;
+        uint32_t    src;
+        uint32_t    dst;
+    };
+
+    class Adjacency
+    {
+    public:
+        Adjacency(std::span<const uint32_t> indices, size_t vertex_count) :
+            _offsets    (vertex_count + 1, 0),
+            _triangles  (indices.size())
+        {
+            for (auto index: indices)
+                ++_offsets[index + 1];
+
+            std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+            std::vector<uint32_t> fill (_offsets.begin(), _offsets.end() - 1);
+
+            for (auto i: std::views::iota(0u, indices.size()))
+                _triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        [[nodiscard]]
+        std::span<const uint32_t> get(uint32_t vertex) const noexcept
+        {
+            return std::span(_triangles).subspan(_offsets[vertex], _offsets[vertex + 1] - _offsets[vertex]);
+        }
+
+    private:
+        std::vector<uint32_t> _offsets;
+        std::vector<uint32_t> _triangles;
+    };
+
+    /// Схлопывает рёбра проходами: за проход каждая вершина участвует не более чем в одном схлопывании,
+    /// поэтому стоимости и проверки переворота треугольников считаются по актуальной геометрии.
+    class Simplifier
+    {
+    public:
+        Simplifier(std::span<const uint32_t> indices, std::span<const Attributes> attributes) :
+            _indices    (indices.begin(), indices.end()),
+            _positions  (attributes.size()),
+            _quadrics   (attributes.size())
+        {
+            std::ranges::transform(attributes, _positions.begin(), [] (const Attributes& vertex_attributes)
+            {
+                return glm::dvec3(vertex_attributes.pos);
+            });
+
+            const Adjacency adjacency (_indices, _positions.size());
+
+            for (auto triangle_id: std::views::iota(0u, _indices.size() / 3))
+            {
+                const auto normal = getNormal(triangle_id);
+
+                if (normal == glm::dvec3(0.0))
+                    continue;
+
+                const auto& p0 = _positions[_indices[triangle_id * 3]];
+
+                const auto quadric = Quadric::fromPlane(normal, -glm::dot(normal, p0), 1.0);
+
+                for (auto k: std::views::iota(0u, 3u))
+                    _quadrics[_indices[triangle_id * 3 + k]] += quadric;
+
+                for (auto k: std::views::iota(0u, 3u))
+                {
+                    const auto a = _indices[triangle_id * 3 + k];
+                    const auto b = _indices[triangle_id * 3 + (k + 1) % 3];
+
+                    if (hasHalfEdge(adjacency, b, a))
+                        continue;
+
+                    const auto edge = _positions[b] - _positions[a];
+
+                    if (glm::dot(edge, edge) == 0.0)
+                        continue;
+
+                    const auto border_normal    = glm::normalize(glm::cross(edge, normal));
+                    const auto border_quadric   = Quadric::fromPlane(border_normal, -glm::dot(border_normal, _positions[a]), border_weight);
+
+                    _quadrics[a] += border_quadric;
+                    _quadrics[b] += border_quadric;
+                }
+            }
+        }
+
+        [[nodiscard]]
+        Lod getLod() const
+        {
+            return Lod
+            {
+                .indices    = _indices,
+                .error      = static_cast<float>(std::sqrt(_max_cost))
+            };
+        }
+
+        [[nodiscard]]
+        size_t getIndexCount() const noexcept
+        {
+            return _indices.size();
+        }
+
+        bool run(size_t target_index_count, float max_error)
+        {
+            const auto max_cost = static_cast<double>(max_error) * static_cast<double>(max_error);
+
+            while (_indices.size() > target_index_count)
+            {
+                if (!runPass(target_index_count, max_cost))
+                    return false;
+            }
+
+            return true;
+        }
+
+    private:
+        [[nodiscard]]
+        glm::dvec3 getNormal(uint32_t triangle_id, uint32_t src = invalid_vertex, const glm::dvec3& dst_pos = glm::dvec3(0.0)) const
+        {
+            std::array<glm::dvec3, 3> p;
+
+            for (auto k: std::views::iota(0u, 3u))
+            {
+                const auto index = _indices[triangle_id * 3 + k];
+                p[k] = index == src ? dst_pos : _positions[index];
+            }
+
+            const auto normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const auto length = glm::length(normal);
+
+            return length > 0.0 ? normal / length : glm::dvec3(0.0);
+        }
+
+        [[nodiscard]]
+        bool hasHalfEdge(const Adjacency& adjacency, uint32_t a, uint32_t b) const noexcept
+        {
+            for (auto triangle_id: adjacency.get(a))
+            {
+                for (auto k: std::views::iota(0u, 3u))
+                {
+                    if (_indices[triangle_id * 3 + k] == a && _indices[triangle_id * 3 + (k + 1) % 3] == b)
+                        return true;
+                }
+            }
+
+            return false;
+        }
+
+        [[nodiscard]]
+        bool containsVertex(uint32_t triangle_id, uint32_t vertex) const noexcept
+        {
+            return
+                    _indices[triangle_id * 3]       == vertex
+                ||  _indices[triangle_id * 3 + 1]   == vertex
+                ||  _indices[triangle_id * 3 + 2]   == vertex;
+        }
+
+        [[nodiscard]]
+        bool isFlipped(const Adjacency& adjacency, uint32_t src, uint32_t dst) const
+        {
+            for (auto triangle_id: adjacency.get(src))
+            {
+                if (containsVertex(triangle_id, dst))
+                    continue;
+
+                const auto old_normal = getNormal(triangle_id);
+                const auto new_normal = getNormal(triangle_id, src, _positions[dst]);
+
+                if (glm::dot(old_normal, new_normal) < min_normal_cos)
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool runPass(size_t target_index_count, double max_cost)
+        {
+            const auto vertex_count = static_cast<uint32_t>(_positions.size());
+
+            const Adjacency adjacency (_indices, vertex_count);
+
+            std::vector<uint32_t> border_edge_counts (vertex_count, 0);
+
+            std::vector<Collapse> collapses;
+            collapses.reserve(_indices.size());
+
+            auto add_collapse = [this, &border_edge_counts, &collapses, max_cost] (uint32_t src, uint32_t dst, bool is_border_edge)
+            {
+                if (border_edge_counts[src] != 0 && (border_edge_counts[src] != 2 || !is_border_edge))
+                    return ;
+
+                auto quadric = _quadrics[src];
+                quadric += _quadrics[dst];
+
+                if (const auto cost = quadric.evaluate(_positions[dst]); cost <= max_cost)
+                    collapses.push_back({cost, src, dst});
+            };
+
+            for (auto i: std::views::iota(0u, _indices.size()))
+            {
+                const auto a = _indices[i];
+                const auto b = _indices[i - i % 3 + (i + 1) % 3];
+
+                if (!hasHalfEdge(adjacency, b, a))
+                {
+                    ++border_edge_counts[a];
+                    ++border_edge_counts[b];
+                }
+            }
+
+            for (auto i: std::views::iota(0u, _indices.size()))
+            {
+                const auto a = _indices[i];
+                const auto b = _indices[i - i % 3 + (i + 1) % 3];
+
+                const auto is_border_edge = !hasHalfEdge(adjacency, b, a);
+
+                add_collapse(a, b, is_border_edge);
+
+                if (is_border_edge)
+                    add_collapse(b, a, true);
+            }
+
+            std::ranges::sort(collapses, { }, &Collapse::cost);
+
+            std::vector<uint32_t>   remap       (vertex_count);
+            std::vector<bool>       is_locked   (vertex_count, false);
+
+            std::iota(remap.begin(), remap.end(), 0u);
+
+            auto    index_count     = _indices.size();
+            bool    is_collapsed    = false;
+
+            for (const auto& collapse: collapses)
+            {
+                if (index_count <= target_index_count)
+                    break;
+
+                if (is_locked[collapse.src] || is_locked[collapse.dst] || isFlipped(adjacency, collapse.src, collapse.dst))
+                    continue;
+
+                remap[collapse.src] = collapse.dst;
+
+                _quadrics[collapse.dst] += _quadrics[collapse.src];
+                _max_cost = std::max(_max_cost, collapse.cost);
+
+                for (auto triangle_id: adjacency.get(collapse.src))
+                {
+                    if (containsVertex(triangle_id, collapse.dst))
+                        index_count -= 3;
+
+                    for (auto k: std::views::iota(0u, 3u))
+                        is_locked[_indices[triangle_id * 3 + k]] = true;
+                }
+
+                is_collapsed = true;
+            }
+
+            if (!is_collapsed)
+                return false;
+
+            size_t dst = 0;
+
+            for (size_t i = 0; i < _indices.size(); i += 3)
+            {
+                const auto a = remap[_indices[i]];
+                const auto b = remap[_indices[i + 1]];
+                const auto c = remap[_indices[i + 2]];
+
+                if (a == b || b == c || a == c)
+                    continue;
+
+                _indices[dst++] = a;
+                _indices[dst++] = b;
+                _indices[dst++] = c;
+            }
+
+            _indices.resize(dst);
+
+            return true;
+        }
+
+    private:
+        static constexpr uint32_t invalid_vertex = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint32_t>   _indices;
+        std::vector<glm::dvec3> _positions;
+        std::vector<Quadric>    _quadrics;
+
+        double _max_cost = 0.0;
+    };
+
+    /// Ближайшая к p точка треугольника abc (Ericson, Real-Time Collision Detection, 5.1.5).
+    static glm::vec3 getClosestPoint(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) noexcept
+    {
+        const auto ab = b - a;
+        const auto ac = c - a;
+        const auto ap = p - a;
+
+        const auto d1 = glm::dot(ab, ap);
+        const auto d2 = glm::dot(ac, ap);
+
+        if (d1 <= 0.0f && d2 <= 0.0f)
+            return a;
+
+        const auto bp = p - b;
+        const auto d3 = glm::dot(ab, bp);
+        const auto d4 = glm::dot(ac, bp);
+
+        if (d3 >= 0.0f && d4 <= d3)
+            return b;
+
+        const auto vc = d1 * d4 - d3 * d2;
+
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            return a + ab * (d1 / (d1 - d3));
+
+        const auto cp = p - c;
+        const auto d5 = glm::dot(ab, cp);
+        const auto d6 = glm::dot(ac, cp);
+
+        if (d6 >= 0.0f && d5 <= d6)
+            return c;
+
+        const auto vb = d5 * d2 - d1 * d6;
+
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            return a + ac * (d2 / (d2 - d6));
+
+        const auto va = d3 * d6 - d5 * d4;
+
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        const auto denom = 1.0f / (va + vb + vc);
+
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+    Lod simplify(
+        std::span<const uint32_t>   indices,
+        std::span<const Attributes> attributes,
+        size_t                      target_index_count,
+        float                       max_error
+    )
+    {
+        Simplifier simplifier (indices, attributes);
+        simplifier.run(target_index_count, max_error);
+
+        return simplifier.getLod();
+    }
+
+    std::vector<Lod> buildChain(std::span<const uint32_t> indices, std::span<const Attributes> attributes)
+    {
+        std::vector<Lod> lods;
+
+        if (indices.size() / 3 < min_lod_triangle_count * 2)
+            return lods;
+
+        const auto max_error = getMaxError(attributes);
+
+        Simplifier simplifier (indices, attributes);
+
+        auto prev_index_count = indices.size();
+
+        for (auto lod: std::views::iota(1u, max_lod_count))
+        {
+            const auto target_index_count = (indices.size() >> lod) / 3 * 3;
+
+            if (target_index_count / 3 < min_lod_triangle_count)
+                break;
+
+            const auto is_reached = simplifier.run(target_index_count, max_error);
+
+            if (static_cast<float>(simplifier.getIndexCount()) > static_cast<float>(prev_index_count) * min_lod_reduction)
+                break;
+
+            prev_index_count = simplifier.getIndexCount();
+            lods.push_back(simplifier.getLod());
+
+            if (!is_reached)
+                break;
+        }
+
+        return lods;
+    }
+
+    glm::vec4 getBoundingSphere(std::span<const Attributes> attributes)
+    {
+        if (attributes.empty())
+            return glm::vec4(0.0f);
+
+        glm::vec3 min_pos (std::numeric_limits<float>::max());
+        glm::vec3 max_pos (std::numeric_limits<float>::lowest());
+
+        for (const auto& vertex_attributes: attributes)
+        {
+            min_pos = glm::min(min_pos, glm::vec3(vertex_attributes.pos));
+            max_pos = glm::max(max_pos, glm::vec3(vertex_attributes.pos));
+        }
+
+        const auto center = (min_pos + max_pos) * 0.5f;
+
+        float radius = 0.0f;
+
+        for (const auto& vertex_attributes: attributes)
+            radius = std::max(radius, glm::distance(center, glm::vec3(vertex_attributes.pos)));
+
+        return glm::vec4(center, radius);
+    }
+
+    float getMaxError(std::span<const Attributes> attributes)
+    {
+        return getBoundingSphere(attributes).w * max_relative_error;
+    }
+
+    float measureError(
+        std::span<const uint32_t>   indices,
+        std::span<const Attributes> attributes,
+        const Lod&                  lod,
+        size_t                      sample_count
+    )
+    {
+        const auto lod_triangle_count   = lod.indices.size() / 3;
+        const auto step                 = std::max<size_t>(lod_triangle_count / std::max<size_t>(sample_count, 1), 1);
+
+        const auto getPos = [attributes] (uint32_t index)
+        {
+            return glm::vec3(attributes[index].pos);
+        };
+
+        float max_distance = 0.0f;
+
+        for (size_t triangle_id = 0; triangle_id < lod_triangle_count; triangle_id += step)
+        {
+            const auto center = (
+                    getPos(lod.indices[triangle_id * 3])
+                +   getPos(lod.indices[triangle_id * 3 + 1])
+                +   getPos(lod.indices[triangle_id * 3 + 2])
+            ) / 3.0f;
+
+            auto min_distance = std::numeric_limits<float>::max();
+
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const auto closest = getClosestPoint(center, getPos(indices[i]), getPos(indices[i + 1]), getPos(indices[i + 2]));
+                min_distance = std::min(min_distance, glm::distance(center, closest));
+            }
+
+            max_distance = std::max(max_distance, min_distance);
+        }
+
+        return max_distance;
+    }
+
+    uint32_t select(std::span<const float> errors, float distance, float max_angular_error) noexcept
+    {
+        uint32_t lod = 0;
+
+        while (lod < errors.size() && errors[lod] <= max_angular_error * distance)
+            ++lod;
+
+        return lod;
+    }
+}
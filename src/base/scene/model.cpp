@@ -6,7 +6,18 @@ namespace vrts
     Model::Model(std::unique_ptr<Node>&& ptr_node, MaterialManager&& material_manager) :
         _ptr_node           (std::move(ptr_node)),
         _material_manager   (std::move(material_manager))
-    { }
+    { 
+        if (_ptr_node)
+            registerNode(_ptr_node.get(), TransformHierarchy::invalid_id);
+    }
+
+    void Model::registerNode(Node* ptr_node, uint32_t parent_id)
+    {
+        ptr_node->transform_id = _transforms.add(parent_id, ptr_node->transform);
+
+        for (const auto& ptr_child: ptr_node->children)
+            registerNode(ptr_child.get(), ptr_node->transform_id);
+    }
 
     std::optional<VkAccelerationStructureKHR> Model::getRootTLAS() const noexcept
     {
@@ -29,11 +40,25 @@ namespace vrts
     void Model::applyTransform(const  glm::mat4& transform)
     {
         if (_ptr_node)
+        {
             _ptr_node->transform *= transform;
+            _transforms.setLocal(_ptr_node->transform_id, _ptr_node->transform);
+        }
     }
 
     void Model::addNode(std::unique_ptr<Node>&& ptr_child)
     {
+        registerNode(ptr_child.get(), _ptr_node->transform_id);
         _ptr_node->children.push_back(std::move(ptr_child));
     }
+
+    std::span<const uint32_t> Model::updateTransforms()
+    {
+        return _transforms.update();
+    }
+
+    const TransformHierarchy& Model::getTransformHierarchy() const noexcept
+    {
+        return _transforms;
+    }
 }
\ No newline at end of file
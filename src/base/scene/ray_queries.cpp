@@ -0,0 +1,209 @@
+#include <base/scene/ray_queries.hpp>
+#include <base/scene/node.hpp>
+#include <base/scene/visitors/acceleration_structure_builder.hpp>
+
+#include <base/job_system.hpp>
+#include <base/logger/logger.hpp>
+
+#include <ranges>
+#include <tuple>
+
+namespace vrts
+{
+    static constexpr size_t rays_per_job        = 256;
+    static constexpr size_t vertices_per_job    = 4096;
+
+    void RayQueries::add(
+        const Node*                     ptr_node,
+        std::span<const uint32_t>       indices,
+        std::span<const Attributes>     attributes,
+        std::span<const SkinningData>   skinning_data,
+        std::span<const mesh_lod::Lod>  lods
+    )
+    {
+        if (!ptr_node)
+            log::error("[RayQueries] ptr_node is null.");
+
+        if (!skinning_data.empty() && !lods.empty())
+            log::error("[RayQueries] Skinned meshes can't have LODs.");
+
+        const auto mesh_id = static_cast<uint32_t>(_nodes.size());
+
+        _nodes.push_back(ptr_node);
+        _pending_meshes.push_back(PendingMesh {indices, attributes, lods});
+
+        if (!skinning_data.empty())
+        {
+            _skinned_geometries.push_back(SkinnedGeometry
+            {
+                mesh_id,
+                std::vector(std::begin(attributes), std::end(attributes)),
+                std::vector(std::begin(skinning_data), std::end(skinning_data)),
+                MeshData 
+                {
+                    std::vector(std::begin(indices), std::end(indices)),
+                    std::vector(std::begin(attributes), std::end(attributes))
+                }
+            });
+        }
+    }
+
+    void RayQueries::build()
+    {
+        if (_pending_meshes.empty())
+            return ;
+
+        std::vector<std::pair<size_t, uint32_t>> jobs;
+
+        for (auto i: std::views::iota(0u, _pending_meshes.size()))
+        {
+            for (auto lod: std::views::iota(0u, _pending_meshes[i].lods.size() + 1))
+                jobs.emplace_back(i, static_cast<uint32_t>(lod));
+        }
+
+        std::vector<std::optional<BVH>> blases (jobs.size());
+
+        /// Крупные меши дополнительно распараллеливаются внутри BVH::build.
+        JobSystem::get().parallelFor(0, jobs.size(), 1, [this, &jobs, &blases] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+            {
+                const auto& [mesh_id, lod]  = jobs[i];
+                const auto& mesh            = _pending_meshes[mesh_id];
+                const auto  indices         = lod == 0 ? mesh.indices : std::span<const uint32_t>(mesh.lods[lod - 1].indices);
+
+                std::vector<glm::vec3> positions (indices.size());
+
+                std::ranges::transform(indices, std::begin(positions), [&mesh] (uint32_t index)
+                {
+                    return glm::vec3(mesh.attributes[index].pos);
+                });
+
+                blases[i] = BVH::build(std::move(positions));
+            }
+        });
+
+        for (auto i: std::views::iota(0u, jobs.size()))
+        {
+            const auto blas_id = _bvh.addBLAS(std::move(*blases[i]));
+
+            if (jobs[i].second == 0)
+            {
+                std::ignore = _bvh.addInstance(blas_id, glm::mat4(1.0f));
+                _lod_blas_ids.emplace_back();
+            }
+
+            _lod_blas_ids.back().push_back(blas_id);
+        }
+
+        _pending_meshes.clear();
+    }
+
+    void RayQueries::update(const TransformHierarchy& transforms, const SkinningPalette* ptr_palette)
+    {
+        if (!_pending_meshes.empty())
+            log::error("[RayQueries] {} meshes are not built, call build() before update().", _pending_meshes.size());
+
+        if (ptr_palette && ptr_palette->getBoneCount() > 0)
+        {
+            for (auto& geometry: _skinned_geometries)
+            {
+                auto& skinned_attributes = geometry.skinned_mesh_data.attributes;
+
+                JobSystem::get().parallelFor(0, geometry.attributes.size(), vertices_per_job, [&geometry, &skinned_attributes, ptr_palette] (size_t first, size_t last)
+                {
+                    for (auto i: std::views::iota(first, last))
+                    {
+                        /// Вершины без костей остаются в позе привязки.
+                        if (geometry.skinning_data[i].bone_ids[0] == -1)
+                            continue;
+
+                        skinned_attributes[i] = skinning::skin(geometry.attributes[i], geometry.skinning_data[i], *ptr_palette);
+                    }
+                });
+
+                _bvh.refit(_lod_blas_ids[geometry.mesh_id].front(), geometry.skinned_mesh_data);
+            }
+        }
+
+        /// Node::transform хранится транспонированным, как и мировые матрицы в TransformHierarchy.
+        for (auto mesh_id: std::views::iota(0u, _nodes.size()))
+            _bvh.setTransform(static_cast<uint32_t>(mesh_id), glm::transpose(transforms.getWorld(_nodes[mesh_id]->transform_id)));
+
+        _bvh.build();
+    }
+
+    void RayQueries::selectLods(const ASBuilder& as_builder)
+    {
+        if (!_pending_meshes.empty())
+            log::error("[RayQueries] {} meshes are not built, call build() before selectLods().", _pending_meshes.size());
+
+        for (auto mesh_id: std::views::iota(0u, _nodes.size()))
+        {
+            const auto& blas_ids    = _lod_blas_ids[mesh_id];
+            const auto  lod         = as_builder.getSelectedLod(_nodes[mesh_id]);
+
+            if (lod >= blas_ids.size())
+                log::error("[RayQueries] Mesh {} has no LOD {}.", mesh_id, lod);
+
+            _bvh.setBLAS(static_cast<uint32_t>(mesh_id), blas_ids[lod]);
+        }
+
+        _bvh.build();
+    }
+
+    auto RayQueries::getHit(const Ray& ray, const RayHit& hit) const
+        -> Hit
+    {
+        return Hit
+        {
+            _nodes[hit.instance_id],
+            hit.instance_id,
+            hit.primitive_id,
+            hit.barycentric,
+            hit.t,
+            ray.origin + ray.dir * hit.t
+        };
+    }
+
+    auto RayQueries::intersect(const Ray& ray) const
+        -> std::optional<Hit>
+    {
+        if (const auto hit = _bvh.intersect(ray))
+            return getHit(ray, *hit);
+
+        return std::nullopt;
+    }
+
+    bool RayQueries::isOccluded(const Ray& ray) const
+    {
+        return _bvh.isOccluded(ray);
+    }
+
+    void RayQueries::intersect(std::span<const Ray> rays, std::span<std::optional<Hit>> hits) const
+    {
+        if (rays.size() != hits.size())
+            log::error("[RayQueries] Ray count {} doesn't match hit count {}.", rays.size(), hits.size());
+
+        JobSystem::get().parallelFor(0, rays.size(), rays_per_job, [this, rays, hits] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                hits[i] = intersect(rays[i]);
+        });
+    }
+
+    size_t RayQueries::getMeshCount() const noexcept
+    {
+        return _nodes.size();
+    }
+
+    const TwoLevelBVH& RayQueries::getBVH() const noexcept
+    {
+        return _bvh;
+    }
+
+    const BVH& RayQueries::getMeshBVH(uint32_t mesh_id, uint32_t lod) const
+    {
+        return _bvh.getBLAS(_lod_blas_ids.at(mesh_id).at(lod));
+    }
+}
@@ -2,12 +2,19 @@
 #include <base/logger/logger.hpp>
 #include <base/scene/material_manager.hpp>
 #include <base/scene/node.hpp>
+#include <base/scene/skinning_data.hpp>
+#include <base/scene/mesh_data.hpp>
+#include <base/scene/synthetic_scene.hpp>
+#include <base/scene/texture.hpp>
+#include <base/scene/assimp_cast.hpp>
+#include <base/job_system.hpp>
 
 #include <base/math.hpp>
 
 #include <utility>
 #include <format>
 #include <algorithm>
+#include <limits>
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -92,6 +99,211 @@ namespace vrts::utils
             .name(name)
             .build();
     }
+
+    /// Если все индексы меша помещаются в 16 бит, храним их как VK_INDEX_TYPE_UINT16.
+    VkIndexType getIndexType(size_t vertex_count) noexcept
+    {
+        return vertex_count <= std::numeric_limits<uint16_t>::max() + size_t(1) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    }
+
+    Buffer createIndexBuffer(
+        const Context*              ptr_context,
+        const std::string_view      name,
+        std::span<const uint32_t>   indices,
+        VkIndexType                 index_type
+    )
+    {
+        constexpr auto usage_flags = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | buffer_usage_flags;
+
+        if (index_type == VK_INDEX_TYPE_UINT32)
+            return createBuffer(ptr_context, name, indices, usage_flags);
+
+        /// Шейдеры читают 16-битные индексы парами из uint, поэтому размер буфера выравниваем до 4 байт.
+        std::vector<uint16_t> packed_indices (indices.size() + indices.size() % 2, 0);
+
+        std::ranges::transform(indices, packed_indices.begin(), [] (uint32_t index)
+        {
+            return static_cast<uint16_t>(index);
+        });
+
+        log::info("[Scene::Importer]\t\t - 16-bit indices, saved {} bytes", indices.size_bytes() - packed_indices.size() * sizeof(uint16_t));
+
+        return createBuffer(ptr_context, name, std::span(packed_indices), usage_flags);
+    }
+
+    Mesh createMesh(
+        const Context*                          ptr_context,
+        const std::string_view                  name,
+        const std::span<const uint32_t>         indices,
+        const std::span<const Attributes>       attributes,
+        const std::span<const mesh_lod::Lod>    lods
+    )
+    {
+        Mesh mesh;
+
+        mesh.index_count        = indices.size();
+        mesh.vertex_count       = attributes.size();
+        mesh.bounding_sphere    = mesh_lod::getBoundingSphere(attributes);
+
+        mesh.index_type     = getIndexType(attributes.size());
+        mesh.index_buffer   = createIndexBuffer
+        (
+            ptr_context,
+            std::format("[Index buffer]: {}", name), 
+            indices, 
+            mesh.index_type
+        );
+
+        mesh.vertex_buffer = createBuffer
+        (
+            ptr_context,
+            std::format("[Vertex buffer]: {}", name), 
+            attributes, 
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | buffer_usage_flags
+        );
+
+        /// LOD ссылаются на тот же буфер вершин, поэтому тип индексов у них как у LOD 0.
+        for (auto lod_id: std::views::iota(0u, lods.size()))
+        {
+            auto& lod = mesh.lods.emplace_back();
+
+            lod.index_count     = lods[lod_id].indices.size();
+            lod.error           = lods[lod_id].error;
+            lod.index_buffer    = createIndexBuffer
+            (
+                ptr_context,
+                std::format("[Index buffer][LOD {}]: {}", lod_id + 1, name), 
+                lods[lod_id].indices, 
+                mesh.index_type
+            );
+        }
+
+        return mesh;
+    }
+
+    SkinnedMesh createMesh(
+        const Context*                          ptr_context,
+        const std::string_view                  name,
+        const std::span<const uint32_t>         indices,
+        const std::span<const Attributes>       attributes,
+        const std::span<const SkinningData>     skinning_data
+    )
+    {
+        static int skinned_mesh_index = 0;
+        ++skinned_mesh_index;
+
+        SkinnedMesh mesh;
+
+        mesh.index_count    = indices.size();
+        mesh.vertex_count   = attributes.size();
+
+        mesh.index_type     = getIndexType(attributes.size());
+        mesh.index_buffer   = createIndexBuffer
+        (
+            ptr_context,
+            std::format("[SkinnedMesh][Index buffer]: {}", name), 
+            indices, 
+            mesh.index_type
+        );
+
+        mesh.source_vertex_buffer = createBuffer
+        (
+            ptr_context,
+            std::format("[SkinnedMesh][Source vertex buffer]: {}", name), 
+            attributes, 
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | buffer_usage_flags
+        );
+
+        mesh.bone_index_format = skinning::getBoneIndexFormat(skinning_data);
+
+        auto packed_skinning_data = skinning::pack(skinning_data, mesh.bone_index_format);
+
+        mesh.skinning_buffer = createBuffer
+        (
+            ptr_context,
+            std::format("[SkinnedMesh][Skinning buffer]: {}", name), 
+            std::span(packed_skinning_data), 
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | buffer_usage_flags 
+        );
+
+        mesh.processed_vertex_buffer = createBuffer
+        (
+            ptr_context,
+            std::format("[SkinnedMesh][Processed vertex buffer]: {}", skinned_mesh_index),
+            static_cast<VkDeviceSize>(attributes.size() * sizeof(Attributes)),
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | buffer_usage_flags
+        );
+
+        return mesh;
+    }
+
+    /// Материал из изображений 1x1: неметалл с максимальной шероховатостью и плоской картой нормалей.
+    Material createSolidMaterial(
+        const Context*          ptr_context,
+        const std::string_view  material_name,
+        const glm::vec3&        color,
+        const glm::vec3&        emissive
+    )
+    {
+        auto albedo_image = Image::Builder(ptr_context)
+            .fillColor(color)
+            .generateMipmap(false)
+            .size(1, 1)
+            .vkFormat(VK_FORMAT_R8G8B8A8_UNORM)
+            .vkFilter(VK_FILTER_NEAREST)
+            .build();
+
+        auto emissive_image = Image::Builder(ptr_context)
+            .fillColor(emissive)
+            .generateMipmap(false)
+            .size(1, 1)
+            .vkFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
+            .vkFilter(VK_FILTER_NEAREST)
+            .build();
+
+        auto metallic_image = Image::Builder(ptr_context)
+            .fillColor(glm::vec3(0))
+            .generateMipmap(false)
+            .size(1, 1)
+            .vkFormat(VK_FORMAT_R8_UNORM)
+            .vkFilter(VK_FILTER_NEAREST)
+            .build();
+
+        auto roughness_image = Image::Builder(ptr_context)
+            .fillColor(glm::vec3(1))
+            .generateMipmap(false)
+            .size(1, 1)
+            .vkFormat(VK_FORMAT_R8_UNORM)
+            .vkFilter(VK_FILTER_NEAREST)
+            .build();
+
+        auto normal_map_image = Image::Builder(ptr_context)
+            .fillColor(glm::vec3(0, 0, 1))
+            .generateMipmap(false)
+            .size(1, 1)
+            .vkFormat(VK_FORMAT_R8G8B8A8_UNORM)
+            .vkFilter(VK_FILTER_NEAREST)
+            .build();
+
+        VkUtils::setName(ptr_context->device_handle, albedo_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: albedo", material_name));
+        VkUtils::setName(ptr_context->device_handle, emissive_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: emissive", material_name));
+        VkUtils::setName(ptr_context->device_handle, metallic_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: metallic", material_name));
+        VkUtils::setName(ptr_context->device_handle, roughness_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: roughness", material_name));
+        VkUtils::setName(ptr_context->device_handle, normal_map_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: normal_map", material_name));
+
+        return Material
+        {
+            std::move(albedo_image),
+            std::move(normal_map_image),
+            std::move(metallic_image),
+            std::move(roughness_image),
+            std::move(emissive_image),
+            emissive
+        };
+    }
+
+    /// Байты изображений createSolidMaterial: RGBA8 + RGBA8 + R8 + R8 + RGBA16F.
+    constexpr size_t solid_material_size = 4 + 4 + 1 + 1 + 8;
 }
 
 namespace vrts
@@ -123,11 +335,13 @@ namespace vrts
         Model&&                     model, 
         std::vector<Light>&&        lights, 
         const Camera&               camera,
-        std::optional<Animator>&&   animator
+        std::optional<Animator>&&   animator,
+        RayQueries&&                ray_queries
     ) :
         _model              (std::move(model)),
         _lights             (std::move(lights)),
-        _camera_controller  (camera)
+        _camera_controller  (camera),
+        _ray_queries        (std::move(ray_queries))
     {
         std::swap(_animator, animator);
     }
@@ -155,6 +369,45 @@ namespace vrts
     void Scene::processEvent(const SDL_Event* ptr_event)
     {
         _camera_controller.process(ptr_event);
+
+        if (ptr_event->type == SDL_MOUSEBUTTONDOWN && ptr_event->button.button == SDL_BUTTON_RIGHT)
+            focus(ptr_event->button.x, ptr_event->button.y);
+    }
+
+    void Scene::focus(int32_t x, int32_t y)
+    {
+        updateRayQueries();
+
+        auto& camera = _camera_controller.getCamera();
+
+        /// Как get_primary_ray в shaders/utils/ray.glsl. rgen пишет пиксель launch_id.y в строку height - y.
+        const auto pixel_center = glm::vec2(static_cast<float>(x), camera._height - static_cast<float>(y)) + glm::vec2(0.5f);
+        const auto d            = pixel_center / glm::vec2(camera._width, camera._height) * 2.0f - 1.0f;
+
+        const auto inv_view_matrix  = camera.getInvViewMatrix();
+        const auto target           = camera.getInvProjection() * glm::vec4(d.x, d.y, 1, 1);
+
+        const Ray ray
+        {
+            glm::vec3(inv_view_matrix * glm::vec4(0, 0, 0, 1)),
+            glm::vec3(inv_view_matrix * glm::vec4(glm::normalize(glm::vec3(target)), 0))
+        };
+
+        const auto hit = intersect(ray);
+
+        if (!hit)
+            return ;
+
+        log::info("[Scene] Focus on '{}': mesh {}, primitive {}, distance {:.2f}", hit->ptr_node->name, hit->mesh_id, hit->primitive_id, hit->t);
+
+        /// Камера смотрит из _pos + _dir в сторону _pos, положение глаза сохраняем.
+        const auto eye = camera._pos + camera._dir;
+
+        camera._dir = glm::normalize(ray.origin - hit->pos);
+        camera._pos = eye - camera._dir;
+
+        const auto right = glm::cross(camera._dir, glm::vec3(0, 1, 0));
+        camera._up = glm::cross(right, camera._dir);
     }
 
     void Scene::updateCamera()
@@ -169,88 +422,105 @@ namespace vrts
         for (auto& light: _lights)
             light.pos = transform * glm::vec4(light.pos, 1.0);
     }
-}
 
-namespace vrts
-{
-    void Scene::addRect(
-        const Context*      ptr_context,
-        const glm::vec3&    color,
-        const glm::vec3&    emissive, 
-        const glm::mat4&    transform
-    )
+    void Scene::updateRayQueries()
     {
-        _model.addNode(Scene::makeRectNode(ptr_context, glm::transpose(transform)));
+        const auto& transforms = _model.getTransformHierarchy();
 
-        static uint32_t rect_material_id = 0;
-        ++rect_material_id;
+        if (transforms.isDirty())
+            log::error("[Scene]: Transform hierarchy is dirty, call Model::updateTransforms() before updating ray queries.");
 
-        auto material_name = std::format("Rect material #{}", rect_material_id);
+        _ray_queries.build();
+        _ray_queries.update(transforms, _animator ? &_animator->getSkinningPalette() : nullptr);
+    }
 
-        auto albedo_image = Image::Builder(ptr_context)
-            .fillColor(color)
-            .generateMipmap(false)
-            .size(1, 1)
-            .vkFormat(VK_FORMAT_R8G8B8A8_UNORM)
-            .vkFilter(VK_FILTER_NEAREST)
-            .build();
+    void Scene::selectRayQueryLods(const ASBuilder& as_builder)
+    {
+        _ray_queries.build();
+        _ray_queries.selectLods(as_builder);
+    }
 
-        auto emissive_image = Image::Builder(ptr_context)
-            .fillColor(emissive)
-            .generateMipmap(false)
-            .size(1, 1)
-            .vkFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
-            .vkFilter(VK_FILTER_NEAREST)
-            .build();
+    std::optional<RayQueries::Hit> Scene::intersect(const Ray& ray) const
+    {
+        return _ray_queries.intersect(ray);
+    }
 
-        auto metallic_image = Image::Builder(ptr_context)
-            .fillColor(glm::vec3(0))
-            .generateMipmap(false)
-            .size(1, 1)
-            .vkFormat(VK_FORMAT_R8_UNORM)
-            .vkFilter(VK_FILTER_NEAREST)
-            .build();
+    bool Scene::isOccluded(const Ray& ray) const
+    {
+        return _ray_queries.isOccluded(ray);
+    }
 
-        auto roughness_image = Image::Builder(ptr_context)
-            .fillColor(glm::vec3(1))
-            .generateMipmap(false)
-            .size(1, 1)
-            .vkFormat(VK_FORMAT_R8_UNORM)
-            .vkFilter(VK_FILTER_NEAREST)
-            .build();
+    void Scene::intersect(std::span<const Ray> rays, std::span<std::optional<RayQueries::Hit>> hits) const
+    {
+        _ray_queries.intersect(rays, hits);
+    }
 
-        auto normal_map_image = Image::Builder(ptr_context)
-            .fillColor(glm::vec3(0, 0, 1))
-            .generateMipmap(false)
-            .size(1, 1)
-            .vkFormat(VK_FORMAT_R8G8B8A8_UNORM)
-            .vkFilter(VK_FILTER_NEAREST)
-            .build();
+    LightSampler Scene::createLightSampler() const
+    {
+        const auto& material_manager    = _model.getMaterialManager();
+        const auto& bvh                 = _ray_queries.getBVH();
+        const auto  instances           = bvh.getInstances();
 
-        VkUtils::setName(ptr_context->device_handle, albedo_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: albedo", material_name));
-        VkUtils::setName(ptr_context->device_handle, emissive_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: emissive", material_name));
-        VkUtils::setName(ptr_context->device_handle, metallic_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: metallic", material_name));
-        VkUtils::setName(ptr_context->device_handle, roughness_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: roughness", material_name));
-        VkUtils::setName(ptr_context->device_handle, normal_map_image, VK_OBJECT_TYPE_IMAGE, std::format("{}: normal_map", material_name));
+        LightSampler::Builder builder;
+
+        std::vector<glm::vec3> positions;
 
-        _model.getMaterialManager().add(Material
+        for (auto mesh_id: std::views::iota(0u, static_cast<uint32_t>(instances.size())))
         {
-            std::move(albedo_image),
-            std::move(normal_map_image),
-            std::move(metallic_image),
-            std::move(roughness_image),
-            std::move(emissive_image) 
-        });
+            const auto& emission = material_manager.getInstanceMaterial(mesh_id).average_emissive;
+
+            if (emission == glm::vec3(0.0f))
+                continue;
+
+            const auto& instance    = instances[mesh_id];
+            const auto& blas        = _ray_queries.getMeshBVH(mesh_id);
+
+            positions.resize(blas.getPositions().size());
+
+            std::ranges::transform(blas.getPositions(), std::begin(positions), [&instance] (const glm::vec3& pos)
+            {
+                return glm::vec3(instance.object_to_world * glm::vec4(pos, 1.0f));
+            });
+
+            builder.addMesh(mesh_id, positions, blas.getPrimitiveIds(), emission);
+        }
+
+        for (const auto& light: _lights)
+            builder.addPointLight(light);
+
+        return builder.build();
     }
+}
 
-    std::unique_ptr<MeshNode> Scene::makeRectNode(
+namespace vrts
+{
+    void Scene::addRect(
         const Context*      ptr_context,
+        const glm::vec3&    color,
+        const glm::vec3&    emissive, 
         const glm::mat4&    transform
     )
     {
-        static uint32_t rect_id = 0;
-        ++rect_id;
+        auto ptr_rect_node = Scene::makeRectNode(ptr_context, glm::transpose(transform));
+
+        /// BVH прямоугольника строится вместе с остальными новыми мешами перед следующим обновлением запросов лучей.
+        _ray_queries.add(ptr_rect_node.get(), _rect_mesh_data.indices, _rect_mesh_data.attributes);
+
+        _model.addNode(std::move(ptr_rect_node));
+
+        static uint32_t rect_material_id = 0;
+        ++rect_material_id;
 
+        _model.getMaterialManager().add(utils::createSolidMaterial(
+            ptr_context, 
+            std::format("Rect material #{}", rect_material_id), 
+            color, 
+            emissive
+        ));
+    }
+
+    MeshData Scene::getRectMeshData()
+    {
         const std::array positions = 
         {
             glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
@@ -284,30 +554,26 @@ namespace vrts
             attributes.push_back(attr);
         }
 
-        auto name = std::format("rect #{}", rect_id);
-
-        std::array indices = {0u, 1u, 2u, 1u, 3u, 2u};
+        return MeshData
+        {
+            {0u, 1u, 2u, 1u, 3u, 2u},
+            std::move(attributes)
+        };
+    }
 
-        Mesh mesh;
+    std::unique_ptr<MeshNode> Scene::makeRectNode(
+        const Context*      ptr_context,
+        const glm::mat4&    transform
+    )
+    {
+        static uint32_t rect_id = 0;
+        ++rect_id;
 
-        mesh.index_count    = indices.size();
-        mesh.vertex_count   = attributes.size();
+        auto [indices, attributes] = getRectMeshData();
 
-        mesh.index_buffer = utils::createBuffer
-        (
-            ptr_context,
-            std::format("[Index buffer]: {}", name), 
-            std::span<uint32_t>(indices), 
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | utils::buffer_usage_flags
-        );
+        auto name = std::format("rect #{}", rect_id);
 
-        mesh.vertex_buffer = utils::createBuffer
-        (
-            ptr_context,
-            std::format("[Vertex buffer]: {}", name), 
-            std::span(attributes), 
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | utils::buffer_usage_flags
-        );
+        auto mesh = utils::createMesh(ptr_context, name, indices, attributes, std::span<const mesh_lod::Lod>());
 
         return std::make_unique<MeshNode>(name, transform, std::move(mesh));
     }
@@ -344,6 +610,12 @@ namespace vrts
         return *this;
     }
 
+    Scene::Importer& Scene::Importer::skinningPalette(SkinningPaletteType type) noexcept
+    {
+        _animation.skinning_palette_type = type;
+        return *this;
+    }
+
     void Scene::Importer::validate() const
     {
         if (!_ptr_context)
@@ -368,7 +640,7 @@ namespace vrts
         {
             const auto ptr_mesh = ptr_scene->mMeshes[ptr_node->mMeshes[i]];
 
-            if (!ptr_mesh->HasFaces() || !ptr_mesh->HasPositions() || !ptr_mesh->HasTextureCoords(0))
+            if (!mesh_conversion::isSupported(ptr_mesh))
                 continue;
 
             vertex_count    += ptr_mesh->mNumVertices;
@@ -382,113 +654,35 @@ namespace vrts
         _ptr_context (ptr_context)
     { }
 
-    Mesh Scene::Importer::createMesh(
-        const std::string_view      name,
-        const std::span<uint32_t>   indices,
-        const std::span<Attributes> attributes
-    ) const
-    {
-        Mesh mesh;
-
-        mesh.index_count    = indices.size();
-        mesh.vertex_count   = attributes.size();
-
-        mesh.index_buffer = utils::createBuffer
-        (
-            _ptr_context,
-            std::format("[Index buffer]: {}", name), 
-            indices, 
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | utils::buffer_usage_flags
-        );
-
-        mesh.vertex_buffer = utils::createBuffer
-        (
-            _ptr_context,
-            std::format("[Vertex buffer]: {}", name), 
-            attributes, 
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | utils::buffer_usage_flags
-        );
-
-        return mesh;
-    }
-
-    SkinnedMesh Scene::Importer::createMesh(
-        const std::string_view          name,
-        const std::span<uint32_t>       indices,
-        const std::span<Attributes>     attributes,
-        const std::span<SkinningData>   skinning_data
-    ) const
-    {
-        static int skinned_mesh_index = 0;
-        ++skinned_mesh_index;
-
-        SkinnedMesh mesh;
-
-        mesh.index_count    = indices.size();
-        mesh.vertex_count   = attributes.size();
-
-        mesh.index_buffer = utils::createBuffer
-        (
-            _ptr_context,
-            std::format("[SkinnedMesh][Index buffer]: {}", name), 
-            indices, 
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | utils::buffer_usage_flags
-        );
-
-        mesh.source_vertex_buffer = utils::createBuffer
-        (
-            _ptr_context,
-            std::format("[SkinnedMesh][Source vertex buffer]: {}", name), 
-            attributes, 
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | utils::buffer_usage_flags
-        );
-
-        mesh.skinning_buffer = utils::createBuffer
-        (
-            _ptr_context,
-            std::format("[SkinnedMesh][Skinning buffer]: {}", name), 
-            skinning_data, 
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | utils::buffer_usage_flags 
-        );
-
-        mesh.processed_vertex_buffer = utils::createBuffer
-        (
-            _ptr_context,
-            std::format("[SkinnedMesh][Processed vertex buffer]: {}", skinned_mesh_index),
-            static_cast<VkDeviceSize>(attributes.size() * sizeof(Attributes)),
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | utils::buffer_usage_flags
-        );
-
-        return mesh;
-    }
-
     void Scene::Importer::add(
-        const std::string_view          name, 
-        const std::span<uint32_t>       indices, 
-        const std::span<Attributes>     attributes,
-        const std::span<SkinningData>   skinning_data
+        const std::string_view                  name, 
+        const std::span<uint32_t>               indices, 
+        const std::span<Attributes>             attributes,
+        const std::span<SkinningData>           skinning_data,
+        const std::span<const mesh_lod::Lod>    lods
     )
     {
+        std::unique_ptr<Node> ptr_node;
+
         if (skinning_data.empty())
         {
-            _ptr_root_node->children.push_back(
-                std::make_unique<MeshNode>(
-                    name, 
-                    _current_state.transform, 
-                    createMesh(name, indices, attributes)
-                )
+            ptr_node = std::make_unique<MeshNode>(
+                name, 
+                _current_state.transform, 
+                utils::createMesh(_ptr_context, name, indices, attributes, lods)
             );
         }
         else 
         {
-            _ptr_root_node->children.push_back(
-                std::make_unique<SkinnedMeshNode>(
-                    name, 
-                    _current_state.transform, 
-                    createMesh(name, indices, attributes, skinning_data)
-                )
+            ptr_node = std::make_unique<SkinnedMeshNode>(
+                name, 
+                _current_state.transform, 
+                utils::createMesh(_ptr_context, name, indices, attributes, skinning_data)
             );
         }
+
+        _ray_queries.add(ptr_node.get(), indices, attributes, skinning_data, lods);
+        _ptr_root_node->children.push_back(std::move(ptr_node));
     }
 
     void Scene::Importer::add(const aiLight* ptr_light)
@@ -579,6 +773,34 @@ namespace vrts
         return getImage(ptr_texture, filter, channels_per_pixel);
     }
 
+    glm::vec3 Scene::Importer::getAverageEmissive(const aiScene* ptr_scene, const aiMaterial* ptr_material) const
+    {
+        aiString texture_name;
+        if (ptr_material->Get(AI_MATKEY_TEXTURE(aiTextureType_EMISSIVE, 0), texture_name) != aiReturn_SUCCESS)
+            return glm::vec3(0.0f);
+
+        if (texture_name.C_Str()[0] != '*')
+            return glm::vec3(0.0f);
+
+        auto ptr_texture = ptr_scene->mTextures[std::stoi(texture_name.C_Str() + 1)];
+
+        if (!ptr_texture)
+            return glm::vec3(0.0f);
+
+        const auto compressed_image_size = ptr_texture->mHeight == 0 ? 
+            ptr_texture->mWidth : 
+            ptr_texture->mWidth * ptr_texture->mHeight;
+
+        /// Излучающих материалов мало, поэтому их текстуру проще ещё раз декодировать на CPU, чем читать Image обратно.
+        const auto texture = Texture::decode(
+            std::span(reinterpret_cast<const uint8_t*>(ptr_texture->pcData), compressed_image_size),
+            4,
+            TextureFilter::linear
+        );
+
+        return glm::vec3(texture.getAverage());
+    }
+
     void Scene::Importer::processMaterial(const aiScene* ptr_scene, const aiMaterial* ptr_material)
     {
         Material material;
@@ -589,6 +811,8 @@ namespace vrts
         material.roughness  = getTexture(ptr_scene, ptr_material, aiTextureType_DIFFUSE_ROUGHNESS, 1, VK_FILTER_LINEAR);
         material.emissive   = getTexture(ptr_scene, ptr_material, aiTextureType_EMISSIVE, 4, VK_FILTER_LINEAR);
 
+        material.average_emissive = getAverageEmissive(ptr_scene, ptr_material);
+
         std::string material_name = ptr_material->GetName().C_Str();
 
         VkUtils::setName(_ptr_context->device_handle, material.albedo.value(), VK_OBJECT_TYPE_IMAGE, material_name + "_albedo");
@@ -605,7 +829,13 @@ namespace vrts
         return _ptr_root_node->children.size();
     }
 
-    void Scene::Importer::processAnimation(const aiMesh* ptr_mesh, std::span<SkinningData> skinning_data)
+    static constexpr size_t skinning_vertices_per_job = 4096;
+
+    void Scene::Importer::processAnimation(
+        const aiMesh*               ptr_mesh, 
+        std::span<const uint32_t>   vertex_remap, 
+        std::span<SkinningData>     skinning_data
+    )
     {
         const std::span bones (ptr_mesh->mBones, ptr_mesh->mNumBones);
         for (const auto& bone: bones)
@@ -637,19 +867,19 @@ namespace vrts
                     continue;
                 }
 
-                auto& vert_skin_data = skinning_data[vertex_id];
-                for (auto k: std::views::iota(0u, 4u))
-                {
-                    if (vert_skin_data.bone_ids[k] > 0 || vert_skin_data.weights[k] > 0.0)
-                        continue;
+                if (!vertex_remap.empty())
+                    vertex_id = vertex_remap[vertex_id];
 
-                    vert_skin_data.bone_ids[k]  = bone_id;
-                    vert_skin_data.weights[k]   = weight;
-                    break;
-                }
+                skinning::addInfluence(skinning_data[vertex_id], static_cast<int32_t>(bone_id), weight);
             }
         }
 
+        JobSystem::get().parallelFor(0, skinning_data.size(), skinning_vertices_per_job, [skinning_data] (size_t first, size_t last)
+        {
+            for (auto& vert_skin_data: skinning_data.subspan(first, last - first))
+                skinning::normalize(vert_skin_data);
+        });
+
         log::info("[Scene::Importer]\t\t - Bone count: {}", _animation.bone_infos.boneCount());
     }
 
@@ -669,48 +899,27 @@ namespace vrts
             log::info("[Scene::Importer]\t\t - Index count: {}", index_count);
             log::info("[Scene::Importer]\t\t - Vertex count: {}", vertex_count);
 
-            std::vector<uint32_t>       indices;
-            std::vector<Attributes>     attributes;
-            std::vector<SkinningData>   skinning_data;
+            std::vector<SkinningData> skinning_data;
 
             for (auto i: std::views::iota(0u, ptr_node->mNumMeshes))
             {
-                const auto ptr_mesh = ptr_scene->mMeshes[ptr_node->mMeshes[i]];
+                const auto ptr_mesh     = ptr_scene->mMeshes[ptr_node->mMeshes[i]];
+                auto&      mesh_data    = _meshes_data[ptr_node->mMeshes[i]];
 
-                if (!ptr_mesh->HasFaces() || !ptr_mesh->HasPositions() || !ptr_mesh->HasTextureCoords(0))
+                if (!mesh_conversion::isSupported(ptr_mesh))
                     continue;
 
                 processMaterial(ptr_scene, ptr_scene->mMaterials[ptr_mesh->mMaterialIndex]);
 
-                for (auto j: std::views::iota(0u, ptr_mesh->mNumVertices))
-                {
-                    Attributes attr;
-                    attr.pos        = utils::cast(ptr_mesh->mVertices[j]);
-                    attr.normal     = utils::cast(ptr_mesh->mNormals[j]);
-                    attr.tangent    = utils::cast(ptr_mesh->mTangents[j]);
-                    attr.uv         = utils::cast(ptr_mesh->mTextureCoords[0][j]);
-
-                    attributes.push_back(attr);
-                }
-
-                const auto ptr_faces = ptr_mesh->mFaces;
-                for (auto j: std::views::iota(0u, ptr_mesh->mNumFaces))
-                {
-                    indices.push_back(ptr_faces[j].mIndices[0]);
-                    indices.push_back(ptr_faces[j].mIndices[1]);
-                    indices.push_back(ptr_faces[j].mIndices[2]);
-                }
-
                 if (ptr_mesh->HasBones())
                 {
-                    skinning_data.resize(attributes.size());
-                    processAnimation(ptr_mesh, skinning_data);
+                    skinning_data.resize(mesh_data.attributes.size());
+                    processAnimation(ptr_mesh, mesh_data.vertex_remap, skinning_data);
                 }
 
-                add(ptr_mesh->mName.C_Str(), indices, attributes, skinning_data);
+                add(ptr_mesh->mName.C_Str(), mesh_data.indices, mesh_data.attributes, skinning_data, mesh_data.lods);
 
-                indices.clear();
-                attributes.clear();
+                skinning_data.clear();
             }
         }
 
@@ -802,6 +1011,7 @@ namespace vrts
                 .boneRegistry(std::move(_animation.bone_infos))
                 .animationHierarchiryRootNode(std::move(_animation.root_node))
                 .time(duration, ticks_per_second)
+                .skinningPalette(_animation.skinning_palette_type)
                 .build();
         }
     }
@@ -836,10 +1046,18 @@ namespace vrts
         for (const auto& light: lights)
             _scene_lights.emplace(light->mName.C_Str(), light);
 
+        /// Вся CPU-конвертация геометрии выполняется заранее и параллельно, processNode дальше только создаёт буферы.
+        _meshes_data = mesh_conversion::convert(ptr_scene);
+
         _ptr_root_node = std::make_unique<Node>(ptr_scene->mName.C_Str(), glm::mat4(1.0f));
         processNode(ptr_scene, ptr_scene->mRootNode);
         getAnimation(ptr_scene);
 
+        /// BVH для запросов лучей строятся, пока исходная геометрия ещё жива.
+        _ray_queries.build();
+
+        _meshes_data.clear();
+
         Camera camera (_width, _height);
 
         importer.FreeScene();
@@ -849,7 +1067,209 @@ namespace vrts
             Model(std::move(_ptr_root_node), std::move(_material_manager)), 
             std::move(_processed_lights),
             camera,
-            std::move(_animation.animator)
+            std::move(_animation.animator),
+            std::move(_ray_queries)
+        );
+    }
+}
+
+namespace vrts
+{
+    Scene::Generator::Generator(const Context* ptr_context) noexcept :
+        _ptr_context (ptr_context)
+    { }
+
+    Scene::Generator& Scene::Generator::instanceCount(uint32_t instance_count) noexcept
+    {
+        _instance_count = instance_count;
+        return *this;
+    }
+
+    Scene::Generator& Scene::Generator::triangleCount(uint32_t triangle_count) noexcept
+    {
+        _triangle_count = triangle_count;
+        return *this;
+    }
+
+    Scene::Generator& Scene::Generator::materialCount(uint32_t material_count) noexcept
+    {
+        _material_count = material_count;
+        return *this;
+    }
+
+    Scene::Generator& Scene::Generator::skinnedInstanceCount(uint32_t skinned_instance_count) noexcept
+    {
+        _skinned_instance_count = skinned_instance_count;
+        return *this;
+    }
+
+    Scene::Generator& Scene::Generator::skinningPalette(SkinningPaletteType type) noexcept
+    {
+        _skinning_palette_type = type;
+        return *this;
+    }
+
+    Scene::Generator& Scene::Generator::viewport(uint32_t width, uint32_t height) noexcept
+    {
+        _width  = width;
+        _height = height;
+        return *this;
+    }
+
+    Scene::Generator& Scene::Generator::seed(uint32_t seed) noexcept
+    {
+        _seed = seed;
+        return *this;
+    }
+
+    const Scene::Generator::Statistics& Scene::Generator::getStatistics() const noexcept
+    {
+        return _statistics;
+    }
+
+    void Scene::Generator::validate() const
+    {
+        if (!_ptr_context)
+            log::error("[Scene::Generator] Not driver.");
+
+        if (!_instance_count && !_skinned_instance_count)
+            log::error("[Scene::Generator] Scene can't be empty.");
+
+        if (!_material_count)
+            log::error("[Scene::Generator] Material count can't be zero.");
+
+        if (!_width || !_height)
+            log::error("[Scene::Generator] Viewport can't be with empty sizes.");
+    }
+
+    static size_t getGeometrySize(const Mesh& mesh)
+    {
+        auto size = mesh.index_buffer->size_in_bytes + mesh.vertex_buffer->size_in_bytes;
+
+        for (const auto& lod: mesh.lods)
+            size += lod.index_buffer->size_in_bytes;
+
+        return static_cast<size_t>(size);
+    }
+
+    static size_t getGeometrySize(const SkinnedMesh& mesh)
+    {
+        return static_cast<size_t>(
+                mesh.index_buffer->size_in_bytes 
+            +   mesh.source_vertex_buffer->size_in_bytes 
+            +   mesh.processed_vertex_buffer->size_in_bytes 
+            +   mesh.skinning_buffer->size_in_bytes
+        );
+    }
+
+    Scene Scene::Generator::generate()
+    {
+        validate();
+
+        const auto begin = std::chrono::high_resolution_clock::now();
+
+        _statistics = { };
+
+        const auto mesh_data = synthetic::makeMesh(_triangle_count);
+
+        std::vector<SkinningData> skinning_data;
+
+        if (_skinned_instance_count)
+            skinning_data = synthetic::makeSkinningData(mesh_data.attributes);
+
+        MaterialManager material_manager;
+
+        for (auto material_id: std::views::iota(0u, _material_count))
+        {
+            std::ignore = material_manager.create(utils::createSolidMaterial(
+                _ptr_context,
+                std::format("Synthetic material #{}", material_id),
+                synthetic::makeColor(material_id),
+                glm::vec3(0.0f)
+            ));
+        }
+
+        auto ptr_root_node = std::make_unique<Node>("Synthetic scene", glm::mat4(1.0f));
+
+        RayQueries ray_queries;
+
+        const auto total_instance_count = _instance_count + _skinned_instance_count;
+
+        for (auto instance_id: std::views::iota(0u, total_instance_count))
+        {
+            const auto name         = std::format("Synthetic mesh #{}", instance_id);
+            const auto is_skinned   = instance_id >= _instance_count;
+
+            /// Матрицы узлов хранятся транспонированными, как их отдаёт Assimp.
+            const auto transform = glm::transpose(synthetic::makeTransform(instance_id, total_instance_count, _seed));
+
+            std::unique_ptr<Node> ptr_node;
+
+            if (!is_skinned)
+            {
+                auto mesh = utils::createMesh(_ptr_context, name, mesh_data.indices, mesh_data.attributes, mesh_data.lods);
+                _statistics.geometry_size += getGeometrySize(mesh);
+
+                ptr_node = std::make_unique<MeshNode>(name, transform, std::move(mesh));
+                ray_queries.add(ptr_node.get(), mesh_data.indices, mesh_data.attributes, { }, mesh_data.lods);
+            }
+            else
+            {
+                auto mesh = utils::createMesh(_ptr_context, name, mesh_data.indices, mesh_data.attributes, skinning_data);
+                _statistics.geometry_size += getGeometrySize(mesh);
+
+                ptr_node = std::make_unique<SkinnedMeshNode>(name, transform, std::move(mesh));
+                ray_queries.add(ptr_node.get(), mesh_data.indices, mesh_data.attributes, skinning_data);
+            }
+
+            material_manager.bind(instance_id % _material_count);
+            ptr_root_node->children.push_back(std::move(ptr_node));
+        }
+
+        ray_queries.build();
+
+        std::optional<Animator> animator;
+
+        if (_skinned_instance_count)
+            animator = synthetic::makeAnimator(_skinning_palette_type);
+
+        const auto lattice_size = synthetic::getLatticeSize(total_instance_count);
+
+        Camera camera (_width, _height);
+        camera.setDepthRange(0.01f, lattice_size * 10.0f);
+        camera.lookaAt(glm::vec3(lattice_size * 0.5f, lattice_size * 0.5f, lattice_size * 2.0f), glm::vec3(0, 0, -1));
+
+        std::vector<Light> lights
+        {
+            Light 
+            {
+                glm::vec3(lattice_size * 0.5f, lattice_size * 2.0f, lattice_size * 2.0f),
+                glm::vec3(1.0f)
+            }
+        };
+
+        _statistics.triangle_count  = mesh_data.indices.size() / 3 * total_instance_count;
+        _statistics.material_size   = utils::solid_material_size * _material_count;
+        _statistics.generate_time   = std::chrono::high_resolution_clock::now() - begin;
+
+        log::info("[Scene::Generator] Instances: {} (+{} skinned), triangles per mesh: {}, materials: {}", 
+            _instance_count, 
+            _skinned_instance_count, 
+            mesh_data.indices.size() / 3, 
+            _material_count
+        );
+
+        log::info("[Scene::Generator]\t - Time: {} ms", _statistics.generate_time.count());
+        log::info("[Scene::Generator]\t - Geometry: {} bytes", _statistics.geometry_size);
+        log::info("[Scene::Generator]\t - Materials: {} bytes", _statistics.material_size);
+
+        return Scene
+        (
+            Model(std::move(ptr_root_node), std::move(material_manager)), 
+            std::move(lights),
+            camera,
+            std::move(animator),
+            std::move(ray_queries)
         );
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,223 @@
+#include <base/scene/scene_data.hpp>
+#include <base/scene/assimp_cast.hpp>
+#include <base/logger/logger.hpp>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+
+#include <format>
+#include <ranges>
+
+namespace vrts
+{
+    void SceneData::applyTransform(const glm::mat4& transform)
+    {
+        _root_transform *= transform;
+
+        for (auto& light: _lights)
+            light.pos = transform * glm::vec4(light.pos, 1.0);
+    }
+
+    void SceneData::addRect(
+        const glm::vec3& color,
+        const glm::vec3& emissive,
+        const glm::mat4& transform
+    )
+    {
+        static uint32_t rect_id = 0;
+        ++rect_id;
+
+        const std::array positions = 
+        {
+            glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+            glm::vec4(1.0f, 0.0f, 0.0f, 1.0f),
+            glm::vec4(0.0f, 1.0f, 0.0f, 1.0f),
+            glm::vec4(1.0f, 1.0f, 0.0f, 1.0f)
+        };
+
+        /// Те же uv, что и в Scene::makeRectNode.
+        const std::array uvs = 
+        {
+            glm::vec4(0.0f, 0.0f, 0.0f, 0.0f),
+            glm::vec4(1.0f, 0.0f, 0.0f, 0.0f),
+            glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
+            glm::vec4(1.0f, 0.0f, 0.0f, 0.0f)
+        };
+
+        MeshInstance instance;
+        instance.name       = std::format("rect #{}", rect_id);
+        instance.transform  = glm::transpose(transform);
+        instance.mesh.indices = {0u, 1u, 2u, 1u, 3u, 2u};
+
+        for (auto i: std::views::iota(0, 4))
+        {
+            Attributes attributes = { };
+            attributes.pos      = positions[i];
+            attributes.normal   = glm::vec4(0, 0, 1, 0);
+            attributes.tangent  = glm::vec4(1, 0, 0, 0);
+            attributes.uv       = uvs[i];
+
+            instance.mesh.attributes.push_back(attributes);
+        }
+
+        _meshes.push_back(std::move(instance));
+
+        /// Значения совпадают с тем, что fillColor записывает в UNORM/SFLOAT изображения addRect.
+        _materials.push_back(MaterialData
+        {
+            Texture::fromColor(glm::vec4(glm::clamp(color, 0.0f, 1.0f), 1.0f)),
+            Texture::fromColor(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)),
+            Texture::fromColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)),
+            Texture::fromColor(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)),
+            Texture::fromColor(glm::vec4(emissive, 1.0f))
+        });
+    }
+
+    std::span<const MeshInstance> SceneData::getMeshes() const noexcept
+    {
+        return _meshes;
+    }
+
+    std::span<const MaterialData> SceneData::getMaterials() const noexcept
+    {
+        return _materials;
+    }
+
+    std::span<const Light> SceneData::getLights() const noexcept
+    {
+        return _lights;
+    }
+
+    glm::mat4 SceneData::getObjectToWorld(size_t mesh_id) const
+    {
+        return glm::transpose(_meshes[mesh_id].transform * _root_transform);
+    }
+}
+
+namespace vrts
+{
+    SceneData::Loader& SceneData::Loader::path(const std::filesystem::path& path)
+    {
+        _path = path;
+        return *this;
+    }
+
+    void SceneData::Loader::validate() const
+    {
+        if (!std::filesystem::exists(_path))
+            log::error("[SceneData::Loader] Not find file: {}.", _path.string());
+    }
+
+    Texture SceneData::Loader::getTexture(
+        const aiScene*      ptr_scene, 
+        const aiMaterial*   ptr_material, 
+        aiTextureType       texture_type,
+        int32_t             channels_per_pixel,
+        TextureFilter       filter
+    )
+    {
+        aiString texture_name;
+        if (ptr_material->Get(AI_MATKEY_TEXTURE(texture_type, 0), texture_name) != aiReturn_SUCCESS)
+            return Texture::fromColor(glm::vec4(0.0f));
+
+        if (texture_name.C_Str()[0] != '*')
+            return Texture::fromColor(glm::vec4(0.0f));
+
+        auto ptr_texture = ptr_scene->mTextures[std::stoi(texture_name.C_Str() + 1)];
+
+        if (!ptr_texture)
+            return Texture::fromColor(glm::vec4(0.0f));
+
+        const auto compressed_image_size = ptr_texture->mHeight == 0 ? 
+            ptr_texture->mWidth : 
+            ptr_texture->mWidth * ptr_texture->mHeight;
+
+        return Texture::decode(
+            std::span(reinterpret_cast<const uint8_t*>(ptr_texture->pcData), compressed_image_size),
+            channels_per_pixel,
+            filter
+        );
+    }
+
+    void SceneData::Loader::processNode(const aiScene* ptr_scene, const aiNode* ptr_node, const glm::mat4& parent_transform)
+    {
+        auto transform = parent_transform * utils::cast(ptr_node->mTransformation);
+
+        if (auto light = _scene_lights.find(ptr_node->mName.C_Str()); light != _scene_lights.end())
+        {
+            _scene_data._lights.push_back(Light
+            {
+                glm::vec3(transform[0][3], transform[1][3], transform[2][3]),
+                glm::vec3(light->second->mColorDiffuse.r, light->second->mColorDiffuse.g, light->second->mColorDiffuse.b)
+            });
+        }
+
+        for (auto i: std::views::iota(0u, ptr_node->mNumMeshes))
+        {
+            const auto ptr_mesh = ptr_scene->mMeshes[ptr_node->mMeshes[i]];
+
+            if (!mesh_conversion::isSupported(ptr_mesh))
+                continue;
+
+            const auto ptr_material = ptr_scene->mMaterials[ptr_mesh->mMaterialIndex];
+
+            _scene_data._materials.push_back(MaterialData
+            {
+                getTexture(ptr_scene, ptr_material, aiTextureType_DIFFUSE, 4, TextureFilter::linear),
+                getTexture(ptr_scene, ptr_material, aiTextureType_NORMALS, 4, TextureFilter::nearest),
+                getTexture(ptr_scene, ptr_material, aiTextureType_METALNESS, 1, TextureFilter::linear),
+                getTexture(ptr_scene, ptr_material, aiTextureType_DIFFUSE_ROUGHNESS, 1, TextureFilter::linear),
+                getTexture(ptr_scene, ptr_material, aiTextureType_EMISSIVE, 4, TextureFilter::linear)
+            });
+
+            _scene_data._meshes.push_back(MeshInstance
+            {
+                ptr_mesh->mName.C_Str(),
+                std::move(_meshes_data[ptr_node->mMeshes[i]]),
+                transform
+            });
+        }
+
+        for (auto i: std::views::iota(0u, ptr_node->mNumChildren))
+            processNode(ptr_scene, ptr_node->mChildren[i], transform);
+    }
+
+    SceneData SceneData::Loader::load()
+    {
+        validate();
+
+        Assimp::Importer importer;
+
+        importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT);
+        importer.SetPropertyBool(AI_CONFIG_IMPORT_COLLADA_IGNORE_UP_DIRECTION, true);
+
+        constexpr auto assimp_read_flags = 
+                aiProcess_GenNormals    
+            |   aiProcess_CalcTangentSpace 
+            |   aiProcess_GenUVCoords   
+            |   aiProcess_JoinIdenticalVertices 
+            |   aiProcess_Triangulate;
+
+        const auto ptr_scene = importer.ReadFile(_path.string(), assimp_read_flags);
+
+        if (!ptr_scene || !ptr_scene->mRootNode)
+            log::error("[SceneData::Loader]: {}", importer.GetErrorString());
+
+        log::info("[SceneData::Loader] Start load scene: {}.", ptr_scene->mName.C_Str());
+
+        const std::span lights (ptr_scene->mLights, ptr_scene->mNumLights);
+        for (const auto& light: lights)
+            _scene_lights.emplace(light->mName.C_Str(), light);
+
+        _meshes_data = mesh_conversion::convert(ptr_scene);
+
+        processNode(ptr_scene, ptr_scene->mRootNode, glm::mat4(1.0f));
+
+        _meshes_data.clear();
+        _scene_lights.clear();
+
+        log::info("[SceneData::Loader] Mesh count: {}", _scene_data._meshes.size());
+
+        return std::move(_scene_data);
+    }
+}
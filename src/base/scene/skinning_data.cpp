@@ -0,0 +1,167 @@
+#include <base/scene/skinning_data.hpp>
+#include <base/logger/logger.hpp>
+
+#include <glm/packing.hpp>
+
+#include <algorithm>
+#include <ranges>
+#include <array>
+#include <limits>
+
+namespace vrts::skinning
+{
+    constexpr auto max_influence_count = 4;
+
+    void addInfluence(SkinningData& skinning_data, int32_t bone_id, float weight)
+    {
+        auto min_slot = 0;
+
+        for (auto i: std::views::iota(0, max_influence_count))
+        {
+            if (skinning_data.bone_ids[i] == -1)
+            {
+                skinning_data.bone_ids[i]   = bone_id;
+                skinning_data.weights[i]    = weight;
+                return ;
+            }
+
+            if (skinning_data.weights[i] < skinning_data.weights[min_slot])
+                min_slot = i;
+        }
+
+        if (weight > skinning_data.weights[min_slot])
+        {
+            skinning_data.bone_ids[min_slot]    = bone_id;
+            skinning_data.weights[min_slot]     = weight;
+        }
+    }
+
+    void normalize(SkinningData& skinning_data)
+    {
+        std::array<std::pair<float, int32_t>, max_influence_count> influences;
+
+        for (auto i: std::views::iota(0, max_influence_count))
+            influences[i] = std::make_pair(skinning_data.weights[i], skinning_data.bone_ids[i]);
+
+        std::ranges::sort(influences, std::greater());
+
+        auto sum = 0.0f;
+        for (const auto& [weight, bone_id]: influences)
+        {
+            if (bone_id != -1)
+                sum += weight;
+        }
+
+        for (auto i: std::views::iota(0, max_influence_count))
+        {
+            const auto [weight, bone_id] = influences[i];
+
+            skinning_data.bone_ids[i]   = bone_id;
+            skinning_data.weights[i]    = bone_id != -1 && sum > 0.0f ? weight / sum : -1.0f;
+        }
+    }
+
+    BoneIndexFormat getBoneIndexFormat(std::span<const SkinningData> skinning_data)
+    {
+        auto max_bone_id = 0;
+
+        for (const auto& data: skinning_data)
+        {
+            for (auto i: std::views::iota(0, max_influence_count))
+                max_bone_id = std::max(max_bone_id, data.bone_ids[i]);
+        }
+
+        if (max_bone_id > std::numeric_limits<uint16_t>::max())
+            log::error("[Skinning] Bone id {} doesn't fit in 16 bits", max_bone_id);
+
+        return max_bone_id > std::numeric_limits<uint8_t>::max() ? BoneIndexFormat::uint16 : BoneIndexFormat::uint8;
+    }
+
+    size_t getWordsPerVertex(BoneIndexFormat format) noexcept
+    {
+        return format == BoneIndexFormat::uint8 ? 2 : 3;
+    }
+
+    static glm::u8vec4 quantizeWeights(const SkinningData& skinning_data)
+    {
+        glm::u8vec4 quantized_weights (0);
+
+        auto sum = 0;
+        for (auto i: std::views::iota(0, max_influence_count))
+        {
+            if (skinning_data.bone_ids[i] == -1)
+                break;
+
+            quantized_weights[i] = static_cast<uint8_t>(std::round(std::clamp(skinning_data.weights[i], 0.0f, 1.0f) * 255.0f));
+            sum += quantized_weights[i];
+        }
+
+        /// Ошибку округления отдаём самому тяжёлому влиянию, чтобы сумма весов осталась ровно 1.
+        if (sum > 0)
+            quantized_weights[0] = static_cast<uint8_t>(std::clamp(quantized_weights[0] + 255 - sum, 0, 255));
+
+        return quantized_weights;
+    }
+
+    std::vector<uint32_t> pack(std::span<const SkinningData> skinning_data, BoneIndexFormat format)
+    {
+        const auto stride = getWordsPerVertex(format);
+
+        std::vector<uint32_t> packed_skinning_data (skinning_data.size() * stride, 0);
+
+        for (auto vertex_id: std::views::iota(0u, skinning_data.size()))
+        {
+            const auto& data = skinning_data[vertex_id];
+
+            const auto weights  = quantizeWeights(data);
+            auto       dst      = packed_skinning_data.begin() + vertex_id * stride;
+
+            const auto bone_ids = glm::uvec4(
+                weights[0] ? data.bone_ids[0] : 0,
+                weights[1] ? data.bone_ids[1] : 0,
+                weights[2] ? data.bone_ids[2] : 0,
+                weights[3] ? data.bone_ids[3] : 0
+            );
+
+            if (format == BoneIndexFormat::uint8)
+                *dst++ = bone_ids[0] | (bone_ids[1] << 8) | (bone_ids[2] << 16) | (bone_ids[3] << 24);
+            else
+            {
+                *dst++ = bone_ids[0] | (bone_ids[1] << 16);
+                *dst++ = bone_ids[2] | (bone_ids[3] << 16);
+            }
+
+            *dst = weights[0] | (weights[1] << 8) | (weights[2] << 16) | (weights[3] << 24);
+        }
+
+        return packed_skinning_data;
+    }
+
+    SkinningData unpack(
+        std::span<const uint32_t>   packed_skinning_data, 
+        BoneIndexFormat             format, 
+        size_t                      vertex_id
+    )
+    {
+        const auto stride   = getWordsPerVertex(format);
+        const auto src      = packed_skinning_data.subspan(vertex_id * stride, stride);
+        const auto weights  = glm::unpackUnorm4x8(src[stride - 1]);
+
+        SkinningData skinning_data;
+
+        for (auto i: std::views::iota(0, max_influence_count))
+        {
+            if (weights[i] == 0.0f)
+                break;
+
+            const auto bone_id = format == BoneIndexFormat::uint8 
+                ? (src[0] >> (8 * i)) & 0xff
+                : (src[i / 2] >> (16 * (i % 2))) & 0xffff;
+
+            skinning_data.bone_ids[i]   = static_cast<int32_t>(bone_id);
+            skinning_data.weights[i]    = weights[i];
+        }
+
+        return skinning_data;
+    }
+}
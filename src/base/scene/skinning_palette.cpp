@@ -0,0 +1,221 @@
+#include <base/scene/skinning_palette.hpp>
+#include <base/logger/logger.hpp>
+
+#include <algorithm>
+#include <ranges>
+
+namespace vrts::skinning
+{
+    glm::mat3x4 toAffine(const glm::mat4& matrix)
+    {
+        const auto rows = glm::transpose(matrix);
+        return glm::mat3x4(rows[0], rows[1], rows[2]);
+    }
+
+    DualQuaternion toDualQuaternion(const glm::mat4& matrix)
+    {
+        const glm::mat3 rotation (
+            glm::normalize(glm::vec3(matrix[0])),
+            glm::normalize(glm::vec3(matrix[1])),
+            glm::normalize(glm::vec3(matrix[2]))
+        );
+
+        const auto real         = glm::normalize(glm::quat_cast(rotation));
+        const auto translation  = glm::vec3(matrix[3]);
+        const auto dual         = glm::quat(0.0f, translation.x, translation.y, translation.z) * real * 0.5f;
+
+        return DualQuaternion
+        {
+            glm::vec4(real.x, real.y, real.z, real.w),
+            glm::vec4(dual.x, dual.y, dual.z, dual.w)
+        };
+    }
+
+    /// inverse(transpose(matrix)) с точностью до положительного множителя |det|: знак определителя возвращаем,
+    /// иначе у отражённых костей (и вывернутых смесей) нормаль смотрит внутрь.
+    static glm::mat3 getNormalMatrix(const glm::mat3& matrix)
+    {
+        const auto cofactor = glm::mat3(
+            glm::cross(matrix[1], matrix[2]),
+            glm::cross(matrix[2], matrix[0]),
+            glm::cross(matrix[0], matrix[1])
+        );
+
+        return glm::determinant(matrix) < 0.0f ? -cofactor : cofactor;
+    }
+
+    static glm::vec3 rotate(const glm::vec4& real, const glm::vec3& v)
+    {
+        const auto r = glm::vec3(real);
+        return v + 2.0f * glm::cross(r, glm::cross(r, v) + real.w * v);
+    }
+
+    Attributes skin(
+        const Attributes&       attributes,
+        const SkinningData&     skinning_data,
+        const SkinningPalette&  palette
+    )
+    {
+        if (skinning_data.bone_ids[0] == -1)
+            return attributes;
+
+        const auto data         = palette.getData();
+        const auto stride       = SkinningPalette::getVec4PerBone(palette.getType());
+        const auto src_pos      = glm::vec4(glm::vec3(attributes.pos), 1.0f);
+        const auto src_normal   = glm::vec3(attributes.normal);
+        const auto src_tangent  = glm::vec3(attributes.tangent);
+
+        auto result = attributes;
+
+        if (palette.getType() == SkinningPaletteType::dual_quaternion)
+        {
+            glm::vec4 real (0.0f);
+            glm::vec4 dual (0.0f);
+
+            const auto first_real = data[skinning_data.bone_ids[0] * stride];
+
+            for (auto i = 0; i < 4 && skinning_data.bone_ids[i] != -1; ++i)
+            {
+                const auto& bone_real = data[skinning_data.bone_ids[i] * stride];
+                const auto& bone_dual = data[skinning_data.bone_ids[i] * stride + 1];
+
+                /// Выбираем полусферу первой кости, иначе смешивание q и -q даёт артефакты.
+                const auto weight = glm::dot(bone_real, first_real) < 0.0f ? -skinning_data.weights[i] : skinning_data.weights[i];
+
+                real += weight * bone_real;
+                dual += weight * bone_dual;
+            }
+
+            const auto inv_length = 1.0f / glm::length(real);
+
+            real *= inv_length;
+            dual *= inv_length;
+
+            const auto translation = 2.0f * (real.w * glm::vec3(dual) - dual.w * glm::vec3(real) + glm::cross(glm::vec3(real), glm::vec3(dual)));
+
+            result.pos      = glm::vec4(rotate(real, glm::vec3(src_pos)) + translation, 1.0f);
+            result.normal   = glm::vec4(glm::normalize(rotate(real, src_normal)), 1.0f);
+            result.tangent  = glm::vec4(glm::normalize(rotate(real, src_tangent)), 1.0f);
+
+            return result;
+        }
+
+        glm::mat3 linear_part (0.0f);
+
+        if (palette.getType() == SkinningPaletteType::affine)
+        {
+            glm::mat3x4 rows (0.0f);
+
+            for (auto i = 0; i < 4 && skinning_data.bone_ids[i] != -1; ++i)
+            {
+                for (auto row: std::views::iota(0u, 3u))
+                    rows[row] += skinning_data.weights[i] * data[skinning_data.bone_ids[i] * stride + row];
+            }
+
+            result.pos  = glm::vec4(src_pos * rows, 1.0f);
+            linear_part = glm::transpose(glm::mat3(rows));
+        }
+        else
+        {
+            glm::mat4 final_matrix (0.0f);
+
+            for (auto i = 0; i < 4 && skinning_data.bone_ids[i] != -1; ++i)
+            {
+                for (auto column: std::views::iota(0u, 4u))
+                    final_matrix[column] += skinning_data.weights[i] * data[skinning_data.bone_ids[i] * stride + column];
+            }
+
+            result.pos  = glm::vec4(glm::vec3(final_matrix * src_pos), 1.0f);
+            linear_part = glm::mat3(final_matrix);
+        }
+
+        result.normal   = glm::vec4(glm::normalize(getNormalMatrix(linear_part) * src_normal), 1.0f);
+        result.tangent  = glm::vec4(glm::normalize(linear_part * src_tangent), 1.0f);
+
+        return result;
+    }
+}
+
+namespace vrts
+{
+    SkinningPalette::SkinningPalette(SkinningPaletteType type) noexcept :
+        _type (type)
+    { }
+
+    size_t SkinningPalette::getVec4PerBone(SkinningPaletteType type) noexcept
+    {
+        switch (type)
+        {
+            case SkinningPaletteType::affine:
+                return 3;
+            case SkinningPaletteType::dual_quaternion:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+
+    void SkinningPalette::update(std::span<const glm::mat4> final_bones_matrices)
+    {
+        const auto stride = getVec4PerBone(_type);
+
+        _data.resize(final_bones_matrices.size() * stride);
+
+        for (auto bone_id: std::views::iota(0u, final_bones_matrices.size()))
+        {
+            const auto& matrix  = final_bones_matrices[bone_id];
+            const auto  dst     = _data.begin() + bone_id * stride;
+
+            switch (_type)
+            {
+                case SkinningPaletteType::mat4:
+                    std::copy_n(&matrix[0], 4, dst);
+                    break;
+                case SkinningPaletteType::affine:
+                {
+                    const auto affine = skinning::toAffine(matrix);
+                    std::copy_n(&affine[0], 3, dst);
+                    break;
+                }
+                case SkinningPaletteType::dual_quaternion:
+                {
+                    if (!_is_scale_reported)
+                    {
+                        constexpr auto eps = 0.001f;
+
+                        for (auto column: std::views::iota(0, 3))
+                        {
+                            if (std::abs(glm::length(glm::vec3(matrix[column])) - 1.0f) > eps)
+                            {
+                                log::warning("[SkinningPalette] Bone {} has scale, dual quaternion skinning ignores it", bone_id);
+                                _is_scale_reported = true;
+                                break;
+                            }
+                        }
+                    }
+
+                    const auto dual_quaternion = skinning::toDualQuaternion(matrix);
+
+                    dst[0] = dual_quaternion.real;
+                    dst[1] = dual_quaternion.dual;
+                    break;
+                }
+            }
+        }
+    }
+
+    SkinningPaletteType SkinningPalette::getType() const noexcept
+    {
+        return _type;
+    }
+
+    std::span<const glm::vec4> SkinningPalette::getData() const noexcept
+    {
+        return _data;
+    }
+
+    size_t SkinningPalette::getBoneCount() const noexcept
+    {
+        return _data.size() / getVec4PerBone(_type);
+    }
+}
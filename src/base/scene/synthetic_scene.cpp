@@ -0,0 +1,198 @@
+#include <base/scene/synthetic_scene.hpp>
+#include <base/scene/skinning_data.hpp>
+#include <base/scene/mesh_lod.hpp>
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <ranges>
+#include <random>
+
+namespace vrts::synthetic
+{
+    constexpr auto wave_amplitude   = 0.05f;
+    constexpr auto wave_frequency   = 3.0f;
+    constexpr auto lattice_spacing  = 1.5f;
+
+    constexpr auto tip_bone_pivot   = 0.5f;
+    constexpr auto tip_bone_swing   = 0.5f;
+
+    MeshData makeMesh(uint32_t triangle_count)
+    {
+        const auto quads_per_side   = std::max(1u, static_cast<uint32_t>(std::sqrt(triangle_count / 2.0f)));
+        const auto vertices_per_side = quads_per_side + 1;
+
+        MeshData mesh_data;
+        mesh_data.attributes.reserve(vertices_per_side * vertices_per_side);
+        mesh_data.indices.reserve(quads_per_side * quads_per_side * 6);
+
+        const auto omega = glm::two_pi<float>() * wave_frequency;
+
+        for (auto j: std::views::iota(0u, vertices_per_side))
+        {
+            for (auto i: std::views::iota(0u, vertices_per_side))
+            {
+                const auto x = static_cast<float>(i) / static_cast<float>(quads_per_side);
+                const auto y = static_cast<float>(j) / static_cast<float>(quads_per_side);
+
+                const auto z    = wave_amplitude * std::sin(omega * x) * std::sin(omega * y);
+                const auto dzdx = wave_amplitude * omega * std::cos(omega * x) * std::sin(omega * y);
+                const auto dzdy = wave_amplitude * omega * std::sin(omega * x) * std::cos(omega * y);
+
+                Attributes attributes = { };
+                attributes.pos      = glm::vec4(x, y, z, 1.0f);
+                attributes.normal   = glm::vec4(glm::normalize(glm::vec3(-dzdx, -dzdy, 1.0f)), 0.0f);
+                attributes.tangent  = glm::vec4(glm::normalize(glm::vec3(1.0f, 0.0f, dzdx)), 0.0f);
+                attributes.uv       = glm::vec4(x, y, 0.0f, 0.0f);
+
+                mesh_data.attributes.push_back(attributes);
+            }
+        }
+
+        for (auto j: std::views::iota(0u, quads_per_side))
+        {
+            for (auto i: std::views::iota(0u, quads_per_side))
+            {
+                const auto v0 = j * vertices_per_side + i;
+                const auto v1 = v0 + 1;
+                const auto v2 = v0 + vertices_per_side;
+                const auto v3 = v2 + 1;
+
+                mesh_data.indices.insert(mesh_data.indices.end(), {v0, v1, v2, v1, v3, v2});
+            }
+        }
+
+        mesh_data.lods = mesh_lod::buildChain(mesh_data.indices, mesh_data.attributes);
+
+        return mesh_data;
+    }
+
+    std::vector<SkinningData> makeSkinningData(std::span<const Attributes> attributes)
+    {
+        std::vector<SkinningData> skinning_data (attributes.size());
+
+        for (auto i: std::views::iota(0u, attributes.size()))
+        {
+            /// Вес кончика плавно растёт в полосе вокруг оси поворота, чтобы сгиб не рвал треугольники.
+            const auto tip_weight = glm::clamp((attributes[i].pos.y - tip_bone_pivot) * 4.0f + 0.5f, 0.0f, 1.0f);
+
+            if (tip_weight < 1.0f)
+                skinning::addInfluence(skinning_data[i], 0, 1.0f - tip_weight);
+
+            if (tip_weight > 0.0f)
+                skinning::addInfluence(skinning_data[i], 1, tip_weight);
+
+            skinning::normalize(skinning_data[i]);
+        }
+
+        return skinning_data;
+    }
+
+    Animator makeAnimator(SkinningPaletteType skinning_palette_type)
+    {
+        constexpr auto duration         = 4.0f;
+        constexpr auto ticks_per_second = 1.0f;
+
+        constexpr std::string_view root_bone_name   = "synthetic root";
+        constexpr std::string_view tip_bone_name    = "synthetic tip";
+
+        std::vector<Bone> bones;
+
+        bones.push_back(
+            Bone::Builder()
+                .name(root_bone_name)
+                .id(0)
+                .positionKeys({PositionKey(glm::vec3(0.0f), 0.0f)})
+                .rotationKeys({RotationKey(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), 0.0f)})
+                .scaleKeys({ScaleKey(glm::vec3(1.0f), 0.0f)})
+                .build()
+        );
+
+        std::vector<RotationKey> tip_rotation_keys;
+
+        for (auto i: std::views::iota(0, 5))
+        {
+            const auto angle = tip_bone_swing * std::sin(glm::half_pi<float>() * static_cast<float>(i));
+            tip_rotation_keys.emplace_back(glm::angleAxis(angle, glm::vec3(0, 0, 1)), duration * static_cast<float>(i) / 4.0f);
+        }
+
+        bones.push_back(
+            Bone::Builder()
+                .name(tip_bone_name)
+                .id(1)
+                .positionKeys({PositionKey(glm::vec3(0.0f, tip_bone_pivot, 0.0f), 0.0f)})
+                .rotationKeys(std::move(tip_rotation_keys))
+                .scaleKeys({ScaleKey(glm::vec3(1.0f), 0.0f)})
+                .build()
+        );
+
+        BoneRegistry bone_registry;
+        bone_registry.add(root_bone_name, BoneInfo { .id = 0 });
+        bone_registry.add(tip_bone_name, BoneInfo { .id = 1, .offset = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -tip_bone_pivot, 0.0f)) });
+
+        AnimationHierarchiry::Node root_node { .name = std::string(root_bone_name), .children = { } };
+        root_node.children.push_back(AnimationHierarchiry::Node { .name = std::string(tip_bone_name), .children = { } });
+
+        return Animator::Builder()
+            .bones(std::move(bones))
+            .boneRegistry(std::move(bone_registry))
+            .animationHierarchiryRootNode(std::move(root_node))
+            .time(duration, ticks_per_second)
+            .skinningPalette(skinning_palette_type)
+            .build();
+    }
+
+    float getLatticeSize(uint32_t instance_count) noexcept
+    {
+        const auto instances_per_side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<float>(std::max(instance_count, 1u)))));
+        return static_cast<float>(instances_per_side) * lattice_spacing;
+    }
+
+    glm::mat4 makeTransform(uint32_t instance_id, uint32_t instance_count, uint32_t seed)
+    {
+        const auto instances_per_side = static_cast<uint32_t>(std::round(getLatticeSize(instance_count) / lattice_spacing));
+
+        const auto cell = glm::vec3
+        (
+            static_cast<float>(instance_id % instances_per_side),
+            static_cast<float>(instance_id / instances_per_side % instances_per_side),
+            static_cast<float>(instance_id / (instances_per_side * instances_per_side))
+        );
+
+        std::mt19937 generator (seed ^ (instance_id * 0x9e3779b9u));
+
+        std::uniform_real_distribution<float> angle_distribution (0.0f, glm::two_pi<float>());
+        std::uniform_real_distribution<float> scale_distribution (0.75f, 1.25f);
+
+        auto transform = glm::translate(glm::mat4(1.0f), cell * lattice_spacing + glm::vec3(0.5f));
+        transform = glm::rotate(transform, angle_distribution(generator), glm::vec3(0, 1, 0));
+        transform = glm::scale(transform, glm::vec3(scale_distribution(generator)));
+
+        /// Центр сетки в начале координат инстанса.
+        return glm::translate(transform, glm::vec3(-0.5f, -0.5f, 0.0f));
+    }
+
+    glm::vec3 makeColor(uint32_t material_id) noexcept
+    {
+        constexpr auto golden_ratio_conjugate = 0.618033988749895f;
+
+        const auto hue = std::fmod(static_cast<float>(material_id) * golden_ratio_conjugate, 1.0f) * 6.0f;
+
+        const auto x = 1.0f - std::abs(std::fmod(hue, 2.0f) - 1.0f);
+
+        glm::vec3 color;
+
+        switch (static_cast<uint32_t>(hue))
+        {
+            case 0:     color = glm::vec3(1, x, 0); break;
+            case 1:     color = glm::vec3(x, 1, 0); break;
+            case 2:     color = glm::vec3(0, 1, x); break;
+            case 3:     color = glm::vec3(0, x, 1); break;
+            case 4:     color = glm::vec3(x, 0, 1); break;
+            default:    color = glm::vec3(1, 0, x); break;
+        }
+
+        /// Насыщенность 0.6, яркость 0.9.
+        return glm::mix(glm::vec3(1.0f), color, 0.6f) * 0.9f;
+    }
+}
@@ -0,0 +1,169 @@
+#include <base/scene/texture.hpp>
+#include <base/logger/logger.hpp>
+
+#include <base/private/stb.hpp>
+
+#include <algorithm>
+#include <ranges>
+
+namespace vrts
+{
+    Texture Texture::fromColor(const glm::vec4& color)
+    {
+        Texture texture;
+        texture._color = color;
+        
+        return texture;
+    }
+
+    Texture Texture::decode(
+        std::span<const uint8_t>    compressed_image, 
+        int32_t                     channels_per_pixel, 
+        TextureFilter               filter
+    )
+    {
+        int32_t width       = 0;
+        int32_t height      = 0;
+        int32_t channels    = 0;
+
+        auto ptr_data = stbi_load_from_memory(
+            compressed_image.data(),
+            static_cast<int>(compressed_image.size()),
+            &width, &height,
+            &channels,
+            channels_per_pixel
+        );
+
+        if (!ptr_data)
+            log::error("[Texture] Failed decode image: {}", stbi_failure_reason());
+
+        Texture texture;
+        texture._channels_per_pixel = channels_per_pixel;
+        texture._filter             = filter;
+
+        auto& base_level = texture._levels.emplace_back();
+        base_level.width    = static_cast<uint32_t>(width);
+        base_level.height   = static_cast<uint32_t>(height);
+        base_level.texels.assign(ptr_data, ptr_data + width * height * channels_per_pixel);
+
+        stbi_image_free(ptr_data);
+
+        /// Как и ImageUtils::generateMipmap, уменьшаем каждый уровень вдвое, пока оба размера не станут 1.
+        while (texture._levels.back().width > 1 || texture._levels.back().height > 1)
+        {
+            const auto& src = texture._levels.back();
+
+            Level dst;
+            dst.width   = std::max(src.width / 2, 1u);
+            dst.height  = std::max(src.height / 2, 1u);
+            dst.texels.resize(dst.width * dst.height * channels_per_pixel);
+
+            for (auto y: std::views::iota(0u, dst.height))
+            {
+                for (auto x: std::views::iota(0u, dst.width))
+                {
+                    const auto x0 = std::min(x * 2, src.width - 1);
+                    const auto x1 = std::min(x * 2 + 1, src.width - 1);
+                    const auto y0 = std::min(y * 2, src.height - 1);
+                    const auto y1 = std::min(y * 2 + 1, src.height - 1);
+
+                    for (auto c: std::views::iota(0, channels_per_pixel))
+                    {
+                        const auto sum = 
+                                src.texels[(y0 * src.width + x0) * channels_per_pixel + c]
+                            +   src.texels[(y0 * src.width + x1) * channels_per_pixel + c]
+                            +   src.texels[(y1 * src.width + x0) * channels_per_pixel + c]
+                            +   src.texels[(y1 * src.width + x1) * channels_per_pixel + c];
+
+                        dst.texels[(y * dst.width + x) * channels_per_pixel + c] = static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+
+            texture._levels.push_back(std::move(dst));
+        }
+
+        return texture;
+    }
+
+    glm::vec4 Texture::fetch(const Level& level, int32_t x, int32_t y) const
+    {
+        const auto width    = static_cast<int32_t>(level.width);
+        const auto height   = static_cast<int32_t>(level.height);
+
+        x = ((x % width) + width) % width;
+        y = ((y % height) + height) % height;
+
+        const auto ptr_texel = level.texels.data() + (y * width + x) * _channels_per_pixel;
+
+        /// Недостающие каналы заполняются как у VK_FORMAT_R8*_UNORM: g = b = 0, a = 1.
+        glm::vec4 texel (0.0f, 0.0f, 0.0f, 1.0f);
+
+        for (auto c: std::views::iota(0, _channels_per_pixel))
+            texel[c] = static_cast<float>(ptr_texel[c]) / 255.0f;
+
+        return texel;
+    }
+
+    glm::vec4 Texture::sample(const Level& level, const glm::vec2& uv) const
+    {
+        const auto size = glm::vec2(level.width, level.height);
+
+        if (_filter == TextureFilter::nearest)
+        {
+            const auto texel = glm::ivec2(glm::floor(uv * size));
+            return fetch(level, texel.x, texel.y);
+        }
+
+        const auto pos  = uv * size - 0.5f;
+        const auto base = glm::floor(pos);
+        const auto t    = pos - base;
+        const auto x    = static_cast<int32_t>(base.x);
+        const auto y    = static_cast<int32_t>(base.y);
+
+        return glm::mix(
+            glm::mix(fetch(level, x, y),     fetch(level, x + 1, y),     t.x),
+            glm::mix(fetch(level, x, y + 1), fetch(level, x + 1, y + 1), t.x),
+            t.y
+        );
+    }
+
+    glm::vec4 Texture::sampleGrad(const glm::vec2& uv, float uv_footprint) const
+    {
+        if (_levels.empty())
+            return _color;
+
+        const auto& base_level  = _levels.front();
+        const auto  texels      = uv_footprint * static_cast<float>(std::max(base_level.width, base_level.height));
+        const auto  max_lod     = static_cast<float>(_levels.size() - 1);
+        const auto  lod         = std::isfinite(texels) && texels > 0.0f ? std::clamp(std::log2(texels), 0.0f, max_lod) : 0.0f;
+
+        const auto level_0 = static_cast<size_t>(lod);
+        const auto level_1 = std::min(level_0 + 1, _levels.size() - 1);
+
+        return glm::mix(sample(_levels[level_0], uv), sample(_levels[level_1], uv), lod - static_cast<float>(level_0));
+    }
+
+    glm::vec4 Texture::getAverage() const
+    {
+        if (_levels.empty())
+            return _color;
+
+        return fetch(_levels.back(), 0, 0);
+    }
+
+    uint32_t Texture::getWidth() const noexcept
+    {
+        return _levels.empty() ? 1 : _levels.front().width;
+    }
+
+    uint32_t Texture::getHeight() const noexcept
+    {
+        return _levels.empty() ? 1 : _levels.front().height;
+    }
+
+    size_t Texture::getLevelCount() const noexcept
+    {
+        return std::max<size_t>(_levels.size(), 1);
+    }
+}
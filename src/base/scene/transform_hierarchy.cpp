@@ -0,0 +1,100 @@
+#include <base/scene/transform_hierarchy.hpp>
+#include <base/logger/logger.hpp>
+
+#include <ranges>
+
+namespace vrts
+{
+    uint32_t TransformHierarchy::add(uint32_t parent_id, const glm::mat4& local_transform)
+    {
+        const auto id = static_cast<uint32_t>(_parents.size());
+
+        if (parent_id != invalid_id && parent_id >= id)
+            log::error("[TransformHierarchy] Parent {} must be added before child {}", parent_id, id);
+
+        _parents.push_back(parent_id);
+        _local_transforms.push_back(local_transform);
+        _world_transforms.push_back(local_transform);
+        _dirty.push_back(true);
+
+        _first_dirty = std::min(_first_dirty, id);
+
+        return id;
+    }
+
+    void TransformHierarchy::setLocal(uint32_t id, const glm::mat4& local_transform)
+    {
+        _local_transforms.at(id) = local_transform;
+        _dirty[id] = true;
+
+        _first_dirty = std::min(_first_dirty, id);
+    }
+
+    std::span<const uint32_t> TransformHierarchy::update()
+    {
+        _changed_nodes.clear();
+        ++_update_count;
+
+        if (_first_dirty == invalid_id)
+            return _changed_nodes;
+
+        for (auto id: std::views::iota(_first_dirty, static_cast<uint32_t>(_parents.size())))
+        {
+            const auto parent_id = _parents[id];
+
+            if (parent_id != invalid_id && _dirty[parent_id])
+                _dirty[id] = true;
+
+            if (!_dirty[id])
+                continue;
+
+            _world_transforms[id] = parent_id == invalid_id 
+                ? _local_transforms[id] 
+                : _local_transforms[id] * _world_transforms[parent_id];
+
+            _changed_nodes.push_back(id);
+        }
+
+        for (const auto id: _changed_nodes)
+            _dirty[id] = false;
+
+        _first_dirty = invalid_id;
+
+        return _changed_nodes;
+    }
+
+    const glm::mat4& TransformHierarchy::getLocal(uint32_t id) const
+    {
+        return _local_transforms.at(id);
+    }
+
+    const glm::mat4& TransformHierarchy::getWorld(uint32_t id) const
+    {
+        return _world_transforms.at(id);
+    }
+
+    uint32_t TransformHierarchy::getParent(uint32_t id) const
+    {
+        return _parents.at(id);
+    }
+
+    std::span<const uint32_t> TransformHierarchy::getChangedNodes() const noexcept
+    {
+        return _changed_nodes;
+    }
+
+    uint64_t TransformHierarchy::getUpdateCount() const noexcept
+    {
+        return _update_count;
+    }
+
+    size_t TransformHierarchy::size() const noexcept
+    {
+        return _parents.size();
+    }
+
+    bool TransformHierarchy::isDirty() const noexcept
+    {
+        return _first_dirty != invalid_id;
+    }
+}
@@ -0,0 +1,194 @@
+#include <base/scene/two_level_bvh.hpp>
+#include <base/logger/logger.hpp>
+
+#include <array>
+#include <ranges>
+
+namespace vrts
+{
+    uint32_t TwoLevelBVH::addBLAS(BVH&& bvh)
+    {
+        _blases.push_back(std::move(bvh));
+        return static_cast<uint32_t>(_blases.size() - 1);
+    }
+
+    uint32_t TwoLevelBVH::addInstance(uint32_t blas_id, const glm::mat4& object_to_world)
+    {
+        if (blas_id >= _blases.size())
+            log::error("[TwoLevelBVH] Invalid BLAS id: {}", blas_id);
+
+        _instances.push_back(Instance
+        {
+            blas_id,
+            object_to_world,
+            glm::inverse(object_to_world),
+            AABB { }
+        });
+
+        _is_dirty = true;
+
+        return static_cast<uint32_t>(_instances.size() - 1);
+    }
+
+    void TwoLevelBVH::setTransform(uint32_t instance_id, const glm::mat4& object_to_world)
+    {
+        auto& instance = _instances.at(instance_id);
+
+        instance.object_to_world = object_to_world;
+        instance.world_to_object = glm::inverse(object_to_world);
+
+        _is_dirty = true;
+    }
+
+    void TwoLevelBVH::setBLAS(uint32_t instance_id, uint32_t blas_id)
+    {
+        if (blas_id >= _blases.size())
+            log::error("[TwoLevelBVH] Invalid BLAS id: {}", blas_id);
+
+        auto& instance = _instances.at(instance_id);
+
+        if (instance.blas_id == blas_id)
+            return ;
+
+        instance.blas_id = blas_id;
+
+        _is_dirty = true;
+    }
+
+    void TwoLevelBVH::refit(uint32_t blas_id, const MeshData& mesh_data)
+    {
+        _blases.at(blas_id).refit(mesh_data);
+        _is_dirty = true;
+    }
+
+    void TwoLevelBVH::refit(uint32_t blas_id, std::span<const glm::vec3> positions)
+    {
+        _blases.at(blas_id).refit(positions);
+        _is_dirty = true;
+    }
+
+    void TwoLevelBVH::build()
+    {
+        std::vector<AABB> bounds;
+        bounds.reserve(_instances.size());
+
+        for (auto& instance: _instances)
+        {
+            const auto nodes = _blases[instance.blas_id].getNodes();
+
+            instance.bounds = nodes.empty() ? AABB { } : nodes.front().bounds.transform(instance.object_to_world);
+
+            bounds.push_back(instance.bounds);
+        }
+
+        _tlas = BVH::build(bounds);
+
+        _is_dirty = false;
+    }
+
+    template<bool any_hit>
+    std::optional<RayHit> TwoLevelBVH::traverse(const Ray& ray) const
+    {
+        if (_is_dirty)
+            log::error("[TwoLevelBVH] Top level is out of date, call build() after changing instances.");
+
+        if (!_tlas || _tlas->getNodes().empty())
+            return std::nullopt;
+
+        const auto nodes        = _tlas->getNodes();
+        const auto instance_ids = _tlas->getPrimitiveIds();
+
+        const auto inv_dir = 1.0f / ray.dir;
+
+        RayHit hit;
+        hit.t = ray.t_max;
+
+        /// Верхний уровень - тоже BVH, его глубина ограничена BVH::max_depth.
+        std::array<uint32_t, BVH::max_depth> stack;
+        size_t stack_size = 0;
+
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const auto& node = nodes[stack[--stack_size]];
+
+            if (intersectBounds(node.bounds, ray, inv_dir, hit.t) == std::numeric_limits<float>::infinity())
+                continue;
+
+            if (node.count > 0)
+            {
+                for (auto instance_id: instance_ids.subspan(node.first, node.count))
+                {
+                    const auto& instance = _instances[instance_id];
+                    const auto& blas     = _blases[instance.blas_id];
+
+                    /// Направление не нормализуется, поэтому t в пространстве объекта совпадает с мировым.
+                    const Ray local_ray
+                    {
+                        glm::vec3(instance.world_to_object * glm::vec4(ray.origin, 1.0f)),
+                        glm::mat3(instance.world_to_object) * ray.dir,
+                        ray.t_min,
+                        hit.t
+                    };
+
+                    if constexpr (any_hit)
+                    {
+                        if (blas.isOccluded(local_ray))
+                        {
+                            hit.instance_id = instance_id;
+                            return hit;
+                        }
+                    }
+                    else if (const auto local_hit = blas.intersect(local_ray))
+                    {
+                        hit             = *local_hit;
+                        hit.instance_id = instance_id;
+                    }
+                }
+
+                continue;
+            }
+
+            const auto t_left   = intersectBounds(nodes[node.first].bounds, ray, inv_dir, hit.t);
+            const auto t_right  = intersectBounds(nodes[node.first + 1].bounds, ray, inv_dir, hit.t);
+
+            if (t_left <= t_right)
+            {
+                stack[stack_size++] = node.first + 1;
+                stack[stack_size++] = node.first;
+            }
+            else
+            {
+                stack[stack_size++] = node.first;
+                stack[stack_size++] = node.first + 1;
+            }
+        }
+
+        if (hit.instance_id == std::numeric_limits<uint32_t>::max())
+            return std::nullopt;
+
+        return hit;
+    }
+
+    std::optional<RayHit> TwoLevelBVH::intersect(const Ray& ray) const
+    {
+        return traverse<false>(ray);
+    }
+
+    bool TwoLevelBVH::isOccluded(const Ray& ray) const
+    {
+        return traverse<true>(ray).has_value();
+    }
+
+    const BVH& TwoLevelBVH::getBLAS(uint32_t blas_id) const
+    {
+        return _blases.at(blas_id);
+    }
+
+    auto TwoLevelBVH::getInstances() const noexcept
+        -> std::span<const Instance>
+    {
+        return _instances;
+    }
+}
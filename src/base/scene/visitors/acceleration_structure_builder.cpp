@@ -1,21 +1,90 @@
 #include <base/scene/visitors/acceleration_structure_builder.hpp>
 #include <base/scene/node.hpp>
+#include <base/scene/mesh_lod.hpp>
 
 #include <base/vulkan/context.hpp>
 #include <base/vulkan/gpu_marker_colors.hpp>
 
 #include <base/vulkan/buffer.hpp>
 
+#include <base/job_system.hpp>
+
 #include <ranges>
+#include <array>
+#include <algorithm>
+#include <iterator>
 
 namespace vrts
 {
-    ASBuilder::ASBuilder(const Context* ptr_context) :
-        _ptr_context (ptr_context)
+    static constexpr size_t instances_per_job = 256;
+
+    /// ALLOW_UPDATE: при движении узлов TLAS обновляется на месте, см. ASBuilder::updateTLAS().
+    static constexpr VkBuildAccelerationStructureFlagsKHR tlas_build_flags = 
+            VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR 
+        |   VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+
+    static VkAccelerationStructureGeometryKHR getInstancesGeometry(const Buffer& instances_buffer)
+    {
+        VkAccelerationStructureGeometryKHR geometry = { };
+        geometry.sType          = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+        geometry.geometryType   = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+        geometry.flags          = VK_GEOMETRY_OPAQUE_BIT_KHR;
+
+        auto& geometry_instances = geometry.geometry.instances;
+        geometry_instances.sType                = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+        geometry_instances.data.deviceAddress   = instances_buffer.getAddress();
+        geometry_instances.arrayOfPointers      = VK_FALSE;
+
+        return geometry;
+    }
+
+    /// Буфер инстансов host-visible, поэтому при обновлении в него пишутся только изменившиеся записи.
+    template<typename Write>
+    static void writeInstances(const Context* ptr_context, const Buffer& instances_buffer, Write&& write)
+    {
+        VkAccelerationStructureInstanceKHR* ptr_instances = nullptr;
+
+        VK_CHECK(
+            vkMapMemory(
+                ptr_context->device_handle,
+                instances_buffer.memory_handle,
+                0, VK_WHOLE_SIZE,
+                0,
+                reinterpret_cast<void**>(&ptr_instances)
+            )
+        );
+
+        write(ptr_instances);
+
+        /// Память может быть не HOST_COHERENT.
+        const VkMappedMemoryRange memory_range
+        {
+            .sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .memory = instances_buffer.memory_handle,
+            .offset = 0,
+            .size   = VK_WHOLE_SIZE
+        };
+
+        VK_CHECK(vkFlushMappedMemoryRanges(ptr_context->device_handle, 1, &memory_range));
+
+        vkUnmapMemory(ptr_context->device_handle, instances_buffer.memory_handle);
+    }
+
+    ASBuilder::ASBuilder(
+        const Context*              ptr_context, 
+        const TransformHierarchy&   transforms, 
+        std::optional<LodPolicy>    lod_policy
+    ) :
+        _ptr_context    (ptr_context),
+        _ptr_transforms (&transforms),
+        _lod_policy     (lod_policy)
     {
         if (!ptr_context)
             log::error("[ASBuilder]: ptr_context is null.");
 
+        if (transforms.isDirty())
+            log::error("[ASBuilder]: Transform hierarchy is dirty, call Model::updateTransforms() before build.");
+
         auto identity_matrix = VkUtils::cast(glm::mat4(1.0f));
 
         if (auto memory_type_index = MemoryProperties::getMemoryIndex(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
@@ -46,81 +115,113 @@ namespace vrts
         for (auto& child: ptr_node->children)
             child->visit(this);
 
-        const auto tlas_name = std::format("[TLAS] '{}'", ptr_node->name);
+        std::vector<const Node*> instance_nodes;
+        instance_nodes.reserve(ptr_node->children.size());
 
-        const auto func_table = VkUtils::getVulkanFunctionPointerTable();
+        for (const auto& ptr_child: ptr_node->children)
+        {
+            if (ptr_child->acceleation_structure != std::nullopt)
+                instance_nodes.push_back(ptr_child.get());
+        }
 
-        std::vector<VkAccelerationStructureInstanceKHR> instances;
-        instances.reserve(ptr_node->children.size() - 1);
+        const auto first_custom_index = _custom_index;
 
-        VkAccelerationStructureKHR acceleration_structure_handle = VK_NULL_HANDLE;
+        _custom_index += static_cast<uint32_t>(instance_nodes.size());
+
+        if (_custom_index > (1u << mesh_lod::custom_index_lod_shift))
+            log::error("[ASBuilder]: Too many instances, custom index overlaps LOD bits.");
+
+        if (instance_nodes.empty())
+            return ;
+
+        const auto& tlas_instances = ptr_node->tlas_instances;
+
+        /// Обновление на месте требует того же числа инстансов, а gl_InstanceCustomIndexEXT не должны сдвинуться.
+        const auto is_same_instances = 
+                ptr_node->acceleation_structure 
+            &&  tlas_instances 
+            &&  tlas_instances->first_custom_index == first_custom_index 
+            &&  std::ranges::equal(tlas_instances->nodes, instance_nodes);
 
-        auto get_instance = [this, &func_table, ptr_node] (const auto& child)
+        if (is_same_instances)
+            updateTLAS(ptr_node);
+        else
+            buildTLAS(ptr_node, std::move(instance_nodes), first_custom_index);
+    }
+
+    VkAccelerationStructureInstanceKHR ASBuilder::getInstance(const Node* ptr_node, uint32_t custom_index) const
+    {
+        custom_index |= getSelectedLod(ptr_node) << mesh_lod::custom_index_lod_shift;
+
+        const VkAccelerationStructureDeviceAddressInfoKHR address_info
         {
-            const VkAccelerationStructureDeviceAddressInfoKHR address_info
-            {
-                .sType                  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
-                .accelerationStructure  = child->acceleation_structure->vk_handle
-            };
+            .sType                  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
+            .accelerationStructure  = ptr_node->acceleation_structure->vk_handle
+        };
 
-            const VkAccelerationStructureInstanceKHR instance 
-            { 
-                .transform                              = VkUtils::cast(child->transform * ptr_node->transform),
-                .instanceCustomIndex                    = _custom_index++, /// gl_InstanceCustomIndexEXT 
-                .mask                                   = 0xff,
-                .instanceShaderBindingTableRecordOffset = 0,
-                .flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR,
-                .accelerationStructureReference         = func_table.vkGetAccelerationStructureDeviceAddressKHR(_ptr_context->device_handle, &address_info)
-            };
+        const auto func_table = VkUtils::getVulkanFunctionPointerTable();
 
-            return instance;
+        const VkAccelerationStructureInstanceKHR instance 
+        { 
+            .transform                              = VkUtils::cast(_ptr_transforms->getWorld(ptr_node->transform_id)),
+            .instanceCustomIndex                    = custom_index, /// gl_InstanceCustomIndexEXT 
+            .mask                                   = 0xff,
+            .instanceShaderBindingTableRecordOffset = 0,
+            .flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR,
+            .accelerationStructureReference         = func_table.vkGetAccelerationStructureDeviceAddressKHR(_ptr_context->device_handle, &address_info)
         };
 
-        auto is_valid = [] (const auto& child) 
-        {
-            return child->acceleation_structure != std::nullopt;
+        return instance;
+    }
+
+    void ASBuilder::buildTLAS(Node* ptr_node, std::vector<const Node*>&& instance_nodes, uint32_t first_custom_index)
+    {
+        const auto tlas_name = std::format("[TLAS] '{}'", ptr_node->name);
+
+        const auto func_table = VkUtils::getVulkanFunctionPointerTable();
+
+        VkAccelerationStructureKHR acceleration_structure_handle = VK_NULL_HANDLE;
+
+        TlasInstances tlas_instances 
+        { 
+            .nodes                      = std::move(instance_nodes),
+            .first_custom_index         = first_custom_index,
+            .transforms_update_count    = _ptr_transforms->getUpdateCount()
         };
 
-        std::ranges::for_each(
-                ptr_node->children 
-            |   std::views::filter(is_valid) 
-            |   std::views::transform(get_instance), 
-            [&instances](auto instance)
-            {
-                instances.push_back(instance);
-            }
-        );
+        auto& instances = tlas_instances.instances;
+        instances.resize(tlas_instances.nodes.size());
 
-        if (instances.empty())
-            return ;
+        JobSystem::get().parallelFor(0, instances.size(), instances_per_job, [&] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                instances[i] = getInstance(tlas_instances.nodes[i], first_custom_index + static_cast<uint32_t>(i));
+        });
+
+        for (auto i: std::views::iota(0u, static_cast<uint32_t>(tlas_instances.nodes.size())))
+            tlas_instances.instance_ids.emplace(tlas_instances.nodes[i]->transform_id, i);
 
         const auto primitive_count = static_cast<uint32_t>(instances.size());
 
-        auto instances_buffer = Buffer::Builder(_ptr_context)
+        tlas_instances.instances_buffer = Buffer::Builder(_ptr_context)
             .vkSize(sizeof(VkAccelerationStructureInstanceKHR) * instances.size())
-            .vkUsage(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+            .vkUsage(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR)
+            .isHostVisible(true)
             .name(std::format("[TLAS] Instance buffer: {}", ptr_node->name))
             .build();
 
-        Buffer::writeData(instances_buffer, std::span(instances));
-
-        VkAccelerationStructureGeometryKHR geometry = { };
-        geometry.sType          = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
-        geometry.geometryType   = VK_GEOMETRY_TYPE_INSTANCES_KHR;
-        geometry.flags          = VK_GEOMETRY_OPAQUE_BIT_KHR;
-
+        writeInstances(_ptr_context, *tlas_instances.instances_buffer, [&instances] (VkAccelerationStructureInstanceKHR* ptr_instances)
         {
-            auto& geometry_instances = geometry.geometry.instances;
-            geometry_instances.sType                = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
-            geometry_instances.data.deviceAddress   = instances_buffer.getAddress();
-            geometry_instances.arrayOfPointers      = VK_FALSE;
-        }
+            std::ranges::copy(instances, ptr_instances);
+        });
+
+        auto geometry = getInstancesGeometry(*tlas_instances.instances_buffer);
 
         VkAccelerationStructureBuildGeometryInfoKHR geometry_build_info 
         { 
             .sType          = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
             .type           = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
-            .flags          = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
+            .flags          = tlas_build_flags,
             .mode           = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
             .geometryCount  = 1,
             .pGeometries    = &geometry,
@@ -169,13 +270,14 @@ namespace vrts
             tlas_name
         );
 
-        auto scratch_buffer = Buffer::Builder(_ptr_context)
-            .vkSize(tlas_size.buildScratchSize)
+        /// Scratch-буфер остаётся у узла для последующих обновлений.
+        tlas_instances.scratch_buffer = Buffer::Builder(_ptr_context)
+            .vkSize(std::max(tlas_size.buildScratchSize, tlas_size.updateScratchSize))
             .vkUsage(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
             .name(std::format("[TLAS] Scratch buffer: {}", ptr_node->name))
             .build();
 
-        geometry_build_info.scratchData.deviceAddress   = scratch_buffer.getAddress();
+        geometry_build_info.scratchData.deviceAddress   = tlas_instances.scratch_buffer->getAddress();
         geometry_build_info.dstAccelerationStructure    = acceleration_structure_handle;
 
         auto command_buffer_for_build = VkUtils::getCommandBuffer(_ptr_context);
@@ -199,27 +301,179 @@ namespace vrts
         command_buffer_for_build.upload(_ptr_context);
 
         ptr_node->acceleation_structure = std::make_optional<AccelerationStructure>(_ptr_context, acceleration_structure_handle, std::move(tlas_buffer));
+        ptr_node->tlas_instances        = std::move(tlas_instances);
+    }
+
+    void ASBuilder::updateTLAS(Node* ptr_node)
+    {
+        auto& tlas_instances = *ptr_node->tlas_instances;
+
+        std::vector<uint32_t> instance_ids;
+
+        auto add_instance = [&tlas_instances, &instance_ids] (uint32_t transform_id)
+        {
+            if (const auto it = tlas_instances.instance_ids.find(transform_id); it != tlas_instances.instance_ids.end())
+                instance_ids.push_back(it->second);
+        };
+
+        const auto update_count = _ptr_transforms->getUpdateCount();
+
+        /// Список изменившихся узлов описывает только последний update(). Если их было несколько, переписываются все инстансы.
+        if (update_count == tlas_instances.transforms_update_count + 1)
+            std::ranges::for_each(_ptr_transforms->getChangedNodes(), add_instance);
+        else if (update_count != tlas_instances.transforms_update_count)
+            std::ranges::copy(std::views::iota(0u, static_cast<uint32_t>(tlas_instances.nodes.size())), std::back_inserter(instance_ids));
+
+        for (const auto ptr_rebuilt_node: _rebuilt_blas_nodes)
+            add_instance(ptr_rebuilt_node->transform_id);
+
+        tlas_instances.transforms_update_count = update_count;
+
+        if (instance_ids.empty())
+            return ;
+
+        std::ranges::sort(instance_ids);
+        instance_ids.erase(std::ranges::unique(instance_ids).begin(), instance_ids.end());
+
+        JobSystem::get().parallelFor(0, instance_ids.size(), instances_per_job, [&] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+            {
+                const auto id = instance_ids[i];
+                tlas_instances.instances[id] = getInstance(tlas_instances.nodes[id], tlas_instances.first_custom_index + id);
+            }
+        });
+
+        writeInstances(_ptr_context, *tlas_instances.instances_buffer, [&tlas_instances, &instance_ids] (VkAccelerationStructureInstanceKHR* ptr_instances)
+        {
+            for (const auto id: instance_ids)
+                ptr_instances[id] = tlas_instances.instances[id];
+        });
+
+        const auto func_table = VkUtils::getVulkanFunctionPointerTable();
+
+        const auto geometry         = getInstancesGeometry(*tlas_instances.instances_buffer);
+        const auto primitive_count  = static_cast<uint32_t>(tlas_instances.instances.size());
+        const auto tlas_handle      = ptr_node->acceleation_structure->vk_handle;
+
+        const VkAccelerationStructureBuildGeometryInfoKHR geometry_update_info 
+        { 
+            .sType                      = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+            .type                       = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+            .flags                      = tlas_build_flags,
+            .mode                       = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR,
+            .srcAccelerationStructure   = tlas_handle,
+            .dstAccelerationStructure   = tlas_handle,
+            .geometryCount              = 1,
+            .pGeometries                = &geometry,
+            .scratchData                = { .deviceAddress = tlas_instances.scratch_buffer->getAddress() }
+        };
+
+        auto command_buffer_for_update = VkUtils::getCommandBuffer(_ptr_context);
+
+        command_buffer_for_update.write([primitive_count, &func_table, &geometry_update_info] (VkCommandBuffer vk_handle)
+        {
+            /// TLAS обновляется на месте, а трассировка предыдущего кадра могла ещё его читать.
+            const VkMemoryBarrier trace_barrier
+            {
+                .sType          = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask  = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+                .dstAccessMask  = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR
+            };
+
+            vkCmdPipelineBarrier(
+                vk_handle,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0,
+                1, &trace_barrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            const VkAccelerationStructureBuildRangeInfoKHR build_range 
+            { 
+                .primitiveCount = primitive_count
+            };
+            
+            auto ptr_build_range = &build_range;
+
+            func_table.vkCmdBuildAccelerationStructuresKHR(
+                vk_handle, 
+                1, &geometry_update_info,
+                &ptr_build_range
+            );
+        }, std::format("Update TLAS: {}", ptr_node->name), GpuMarkerColors::build_tlas);
+
+        command_buffer_for_update.upload(_ptr_context);
+    }
+
+    uint32_t ASBuilder::getSelectedLod(const Node* ptr_node) const noexcept
+    {
+        const auto lod = _selected_lods.find(ptr_node);
+        return lod != _selected_lods.end() ? lod->second : 0;
+    }
+
+    uint32_t ASBuilder::selectLod(const MeshNode* ptr_node) const
+    {
+        const auto& mesh = ptr_node->mesh;
+
+        if (!_lod_policy || mesh.lods.empty())
+            return 0;
+
+        const auto object_to_world = glm::transpose(_ptr_transforms->getWorld(ptr_node->transform_id));
+
+        const auto scale = std::max({
+            glm::length(glm::vec3(object_to_world[0])),
+            glm::length(glm::vec3(object_to_world[1])),
+            glm::length(glm::vec3(object_to_world[2]))
+        });
+
+        const auto center   = glm::vec3(object_to_world * glm::vec4(glm::vec3(mesh.bounding_sphere), 1.0f));
+        const auto distance = std::max(glm::distance(center, _lod_policy->eye) - mesh.bounding_sphere.w * scale, 0.0f);
+
+        std::array<float, mesh_lod::max_lod_count - 1> errors;
+
+        for (auto i: std::views::iota(0u, mesh.lods.size()))
+            errors[i] = mesh.lods[i].error * scale;
+
+        return mesh_lod::select(std::span(errors).first(mesh.lods.size()), distance, _lod_policy->max_angular_error);
     }
 
     void ASBuilder::process(MeshNode* ptr_node)
     {
+        const auto lod = selectLod(ptr_node);
+
+        _selected_lods[ptr_node] = lod;
+
+        if (ptr_node->acceleation_structure && ptr_node->lod == lod)
+            return ;
+
+        ptr_node->lod = lod;
+        _rebuilt_blas_nodes.push_back(ptr_node);
+
+        const auto& index_buffer    = lod == 0 ? ptr_node->mesh.index_buffer    : ptr_node->mesh.lods[lod - 1].index_buffer;
+        const auto  index_count     = lod == 0 ? ptr_node->mesh.index_count     : ptr_node->mesh.lods[lod - 1].index_count;
+
         ptr_node->acceleation_structure = buildBLAS(
             ptr_node->name, 
             *ptr_node->mesh.vertex_buffer,
             static_cast<uint32_t>(ptr_node->mesh.vertex_count),
-            *ptr_node->mesh.index_buffer,
-            static_cast<uint32_t>(ptr_node->mesh.index_count)
+            *index_buffer,
+            static_cast<uint32_t>(index_count),
+            ptr_node->mesh.index_type
         );
     }
     
     void ASBuilder::process(SkinnedMeshNode* ptr_node)
     {
+        _rebuilt_blas_nodes.push_back(ptr_node);
+
         ptr_node->acceleation_structure = buildBLAS(
             ptr_node->name, 
             *ptr_node->mesh.processed_vertex_buffer,
             static_cast<uint32_t>(ptr_node->mesh.vertex_count),
             *ptr_node->mesh.index_buffer,
-            static_cast<uint32_t>(ptr_node->mesh.index_count)
+            static_cast<uint32_t>(ptr_node->mesh.index_count),
+            ptr_node->mesh.index_type
         );
     }
 
@@ -228,7 +482,8 @@ namespace vrts
         const Buffer&       vertex_buffer,
         uint32_t            vertex_count,
         const Buffer&       index_buffer,
-        uint32_t            index_count
+        uint32_t            index_count,
+        VkIndexType         index_type
     )
     {
         VkAccelerationStructureGeometryKHR mesh_info 
@@ -248,7 +503,7 @@ namespace vrts
                 .vertexData     = { .deviceAddress = vertex_buffer.getAddress() },
                 .vertexStride   = sizeof(Attributes),
                 .maxVertex      = vertex_count,
-                .indexType      = VK_INDEX_TYPE_UINT32,
+                .indexType      = index_type,
                 .indexData      = { .deviceAddress = index_buffer.getAddress() },
                 .transformData  = { .deviceAddress = _identity_matrix->getAddress() }
             };
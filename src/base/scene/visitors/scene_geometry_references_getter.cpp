@@ -1,5 +1,8 @@
 #include <base/scene/visitors/scene_geometry_references_getter.hpp>
 #include <base/scene/node.hpp>
+#include <base/scene/mesh_lod.hpp>
+
+#include <ranges>
 
 namespace vrts
 {
@@ -21,8 +24,16 @@ namespace vrts
 
     void SceneGeometryReferencesGetter::process(MeshNode* ptr_node)
     {
-        _vertex_buffers_references.push_back(ptr_node->mesh.vertex_buffer->getAddress());
-        _index_buffers_references.push_back(ptr_node->mesh.index_buffer->getAddress());
+        const auto& mesh = ptr_node->mesh;
+
+        _vertex_buffers_references.push_back(mesh.vertex_buffer->getAddress());
+        _index_buffers_references.push_back({mesh.index_buffer->getAddress(), mesh.index_type});
+
+        for (auto lod: std::views::iota(1u, mesh_lod::max_lod_count))
+        {
+            const auto& index_buffer = lod <= mesh.lods.size() ? mesh.lods[lod - 1].index_buffer : mesh.index_buffer;
+            _index_buffers_references.push_back({index_buffer->getAddress(), mesh.index_type});
+        }
 
         process(static_cast<Node*>(ptr_node));
     }
@@ -30,7 +41,12 @@ namespace vrts
     void SceneGeometryReferencesGetter::process(SkinnedMeshNode* ptr_node)
     {
         _vertex_buffers_references.push_back(ptr_node->mesh.processed_vertex_buffer->getAddress());
-        _index_buffers_references.push_back(ptr_node->mesh.index_buffer->getAddress());
+
+        _index_buffers_references.insert(
+            _index_buffers_references.end(), 
+            mesh_lod::max_lod_count, 
+            {ptr_node->mesh.index_buffer->getAddress(), ptr_node->mesh.index_type}
+        );
 
         process(static_cast<Node*>(ptr_node));
     }
@@ -40,13 +56,14 @@ namespace vrts
         return _vertex_buffers_references.size();
     }
 
-    Buffer SceneGeometryReferencesGetter::createBuffer(const std::vector<VkDeviceAddress>& references, const std::string_view name) const
+    template<typename T>
+    Buffer SceneGeometryReferencesGetter::createBuffer(const std::vector<T>& references, const std::string_view name) const
     {
         if (references.empty())
             log::error("[SceneGeometryReferencesGetter]: Not references.");
 
         auto references_buffer = Buffer::Builder(_ptr_context)
-            .vkSize(references.size() * sizeof(VkDeviceAddress))
+            .vkSize(references.size() * sizeof(T))
             .vkUsage(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
             .name(name)
             .build();
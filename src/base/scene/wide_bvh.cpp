@@ -0,0 +1,550 @@
+#include <base/scene/wide_bvh.hpp>
+#include <base/logger/logger.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <tuple>
+#include <ranges>
+
+namespace vrts
+{
+    template<uint32_t width>
+    struct SimdRay
+    {
+        using Float = simd::Float<width>;
+
+        explicit SimdRay(const Ray& ray) :
+            origin_x    (Float::broadcast(ray.origin.x)),
+            origin_y    (Float::broadcast(ray.origin.y)),
+            origin_z    (Float::broadcast(ray.origin.z)),
+            dir_x       (Float::broadcast(ray.dir.x)),
+            dir_y       (Float::broadcast(ray.dir.y)),
+            dir_z       (Float::broadcast(ray.dir.z)),
+            inv_dir_x   (Float::broadcast(1.0f / ray.dir.x)),
+            inv_dir_y   (Float::broadcast(1.0f / ray.dir.y)),
+            inv_dir_z   (Float::broadcast(1.0f / ray.dir.z)),
+            t_min       (Float::broadcast(ray.t_min))
+        { }
+
+        Float origin_x, origin_y, origin_z;
+        Float dir_x, dir_y, dir_z;
+        Float inv_dir_x, inv_dir_y, inv_dir_z;
+        Float t_min;
+    };
+
+    template<uint32_t width>
+    static bool intersectBlock(const SimdRay<width>& ray, const typename WideBVH<width>::TriangleBlock& block, RayHit& hit)
+    {
+        using Float = simd::Float<width>;
+
+        const auto zero = Float::broadcast(0.0f);
+        const auto one  = Float::broadcast(1.0f);
+
+        const auto edge_1_x = Float::load(block.edge_1[0].data());
+        const auto edge_1_y = Float::load(block.edge_1[1].data());
+        const auto edge_1_z = Float::load(block.edge_1[2].data());
+        const auto edge_2_x = Float::load(block.edge_2[0].data());
+        const auto edge_2_y = Float::load(block.edge_2[1].data());
+        const auto edge_2_z = Float::load(block.edge_2[2].data());
+
+        const auto p_x = ray.dir_y * edge_2_z - ray.dir_z * edge_2_y;
+        const auto p_y = ray.dir_z * edge_2_x - ray.dir_x * edge_2_z;
+        const auto p_z = ray.dir_x * edge_2_y - ray.dir_y * edge_2_x;
+
+        const auto det = edge_1_x * p_x + edge_1_y * p_y + edge_1_z * p_z;
+
+        auto valid = abs(det) >= Float::broadcast(std::numeric_limits<float>::min());
+
+        const auto inv_det = one / det;
+
+        const auto t_x = ray.origin_x - Float::load(block.p0[0].data());
+        const auto t_y = ray.origin_y - Float::load(block.p0[1].data());
+        const auto t_z = ray.origin_z - Float::load(block.p0[2].data());
+
+        const auto u = (t_x * p_x + t_y * p_y + t_z * p_z) * inv_det;
+        valid = valid & (u >= zero) & (u <= one);
+
+        const auto q_x = t_y * edge_1_z - t_z * edge_1_y;
+        const auto q_y = t_z * edge_1_x - t_x * edge_1_z;
+        const auto q_z = t_x * edge_1_y - t_y * edge_1_x;
+
+        const auto v = (ray.dir_x * q_x + ray.dir_y * q_y + ray.dir_z * q_z) * inv_det;
+        valid = valid & (v >= zero) & (u + v <= one);
+
+        const auto t = (edge_2_x * q_x + edge_2_y * q_y + edge_2_z * q_z) * inv_det;
+        valid = valid & (t >= ray.t_min) & (t < Float::broadcast(hit.t));
+
+        auto mask = movemask(valid);
+
+        if (!mask)
+            return false;
+
+        std::array<float, width> ts;
+        std::array<float, width> us;
+        std::array<float, width> vs;
+
+        t.store(ts.data());
+        u.store(us.data());
+        v.store(vs.data());
+
+        while (mask)
+        {
+            const auto lane = static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+
+            if (ts[lane] < hit.t)
+            {
+                hit.t               = ts[lane];
+                hit.barycentric     = glm::vec2(us[lane], vs[lane]);
+                hit.primitive_id    = block.primitive_ids[lane];
+            }
+        }
+
+        return true;
+    }
+}
+
+namespace vrts
+{
+    template<uint32_t width>
+    WideBVH<width> WideBVH<width>::collapse(const BVH& bvh)
+    {
+        WideBVH wide_bvh;
+
+        if (!bvh.getNodes().empty())
+            std::ignore = wide_bvh.collapse(bvh, 0);
+
+        return wide_bvh;
+    }
+
+    template<uint32_t width>
+    uint32_t WideBVH<width>::addLeaf(const BVH& bvh, const BVH::Node& node)
+    {
+        const auto positions        = bvh.getPositions();
+        const auto primitive_ids    = bvh.getPrimitiveIds();
+
+        const auto first_block = static_cast<uint32_t>(_blocks.size());
+
+        for (auto first = node.first; first < node.first + node.count; first += width)
+        {
+            auto& block = _blocks.emplace_back();
+
+            for (auto lane: std::views::iota(0u, width))
+            {
+                const auto triangle_id = first + lane;
+
+                if (triangle_id >= node.first + node.count)
+                {
+                    for (auto axis: std::views::iota(0, 3))
+                    {
+                        block.p0[axis][lane]        = 0.0f;
+                        block.edge_1[axis][lane]    = 0.0f;
+                        block.edge_2[axis][lane]    = 0.0f;
+                    }
+
+                    block.primitive_ids[lane] = invalid_id;
+                    continue;
+                }
+
+                const auto& p0 = positions[triangle_id * 3];
+                const auto  e1 = positions[triangle_id * 3 + 1] - p0;
+                const auto  e2 = positions[triangle_id * 3 + 2] - p0;
+
+                for (auto axis: std::views::iota(0, 3))
+                {
+                    block.p0[axis][lane]        = p0[axis];
+                    block.edge_1[axis][lane]    = e1[axis];
+                    block.edge_2[axis][lane]    = e2[axis];
+                }
+
+                block.primitive_ids[lane] = primitive_ids[triangle_id];
+            }
+        }
+
+        return first_block;
+    }
+
+    template<uint32_t width>
+    uint32_t WideBVH<width>::collapse(const BVH& bvh, uint32_t node_id)
+    {
+        const auto nodes = bvh.getNodes();
+
+        const auto wide_node_id = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+
+        std::array<uint32_t, width> slots;
+        uint32_t                    slot_count = 0;
+
+        if (nodes[node_id].count > 0)
+            slots[slot_count++] = node_id;
+        else
+        {
+            slots[slot_count++] = nodes[node_id].first;
+            slots[slot_count++] = nodes[node_id].first + 1;
+
+            while (slot_count < width)
+            {
+                auto best_slot  = slot_count;
+                auto best_area  = -1.0f;
+
+                for (auto i: std::views::iota(0u, slot_count))
+                {
+                    const auto& child = nodes[slots[i]];
+
+                    if (child.count == 0 && child.bounds.getSurfaceArea() > best_area)
+                    {
+                        best_slot = i;
+                        best_area = child.bounds.getSurfaceArea();
+                    }
+                }
+
+                if (best_slot == slot_count)
+                    break;
+
+                const auto first = nodes[slots[best_slot]].first;
+
+                slots[best_slot]        = first;
+                slots[slot_count++]     = first + 1;
+            }
+        }
+
+        std::array<uint32_t, width> children;
+        std::array<uint32_t, width> block_counts;
+
+        children.fill(invalid_id);
+        block_counts.fill(0);
+
+        for (auto i: std::views::iota(0u, slot_count))
+        {
+            const auto& child = nodes[slots[i]];
+
+            if (child.count > 0)
+            {
+                children[i]     = leaf_flag | addLeaf(bvh, child);
+                block_counts[i] = (child.count + width - 1) / width;
+            }
+            else
+                children[i] = collapse(bvh, slots[i]);
+        }
+
+        /// Ссылку берём только после рекурсии: _nodes мог перевыделиться.
+        auto& node = _nodes[wide_node_id];
+
+        node.children       = children;
+        node.block_counts   = block_counts;
+        node.child_count    = slot_count;
+
+        for (auto i: std::views::iota(0u, width))
+        {
+            const auto bounds = i < slot_count ? nodes[slots[i]].bounds : AABB { glm::vec3(0.0f), glm::vec3(0.0f) };
+
+            node.min_x[i] = bounds.min.x;
+            node.min_y[i] = bounds.min.y;
+            node.min_z[i] = bounds.min.z;
+            node.max_x[i] = bounds.max.x;
+            node.max_y[i] = bounds.max.y;
+            node.max_z[i] = bounds.max.z;
+        }
+
+        return wide_node_id;
+    }
+}
+
+namespace vrts
+{
+    template<uint32_t width>
+    template<bool any_hit>
+    std::optional<RayHit> WideBVH<width>::traverse(const Ray& ray) const
+    {
+        using Float = simd::Float<width>;
+
+        if (_nodes.empty())
+            return std::nullopt;
+
+        const SimdRay<width> simd_ray (ray);
+
+        RayHit hit;
+        hit.t = ray.t_max;
+
+        struct StackEntry
+        {
+            uint32_t    node_id;
+            float       t_near;
+        };
+
+        std::array<StackEntry, max_stack_size> stack;
+        size_t stack_size = 0;
+
+        stack[stack_size++] = StackEntry {0, ray.t_min};
+
+        while (stack_size > 0)
+        {
+            const auto entry = stack[--stack_size];
+
+            if (entry.t_near > hit.t)
+                continue;
+
+            const auto& node = _nodes[entry.node_id];
+
+            const auto t_x0 = (Float::load(node.min_x.data()) - simd_ray.origin_x) * simd_ray.inv_dir_x;
+            const auto t_x1 = (Float::load(node.max_x.data()) - simd_ray.origin_x) * simd_ray.inv_dir_x;
+            const auto t_y0 = (Float::load(node.min_y.data()) - simd_ray.origin_y) * simd_ray.inv_dir_y;
+            const auto t_y1 = (Float::load(node.max_y.data()) - simd_ray.origin_y) * simd_ray.inv_dir_y;
+            const auto t_z0 = (Float::load(node.min_z.data()) - simd_ray.origin_z) * simd_ray.inv_dir_z;
+            const auto t_z1 = (Float::load(node.max_z.data()) - simd_ray.origin_z) * simd_ray.inv_dir_z;
+
+            const auto t_near   = max(max(min(t_x0, t_x1), min(t_y0, t_y1)), max(min(t_z0, t_z1), simd_ray.t_min));
+            const auto t_far    = min(min(max(t_x0, t_x1), max(t_y0, t_y1)), min(max(t_z0, t_z1), Float::broadcast(hit.t)));
+
+            auto mask = movemask(t_near <= t_far) & ((1u << node.child_count) - 1);
+
+            if (!mask)
+                continue;
+
+            std::array<float, width> distances;
+            t_near.store(distances.data());
+
+            std::array<uint32_t, width> interior_slots;
+            uint32_t                    interior_count = 0;
+
+            while (mask)
+            {
+                const auto slot = static_cast<uint32_t>(std::countr_zero(mask));
+                mask &= mask - 1;
+
+                const auto child = node.children[slot];
+
+                if (!(child & leaf_flag))
+                {
+                    interior_slots[interior_count++] = slot;
+                    continue;
+                }
+
+                const auto first_block = child & ~leaf_flag;
+
+                for (auto block_id: std::views::iota(first_block, first_block + node.block_counts[slot]))
+                {
+                    if (intersectBlock<width>(simd_ray, _blocks[block_id], hit) && any_hit)
+                        return hit;
+                }
+            }
+
+            std::sort(std::begin(interior_slots), std::begin(interior_slots) + interior_count, [&distances] (uint32_t lhs, uint32_t rhs)
+            {
+                return distances[lhs] > distances[rhs];
+            });
+
+            for (auto slot: std::span(interior_slots).first(interior_count))
+                stack[stack_size++] = StackEntry {node.children[slot], distances[slot]};
+        }
+
+        if (hit.primitive_id == std::numeric_limits<uint32_t>::max())
+            return std::nullopt;
+
+        return hit;
+    }
+
+    template<uint32_t width>
+    std::optional<RayHit> WideBVH<width>::intersect(const Ray& ray) const
+    {
+        return traverse<false>(ray);
+    }
+
+    template<uint32_t width>
+    bool WideBVH<width>::isOccluded(const Ray& ray) const
+    {
+        return traverse<true>(ray).has_value();
+    }
+
+    template<uint32_t width>
+    void WideBVH<width>::intersect(std::span<const Ray> rays, std::span<std::optional<RayHit>> hits) const
+    {
+        if (rays.size() != hits.size())
+            log::error("[WideBVH] Ray count {} doesn't match hit count {}.", rays.size(), hits.size());
+
+        for (size_t first = 0; first < rays.size(); first += width)
+        {
+            const auto count = std::min<size_t>(width, rays.size() - first);
+            intersectPacket(rays.subspan(first, count), hits.subspan(first, count));
+        }
+    }
+
+    template<uint32_t width>
+    void WideBVH<width>::intersectPacket(std::span<const Ray> rays, std::span<std::optional<RayHit>> hits) const
+    {
+        using Float = simd::Float<width>;
+
+        std::ranges::fill(hits, std::nullopt);
+
+        if (_nodes.empty())
+            return ;
+
+        std::array<std::array<float, width>, 3> origins;
+        std::array<std::array<float, width>, 3> dirs;
+        std::array<float, width>                t_mins;
+        std::array<float, width>                t_maxs;
+        std::array<uint32_t, width>             primitive_ids;
+
+        primitive_ids.fill(invalid_id);
+
+        for (auto lane: std::views::iota(0u, width))
+        {
+            const auto ray = lane < rays.size() ? rays[lane] : Ray {glm::vec3(0.0f), glm::vec3(1.0f), 0.0f, -std::numeric_limits<float>::infinity()};
+
+            for (auto axis: std::views::iota(0, 3))
+            {
+                origins[axis][lane] = ray.origin[axis];
+                dirs[axis][lane]    = ray.dir[axis];
+            }
+
+            t_mins[lane] = ray.t_min;
+            t_maxs[lane] = ray.t_max;
+        }
+
+        const auto zero = Float::broadcast(0.0f);
+        const auto one  = Float::broadcast(1.0f);
+
+        const auto origin_x = Float::load(origins[0].data());
+        const auto origin_y = Float::load(origins[1].data());
+        const auto origin_z = Float::load(origins[2].data());
+        const auto dir_x    = Float::load(dirs[0].data());
+        const auto dir_y    = Float::load(dirs[1].data());
+        const auto dir_z    = Float::load(dirs[2].data());
+        const auto t_min    = Float::load(t_mins.data());
+
+        const auto inv_dir_x = one / dir_x;
+        const auto inv_dir_y = one / dir_y;
+        const auto inv_dir_z = one / dir_z;
+
+        auto t_max  = Float::load(t_maxs.data());
+        auto u_hit  = zero;
+        auto v_hit  = zero;
+
+        std::array<uint32_t, max_stack_size> stack;
+        size_t stack_size = 0;
+
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const auto& node = _nodes[stack[--stack_size]];
+
+            for (auto slot: std::views::iota(0u, node.child_count))
+            {
+                const auto t_x0 = (Float::broadcast(node.min_x[slot]) - origin_x) * inv_dir_x;
+                const auto t_x1 = (Float::broadcast(node.max_x[slot]) - origin_x) * inv_dir_x;
+                const auto t_y0 = (Float::broadcast(node.min_y[slot]) - origin_y) * inv_dir_y;
+                const auto t_y1 = (Float::broadcast(node.max_y[slot]) - origin_y) * inv_dir_y;
+                const auto t_z0 = (Float::broadcast(node.min_z[slot]) - origin_z) * inv_dir_z;
+                const auto t_z1 = (Float::broadcast(node.max_z[slot]) - origin_z) * inv_dir_z;
+
+                const auto t_near   = max(max(min(t_x0, t_x1), min(t_y0, t_y1)), max(min(t_z0, t_z1), t_min));
+                const auto t_far    = min(min(max(t_x0, t_x1), max(t_y0, t_y1)), min(max(t_z0, t_z1), t_max));
+
+                if (!movemask(t_near <= t_far))
+                    continue;
+
+                const auto child = node.children[slot];
+
+                if (!(child & leaf_flag))
+                {
+                    stack[stack_size++] = child;
+                    continue;
+                }
+
+                const auto first_block = child & ~leaf_flag;
+
+                for (const auto& block: std::span(_blocks).subspan(first_block, node.block_counts[slot]))
+                {
+                    for (auto triangle: std::views::iota(0u, width))
+                    {
+                        if (block.primitive_ids[triangle] == invalid_id)
+                            break;
+
+                        const auto edge_1_x = Float::broadcast(block.edge_1[0][triangle]);
+                        const auto edge_1_y = Float::broadcast(block.edge_1[1][triangle]);
+                        const auto edge_1_z = Float::broadcast(block.edge_1[2][triangle]);
+                        const auto edge_2_x = Float::broadcast(block.edge_2[0][triangle]);
+                        const auto edge_2_y = Float::broadcast(block.edge_2[1][triangle]);
+                        const auto edge_2_z = Float::broadcast(block.edge_2[2][triangle]);
+
+                        const auto p_x = dir_y * edge_2_z - dir_z * edge_2_y;
+                        const auto p_y = dir_z * edge_2_x - dir_x * edge_2_z;
+                        const auto p_z = dir_x * edge_2_y - dir_y * edge_2_x;
+
+                        const auto det = edge_1_x * p_x + edge_1_y * p_y + edge_1_z * p_z;
+
+                        auto valid = abs(det) >= Float::broadcast(std::numeric_limits<float>::min());
+
+                        const auto inv_det = one / det;
+
+                        const auto t_x = origin_x - Float::broadcast(block.p0[0][triangle]);
+                        const auto t_y = origin_y - Float::broadcast(block.p0[1][triangle]);
+                        const auto t_z = origin_z - Float::broadcast(block.p0[2][triangle]);
+
+                        const auto u = (t_x * p_x + t_y * p_y + t_z * p_z) * inv_det;
+                        valid = valid & (u >= zero) & (u <= one);
+
+                        const auto q_x = t_y * edge_1_z - t_z * edge_1_y;
+                        const auto q_y = t_z * edge_1_x - t_x * edge_1_z;
+                        const auto q_z = t_x * edge_1_y - t_y * edge_1_x;
+
+                        const auto v = (dir_x * q_x + dir_y * q_y + dir_z * q_z) * inv_det;
+                        valid = valid & (v >= zero) & (u + v <= one);
+
+                        const auto t = (edge_2_x * q_x + edge_2_y * q_y + edge_2_z * q_z) * inv_det;
+                        valid = valid & (t >= t_min) & (t < t_max);
+
+                        auto mask = movemask(valid);
+
+                        if (!mask)
+                            continue;
+
+                        t_max = select(valid, t, t_max);
+                        u_hit = select(valid, u, u_hit);
+                        v_hit = select(valid, v, v_hit);
+
+                        while (mask)
+                        {
+                            primitive_ids[std::countr_zero(mask)] = block.primitive_ids[triangle];
+                            mask &= mask - 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::array<float, width> us;
+        std::array<float, width> vs;
+
+        t_max.store(t_maxs.data());
+        u_hit.store(us.data());
+        v_hit.store(vs.data());
+
+        for (auto lane: std::views::iota(0u, static_cast<uint32_t>(rays.size())))
+        {
+            if (primitive_ids[lane] != invalid_id)
+                hits[lane] = RayHit {t_maxs[lane], glm::vec2(us[lane], vs[lane]), primitive_ids[lane]};
+        }
+    }
+
+    template<uint32_t width>
+    auto WideBVH<width>::getNodes() const noexcept
+        -> std::span<const Node>
+    {
+        return _nodes;
+    }
+
+    template<uint32_t width>
+    auto WideBVH<width>::getBlocks() const noexcept
+        -> std::span<const TriangleBlock>
+    {
+        return _blocks;
+    }
+
+    template class WideBVH<4>;
+
+#if defined(__AVX2__) || defined(__AVX__)
+    template class WideBVH<8>;
+#endif
+}
@@ -0,0 +1,145 @@
+#include <base/sobol.hpp>
+
+#include <ranges>
+#include <span>
+
+namespace vrts::sobol
+{
+    /// Примитивный многочлен степени s с коэффициентами a и начальные числа m (new-joe-kuo-6.21201).
+    struct Polynomial
+    {
+        uint32_t                s;
+        uint32_t                a;
+        std::array<uint32_t, 3> m;
+    };
+
+    static Directions createDirections() noexcept
+    {
+        constexpr std::array<Polynomial, dimension_count - 1> polynomials
+        {
+            Polynomial { 1, 0, {1, 0, 0} },
+            Polynomial { 2, 1, {1, 3, 0} },
+            Polynomial { 3, 1, {1, 3, 1} }
+        };
+
+        Directions directions = { };
+
+        for (auto bit: std::views::iota(0u, bit_count))
+            directions[bit] = 1u << (bit_count - 1 - bit);
+
+        for (auto dimension: std::views::iota(1u, dimension_count))
+        {
+            const auto& [s, a, m] = polynomials[dimension - 1];
+
+            auto v = std::span(directions).subspan(dimension * bit_count, bit_count);
+
+            for (auto bit: std::views::iota(0u, s))
+                v[bit] = m[bit] << (bit_count - 1 - bit);
+
+            for (auto bit: std::views::iota(s, bit_count))
+            {
+                v[bit] = v[bit - s] ^ (v[bit - s] >> s);
+
+                for (auto k: std::views::iota(1u, s))
+                    v[bit] ^= ((a >> (s - 1 - k)) & 1u) * v[bit - k];
+            }
+        }
+
+        return directions;
+    }
+
+    static uint32_t reverseBits(uint32_t x) noexcept
+    {
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+        x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+
+        return (x >> 16) | (x << 16);
+    }
+
+    /// 24 старших бита, чтобы результат не округлялся до 1.
+    static float toFloat(uint32_t x) noexcept
+    {
+        return static_cast<float>(x >> 8) * (1.0f / static_cast<float>(1u << 24));
+    }
+}
+
+namespace vrts::sobol
+{
+    const Directions& getDirections() noexcept
+    {
+        static const auto directions = createDirections();
+        return directions;
+    }
+
+    uint32_t sample(uint32_t index, uint32_t dimension) noexcept
+    {
+        const auto& directions = getDirections();
+
+        uint32_t result = 0;
+
+        for (auto bit = 0u; index; ++bit, index >>= 1)
+        {
+            if (index & 1u)
+                result ^= directions[dimension * bit_count + bit];
+        }
+
+        return result;
+    }
+
+    uint32_t hash(uint32_t x) noexcept
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+
+        return x;
+    }
+
+    uint32_t hashCombine(uint32_t seed, uint32_t value) noexcept
+    {
+        return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+    }
+
+    uint32_t nestedUniformScramble(uint32_t x, uint32_t seed) noexcept
+    {
+        /// Перестановка Laine-Karras: каждый бит зависит только от младших, после разворота - от старших.
+        x = reverseBits(x);
+
+        x += seed;
+        x ^= x * 0x6c50b47cu;
+        x ^= x * 0xb82f1e52u;
+        x ^= x * 0xc7afe638u;
+        x ^= x * 0x8d22f6e6u;
+
+        return reverseBits(x);
+    }
+
+    uint32_t getPixelSeed(uint32_t x, uint32_t y) noexcept
+    {
+        return hash(x ^ hash(y));
+    }
+
+    uint32_t getDimensionSeed(uint32_t pixel_seed, uint32_t dimension) noexcept
+    {
+        return hashCombine(pixel_seed, hash(dimension));
+    }
+
+    glm::vec4 getSample(uint32_t index, uint32_t seed) noexcept
+    {
+        index = nestedUniformScramble(index, seed);
+
+        glm::vec4 result (0.0f);
+
+        for (auto dimension: std::views::iota(0u, dimension_count))
+        {
+            const auto x = nestedUniformScramble(sample(index, dimension), hashCombine(seed, dimension));
+            result[dimension] = toFloat(x);
+        }
+
+        return result;
+    }
+}
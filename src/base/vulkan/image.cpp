@@ -140,6 +140,116 @@ namespace vrts
         command_buffer.upload(_ptr_context);
     }
 
+    void Image::readData(const ImageWriteData& read_data) const
+    {
+        const size_t pixel_format_size    = VkUtils::getFormatSize(read_data.format);
+        const size_t scanline_size        = read_data.width * pixel_format_size; 
+        const size_t image_size           = read_data.height * scanline_size;
+
+        auto temp_buffer = Buffer::Builder(_ptr_context)
+            .vkSize(image_size)
+            .vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+            .isHostVisible(true)
+            .name("[Image] Readback buffer")
+            .build();
+
+        auto command_buffer = VkUtils::getCommandBuffer(_ptr_context);
+
+        command_buffer.write([this, &temp_buffer, &read_data] (VkCommandBuffer command_buffer_handle)
+        {
+            constexpr VkImageSubresourceLayers subresource 
+            { 
+                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel       = 0,
+                .baseArrayLayer = 0,
+                .layerCount     = 1
+            };
+
+            const VkBufferImageCopy2 region 
+            { 
+                .sType                = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
+                .bufferOffset         = 0,
+                .bufferRowLength      = static_cast<uint32_t>(read_data.width),
+                .bufferImageHeight    = static_cast<uint32_t>(read_data.height),
+                .imageSubresource     = subresource,
+                .imageOffset          = { },
+                .imageExtent          = {static_cast<uint32_t>(read_data.width), static_cast<uint32_t>(read_data.height), 1}
+            };
+
+            const VkCopyImageToBufferInfo2 copy_info 
+            { 
+                .sType             = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_BUFFER_INFO_2,
+                .srcImage          = vk_handle,
+                .srcImageLayout    = VK_IMAGE_LAYOUT_GENERAL,
+                .dstBuffer         = temp_buffer.vk_handle,
+                .regionCount       = 1,
+                .pRegions          = &region
+            };
+
+            const VkMemoryBarrier shader_write_barrier
+            {
+                .sType          = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask  = VK_ACCESS_SHADER_WRITE_BIT,
+                .dstAccessMask  = VK_ACCESS_TRANSFER_READ_BIT
+            };
+
+            vkCmdPipelineBarrier(
+                command_buffer_handle,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                1, &shader_write_barrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            vkCmdCopyImageToBuffer2(command_buffer_handle, &copy_info);
+
+            const VkMemoryBarrier host_read_barrier
+            {
+                .sType          = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask  = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask  = VK_ACCESS_HOST_READ_BIT
+            };
+
+            vkCmdPipelineBarrier(
+                command_buffer_handle,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                1, &host_read_barrier,
+                0, nullptr,
+                0, nullptr
+            );
+        }, "Read data from image", GpuMarkerColors::read_data_from_image);
+
+        command_buffer.upload(_ptr_context);
+
+        {
+            void* ptr_temp_buffer_memory = nullptr;
+
+            VK_CHECK(
+                vkMapMemory(
+                    _ptr_context->device_handle,
+                    temp_buffer.memory_handle,
+                    0, VK_WHOLE_SIZE,
+                    0,
+                    &ptr_temp_buffer_memory
+                )
+            );
+
+            const VkMappedMemoryRange memory_range
+            {
+                .sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                .memory = temp_buffer.memory_handle,
+                .offset = 0,
+                .size   = VK_WHOLE_SIZE
+            };
+
+            VK_CHECK(vkInvalidateMappedMemoryRanges(_ptr_context->device_handle, 1, &memory_range));
+
+            memcpy(read_data.ptr_data, ptr_temp_buffer_memory, image_size);
+
+            vkUnmapMemory(_ptr_context->device_handle, temp_buffer.memory_handle);
+        }
+    }
+
     void Image::init() noexcept
     {
         stbi_set_flip_vertically_on_load(true);
@@ -16,8 +16,10 @@ namespace vrts::dancing_penguin
     { }
 
     AnimationPass::AnimationPass(AnimationPass&& animation_pass) :
-        _meshes         (std::move(animation_pass._meshes)),
-        _ptr_context    (animation_pass._ptr_context)
+        _meshes                 (std::move(animation_pass._meshes)),
+        _final_bones_matrices   (std::move(animation_pass._final_bones_matrices)),
+        _skinning_palette_type  (animation_pass._skinning_palette_type),
+        _ptr_context            (animation_pass._ptr_context)
     { 
         std::swap(_pipeline_handle, animation_pass._pipeline_handle);
         std::swap(_pipeline_layout, animation_pass._pipeline_layout);
@@ -44,7 +46,9 @@ namespace vrts::dancing_penguin
 
     AnimationPass& AnimationPass::operator = (AnimationPass&& animation_pass)
     {
-        _meshes = std::move(animation_pass._meshes);
+        _meshes                 = std::move(animation_pass._meshes);
+        _final_bones_matrices   = std::move(animation_pass._final_bones_matrices);
+        _skinning_palette_type  = animation_pass._skinning_palette_type;
 
         std::swap(_pipeline_handle, animation_pass._pipeline_handle);
         std::swap(_pipeline_layout, animation_pass._pipeline_layout);
@@ -96,12 +100,12 @@ namespace vrts::dancing_penguin
         );
     }
 
-    void AnimationPass::updateMatrices(std::span<const glm::mat4> matrices)
+    void AnimationPass::updateMatrices(std::span<const glm::vec4> palette)
     {
-        if (matrices.empty())
+        if (palette.empty())
             return ;
 
-        const auto size = static_cast<VkDeviceSize>(sizeof(glm::mat4) * matrices.size());
+        const auto size = static_cast<VkDeviceSize>(sizeof(glm::vec4) * palette.size());
 
         constexpr auto buffer_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
@@ -135,12 +139,15 @@ namespace vrts::dancing_penguin
             vkUpdateDescriptorSets(_ptr_context->device_handle, 1, &write_info, 0, nullptr);
         }
 
-        Buffer::writeData(*_final_bones_matrices, matrices);
+        Buffer::writeData(*_final_bones_matrices, palette);
     }
 
-    void AnimationPass::process(std::span<const glm::mat4> final_bones_matrices)
+    void AnimationPass::process(const SkinningPalette& skinning_palette)
     {
-        updateMatrices(final_bones_matrices);
+        if (skinning_palette.getType() != _skinning_palette_type)
+            log::error("[AnimationPass] Skinning palette type doesn't match the pipeline");
+
+        updateMatrices(skinning_palette.getData());
 
         for (const auto ptr_skinned_mesh: _meshes)
         {
@@ -161,6 +168,19 @@ namespace vrts::dancing_penguin
                     1, &_descriptor_set_handle, 
                     0, nullptr
                 );
+
+                const PushConstants push_constants
+                {
+                    .bone_index_format  = ptr_skinned_mesh->bone_index_format,
+                    .index_type         = ptr_skinned_mesh->index_type
+                };
+
+                vkCmdPushConstants(
+                    command_buffer_handle,
+                    _pipeline_layout,
+                    VK_SHADER_STAGE_COMPUTE_BIT,
+                    0, sizeof(PushConstants), &push_constants
+                );
                 
                 vkCmdDispatch(command_buffer_handle, x_group_size, 1, 1); 
             }, "Run animation subpass", GpuMarkerColors::run_compute_pipeline);
@@ -184,6 +204,12 @@ namespace vrts::dancing_penguin
             log::error("[AnimationPass::Builder] Vulkan context is null");
     }
 
+    AnimationPass::Builder& AnimationPass::Builder::skinningPaletteType(SkinningPaletteType type) noexcept
+    {
+        _skinning_palette_type = type;
+        return *this;
+    }
+
     void AnimationPass::Builder::process(Node* ptr_node)
     {
         for (const auto& ptr_child: ptr_node->children)
@@ -228,11 +254,20 @@ namespace vrts::dancing_penguin
             &_descriptor_set_layout
         ));
 
+        constexpr VkPushConstantRange push_constant_range 
+        { 
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset     = 0,
+            .size       = sizeof(PushConstants)
+        };
+
         const VkPipelineLayoutCreateInfo layout_info 
         { 
-            .sType           = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .setLayoutCount  = 1,
-            .pSetLayouts     = &_descriptor_set_layout
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = 1,
+            .pSetLayouts            = &_descriptor_set_layout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &push_constant_range
         };
         
         VK_CHECK(vkCreatePipelineLayout(
@@ -255,12 +290,28 @@ namespace vrts::dancing_penguin
             shader::Type::compute
         );
 
+        const VkSpecializationMapEntry palette_type_entry 
+        { 
+            .constantID = 0,
+            .offset     = 0,
+            .size       = sizeof(SkinningPaletteType)
+        };
+
+        const VkSpecializationInfo specialization_info 
+        { 
+            .mapEntryCount  = 1,
+            .pMapEntries    = &palette_type_entry,
+            .dataSize       = sizeof(SkinningPaletteType),
+            .pData          = &_skinning_palette_type
+        };
+
         const VkPipelineShaderStageCreateInfo stage 
         { 
-            .sType     = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage     = VK_SHADER_STAGE_COMPUTE_BIT,
-            .module    = _compute_shader_handle,
-            .pName     = "main"
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage                  = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module                 = _compute_shader_handle,
+            .pName                  = "main",
+            .pSpecializationInfo    = &specialization_info
         };
 
         const VkComputePipelineCreateInfo pipeline_info 
@@ -338,6 +389,7 @@ namespace vrts::dancing_penguin
         animation_pass._descriptor_set_layout   = _descriptor_set_layout;
         animation_pass._descriptor_pool_handle  = _descriptor_pool_handle;
         animation_pass._descriptor_set_handle   = _descriptor_set_handle;
+        animation_pass._skinning_palette_type   = _skinning_palette_type;
 
         return animation_pass;
     }
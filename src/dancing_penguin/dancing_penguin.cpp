@@ -23,13 +23,17 @@ void DancingPenguin::initScene()
 {
     auto [width, height] = _window->getSize();
 
+    constexpr auto skinning_palette_type = SkinningPaletteType::affine;
+
     _scene = Scene::Importer(getContext())
         .path(project_dir / "content/dancing_penguin.glb")
         .vkMemoryTypeIndex(MemoryProperties::getMemoryIndex(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
         .viewport(width, height)
+        .skinningPalette(skinning_palette_type)
         .import();
 
     auto ptr_animation_pass_builder = std::make_unique<AnimationPass::Builder>(getContext());
+    ptr_animation_pass_builder->skinningPaletteType(skinning_palette_type);
 
     _scene->getModel().visit(ptr_animation_pass_builder);
 
@@ -45,7 +49,7 @@ void DancingPenguin::initCamera()
 
 void DancingPenguin::createPipelineLayout()
 {
-    auto materials = _scene->getModel().getMaterialManager().getMaterials();
+    const auto instance_count = _scene->getModel().getMaterialManager().getInstanceCount();
     
     std::vector<VkDescriptorSetLayoutBinding> bindings (Bindings::count);
 
@@ -65,7 +69,7 @@ void DancingPenguin::createPipelineLayout()
     bindings[Bindings::scene_geometry].stageFlags       = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
     
     bindings[Bindings::albedos].binding         = Bindings::albedos;
-    bindings[Bindings::albedos].descriptorCount = static_cast<uint32_t>(materials.size());
+    bindings[Bindings::albedos].descriptorCount = static_cast<uint32_t>(instance_count);
     bindings[Bindings::albedos].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     bindings[Bindings::albedos].stageFlags      = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
 
@@ -108,12 +112,12 @@ void DancingPenguin::createPipelineLayout()
 
 void DancingPenguin::createDescriptorSets()
 {
-    auto material = _scene->getModel().getMaterialManager().getMaterials();
+    const auto instance_count = _scene->getModel().getMaterialManager().getInstanceCount();
 
     std::vector<VkDescriptorPoolSize> pool_sizes;
     pool_sizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1});
     pool_sizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1});
-    pool_sizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(material.size())});
+    pool_sizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(instance_count)});
 
     const VkDescriptorPoolCreateInfo descriptor_pool_create_info 
     { 
@@ -534,13 +538,21 @@ void DancingPenguin::animationPass()
     auto& animator = _scene->getAnimator();
 
     animator.update(_delta_time);
-    _animation_pass->process(animator.getFinalBoneMatrices());
-
-    auto ptr_as_builder = std::make_unique<ASBuilder>(getContext());
+    _animation_pass->process(animator.getSkinningPalette());
 
     auto& model = _scene->getModel();
+    model.updateTransforms();
+
+    const LodPolicy lod_policy
+    {
+        .eye = glm::vec3(_scene->getCameraController().getCamera().getInvViewMatrix() * glm::vec4(0, 0, 0, 1))
+    };
+
+    auto ptr_as_builder = std::make_unique<ASBuilder>(getContext(), model.getTransformHierarchy(), lod_policy);
     model.visit(ptr_as_builder);
 
+    _scene->selectRayQueryLods(*ptr_as_builder);
+
     updateVertexBufferReferences();
 }
 
@@ -642,15 +654,18 @@ void DancingPenguin::resizeWindow()
 
 void DancingPenguin::bindAlbedos()
 {
-    auto materials = _scene->getModel().getMaterialManager().getMaterials();
+    const auto& material_manager = _scene->getModel().getMaterialManager();
+    const auto  instance_count   = material_manager.getInstanceCount();
 
-    std::vector<VkDescriptorImageInfo> albedos_infos (materials.size());
-    for (auto i: std::views::iota(0u, materials.size()))
+    std::vector<VkDescriptorImageInfo> albedos_infos (instance_count);
+    for (auto i: std::views::iota(0u, instance_count))
     {
+        const auto& albedo = material_manager.getInstanceMaterial(i).albedo;
+
         albedos_infos[i] = { };
         albedos_infos[i].imageLayout    = VK_IMAGE_LAYOUT_GENERAL;
-        albedos_infos[i].imageView      = materials[i].albedo->view_handle;
-        albedos_infos[i].sampler        = materials[i].albedo->sampler_handle;
+        albedos_infos[i].imageView      = albedo->view_handle;
+        albedos_infos[i].sampler        = albedo->sampler_handle;
     }
 
     const VkWriteDescriptorSet albedo_write_info 
@@ -659,7 +674,7 @@ void DancingPenguin::bindAlbedos()
         .dstSet            = _descriptor_set_handle,
         .dstBinding        = Bindings::albedos,
         .dstArrayElement   = 0,
-        .descriptorCount   = static_cast<uint32_t>(materials.size()),
+        .descriptorCount   = static_cast<uint32_t>(instance_count),
         .descriptorType    = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
         .pImageInfo        = albedos_infos.data(),
     };
@@ -0,0 +1,151 @@
+#include <junk_shop/atrous_denoiser.hpp>
+
+#include <base/job_system.hpp>
+#include <base/logger/logger.hpp>
+
+#include <array>
+#include <ranges>
+#include <cmath>
+
+namespace vrts::junk_shop::atrous
+{
+    static constexpr std::array<float, 5> kernel { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+    static float luminance(const glm::vec3& color) noexcept
+    {
+        return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    }
+
+    /// Одна итерация: main в atrous.glsl.comp.
+    static void filterRows(
+        std::span<const glm::vec3>  src,
+        std::span<glm::vec3>        dst,
+        int32_t                     step_size,
+        float                       inv_color_sigma,
+        const FeatureBuffers&       features,
+        const Parameters&           parameters,
+        uint32_t                    first_row,
+        uint32_t                    last_row
+    )
+    {
+        const auto width    = static_cast<int32_t>(features.width);
+        const auto height   = static_cast<int32_t>(features.height);
+
+        for (auto y: std::views::iota(static_cast<int32_t>(first_row), static_cast<int32_t>(last_row)))
+        {
+            for (auto x: std::views::iota(0, width))
+            {
+                const auto p = static_cast<size_t>(y * width + x);
+
+                const auto depth_p = features.depth[p];
+
+                if (depth_p == 0.0f)
+                {
+                    dst[p] = src[p];
+                    continue;
+                }
+
+                const auto& normal_p    = features.normal[p];
+                const auto& albedo_p    = features.albedo[p];
+                const auto  luminance_p = luminance(src[p]);
+
+                glm::vec3   sum         (0.0f);
+                float       weight_sum  = 0.0f;
+
+                for (auto dy: std::views::iota(-2, 3))
+                {
+                    for (auto dx: std::views::iota(-2, 3))
+                    {
+                        const auto qx = x + dx * step_size;
+                        const auto qy = y + dy * step_size;
+
+                        if (qx < 0 || qy < 0 || qx >= width || qy >= height)
+                            continue;
+
+                        const auto q = static_cast<size_t>(qy * width + qx);
+
+                        const auto depth_q = features.depth[q];
+
+                        if (depth_q == 0.0f)
+                            continue;
+
+                        const auto offset_length = static_cast<float>(step_size) * std::sqrt(static_cast<float>(dx * dx + dy * dy));
+
+                        const auto depth_weight = offset_length > 0.0f ?
+                                std::exp(-std::abs(depth_p - depth_q) / (parameters.depth_sigma * depth_p * offset_length))
+                            :   1.0f;
+
+                        const auto normal_weight    = std::pow(std::max(glm::dot(normal_p, features.normal[q]), 0.0f), parameters.normal_sigma);
+                        const auto albedo_weight    = std::exp(-glm::length(albedo_p - features.albedo[q]) / parameters.albedo_sigma);
+                        const auto color_weight     = std::exp(-std::abs(luminance_p - luminance(src[q])) * inv_color_sigma);
+
+                        const auto weight =
+                                kernel[static_cast<size_t>(dx + 2)] * kernel[static_cast<size_t>(dy + 2)]
+                            *   depth_weight * normal_weight * albedo_weight * color_weight;
+
+                        sum         += src[q] * weight;
+                        weight_sum  += weight;
+                    }
+                }
+
+                dst[p] = weight_sum > 0.0f ? sum / weight_sum : src[p];
+            }
+        }
+    }
+
+    std::vector<glm::vec3> denoise(
+        std::span<const glm::vec3>  color,
+        float                       sample_count,
+        const FeatureBuffers&       features,
+        const Parameters&           parameters
+    )
+    {
+        const auto pixel_count = static_cast<size_t>(features.width) * static_cast<size_t>(features.height);
+
+        if (color.size() != pixel_count || features.albedo.size() != pixel_count || features.normal.size() != pixel_count || features.depth.size() != pixel_count)
+            log::error("[atrous] Image and feature buffers must be {}x{}.", features.width, features.height);
+
+        std::vector<glm::vec3> src (std::begin(color), std::end(color));
+        std::vector<glm::vec3> dst (pixel_count);
+
+        const auto inv_color_sigma = std::sqrt(std::max(sample_count, 1.0f)) / parameters.color_sigma;
+
+        for (auto iteration: std::views::iota(0u, parameters.iteration_count))
+        {
+            const auto step_size = static_cast<int32_t>(1u << iteration);
+
+            JobSystem::get().parallelFor(0, features.height, 16, [&] (size_t first, size_t last)
+            {
+                filterRows(
+                    src, dst,
+                    step_size, inv_color_sigma,
+                    features, parameters,
+                    static_cast<uint32_t>(first), static_cast<uint32_t>(last)
+                );
+            });
+
+            std::swap(src, dst);
+        }
+
+        return src;
+    }
+
+    double getRmse(std::span<const glm::vec3> image, std::span<const glm::vec3> reference)
+    {
+        if (image.size() != reference.size())
+            log::error("[atrous] Image has {} pixels, reference - {}.", image.size(), reference.size());
+
+        if (image.empty())
+            return 0.0;
+
+        double sum = 0.0;
+
+        for (auto i: std::views::iota(0u, image.size()))
+        {
+            const auto diff = glm::dvec3(image[i] - reference[i]);
+            sum += glm::dot(diff, diff);
+        }
+
+        return std::sqrt(sum / static_cast<double>(image.size() * 3));
+    }
+}
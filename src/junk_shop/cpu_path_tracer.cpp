@@ -0,0 +1,932 @@
+#include <junk_shop/cpu_path_tracer.hpp>
+
+#include <base/image_writer.hpp>
+#include <base/job_system.hpp>
+#include <base/logger/logger.hpp>
+#include <base/configuration.hpp>
+#include <base/sobol.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <chrono>
+#include <ranges>
+#include <numeric>
+
+namespace vrts::junk_shop
+{
+    /// Константы из shaders/utils/math_constants.glsl и shaders/junk_shop/shared.glsl.
+    static constexpr float      pi              = 3.1415927f;
+    static constexpr float      eps             = 0.0000001f;
+    static constexpr uint32_t   max_recursive   = 7;
+
+    static constexpr uint32_t   brdf_dimension          = 0;
+    static constexpr uint32_t   light_dimension         = 1;
+    static constexpr uint32_t   dimensions_per_bounce   = 2;
+    static constexpr float      ray_t_min       = 0.2f;
+
+    static constexpr uint32_t tile_size = 16;
+}
+
+/// shaders/utils/rng.glsl
+namespace vrts::junk_shop::rng
+{
+    static glm::vec3 cosineSampleHemisphere(const glm::vec3& n, const glm::vec2& u)
+    {
+        const auto r        = std::sqrt(u.x);
+        const auto theta    = 2.0f * pi * u.y;
+
+        const auto b = glm::normalize(glm::cross(n, glm::vec3(0, 1, 1)));
+        const auto t = glm::cross(b, n);
+
+        return glm::normalize(r * std::sin(theta) * b + std::sqrt(1.0f - u.x) * n + r * std::cos(theta) * t);
+    }
+}
+
+/// shaders/junk_shop/pbr.glsl
+namespace vrts::junk_shop::pbr
+{
+    struct Brdf
+    {
+        glm::vec3   result;
+        float       pdf;
+    };
+
+    static float luma(const glm::vec3& color)
+    {
+        return glm::dot(color, glm::vec3(0.299f, 0.587f, 0.114f));
+    }
+
+    static glm::vec3 fSchlick(const glm::vec3& f0, float theta)
+    {
+        return f0 + (1.0f - f0) * std::pow(1.0f - theta, 5.0f);
+    }
+
+    static float fSchlick(float f0, float f90, float theta)
+    {
+        return f0 + (f90 - f0) * std::pow(1.0f - theta, 5.0f);
+    }
+
+    static float dGTR(float roughness, float n_dot_h, float k)
+    {
+        const auto a2 = roughness * roughness;
+        return a2 / (pi * std::pow((n_dot_h * n_dot_h) * (a2 * a2 - 1.0f) + 1.0f, k));
+    }
+
+    static float smithG(float n_dot_v, float alpha_g)
+    {
+        const auto a = alpha_g * alpha_g;
+        const auto b = n_dot_v * n_dot_v;
+        return (2.0f * n_dot_v) / (n_dot_v + std::sqrt(a + b - a * b));
+    }
+
+    static float geometryTerm(float n_dot_l, float n_dot_v, float roughness)
+    {
+        const auto a2 = roughness * roughness;
+        return smithG(n_dot_l, a2) * smithG(n_dot_v, a2);
+    }
+
+    static float ggxvndPdf(float n_dot_h, float n_dot_v, float roughness)
+    {
+        const auto d    = dGTR(roughness, n_dot_h, 2.0f);
+        const auto g1   = smithG(n_dot_v, roughness * roughness);
+        return (d * g1) / std::max(eps, 4.0f * n_dot_v);
+    }
+
+    static glm::vec3 sampleGGXVNDF(const glm::vec3& v, float ax, float ay, float r1, float r2)
+    {
+        const auto vh = glm::normalize(glm::vec3(ax * v.x, ay * v.y, v.z));
+
+        const auto lensq    = vh.x * vh.x + vh.y * vh.y;
+        const auto t1       = lensq > 0.0f ? glm::vec3(-vh.y, vh.x, 0) / std::sqrt(lensq) : glm::vec3(1, 0, 0);
+        const auto t2       = glm::cross(vh, t1);
+
+        const auto r    = std::sqrt(r1);
+        const auto phi  = 2.0f * pi * r2;
+        const auto b1   = r * std::cos(phi);
+        const auto s    = 0.5f * (1.0f + vh.z);
+        const auto b2   = (1.0f - s) * std::sqrt(1.0f - b1 * b1) + s * r * std::sin(phi);
+
+        const auto nh = b1 * t1 + b2 * t2 + std::sqrt(std::max(0.0f, 1.0f - b1 * b1 - b2 * b2)) * vh;
+
+        return glm::normalize(glm::vec3(ax * nh.x, ay * nh.y, std::max(0.0f, nh.z)));
+    }
+
+    template<typename Material>
+    static Brdf sampleDisneyBRDF(const glm::vec3& u, const glm::vec3& v, const Material& material, glm::vec3& out_dir)
+    {
+        const auto roughness = material.roughness * material.roughness;
+
+        auto h = sampleGGXVNDF(v, roughness, roughness, u.y, u.z);
+
+        const auto v_dot_h = std::max(glm::dot(v, h), eps);
+
+        const auto f0 = glm::mix(glm::vec3(0.04f), material.albedo, material.metallic);
+        const auto f  = fSchlick(f0, v_dot_h);
+
+        auto diff_w = 1.0f - material.metallic;
+        auto spec_w = luma(f);
+
+        const auto inv_w = 1.0f / (diff_w + spec_w);
+
+        diff_w *= inv_w;
+        spec_w *= inv_w;
+
+        if (u.x < diff_w)
+        {
+            out_dir = rng::cosineSampleHemisphere(material.shading_normal, glm::vec2(u.y, u.z));
+            h       = glm::normalize(out_dir + v);
+
+            const auto n_dot_l = std::max(glm::dot(material.shading_normal, out_dir), eps);
+            const auto n_dot_v = std::max(glm::dot(material.shading_normal, v), eps);
+
+            if (n_dot_l > eps)
+            {
+                const auto l_dot_h = std::max(glm::dot(out_dir, h), eps);
+
+                const auto f90  = 0.5f + 2.0f * roughness * l_dot_h * l_dot_h;
+                const auto a    = fSchlick(1.0f, f90, n_dot_l);
+                const auto b    = fSchlick(1.0f, f90, n_dot_v);
+
+                const auto diff = material.albedo * (a * b / pi);
+
+                return Brdf {diff * n_dot_l, diff_w * (n_dot_l / pi)};
+            }
+        }
+        else
+        {
+            out_dir = glm::reflect(-v, h);
+
+            const auto n_dot_l = std::max(glm::dot(material.shading_normal, out_dir), eps);
+            const auto n_dot_v = std::max(glm::dot(material.shading_normal, v), eps);
+
+            if (n_dot_l > eps && n_dot_v > eps)
+            {
+                const auto n_dot_h = std::max(glm::dot(material.shading_normal, h), eps);
+
+                const auto d = dGTR(roughness, n_dot_h, 2.0f);
+                const auto g = geometryTerm(n_dot_l, n_dot_v, std::pow(0.5f + material.roughness * 0.5f, 2.0f));
+
+                const auto spec = (f * g * d) / (4.0f * n_dot_l * n_dot_v);
+
+                return Brdf {spec * n_dot_l, spec_w * ggxvndPdf(n_dot_h, n_dot_v, roughness)};
+            }
+        }
+
+        return Brdf {glm::vec3(0), eps};
+    }
+
+    template<typename Material>
+    static Brdf evalDisneyBRDF(const glm::vec3& v, const glm::vec3& l, const Material& material)
+    {
+        const auto n_dot_l = glm::dot(material.shading_normal, l);
+        const auto n_dot_v = glm::dot(material.shading_normal, v);
+
+        if (n_dot_l <= eps || n_dot_v <= eps)
+            return Brdf {glm::vec3(0), 0.0f};
+
+        const auto roughness = material.roughness * material.roughness;
+
+        const auto h = glm::normalize(v + l);
+
+        const auto v_dot_h = std::max(glm::dot(v, h), eps);
+        const auto l_dot_h = std::max(glm::dot(l, h), eps);
+        const auto n_dot_h = std::max(glm::dot(material.shading_normal, h), eps);
+
+        const auto f0 = glm::mix(glm::vec3(0.04f), material.albedo, material.metallic);
+        const auto f  = fSchlick(f0, v_dot_h);
+
+        auto diff_w = 1.0f - material.metallic;
+        auto spec_w = luma(f);
+
+        const auto inv_w = 1.0f / (diff_w + spec_w);
+
+        diff_w *= inv_w;
+        spec_w *= inv_w;
+
+        const auto f90  = 0.5f + 2.0f * roughness * l_dot_h * l_dot_h;
+        const auto a    = fSchlick(1.0f, f90, n_dot_l);
+        const auto b    = fSchlick(1.0f, f90, n_dot_v);
+
+        const auto diff = material.albedo * (a * b / pi);
+
+        const auto d = dGTR(roughness, n_dot_h, 2.0f);
+        const auto g = geometryTerm(n_dot_l, n_dot_v, std::pow(0.5f + material.roughness * 0.5f, 2.0f));
+
+        const auto spec = (f * g * d) / (4.0f * n_dot_l * n_dot_v);
+
+        const auto pdf = diff_w * (n_dot_l / pi) + spec_w * ggxvndPdf(n_dot_h, n_dot_v, roughness);
+
+        return Brdf {(diff + spec) * n_dot_l, pdf};
+    }
+}
+
+/// shaders/utils/light_sampling.glsl
+namespace vrts::junk_shop::light_sampling
+{
+    static glm::vec2 sampleTriangle(const glm::vec2& u)
+    {
+        const auto su = std::sqrt(u.x);
+        return glm::vec2(su * (1.0f - u.y), su * u.y);
+    }
+
+    static float powerHeuristic(float pdf, float other_pdf)
+    {
+        const auto pdf_2        = pdf * pdf;
+        const auto other_pdf_2  = other_pdf * other_pdf;
+
+        return pdf_2 / std::max(pdf_2 + other_pdf_2, eps);
+    }
+}
+
+namespace vrts::junk_shop
+{
+    /// shaders/utils/tone_mapping.glsl
+    static glm::vec3 whitePreservingLumaBasedReinhard(glm::vec3 color)
+    {
+        constexpr auto gamma = 2.2f;
+        constexpr auto white = 20.0f;
+
+        const auto luma             = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+        const auto tone_mapped_luma = luma * (1.0f + luma / (white * white)) / (1.0f + luma);
+
+        color *= tone_mapped_luma / std::max(luma, eps);
+
+        return glm::pow(color, glm::vec3(1.0f / gamma));
+    }
+
+    static glm::vec3 skyColor(const glm::vec2& p, float f)
+    {
+        const auto h = std::max(0.0f, f - p.y - std::pow(std::abs(p.x - 0.5f), 3.0f));
+
+        const auto l = glm::vec3(
+            std::pow(h, 3.0f), 
+            std::pow(h, 7.0f), 
+            0.2f + std::pow(std::max(0.0f, h - 0.1f), 10.0f)
+        ) * 1.5f;
+
+        return glm::mix(glm::vec3(0.05f), glm::vec3(51.0f) / 255.0f, l);
+    }
+}
+
+namespace vrts::junk_shop
+{
+    CpuPathTracer::CpuPathTracer(const SceneData& scene_data, const Camera& camera) :
+        _scene_data                     (scene_data),
+        _inv_view_matrix                (camera.getInvViewMatrix()),
+        _inv_projection_matrix          (camera.getInvProjection()),
+        _eye_to_pixel_cone_spread_angle (camera.getEyeToPixelConeSpreadAngle())
+    {
+        const auto [width, height] = camera.getSize();
+
+        _width  = static_cast<uint32_t>(width);
+        _height = static_cast<uint32_t>(height);
+
+        if (!_width || !_height)
+            log::error("[CpuPathTracer] Viewport can't be with empty sizes.");
+
+        _accumulated_color.resize(_width * _height, glm::vec3(0.0f));
+        _accumulated_radiance.resize(_width * _height, glm::vec3(0.0f));
+
+        _features.width     = _width;
+        _features.height    = _height;
+        _features.albedo.resize(_width * _height, glm::vec3(0.0f));
+        _features.normal.resize(_width * _height, glm::vec3(0.0f));
+        _features.depth.resize(_width * _height, 0.0f);
+
+        const auto meshes = _scene_data.getMeshes();
+
+        if (_scene_data.getMaterials().size() != meshes.size())
+            log::error("[CpuPathTracer] Material count doesn't match mesh count.");
+
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t>  primitive_ids;
+
+        LightSampler::Builder light_sampler_builder;
+
+        for (auto mesh_id: std::views::iota(0u, meshes.size()))
+        {
+            const auto& mesh            = meshes[mesh_id].mesh;
+            const auto  object_to_world = _scene_data.getObjectToWorld(mesh_id);
+
+            _mesh_transforms.push_back(MeshTransform
+            {
+                object_to_world,
+                glm::transpose(glm::inverse(glm::mat3(object_to_world)))
+            });
+
+            _first_primitive_ids.push_back(static_cast<uint32_t>(positions.size() / 3));
+
+            for (auto index: mesh.indices)
+                positions.push_back(glm::vec3(object_to_world * glm::vec4(glm::vec3(mesh.attributes[index].pos), 1.0f)));
+
+            const auto triangle_count = mesh.indices.size() / 3;
+
+            primitive_ids.resize(triangle_count);
+            std::iota(std::begin(primitive_ids), std::end(primitive_ids), 0u);
+
+            light_sampler_builder.addMesh(
+                static_cast<uint32_t>(mesh_id),
+                std::span(positions).last(triangle_count * 3),
+                primitive_ids,
+                glm::vec3(_scene_data.getMaterials()[mesh_id].emissive.getAverage())
+            );
+        }
+
+        for (const auto& light: _scene_data.getLights())
+            light_sampler_builder.addPointLight(light);
+
+        _light_sampler = light_sampler_builder.build();
+
+        _environment_map                    = createEnvironmentMap();
+        _environment_selection_probability  = getEnvironmentSelectionProbability(_environment_map, _light_sampler->getLights().size());
+
+        const auto bvh          = BVH::build(std::move(positions));
+        const auto& statistics  = bvh.getStatistics();
+
+        log::info(
+            "[CpuPathTracer] BVH: {} triangles, {} nodes, depth {}, SAH cost {:.2f}, {:.2f} ms", 
+            bvh.getTriangleCount(), 
+            statistics.node_count, 
+            statistics.max_depth, 
+            statistics.sah_cost, 
+            statistics.build_time_ms
+        );
+
+        _bvh = WideBVH<simd::max_width>::collapse(bvh);
+
+        log::info("[CpuPathTracer] {}-wide BVH: {} nodes, {} triangle blocks", simd::max_width, _bvh->getNodes().size(), _bvh->getBlocks().size());
+    }
+
+    uint32_t CpuPathTracer::getMeshId(uint32_t primitive_id) const
+    {
+        const auto it = std::ranges::upper_bound(_first_primitive_ids, primitive_id);
+        return static_cast<uint32_t>(std::distance(std::begin(_first_primitive_ids), it) - 1);
+    }
+
+    float CpuPathTracer::getEmissionMisWeight(const Ray& ray, const RayHit& hit, uint32_t mesh_id, const Surface& surface, float brdf_pdf) const
+    {
+        const auto area_pdf = _light_sampler->getAreaPdf(mesh_id);
+
+        if (brdf_pdf <= 0.0f || area_pdf <= 0.0f)
+            return 1.0f;
+
+        const auto world    = glm::mat3(_mesh_transforms[mesh_id].object_to_world);
+        const auto edge_1   = world * (surface.positions[1] - surface.positions[0]);
+        const auto edge_2   = world * (surface.positions[2] - surface.positions[0]);
+
+        const auto cos_light = std::abs(glm::dot(glm::normalize(glm::cross(edge_1, edge_2)), ray.dir));
+        const auto light_pdf = (1.0f - _environment_selection_probability) * area_pdf * hit.t * hit.t / std::max(cos_light, eps);
+
+        return light_sampling::powerHeuristic(brdf_pdf, light_pdf);
+    }
+
+    float CpuPathTracer::getEnvironmentMisWeight(const glm::vec3& dir, float brdf_pdf) const
+    {
+        if (brdf_pdf <= 0.0f || _environment_selection_probability <= 0.0f)
+            return 1.0f;
+
+        return light_sampling::powerHeuristic(brdf_pdf, _environment_selection_probability * _environment_map.getPdf(dir));
+    }
+
+    auto CpuPathTracer::sampleEnvironmentLight(const Material& material, const glm::vec3& v, const glm::vec3& origin, const glm::vec4& u) const
+        -> std::pair<glm::vec3, bool>
+    {
+        const auto environment_sample   = _environment_map.sample(u);
+        const auto light_pdf            = environment_sample.pdf * _environment_selection_probability;
+
+        const auto brdf = pbr::evalDisneyBRDF(v, environment_sample.direction, material);
+
+        if (brdf.pdf <= 0.0f || light_pdf <= 0.0f || environment_sample.radiance == glm::vec3(0.0f))
+            return std::make_pair(glm::vec3(0.0f), false);
+
+        if (_bvh->isOccluded(Ray {origin, environment_sample.direction, ray_t_min}))
+            return std::make_pair(glm::vec3(0.0f), true);
+
+        const auto weight = light_sampling::powerHeuristic(light_pdf, brdf.pdf);
+
+        return std::make_pair(brdf.result * environment_sample.radiance * (weight / light_pdf), true);
+    }
+
+    auto CpuPathTracer::sampleDirectLight(const Material& material, const glm::vec3& v, const glm::vec3& origin, const glm::vec4& u) const
+        -> std::pair<glm::vec3, bool>
+    {
+        const auto environment_probability = _environment_selection_probability;
+
+        /// u.x делится между стратегиями и растягивается обратно в [0, 1): u.w свободен и уходит окружению.
+        if (u.x < environment_probability)
+            return sampleEnvironmentLight(material, v, origin, glm::vec4(u.y, u.z, u.x / environment_probability, u.w));
+
+        if (_light_sampler->empty())
+            return std::make_pair(glm::vec3(0.0f), false);
+
+        const auto u_light  = (u.x - environment_probability) / (1.0f - environment_probability);
+        auto       u_point  = glm::vec2(u.y, u.z);
+
+        const auto& light = _light_sampler->getLights()[_light_sampler->sample(u_light)];
+
+        const auto is_point_light = light.mesh_id == LightSampler::point_light_mesh_id;
+
+        auto light_pos = light.pos;
+
+        if (!is_point_light)
+        {
+            u_point     = light_sampling::sampleTriangle(u_point);
+            light_pos  += light.edge_1 * u_point.x + light.edge_2 * u_point.y;
+        }
+
+        const auto to_light     = light_pos - origin;
+        const auto distance_2   = glm::dot(to_light, to_light);
+        const auto distance     = std::sqrt(distance_2);
+        const auto l            = to_light / distance;
+
+        glm::vec3   emission    (0.0f);
+        float       light_pdf   = 0.0f;
+
+        if (is_point_light)
+        {
+            emission    = light.edge_1 / distance_2;
+            light_pdf   = light.pdf * (1.0f - environment_probability);
+        }
+        else
+        {
+            const auto normal       = glm::cross(light.edge_1, light.edge_2);
+            const auto area         = 0.5f * glm::length(normal);
+            const auto cos_light    = std::abs(glm::dot(normal, l)) / std::max(2.0f * area, eps);
+
+            if (cos_light <= eps || area <= eps)
+                return std::make_pair(glm::vec3(0.0f), false);
+
+            /// shaders/utils/scene_geometry.glsl: get_uv
+            const auto& mesh    = _scene_data.getMeshes()[light.mesh_id].mesh;
+            const auto  uv0     = glm::vec2(mesh.attributes[mesh.indices[light.primitive_id * 3]].uv);
+            const auto  uv1     = glm::vec2(mesh.attributes[mesh.indices[light.primitive_id * 3 + 1]].uv);
+            const auto  uv2     = glm::vec2(mesh.attributes[mesh.indices[light.primitive_id * 3 + 2]].uv);
+
+            const auto uv = uv0 * (1.0f - u_point.x - u_point.y) + uv1 * u_point.x + uv2 * u_point.y;
+
+            emission    = glm::vec3(_scene_data.getMaterials()[light.mesh_id].emissive.sampleGrad(uv, 0.0f));
+            light_pdf   = light.pdf * (1.0f - environment_probability) / area * distance_2 / cos_light;
+        }
+
+        const auto brdf = pbr::evalDisneyBRDF(v, l, material);
+
+        if (brdf.pdf <= 0.0f || light_pdf <= 0.0f || emission == glm::vec3(0.0f))
+            return std::make_pair(glm::vec3(0.0f), false);
+
+        if (_bvh->isOccluded(Ray {origin, l, ray_t_min, distance * 0.999f}))
+            return std::make_pair(glm::vec3(0.0f), true);
+
+        const auto weight = is_point_light ? 1.0f : light_sampling::powerHeuristic(light_pdf, brdf.pdf);
+
+        return std::make_pair(brdf.result * emission * (weight / light_pdf), true);
+    }
+
+    /// shaders/utils/scene_geometry.glsl: get_surface
+    auto CpuPathTracer::getSurface(const RayHit& hit, uint32_t mesh_id) const
+        -> Surface
+    {
+        const auto& mesh            = _scene_data.getMeshes()[mesh_id].mesh;
+        const auto  primitive_id    = hit.primitive_id - _first_primitive_ids[mesh_id];
+
+        const glm::vec3 bc (1.0f - hit.barycentric.x - hit.barycentric.y, hit.barycentric.x, hit.barycentric.y);
+
+        const std::array vertices = 
+        {
+            &mesh.attributes[mesh.indices[primitive_id * 3]],
+            &mesh.attributes[mesh.indices[primitive_id * 3 + 1]],
+            &mesh.attributes[mesh.indices[primitive_id * 3 + 2]]
+        };
+
+        Surface surface = { };
+
+        glm::vec3 pos (0.0f);
+        glm::vec3 normal (0.0f);
+
+        for (auto i: std::views::iota(0, 3))
+        {
+            surface.positions[i]    = glm::vec3(vertices[i]->pos);
+            surface.uvs[i]          = glm::vec2(vertices[i]->uv);
+
+            pos             += surface.positions[i] * bc[i];
+            normal          += glm::vec3(vertices[i]->normal) * bc[i];
+            surface.tangent += glm::vec3(vertices[i]->tangent) * bc[i];
+            surface.uv      += surface.uvs[i] * bc[i];
+        }
+
+        surface.pos     = glm::vec3(_mesh_transforms[mesh_id].object_to_world * glm::vec4(pos, 1.0f));
+        surface.normal  = glm::normalize(normal);
+
+        return surface;
+    }
+
+    /// junk_shop.glsl.rchit: get_material + shaders/utils/texture_sampling.glsl + shaders/utils/normal_mapping.glsl
+    auto CpuPathTracer::getMaterial(const Ray& ray, const RayHit& hit, uint32_t mesh_id, const Surface& surface) const
+        -> Material
+    {
+        const auto& transform   = _mesh_transforms[mesh_id];
+        const auto  world       = glm::mat3(transform.object_to_world);
+
+        const auto hit_position     = ray.dir * hit.t + ray.origin;
+        const auto ray_cone_width   = _eye_to_pixel_cone_spread_angle * glm::length(hit_position - ray.origin);
+        const auto world_normal     = glm::normalize(world * surface.normal);
+
+        const auto uv10         = surface.uvs[1] - surface.uvs[0];
+        const auto uv20         = surface.uvs[2] - surface.uvs[0];
+        const auto quad_uv_area = std::abs(uv10.x * uv20.y + uv20.x * uv10.y);
+
+        const auto edge10       = world * (surface.positions[1] - surface.positions[0]);
+        const auto edge20       = world * (surface.positions[2] - surface.positions[0]);
+        const auto quad_area    = glm::length(glm::cross(edge10, edge20));
+
+        const auto projection_cone_width    = ray_cone_width / std::abs(glm::dot(ray.dir, world_normal));
+        const auto visible_area_ratio       = (projection_cone_width * projection_cone_width) / quad_area;
+        const auto u_length                 = std::sqrt(quad_uv_area * visible_area_ratio);
+
+        const auto& material_data = _scene_data.getMaterials()[mesh_id];
+
+        Material material = { };
+        material.albedo     = glm::vec3(material_data.albedo.sampleGrad(surface.uv, u_length));
+        material.emissive   = glm::vec3(material_data.emissive.sampleGrad(surface.uv, u_length));
+        material.metallic   = material_data.metallic.sampleGrad(surface.uv, u_length).r;
+        material.roughness  = material_data.roughness.sampleGrad(surface.uv, u_length).r;
+
+        const auto normal_from_tangent_space = glm::vec3(material_data.normal_map.sampleGrad(surface.uv, u_length));
+
+        const glm::mat3 tbn (
+            surface.tangent,
+            glm::cross(surface.normal, surface.tangent),
+            surface.normal
+        );
+
+        const auto shading_normal = glm::normalize(tbn * (normal_from_tangent_space * 2.0f - 1.0f));
+
+        material.shading_normal = glm::normalize(transform.normal_matrix * shading_normal);
+
+        return material;
+    }
+
+    /// shaders/utils/ray.glsl: get_primary_ray
+    Ray CpuPathTracer::getPrimaryRay(uint32_t x, uint32_t y) const
+    {
+        const auto pixel_center = glm::vec2(x, y) + glm::vec2(0.5f);
+        const auto uv           = pixel_center / glm::vec2(_width, _height);
+        const auto d            = uv * 2.0f - 1.0f;
+
+        const auto origin   = _inv_view_matrix * glm::vec4(0, 0, 0, 1);
+        const auto target   = _inv_projection_matrix * glm::vec4(d.x, d.y, 1, 1);
+        const auto dir      = _inv_view_matrix * glm::vec4(glm::normalize(glm::vec3(target)), 0);
+
+        return Ray {glm::vec3(origin), glm::vec3(dir), ray_t_min};
+    }
+
+    auto CpuPathTracer::PathStatistics::operator += (const PathStatistics& statistics) noexcept
+        -> PathStatistics&
+    {
+        bounce_count            += statistics.bounce_count;
+        shadow_ray_count        += statistics.shadow_ray_count;
+        terminated_path_count   += statistics.terminated_path_count;
+
+        return *this;
+    }
+
+    /// junk_shop.glsl.rgen: main + rchit/rmiss
+    auto CpuPathTracer::tracePath(uint32_t x, uint32_t y, uint32_t frame, const std::optional<RayHit>& primary_hit) const
+        -> std::pair<glm::vec3, PathStatistics>
+    {
+        const auto pixel_seed = sobol::getPixelSeed(x, y);
+
+        glm::vec3 acc   (0.0f);
+        glm::vec3 abso  (1.0f);
+
+        auto ray = getPrimaryRay(x, y);
+
+        auto hit = primary_hit;
+
+        float brdf_pdf = 0.0f;
+
+        uint32_t bounce = 0;
+
+        PathStatistics statistics;
+
+        /// junk_shop.glsl.rchit: get_sample
+        const auto getSample = [frame, pixel_seed, &bounce] (uint32_t strategy)
+        {
+            const auto dimension = (bounce - 1) * dimensions_per_bounce + strategy;
+            return sobol::getSample(frame, sobol::getDimensionSeed(pixel_seed, dimension));
+        };
+
+        while (bounce < max_recursive)
+        {
+            if (++bounce > 1)
+                hit = _bvh->intersect(ray);
+
+            if (!hit)
+            {
+                acc += _environment_map.getRadiance(ray.dir) * abso * getEnvironmentMisWeight(ray.dir, brdf_pdf);
+                break;
+            }
+
+            const auto mesh_id  = getMeshId(hit->primitive_id);
+            const auto surface  = getSurface(*hit, mesh_id);
+            const auto material = getMaterial(ray, *hit, mesh_id, surface);
+
+            glm::vec3 out_dir (0.0f);
+
+            const auto brdf_u   = getSample(brdf_dimension);
+            const auto brdf     = pbr::sampleDisneyBRDF(glm::vec3(brdf_u), -ray.dir, material, out_dir);
+
+            acc += material.emissive * abso * getEmissionMisWeight(ray, *hit, mesh_id, surface, brdf_pdf);
+
+            const auto origin = surface.pos + surface.normal * eps;
+
+            const auto [direct_light, is_shadow_ray_traced] = sampleDirectLight(material, -ray.dir, origin, getSample(light_dimension));
+
+            acc += direct_light * abso;
+            statistics.shadow_ray_count += is_shadow_ray_traced ? 1 : 0;
+
+            if (brdf.pdf > eps)
+                abso *= brdf.result / brdf.pdf;
+
+            brdf_pdf = pbr::evalDisneyBRDF(-ray.dir, out_dir, material).pdf;
+
+            if (bounce >= _russian_roulette_min_bounces)
+            {
+                const auto survival_probability = std::min(std::max({abso.r, abso.g, abso.b}), 0.95f);
+
+                if (brdf_u.w >= survival_probability)
+                {
+                    ++statistics.terminated_path_count;
+                    break;
+                }
+
+                abso /= survival_probability;
+            }
+
+            ray.origin  = origin;
+            ray.dir     = out_dir;
+        }
+
+        statistics.bounce_count = bounce;
+
+        return std::make_pair(acc, statistics);
+    }
+
+    auto CpuPathTracer::renderTile(uint32_t tile_id, uint32_t first_frame, uint32_t sample_count)
+        -> PathStatistics
+    {
+        const auto tiles_x = (_width + tile_size - 1) / tile_size;
+
+        const auto x_begin  = (tile_id % tiles_x) * tile_size;
+        const auto y_begin  = (tile_id / tiles_x) * tile_size;
+        const auto x_end    = std::min(x_begin + tile_size, _width);
+        const auto y_end    = std::min(y_begin + tile_size, _height);
+
+        PathStatistics statistics;
+
+        std::array<Ray, tile_size>                      primary_rays;
+        std::array<std::optional<RayHit>, tile_size>    primary_hits;
+
+        const auto row_size = x_end - x_begin;
+
+        for (auto y: std::views::iota(y_begin, y_end))
+        {
+            /// Как get_image_coord в rgen: строки идут сверху вниз.
+            const auto row = _height - 1 - y;
+
+            for (auto x: std::views::iota(x_begin, x_end))
+                primary_rays[x - x_begin] = getPrimaryRay(x, y);
+
+            _bvh->intersect(std::span(primary_rays).first(row_size), std::span(primary_hits).first(row_size));
+
+            for (auto x: std::views::iota(x_begin, x_end))
+            {
+                if (const auto& hit = primary_hits[x - x_begin])
+                {
+                    const auto mesh_id  = getMeshId(hit->primitive_id);
+                    const auto surface  = getSurface(*hit, mesh_id);
+                    const auto material = getMaterial(primary_rays[x - x_begin], *hit, mesh_id, surface);
+
+                    _features.albedo[row * _width + x]  = material.albedo;
+                    _features.normal[row * _width + x]  = material.shading_normal;
+                    _features.depth[row * _width + x]   = hit->t;
+                }
+                glm::vec3 color     (0.0f);
+                glm::vec3 radiance  (0.0f);
+
+                for (auto frame: std::views::iota(first_frame, first_frame + sample_count))
+                {
+                    const auto [acc, path_statistics] = tracePath(x, y, frame, primary_hits[x - x_begin]);
+
+                    color       += whitePreservingLumaBasedReinhard(acc);
+                    radiance    += acc;
+                    statistics  += path_statistics;
+                }
+
+                _accumulated_color[row * _width + x]     += color;
+                _accumulated_radiance[row * _width + x]  += radiance;
+            }
+        }
+
+        return statistics;
+    }
+
+    void CpuPathTracer::setRussianRouletteMinBounces(uint32_t min_bounces) noexcept
+    {
+        _russian_roulette_min_bounces = min_bounces;
+    }
+
+    void CpuPathTracer::render(uint32_t sample_count)
+    {
+        if (!sample_count)
+            return ;
+
+        const auto tiles_x      = (_width + tile_size - 1) / tile_size;
+        const auto tiles_y      = (_height + tile_size - 1) / tile_size;
+        const auto first_frame  = _accumulated_frames_count;
+
+        PathStatistics  statistics;
+        std::mutex      statistics_mutex;
+
+        const auto start_time = std::chrono::steady_clock::now();
+
+        /// Тайлы не пересекаются, поэтому пишут в общие буферы накопления без синхронизации.
+        JobSystem::get().parallelFor(0, tiles_x * tiles_y, 1, [this, first_frame, sample_count, &statistics, &statistics_mutex] (size_t first, size_t last)
+        {
+            PathStatistics tiles_statistics;
+
+            for (auto tile_id: std::views::iota(first, last))
+                tiles_statistics += renderTile(static_cast<uint32_t>(tile_id), first_frame, sample_count);
+
+            std::lock_guard lock (statistics_mutex);
+            statistics += tiles_statistics;
+        });
+
+        const std::chrono::duration<double> render_time = std::chrono::steady_clock::now() - start_time;
+
+        _accumulated_frames_count += sample_count;
+
+        const auto path_count   = static_cast<double>(_width) * static_cast<double>(_height) * static_cast<double>(sample_count);
+        const auto ray_count    = static_cast<double>(statistics.bounce_count + statistics.shadow_ray_count);
+
+        log::info(
+            "[CpuPathTracer] {}x{}, {} samples: {:.3f} s, {:.2f} Mrays/s, average path length {:.2f}, terminated by russian roulette {:.1f}%", 
+            _width, _height, sample_count, 
+            render_time.count(), 
+            ray_count / render_time.count() * 1e-6,
+            static_cast<double>(statistics.bounce_count) / path_count,
+            static_cast<double>(statistics.terminated_path_count) / path_count * 100.0
+        );
+    }
+
+    std::vector<glm::vec3> CpuPathTracer::getResult() const
+    {
+        std::vector<glm::vec3> result (_accumulated_color.size(), glm::vec3(0.0f));
+
+        if (_accumulated_frames_count > 0)
+        {
+            std::ranges::transform(_accumulated_color, std::begin(result), [this] (const glm::vec3& color)
+            {
+                return color / static_cast<float>(_accumulated_frames_count);
+            });
+        }
+
+        return result;
+    }
+
+    std::vector<glm::vec3> CpuPathTracer::getRadiance() const
+    {
+        std::vector<glm::vec3> result (_accumulated_radiance.size(), glm::vec3(0.0f));
+
+        if (_accumulated_frames_count > 0)
+        {
+            std::ranges::transform(_accumulated_radiance, std::begin(result), [this] (const glm::vec3& radiance)
+            {
+                return radiance / static_cast<float>(_accumulated_frames_count);
+            });
+        }
+
+        return result;
+    }
+
+    const atrous::FeatureBuffers& CpuPathTracer::getFeatures() const noexcept
+    {
+        return _features;
+    }
+
+    void CpuPathTracer::saveFeatures(const std::filesystem::path& path) const
+    {
+        const auto getPath = [&path] (std::string_view name)
+        {
+            return path.parent_path() / std::format("{}_{}.exr", path.stem().string(), name);
+        };
+
+        std::vector<glm::vec3> depth (_features.depth.size());
+        std::ranges::transform(_features.depth, std::begin(depth), [] (float d) { return glm::vec3(d); });
+
+        image_writer::writeExr(getPath("albedo"), _width, _height, _features.albedo);
+        image_writer::writeExr(getPath("normal"), _width, _height, _features.normal);
+        image_writer::writeExr(getPath("depth"), _width, _height, depth);
+
+        log::info("[CpuPathTracer] Saved AOVs: {}", getPath("*").string());
+    }
+
+    void CpuPathTracer::save(const std::filesystem::path& path) const
+    {
+        const auto extension = path.extension();
+
+        if (extension == ".png")
+            image_writer::writePng(path, _width, _height, getResult());
+        else if (extension == ".exr")
+            image_writer::writeExr(path, _width, _height, getRadiance());
+        else
+            log::error("[CpuPathTracer] Unsupported output format: {}", path.string());
+
+        log::info("[CpuPathTracer] Saved: {}", path.string());
+    }
+
+    uint32_t CpuPathTracer::getAccumulatedFramesCount() const noexcept
+    {
+        return _accumulated_frames_count;
+    }
+}
+
+namespace vrts::junk_shop
+{
+    glm::vec3 getSkyColor(const glm::vec3& direction) noexcept
+    {
+        return skyColor(glm::vec2(direction.y, direction.z), 0.2f);
+    }
+
+    EnvironmentMap createEnvironmentMap()
+    {
+        const auto path = project_dir / "content/environment.hdr";
+
+        if (std::filesystem::exists(path))
+            return EnvironmentMap::load(path);
+
+        constexpr uint32_t width    = 512;
+        constexpr uint32_t height   = 256;
+
+        std::vector<glm::vec3> pixels (width * height);
+
+        for (auto y: std::views::iota(0u, height))
+        {
+            for (auto x: std::views::iota(0u, width))
+            {
+                const auto uv = (glm::vec2(x, y) + 0.5f) / glm::vec2(width, height);
+                pixels[y * width + x] = getSkyColor(EnvironmentMap::uvToDirection(uv));
+            }
+        }
+
+        return EnvironmentMap::build(width, height, std::move(pixels));
+    }
+
+    float getEnvironmentSelectionProbability(const EnvironmentMap& environment_map, size_t light_count) noexcept
+    {
+        if (environment_map.empty())
+            return 0.0f;
+
+        return light_count == 0 ? 1.0f : 0.5f;
+    }
+
+    void renderReference(
+        const std::filesystem::path&    output_path, 
+        uint32_t                        width, 
+        uint32_t                        height, 
+        uint32_t                        sample_count
+    )
+    {
+        /// Сцена и камера - как в JunkShop::importScene и JunkShop::initCamera.
+        auto scene_data = SceneData::Loader()
+            .path(project_dir / "content/Blender 2.glb")
+            .load();
+
+        const auto rect_transform =
+                glm::translate(glm::mat4(1), glm::vec3(-20, 10, 20))
+            *   glm::rotate(glm::mat4(1), glm::radians(-45.0f), glm::vec3(1, 0, 0))
+            *   glm::scale(glm::mat4(1), glm::vec3(30, 10, 1));
+
+        scene_data.addRect(glm::vec3(1, 1, 0), glm::vec3(2500), rect_transform);
+        scene_data.applyTransform(glm::scale(glm::mat4(1), glm::vec3(100)));
+
+        Camera camera (width, height);
+        camera.setDepthRange(0.01f, 1000.0f);
+        camera.lookaAt(glm::vec3(50, 1823.898, 5133.947), glm::vec3(-0.5, 0, 1));
+
+        CpuPathTracer path_tracer (scene_data, camera);
+        path_tracer.render(sample_count);
+        path_tracer.save(output_path);
+        path_tracer.saveFeatures(output_path);
+
+        const auto denoised = atrous::denoise(
+            path_tracer.getResult(), 
+            static_cast<float>(path_tracer.getAccumulatedFramesCount()), 
+            path_tracer.getFeatures()
+        );
+
+        const auto denoised_path = output_path.parent_path() / std::format("{}_denoised.png", output_path.stem().string());
+
+        image_writer::writePng(denoised_path, width, height, denoised);
+        log::info("[CpuPathTracer] Saved: {}", denoised_path.string());
+    }
+}
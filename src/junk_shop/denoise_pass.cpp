@@ -0,0 +1,403 @@
+#include <junk_shop/denoise_pass.hpp>
+
+#include <base/vulkan/context.hpp>
+#include <base/vulkan/utils.hpp>
+
+#include <base/logger/logger.hpp>
+#include <base/configuration.hpp>
+
+#include <base/shader_compiler.hpp>
+
+#include <ranges>
+
+namespace vrts::junk_shop
+{
+    DenoisePass::DenoisePass(const Context* ptr_context) :
+        _ptr_context (ptr_context)
+    { }
+
+    DenoisePass::DenoisePass(DenoisePass&& denoise_pass) :
+        _parameters             (denoise_pass._parameters),
+        _width                  (denoise_pass._width),
+        _height                 (denoise_pass._height),
+        _intermediate_images    (std::move(denoise_pass._intermediate_images)),
+        _ptr_context            (denoise_pass._ptr_context)
+    {
+        std::swap(_pipeline_handle, denoise_pass._pipeline_handle);
+        std::swap(_pipeline_layout, denoise_pass._pipeline_layout);
+        std::swap(_descriptor_set_layout, denoise_pass._descriptor_set_layout);
+        std::swap(_descriptor_pool_handle, denoise_pass._descriptor_pool_handle);
+        std::swap(_descriptor_set_handle, denoise_pass._descriptor_set_handle);
+    }
+
+    DenoisePass::~DenoisePass()
+    {
+        if (_descriptor_pool_handle != VK_NULL_HANDLE)
+            vkDestroyDescriptorPool(_ptr_context->device_handle, _descriptor_pool_handle, nullptr);
+
+        if (_descriptor_set_layout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(_ptr_context->device_handle, _descriptor_set_layout, nullptr);
+
+        if (_pipeline_layout != VK_NULL_HANDLE)
+            vkDestroyPipelineLayout(_ptr_context->device_handle, _pipeline_layout, nullptr);
+
+        if (_pipeline_handle != VK_NULL_HANDLE)
+            vkDestroyPipeline(_ptr_context->device_handle, _pipeline_handle, nullptr);
+    }
+
+    DenoisePass& DenoisePass::operator = (DenoisePass&& denoise_pass)
+    {
+        _parameters             = denoise_pass._parameters;
+        _width                  = denoise_pass._width;
+        _height                 = denoise_pass._height;
+        _intermediate_images    = std::move(denoise_pass._intermediate_images);
+        _ptr_context            = denoise_pass._ptr_context;
+
+        std::swap(_pipeline_handle, denoise_pass._pipeline_handle);
+        std::swap(_pipeline_layout, denoise_pass._pipeline_layout);
+        std::swap(_descriptor_set_layout, denoise_pass._descriptor_set_layout);
+        std::swap(_descriptor_pool_handle, denoise_pass._descriptor_pool_handle);
+        std::swap(_descriptor_set_handle, denoise_pass._descriptor_set_handle);
+
+        return *this;
+    }
+
+    void DenoisePass::createIntermediateImages()
+    {
+        for (auto i: std::views::iota(0u, static_cast<uint32_t>(_intermediate_images.size())))
+        {
+            _intermediate_images[i] = Image::Builder(_ptr_context)
+                .generateMipmap(false)
+                .size(_width, _height)
+                .vkFormat(VK_FORMAT_R32G32B32A32_SFLOAT)
+                .build();
+
+            VkUtils::setName(
+                _ptr_context->device_handle,
+                *_intermediate_images[i],
+                VK_OBJECT_TYPE_IMAGE,
+                std::format("[DenoisePass] Intermediate image {}", i)
+            );
+        }
+    }
+
+    void DenoisePass::resize(uint32_t width, uint32_t height)
+    {
+        _width  = width;
+        _height = height;
+
+        createIntermediateImages();
+    }
+
+    void DenoisePass::updateDescriptorSet(
+        VkImageView source,
+        VkImageView albedo,
+        VkImageView normal,
+        VkImageView depth,
+        VkImageView result
+    )
+    {
+        const auto createImageInfo = [] (VkImageView image_view_handle)
+        {
+            return VkDescriptorImageInfo
+            {
+                .imageView      = image_view_handle,
+                .imageLayout    = VK_IMAGE_LAYOUT_GENERAL
+            };
+        };
+
+        std::array<VkDescriptorImageInfo, Images::count> colors_info;
+        colors_info[Images::source] = createImageInfo(source);
+        colors_info[Images::ping]   = createImageInfo(_intermediate_images[0]->view_handle);
+        colors_info[Images::pong]   = createImageInfo(_intermediate_images[1]->view_handle);
+        colors_info[Images::result] = createImageInfo(result);
+
+        const std::array<VkDescriptorImageInfo, Bindings::count> images_info
+        {
+            VkDescriptorImageInfo { },
+            createImageInfo(albedo),
+            createImageInfo(normal),
+            createImageInfo(depth)
+        };
+
+        std::array<VkWriteDescriptorSet, Bindings::count> write_infos;
+
+        for (auto i: std::views::iota(0u, write_infos.size()))
+        {
+            write_infos[i] = { };
+            write_infos[i].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write_infos[i].descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            write_infos[i].dstArrayElement  = 0;
+            write_infos[i].dstBinding       = static_cast<uint32_t>(i);
+            write_infos[i].dstSet           = _descriptor_set_handle;
+            write_infos[i].descriptorCount  = 1;
+            write_infos[i].pImageInfo       = &images_info[i];
+        }
+
+        write_infos[Bindings::colors].descriptorCount   = static_cast<uint32_t>(colors_info.size());
+        write_infos[Bindings::colors].pImageInfo        = colors_info.data();
+
+        vkUpdateDescriptorSets(
+            _ptr_context->device_handle,
+            static_cast<uint32_t>(write_infos.size()), write_infos.data(),
+            0, nullptr
+        );
+    }
+
+    void DenoisePass::process(VkCommandBuffer command_buffer_handle) const
+    {
+        constexpr uint32_t group_size = 8;
+
+        vkCmdBindPipeline(command_buffer_handle, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline_handle);
+
+        vkCmdBindDescriptorSets(
+            command_buffer_handle,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            _pipeline_layout,
+            0,
+            1, &_descriptor_set_handle,
+            0, nullptr
+        );
+
+        const VkMemoryBarrier iteration_barrier
+        {
+            .sType          = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask  = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask  = VK_ACCESS_SHADER_READ_BIT
+        };
+
+        uint32_t src = Images::source;
+
+        for (auto iteration: std::views::iota(0u, _parameters.iteration_count))
+        {
+            const auto is_last = iteration + 1 == _parameters.iteration_count;
+
+            const uint32_t dst = is_last ? Images::result : (src == Images::ping ? Images::pong : Images::ping);
+
+            const PushConstants push_constants
+            {
+                .src            = src,
+                .dst            = dst,
+                .step_size      = static_cast<int32_t>(1u << iteration),
+                .color_sigma    = _parameters.color_sigma,
+                .normal_sigma   = _parameters.normal_sigma,
+                .depth_sigma    = _parameters.depth_sigma,
+                .albedo_sigma   = _parameters.albedo_sigma
+            };
+
+            vkCmdPushConstants(
+                command_buffer_handle,
+                _pipeline_layout,
+                VK_SHADER_STAGE_COMPUTE_BIT,
+                0, sizeof(PushConstants), &push_constants
+            );
+
+            vkCmdDispatch(
+                command_buffer_handle,
+                (_width + group_size - 1) / group_size,
+                (_height + group_size - 1) / group_size,
+                1
+            );
+
+            if (!is_last)
+            {
+                vkCmdPipelineBarrier(
+                    command_buffer_handle,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                    1, &iteration_barrier,
+                    0, nullptr,
+                    0, nullptr
+                );
+            }
+
+            src = dst;
+        }
+    }
+}
+
+namespace vrts::junk_shop
+{
+    DenoisePass::Builder::Builder(const Context* ptr_context) :
+        _ptr_context(ptr_context)
+    {
+        if (!ptr_context)
+            log::error("[DenoisePass::Builder] Vulkan context is null");
+    }
+
+    DenoisePass::Builder::~Builder()
+    {
+        vkDestroyShaderModule(_ptr_context->device_handle, _compute_shader_handle, nullptr);
+    }
+
+    DenoisePass::Builder& DenoisePass::Builder::parameters(const atrous::Parameters& parameters) noexcept
+    {
+        _parameters = parameters;
+        return *this;
+    }
+
+    DenoisePass::Builder& DenoisePass::Builder::size(uint32_t width, uint32_t height) noexcept
+    {
+        _width  = width;
+        _height = height;
+        return *this;
+    }
+
+    void DenoisePass::Builder::createPipelineLayout()
+    {
+        log::info("[DenoisePass::Builder] Create pipeline layout");
+
+        std::array<VkDescriptorSetLayoutBinding, Bindings::count> bindings_info;
+
+        for (auto i: std::views::iota(0u, bindings_info.size()))
+        {
+            bindings_info[i] = { };
+            bindings_info[i].binding            = static_cast<uint32_t>(i);
+            bindings_info[i].descriptorCount    = 1;
+            bindings_info[i].descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            bindings_info[i].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        bindings_info[Bindings::colors].descriptorCount = Images::count;
+
+        const VkDescriptorSetLayoutCreateInfo descriptor_set_info
+        {
+            .sType           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount    = static_cast<uint32_t>(bindings_info.size()),
+            .pBindings       = bindings_info.data()
+        };
+
+        VK_CHECK(vkCreateDescriptorSetLayout(
+            _ptr_context->device_handle,
+            &descriptor_set_info,
+            nullptr,
+            &_descriptor_set_layout
+        ));
+
+        constexpr VkPushConstantRange push_constant_range
+        {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset     = 0,
+            .size       = sizeof(PushConstants)
+        };
+
+        const VkPipelineLayoutCreateInfo layout_info
+        {
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = 1,
+            .pSetLayouts            = &_descriptor_set_layout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &push_constant_range
+        };
+
+        VK_CHECK(vkCreatePipelineLayout(
+            _ptr_context->device_handle,
+            &layout_info,
+            nullptr,
+            &_pipeline_layout
+        ));
+    }
+
+    void DenoisePass::Builder::createPipeline()
+    {
+        log::info("[DenoisePass::Builder] Create compute pipeline");
+
+        const auto shader_name = project_dir / "shaders/junk_shop/atrous.glsl.comp";
+
+        _compute_shader_handle = shader::Compiler::createShaderModule(
+            _ptr_context->device_handle,
+            shader_name,
+            shader::Type::compute
+        );
+
+        const VkPipelineShaderStageCreateInfo stage
+        {
+            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = _compute_shader_handle,
+            .pName  = "main"
+        };
+
+        const VkComputePipelineCreateInfo pipeline_info
+        {
+            .sType     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage     = stage,
+            .layout    = _pipeline_layout
+        };
+
+        VK_CHECK(vkCreateComputePipelines(
+            _ptr_context->device_handle,
+            VK_NULL_HANDLE,
+            1, &pipeline_info,
+            nullptr,
+            &_pipeline_handle
+        ));
+    }
+
+    void DenoisePass::Builder::createDescriptorPool()
+    {
+        constexpr VkDescriptorPoolSize descriptor_size
+        {
+            .type               = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount    = Images::count + Bindings::count - 1
+        };
+
+        const VkDescriptorPoolCreateInfo descriptor_pool_info
+        {
+            .sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets        = 1,
+            .poolSizeCount  = 1,
+            .pPoolSizes     = &descriptor_size
+        };
+
+        VK_CHECK(vkCreateDescriptorPool(
+            _ptr_context->device_handle,
+            &descriptor_pool_info,
+            nullptr,
+            &_descriptor_pool_handle
+        ));
+    }
+
+    void DenoisePass::Builder::allocateDescriptorSet()
+    {
+        const VkDescriptorSetAllocateInfo allocate_info
+        {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = _descriptor_pool_handle,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &_descriptor_set_layout
+        };
+
+        VK_CHECK(vkAllocateDescriptorSets(_ptr_context->device_handle, &allocate_info, &_descriptor_set_handle));
+
+        VkUtils::setName(
+            _ptr_context->device_handle,
+            _descriptor_set_handle,
+            VK_OBJECT_TYPE_DESCRIPTOR_SET,
+            "[DenoisePass] Descriptor set"
+        );
+    }
+
+    DenoisePass DenoisePass::Builder::build()
+    {
+        if (_parameters.iteration_count == 0)
+            log::error("[DenoisePass::Builder] Iteration count must be positive");
+
+        createPipelineLayout();
+        createPipeline();
+        createDescriptorPool();
+        allocateDescriptorSet();
+
+        DenoisePass denoise_pass (_ptr_context);
+
+        denoise_pass._parameters                = _parameters;
+        denoise_pass._pipeline_handle           = _pipeline_handle;
+        denoise_pass._pipeline_layout           = _pipeline_layout;
+        denoise_pass._descriptor_set_layout     = _descriptor_set_layout;
+        denoise_pass._descriptor_pool_handle    = _descriptor_pool_handle;
+        denoise_pass._descriptor_set_handle     = _descriptor_set_handle;
+
+        denoise_pass.resize(_width, _height);
+
+        return denoise_pass;
+    }
+}
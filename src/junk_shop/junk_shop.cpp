@@ -1,10 +1,16 @@
 #include <junk_shop/junk_shop.hpp>
+#include <junk_shop/cpu_path_tracer.hpp>
 #include <base/scene/visitors/acceleration_structure_builder.hpp>
 #include <base/scene/visitors/scene_geometry_references_getter.hpp>
+#include <base/scene/environment_map.hpp>
 
 #include <base/shader_compiler.hpp>
+#include <base/image_writer.hpp>
+#include <base/sobol.hpp>
 
 #include <ranges>
+#include <algorithm>
+#include <fstream>
 
 using namespace junk_shop;
 
@@ -23,11 +29,21 @@ void JunkShop::init()
 	
 	importScene();
 	initCamera();
-
-	createAccumulationBuffer();
+	createAS();
+	createLightSampler();
+	createEnvironment();
+	createSobolDirections();
+	createPathStatisticsBuffer();
+	createReprojectionBuffer();
+
+	createAccumulationBuffers();
+	createAovImages();
+	createDenoisePass();
+	createAdaptiveSamplingBuffers();
 	createPipeline();
 	createShaderBindingTable();
 	createDescriptorSets();
+	createWavefrontPass();
 
 	buildCommandBuffers();
 }
@@ -45,7 +61,12 @@ void JunkShop::resizeWindow()
 	createSwapchain();
 	getSwapchainImages();
 	createSwapchainImageViews();
-	createAccumulationBuffer();
+	createAccumulationBuffers();
+	createAovImages();
+	createAdaptiveSamplingBuffers();
+
+	_denoiser.pass->resize(width, height);
+	_wavefront.pass->resize(width, height);
 
 	buildCommandBuffers();
 }
@@ -87,7 +108,7 @@ auto JunkShop::createDescriptorBufferInfo(VkBuffer buffer_handle, VkDeviceSize s
 	return buffer_info;
 }
 
-void JunkShop::updateDescriptorSet(uint32_t image_index)
+void JunkShop::updateDescriptorSet(VkImageView result_view_handle)
 {
 	auto root_tlas_handle = _scene->getModel().getRootTLAS();
 	if (!root_tlas_handle)
@@ -103,33 +124,75 @@ void JunkShop::updateDescriptorSet(uint32_t image_index)
 	};
 
 	/*	--------------- rendering result ----------------------	*/
-	auto result_image_info = createDescriptorImageInfo(_swapchain_image_view_handles[image_index]);
+	auto result_image_info = createDescriptorImageInfo(result_view_handle);
 
 	/*	------------------------------------------------------	*/
 	/*	--------------- accumulated buffer ----------------------	*/
-	auto accumulated_buffer_info = createDescriptorImageInfo(_accumulation_buffer->view_handle);
+	const auto history_buffer_index = _current_buffer_index ^ 1;
+
+	auto accumulated_buffer_info	= createDescriptorImageInfo(_accumulation_buffers[_current_buffer_index]->view_handle);
+	auto history_buffer_info		= createDescriptorImageInfo(_accumulation_buffers[history_buffer_index]->view_handle);
+	auto depth_buffer_info			= createDescriptorImageInfo(_depth_buffers[_current_buffer_index]->view_handle);
+	auto history_depth_buffer_info	= createDescriptorImageInfo(_depth_buffers[history_buffer_index]->view_handle);
+	auto moments_buffer_info		= createDescriptorImageInfo(_moment_buffers[_current_buffer_index]->view_handle);
+	auto history_moments_info		= createDescriptorImageInfo(_moment_buffers[history_buffer_index]->view_handle);
 
 	/*	------------------------------------------------------	*/
 	/*	---------------- scene geometry	----------------------	*/
 	auto buffer_info = createDescriptorBufferInfo(_vertex_buffers_references.scene_info_reference->vk_handle, sizeof(VkDeviceAddress) * 2);
 
+	/*	------------------------------------------------------	*/
+	/*	-------------------	light sampler	------------------	*/
+	auto light_sampler_info = createDescriptorBufferInfo(_light_sampler.info->vk_handle, sizeof(LightSamplerInfo));
+
+	/*	------------------------------------------------------	*/
+	/*	--------------------	environment	------------------	*/
+	auto environment_info = createDescriptorBufferInfo(_environment.info->vk_handle, sizeof(EnvironmentInfo));
+
+	/*	------------------------------------------------------	*/
+	/*	-----------------------	sobol	----------------------	*/
+	auto sobol_info = createDescriptorBufferInfo(_sobol.reference->vk_handle, sizeof(VkDeviceAddress));
+
+	/*	------------------------------------------------------	*/
+	/*	------------------	path statistics	------------------	*/
+	auto path_statistics_info = createDescriptorBufferInfo(_path_statistics.buffer->vk_handle, sizeof(PathStatistics));
+
+	/*	------------------------------------------------------	*/
+	/*	-------------------	reprojection	------------------	*/
+	auto reprojection_info = createDescriptorBufferInfo(_reprojection.buffer->vk_handle, sizeof(ReprojectionData));
+
+	/*	------------------------------------------------------	*/
+	/*	-----------------------	AOV	--------------------------	*/
+	auto albedo_aov_info = createDescriptorImageInfo(_denoiser.albedo_aov->view_handle);
+	auto normal_aov_info = createDescriptorImageInfo(_denoiser.normal_aov->view_handle);
+
+	/*	------------------------------------------------------	*/
+	/*	-----------------	adaptive sampling	--------------	*/
+	const auto tile_errors_size = sizeof(uint32_t) * _adaptive_sampling.tile_count;
+
+	auto adaptive_sampling_info		= createDescriptorBufferInfo(_adaptive_sampling.data->vk_handle, sizeof(AdaptiveSamplingData));
+	auto tile_errors_info			= createDescriptorBufferInfo(_adaptive_sampling.tile_errors[_current_buffer_index]->vk_handle, tile_errors_size);
+	auto history_tile_errors_info	= createDescriptorBufferInfo(_adaptive_sampling.tile_errors[history_buffer_index]->vk_handle, tile_errors_size);
+
 	/*	------------------------------------------------------	*/
 	/*	--------------------	materials	------------------	*/
-	auto materials = material_manager.getMaterials();
+	const auto instance_count = material_manager.getInstanceCount();
 
-	std::vector<VkDescriptorImageInfo> albedos_infos 		(materials.size());
-	std::vector<VkDescriptorImageInfo> normal_maps_infos 	(materials.size());
-	std::vector<VkDescriptorImageInfo> metallic_infos 		(materials.size());
-	std::vector<VkDescriptorImageInfo> roughness_infos 		(materials.size());
-	std::vector<VkDescriptorImageInfo> emissive_infos 		(materials.size());
+	std::vector<VkDescriptorImageInfo> albedos_infos 		(instance_count);
+	std::vector<VkDescriptorImageInfo> normal_maps_infos 	(instance_count);
+	std::vector<VkDescriptorImageInfo> metallic_infos 		(instance_count);
+	std::vector<VkDescriptorImageInfo> roughness_infos 		(instance_count);
+	std::vector<VkDescriptorImageInfo> emissive_infos 		(instance_count);
 
-	for (auto i: std::views::iota(0u, materials.size()))
+	for (auto i: std::views::iota(0u, instance_count))
 	{
-		albedos_infos[i] 		= createDescriptorImageInfo(materials[i].albedo.value());
-		normal_maps_infos[i] 	= createDescriptorImageInfo(materials[i].normal_map.value());
-		metallic_infos[i] 		= createDescriptorImageInfo(materials[i].metallic.value());
-		roughness_infos[i] 		= createDescriptorImageInfo(materials[i].roughness.value());
-		emissive_infos[i] 		= createDescriptorImageInfo(materials[i].emissive.value());
+		const auto& material = material_manager.getInstanceMaterial(i);
+
+		albedos_infos[i] 		= createDescriptorImageInfo(material.albedo.value());
+		normal_maps_infos[i] 	= createDescriptorImageInfo(material.normal_map.value());
+		metallic_infos[i] 		= createDescriptorImageInfo(material.metallic.value());
+		roughness_infos[i] 		= createDescriptorImageInfo(material.roughness.value());
+		emissive_infos[i] 		= createDescriptorImageInfo(material.emissive.value());
 	}
 
 	/*	------------------------------------------------------	*/
@@ -176,12 +239,65 @@ void JunkShop::updateDescriptorSet(uint32_t image_index)
 	write_infos[DescriptorSets::emissive].descriptorCount	= static_cast<uint32_t>(emissive_infos.size());
 	write_infos[DescriptorSets::emissive].pImageInfo 		= emissive_infos.data();
 	write_infos[DescriptorSets::emissive].descriptorType 	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+	write_infos[DescriptorSets::light_sampler].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::light_sampler].pBufferInfo		= &light_sampler_info;
+
+	write_infos[DescriptorSets::sobol].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::sobol].pBufferInfo		= &sobol_info;
+
+	write_infos[DescriptorSets::path_statistics].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::path_statistics].pBufferInfo	= &path_statistics_info;
+
+	write_infos[DescriptorSets::history_buffer].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write_infos[DescriptorSets::history_buffer].pImageInfo		= &history_buffer_info;
+
+	write_infos[DescriptorSets::depth_buffer].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write_infos[DescriptorSets::depth_buffer].pImageInfo		= &depth_buffer_info;
+
+	write_infos[DescriptorSets::history_depth_buffer].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write_infos[DescriptorSets::history_depth_buffer].pImageInfo		= &history_depth_buffer_info;
+
+	write_infos[DescriptorSets::reprojection].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::reprojection].pBufferInfo		= &reprojection_info;
+
+	write_infos[DescriptorSets::albedo_aov].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write_infos[DescriptorSets::albedo_aov].pImageInfo		= &albedo_aov_info;
+
+	write_infos[DescriptorSets::normal_aov].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write_infos[DescriptorSets::normal_aov].pImageInfo		= &normal_aov_info;
+
+	write_infos[DescriptorSets::moments_buffer].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write_infos[DescriptorSets::moments_buffer].pImageInfo		= &moments_buffer_info;
+
+	write_infos[DescriptorSets::history_moments_buffer].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write_infos[DescriptorSets::history_moments_buffer].pImageInfo		= &history_moments_info;
+
+	write_infos[DescriptorSets::adaptive_sampling].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::adaptive_sampling].pBufferInfo		= &adaptive_sampling_info;
+
+	write_infos[DescriptorSets::tile_errors].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::tile_errors].pBufferInfo	= &tile_errors_info;
+
+	write_infos[DescriptorSets::history_tile_errors].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::history_tile_errors].pBufferInfo	= &history_tile_errors_info;
+
+	write_infos[DescriptorSets::environment].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write_infos[DescriptorSets::environment].pBufferInfo	= &environment_info;
 	
 	vkUpdateDescriptorSets(
 		_context.device_handle, 
 		static_cast<uint32_t>(write_infos.size()), write_infos.data(), 
 		0, nullptr
 	);
+
+	_denoiser.pass->updateDescriptorSet(
+		_accumulation_buffers[_current_buffer_index]->view_handle,
+		_denoiser.albedo_aov->view_handle,
+		_denoiser.normal_aov->view_handle,
+		_depth_buffers[_current_buffer_index]->view_handle,
+		result_view_handle
+	);
 }
 
 bool JunkShop::processEvents()
@@ -199,6 +315,45 @@ bool JunkShop::processEvents()
 			case SDL_KEYUP:
 				if (event.key.keysym.scancode == SDL_SCANCODE_ESCAPE)
 					return false;
+				if (event.key.keysym.scancode == SDL_SCANCODE_R)
+				{
+					_reprojection.is_enabled = !_reprojection.is_enabled;
+					_draw_stay = DrawStay::clear;
+
+					log::info("[JunkShop] Temporal reprojection: {}", _reprojection.is_enabled ? "on" : "off");
+					break;
+				}
+				if (event.key.keysym.scancode == SDL_SCANCODE_M)
+				{
+					_wavefront.is_enabled = !_wavefront.is_enabled;
+					_draw_stay = DrawStay::clear;
+
+					log::info("[JunkShop] Wavefront path tracing: {}", _wavefront.is_enabled ? "on" : "off");
+					break;
+				}
+				if (event.key.keysym.scancode == SDL_SCANCODE_F)
+				{
+					_denoiser.is_enabled = !_denoiser.is_enabled;
+
+					/// AOV пишутся только для трассируемых пикселей: сошедшиеся тайлы перезапускаются, иначе фильтру нечего читать.
+					_draw_stay = DrawStay::clear;
+
+					log::info("[JunkShop] Denoiser: {}", _denoiser.is_enabled ? "on" : "off");
+					break;
+				}
+				if (event.key.keysym.scancode == SDL_SCANCODE_Q)
+				{
+					_render_scale.is_enabled = !_render_scale.is_enabled;
+					log::info("[JunkShop] Dynamic resolution: {}", _render_scale.is_enabled ? "on" : "off");
+				}
+				if (event.key.keysym.scancode == SDL_SCANCODE_V)
+				{
+					_adaptive_sampling.settings.is_enabled = _adaptive_sampling.settings.is_enabled ? 0 : 1;
+					updateAdaptiveSamplingData();
+					restartConvergenceTimer();
+
+					log::info("[JunkShop] Adaptive sampling: {}", _adaptive_sampling.settings.is_enabled ? "on" : "off");
+				}
 				_draw_stay = DrawStay::draw;
 				break;
 			case SDL_MOUSEBUTTONUP:
@@ -206,7 +361,9 @@ bool JunkShop::processEvents()
 				break;
 			case SDL_KEYDOWN:
 			case SDL_MOUSEBUTTONDOWN:
-				_draw_stay = DrawStay::clear;
+				/// С репроекцией накопление при движении камеры не сбрасывается. В wavefront-режиме репроекции нет.
+				if (!_reprojection.is_enabled || _wavefront.is_enabled)
+					_draw_stay = DrawStay::clear;
 				break;
 			case SDL_WINDOWEVENT:
 				if (event.window.event == SDL_WINDOWEVENT_RESIZED)
@@ -225,71 +382,109 @@ void JunkShop::show()
 {
 	log::info("Sample running !!!");
 
+	_render_scale.last_frame_time = std::chrono::steady_clock::now();
+
 	while (processEvents())
 	{
 		if (_draw_stay == DrawStay::clear)
 		{
 			_accumulated_frames_count = 0;
 			_draw_stay = DrawStay::draw;
+
+			restartConvergenceTimer();
 		}
 		else
 			++_accumulated_frames_count;
 
 		_scene->updateCamera();
+
+		const auto eye = glm::vec3(_scene->getCameraController().getCamera().getInvViewMatrix() * glm::vec4(0, 0, 0, 1));
+
+		if (eye != _lod_eye)
+			updateLods();
 		
 		auto image_index = getNextImageIndex();
 		if (auto is_resize_window = image_index == std::numeric_limits<uint32_t>::max(); is_resize_window)
 			continue;
 
-		updateDescriptorSet(image_index);
+		updateReprojection();
+
+		if (_reprojection.is_camera_moved)
+			restartConvergenceTimer();
+
+		updateRenderScale();
+
+		updateDescriptorSet(_swapchain_image_view_handles[image_index]);
 
 		auto command_buffer_for_trace_ray = getCommandBuffer();
 
-		command_buffer_for_trace_ray.write([this](VkCommandBuffer command_buffer_handle)
+		if (_wavefront.is_enabled)
 		{
-			auto push_constant_data = getPushConstantData();
-
-			auto func_table = VkUtils::getVulkanFunctionPointerTable();
-
-			auto [width, height] = _window->getSize();
-
-			vkCmdBindPipeline(
-				command_buffer_handle,
-				VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
-				_pipeline
-			);
-
-			vkCmdBindDescriptorSets(
-				command_buffer_handle,
-				VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
-				_pipeline_layout,
-				0, 1, &_descriptor_set,
-				0, nullptr
-			);
-
-			vkCmdPushConstants(
-				command_buffer_handle,
-				_pipeline_layout, VK_SHADER_STAGE_RAYGEN_BIT_KHR,
-				0, sizeof(PushConstants::RayGen), &push_constant_data.rgen_consts
-			);
-
-			vkCmdPushConstants(
-				command_buffer_handle,
-				_pipeline_layout, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
-				sizeof(PushConstants::RayGen), sizeof(PushConstants::ClosestHit), &push_constant_data.chit_consts
-			);
-
-			func_table.vkCmdTraceRaysKHR(
-				command_buffer_handle,
-				&_sbt.raygen_region,
-				&_sbt.miss_region,
-				&_sbt.chit_region,
-				&_sbt.callable_region,
-				width, height, 1
-			);
-		}, "Run drawing", GpuMarkerColors::run_ray_tracing_pipeline);
-
-		command_buffer_for_trace_ray.upload(getContext());
+			command_buffer_for_trace_ray.write([this](VkCommandBuffer command_buffer_handle)
+			{
+				_wavefront.pass->process(command_buffer_handle, _descriptor_set, getWavefrontPushConstantData());
+			}, "Run wavefront path tracing", GpuMarkerColors::run_ray_tracing_pipeline);
+
+			command_buffer_for_trace_ray.upload(getContext());
+
+			processQueueStatistics();
+		}
+		else
+		{
+			command_buffer_for_trace_ray.write([this](VkCommandBuffer command_buffer_handle)
+			{
+				auto [width, height] = _window->getSize();
+
+				const auto scale = _render_scale.scale;
+
+				clearFrameCounters(command_buffer_handle);
+				traceRays(command_buffer_handle, getPushConstantData(), (width + scale - 1) / scale, (height + scale - 1) / scale);
+
+				const VkMemoryBarrier read_statistics_barrier
+				{
+					.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+					.srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT,
+					.dstAccessMask	= VK_ACCESS_HOST_READ_BIT
+				};
+
+				vkCmdPipelineBarrier(
+					command_buffer_handle,
+					VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_HOST_BIT, 0,
+					1, &read_statistics_barrier,
+					0, nullptr,
+					0, nullptr
+				);
+
+				if (_denoiser.is_enabled)
+				{
+					const VkMemoryBarrier denoise_barrier
+					{
+						.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+						.srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT,
+						.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+					};
+
+					vkCmdPipelineBarrier(
+						command_buffer_handle,
+						VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+						1, &denoise_barrier,
+						0, nullptr,
+						0, nullptr
+					);
+
+					_denoiser.pass->process(command_buffer_handle);
+				}
+			}, "Run drawing", GpuMarkerColors::run_ray_tracing_pipeline);
+
+			command_buffer_for_trace_ray.upload(getContext());
+
+			const auto statistics = processPathStatistics();
+
+			if (_render_scale.scale == 1)
+				processTileErrors(statistics);
+		}
+
+		_current_buffer_index ^= 1;
 
 		VkResult result = VK_RESULT_MAX_ENUM;
 
@@ -318,9 +513,76 @@ void JunkShop::show()
 	}
 }
 
+void JunkShop::clearFrameCounters(VkCommandBuffer command_buffer_handle) const
+{
+	vkCmdFillBuffer(command_buffer_handle, _path_statistics.buffer->vk_handle, 0, VK_WHOLE_SIZE, 0);
+	vkCmdFillBuffer(command_buffer_handle, _adaptive_sampling.tile_errors[_current_buffer_index]->vk_handle, 0, VK_WHOLE_SIZE, 0);
+
+	/// Заодно делает видимыми записи прошлого кадра, даже если он отправлялся отдельно.
+	const VkMemoryBarrier clear_statistics_barrier
+	{
+		.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+		.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	};
+
+	vkCmdPipelineBarrier(
+		command_buffer_handle,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0,
+		1, &clear_statistics_barrier,
+		0, nullptr,
+		0, nullptr
+	);
+}
+
+void JunkShop::traceRays(
+	VkCommandBuffer			command_buffer_handle, 
+	const PushConstants&	push_constants, 
+	uint32_t				width, 
+	uint32_t				height
+) const
+{
+	auto func_table = VkUtils::getVulkanFunctionPointerTable();
+
+	vkCmdBindPipeline(
+		command_buffer_handle,
+		VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
+		_pipeline
+	);
+
+	vkCmdBindDescriptorSets(
+		command_buffer_handle,
+		VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
+		_pipeline_layout,
+		0, 1, &_descriptor_set,
+		0, nullptr
+	);
+
+	vkCmdPushConstants(
+		command_buffer_handle,
+		_pipeline_layout, VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+		0, sizeof(PushConstants::RayGen), &push_constants.rgen_consts
+	);
+
+	vkCmdPushConstants(
+		command_buffer_handle,
+		_pipeline_layout, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR,
+		sizeof(PushConstants::RayGen), sizeof(PushConstants::ClosestHit), &push_constants.chit_consts
+	);
+
+	func_table.vkCmdTraceRaysKHR(
+		command_buffer_handle,
+		&_sbt.raygen_region,
+		&_sbt.miss_region,
+		&_sbt.chit_region,
+		&_sbt.callable_region,
+		width, height, 1
+	);
+}
+
 DescriptorSetsBindings JunkShop::getPipelineDescriptorSetsBindings() const
 {
-	auto materials = _scene->getModel().getMaterialManager().getMaterials();
+	const auto instance_count = _scene->getModel().getMaterialManager().getInstanceCount();
 
 	std::array<VkDescriptorSetLayoutBinding, DescriptorSets::count> bindings;
 
@@ -350,34 +612,86 @@ DescriptorSetsBindings JunkShop::getPipelineDescriptorSetsBindings() const
 
 	bindings[DescriptorSets::albedos] = { };
 	bindings[DescriptorSets::albedos].binding			= DescriptorSets::albedos;
-	bindings[DescriptorSets::albedos].descriptorCount	= static_cast<uint32_t>(materials.size());
+	bindings[DescriptorSets::albedos].descriptorCount	= static_cast<uint32_t>(instance_count);
 	bindings[DescriptorSets::albedos].descriptorType	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	bindings[DescriptorSets::albedos].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
 
 	bindings[DescriptorSets::normal_maps] = { };
 	bindings[DescriptorSets::normal_maps].binding			= DescriptorSets::normal_maps;
-	bindings[DescriptorSets::normal_maps].descriptorCount	= static_cast<uint32_t>(materials.size());
+	bindings[DescriptorSets::normal_maps].descriptorCount	= static_cast<uint32_t>(instance_count);
 	bindings[DescriptorSets::normal_maps].descriptorType	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	bindings[DescriptorSets::normal_maps].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
 
 	bindings[DescriptorSets::metallic] = { };
 	bindings[DescriptorSets::metallic].binding			= DescriptorSets::metallic;
-	bindings[DescriptorSets::metallic].descriptorCount	= static_cast<uint32_t>(materials.size());
+	bindings[DescriptorSets::metallic].descriptorCount	= static_cast<uint32_t>(instance_count);
 	bindings[DescriptorSets::metallic].descriptorType	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	bindings[DescriptorSets::metallic].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
 
 	bindings[DescriptorSets::roughness] = { };
 	bindings[DescriptorSets::roughness].binding			= DescriptorSets::roughness;
-	bindings[DescriptorSets::roughness].descriptorCount	= static_cast<uint32_t>(materials.size());
+	bindings[DescriptorSets::roughness].descriptorCount	= static_cast<uint32_t>(instance_count);
 	bindings[DescriptorSets::roughness].descriptorType	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	bindings[DescriptorSets::roughness].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
 	
 	bindings[DescriptorSets::emissive] = { };
 	bindings[DescriptorSets::emissive].binding			= DescriptorSets::emissive;
-	bindings[DescriptorSets::emissive].descriptorCount	= static_cast<uint32_t>(materials.size());
+	bindings[DescriptorSets::emissive].descriptorCount	= static_cast<uint32_t>(instance_count);
 	bindings[DescriptorSets::emissive].descriptorType	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	bindings[DescriptorSets::emissive].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
 
+	bindings[DescriptorSets::light_sampler] = { };
+	bindings[DescriptorSets::light_sampler].binding			= DescriptorSets::light_sampler;
+	bindings[DescriptorSets::light_sampler].descriptorCount	= 1;
+	bindings[DescriptorSets::light_sampler].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[DescriptorSets::light_sampler].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
+
+	bindings[DescriptorSets::sobol] = { };
+	bindings[DescriptorSets::sobol].binding			= DescriptorSets::sobol;
+	bindings[DescriptorSets::sobol].descriptorCount	= 1;
+	bindings[DescriptorSets::sobol].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[DescriptorSets::sobol].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
+
+	bindings[DescriptorSets::path_statistics] = { };
+	bindings[DescriptorSets::path_statistics].binding			= DescriptorSets::path_statistics;
+	bindings[DescriptorSets::path_statistics].descriptorCount	= 1;
+	bindings[DescriptorSets::path_statistics].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[DescriptorSets::path_statistics].stageFlags		= VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+
+	for (auto binding: {DescriptorSets::history_buffer, DescriptorSets::depth_buffer, DescriptorSets::history_depth_buffer, DescriptorSets::albedo_aov, DescriptorSets::normal_aov, DescriptorSets::moments_buffer, DescriptorSets::history_moments_buffer})
+	{
+		bindings[binding] = { };
+		bindings[binding].binding			= static_cast<uint32_t>(binding);
+		bindings[binding].descriptorCount	= 1;
+		bindings[binding].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		bindings[binding].stageFlags		= VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+	}
+
+	bindings[DescriptorSets::reprojection] = { };
+	bindings[DescriptorSets::reprojection].binding			= DescriptorSets::reprojection;
+	bindings[DescriptorSets::reprojection].descriptorCount	= 1;
+	bindings[DescriptorSets::reprojection].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[DescriptorSets::reprojection].stageFlags		= VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+
+	for (auto binding: {DescriptorSets::adaptive_sampling, DescriptorSets::tile_errors, DescriptorSets::history_tile_errors})
+	{
+		bindings[binding] = { };
+		bindings[binding].binding			= static_cast<uint32_t>(binding);
+		bindings[binding].descriptorCount	= 1;
+		bindings[binding].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[binding].stageFlags		= VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+	}
+
+	bindings[DescriptorSets::environment] = { };
+	bindings[DescriptorSets::environment].binding			= DescriptorSets::environment;
+	bindings[DescriptorSets::environment].descriptorCount	= 1;
+	bindings[DescriptorSets::environment].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[DescriptorSets::environment].stageFlags		= VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR;
+
+	/// Тот же набор дескрипторов - set 0 у стадий WavefrontPass.
+	for (auto& binding: bindings)
+		binding.stageFlags |= VK_SHADER_STAGE_COMPUTE_BIT;
+
 	return bindings;
 }
 
@@ -460,6 +774,12 @@ void JunkShop::createPipeline()
 	shader_stages_info[ShaderId::miss].pName 	= "main";
 	shader_stages_info[ShaderId::miss].stage 	= VK_SHADER_STAGE_MISS_BIT_KHR;
 
+	shader_stages_info[ShaderId::shadow_miss] = { };
+	shader_stages_info[ShaderId::shadow_miss].sType 	= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shader_stages_info[ShaderId::shadow_miss].module 	= _shader_modules[ShaderId::shadow_miss];
+	shader_stages_info[ShaderId::shadow_miss].pName 	= "main";
+	shader_stages_info[ShaderId::shadow_miss].stage 	= VK_SHADER_STAGE_MISS_BIT_KHR;
+
 	std::array<VkRayTracingShaderGroupCreateInfoKHR, ShaderId::count> groups;
 
 	groups[ShaderId::ray_gen] = { };
@@ -478,6 +798,14 @@ void JunkShop::createPipeline()
 	groups[ShaderId::miss].intersectionShader	= VK_SHADER_UNUSED_KHR;
 	groups[ShaderId::miss].type 				= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
 
+	groups[ShaderId::shadow_miss] = { };
+	groups[ShaderId::shadow_miss].sType					= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+	groups[ShaderId::shadow_miss].generalShader  		= ShaderId::shadow_miss;
+	groups[ShaderId::shadow_miss].closestHitShader		= VK_SHADER_UNUSED_KHR;
+	groups[ShaderId::shadow_miss].anyHitShader			= VK_SHADER_UNUSED_KHR;
+	groups[ShaderId::shadow_miss].intersectionShader	= VK_SHADER_UNUSED_KHR;
+	groups[ShaderId::shadow_miss].type 					= VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
+
 	groups[ShaderId::chit] = { };
 	groups[ShaderId::chit].sType 				= VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
 	groups[ShaderId::chit].closestHitShader		= ShaderId::chit;
@@ -516,11 +844,15 @@ void JunkShop::compileShaders()
 	shaders[ShaderId::chit] 	= project_dir / "shaders/junk_shop/junk_shop.glsl.rchit";
 	shaders[ShaderId::miss] 	= project_dir / "shaders/junk_shop/junk_shop.glsl.rmiss";
 
+	shaders[ShaderId::shadow_miss] = project_dir / "shaders/junk_shop/junk_shop_shadow.glsl.rmiss";
+
 	std::array<shader::Type, ShaderId::count> types;
 	types[ShaderId::ray_gen] 	= shader::Type::raygen;
 	types[ShaderId::chit] 		= shader::Type::closesthit;
 	types[ShaderId::miss] 		= shader::Type::miss;
 
+	types[ShaderId::shadow_miss] = shader::Type::miss;
+
     for (auto i: std::views::iota(0u, ShaderId::count))
 	{
 		_shader_modules[i] = shader::Compiler::createShaderModule(_context.device_handle, shaders[i], types[i]);
@@ -536,7 +868,7 @@ void JunkShop::compileShaders()
 
 void JunkShop::createShaderBindingTable()
 {
-	constexpr uint32_t miss_count 	= 1;
+	constexpr uint32_t miss_count 	= 2;
 	constexpr uint32_t hit_count 	= 1;
 
 	constexpr uint32_t handle_count = 1 + miss_count + hit_count;
@@ -568,7 +900,7 @@ void JunkShop::createShaderBindingTable()
 	)
 	{
 		buffer = Buffer::Builder(getContext())
-			.vkSize(_ray_tracing_pipeline_properties.shaderGroupHandleSize)
+			.vkSize(data.size())
 			.vkUsage(VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
 			.name(std::format("[SBT]: {}", name))
 			.build();
@@ -579,7 +911,10 @@ void JunkShop::createShaderBindingTable()
 
 	auto raygen_data 		= std::span(&raw_data[handle_size_aligned * ShaderId::ray_gen], _ray_tracing_pipeline_properties.shaderGroupHandleSize);
 	auto closest_hit_data 	= std::span(&raw_data[handle_size_aligned * ShaderId::chit], _ray_tracing_pipeline_properties.shaderGroupHandleSize); 
-	auto miss_data 			= std::span(&raw_data[handle_size_aligned * ShaderId::miss], _ray_tracing_pipeline_properties.shaderGroupHandleSize);
+
+	/// Группы miss и shadow_miss идут подряд: индекс промаха в traceRayEXT - номер записи в miss_region.
+	static_assert(ShaderId::shadow_miss == ShaderId::miss + 1);
+	auto miss_data = std::span(&raw_data[handle_size_aligned * ShaderId::miss], handle_size_aligned * miss_count);
 
 	createBufferForSBT(_sbt.raygen, raygen_data, "raygen");
 	createBufferForSBT(_sbt.closest_hit, closest_hit_data, "closest hit");
@@ -590,17 +925,17 @@ void JunkShop::createShaderBindingTable()
 	_sbt.raygen_region.size 			= handle_size_aligned;
 
 	_sbt.chit_region.deviceAddress 		= _sbt.closest_hit->getAddress();
-	_sbt.raygen_region.stride 			= handle_size_aligned;
-	_sbt.raygen_region.size 			= handle_size_aligned;
+	_sbt.chit_region.stride 			= handle_size_aligned;
+	_sbt.chit_region.size 				= handle_size_aligned * hit_count;
 	
 	_sbt.miss_region.deviceAddress 		= _sbt.miss->getAddress();
-	_sbt.raygen_region.stride 			= handle_size_aligned;
-	_sbt.raygen_region.size 			= handle_size_aligned;
+	_sbt.miss_region.stride 			= handle_size_aligned;
+	_sbt.miss_region.size 				= handle_size_aligned * miss_count;
 }
 
 PoolSizes JunkShop::getPoolSizes() const
 {
-	auto materials = _scene->getModel().getMaterialManager().getMaterials();
+	const auto instance_count = _scene->getModel().getMaterialManager().getInstanceCount();
 
 	std::array<VkDescriptorPoolSize, DescriptorSets::count> pool_sizes;
 
@@ -622,23 +957,57 @@ PoolSizes JunkShop::getPoolSizes() const
 
 	pool_sizes[DescriptorSets::albedos] = { };
 	pool_sizes[DescriptorSets::albedos].type			= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_sizes[DescriptorSets::albedos].descriptorCount	= static_cast<uint32_t>(materials.size());
+	pool_sizes[DescriptorSets::albedos].descriptorCount	= static_cast<uint32_t>(instance_count);
 
 	pool_sizes[DescriptorSets::normal_maps] = { };
 	pool_sizes[DescriptorSets::normal_maps].type			= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_sizes[DescriptorSets::normal_maps].descriptorCount	= static_cast<uint32_t>(materials.size());
+	pool_sizes[DescriptorSets::normal_maps].descriptorCount	= static_cast<uint32_t>(instance_count);
 
 	pool_sizes[DescriptorSets::metallic] = { };
 	pool_sizes[DescriptorSets::metallic].type				= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_sizes[DescriptorSets::metallic].descriptorCount	= static_cast<uint32_t>(materials.size());
+	pool_sizes[DescriptorSets::metallic].descriptorCount	= static_cast<uint32_t>(instance_count);
 
 	pool_sizes[DescriptorSets::roughness] = { };
 	pool_sizes[DescriptorSets::roughness].type				= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_sizes[DescriptorSets::roughness].descriptorCount	= static_cast<uint32_t>(materials.size());
+	pool_sizes[DescriptorSets::roughness].descriptorCount	= static_cast<uint32_t>(instance_count);
 	
 	pool_sizes[DescriptorSets::emissive] = { };
 	pool_sizes[DescriptorSets::emissive].type				= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_sizes[DescriptorSets::emissive].descriptorCount	= static_cast<uint32_t>(materials.size());
+	pool_sizes[DescriptorSets::emissive].descriptorCount	= static_cast<uint32_t>(instance_count);
+
+	pool_sizes[DescriptorSets::light_sampler] = { };
+	pool_sizes[DescriptorSets::light_sampler].type				= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[DescriptorSets::light_sampler].descriptorCount 	= 1;
+
+	pool_sizes[DescriptorSets::sobol] = { };
+	pool_sizes[DescriptorSets::sobol].type				= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[DescriptorSets::sobol].descriptorCount 	= 1;
+
+	pool_sizes[DescriptorSets::path_statistics] = { };
+	pool_sizes[DescriptorSets::path_statistics].type			= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[DescriptorSets::path_statistics].descriptorCount	= 1;
+
+	for (auto pool: {DescriptorSets::history_buffer, DescriptorSets::depth_buffer, DescriptorSets::history_depth_buffer, DescriptorSets::albedo_aov, DescriptorSets::normal_aov, DescriptorSets::moments_buffer, DescriptorSets::history_moments_buffer})
+	{
+		pool_sizes[pool] = { };
+		pool_sizes[pool].type				= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		pool_sizes[pool].descriptorCount	= 1;
+	}
+
+	pool_sizes[DescriptorSets::reprojection] = { };
+	pool_sizes[DescriptorSets::reprojection].type				= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[DescriptorSets::reprojection].descriptorCount	= 1;
+
+	for (auto pool: {DescriptorSets::adaptive_sampling, DescriptorSets::tile_errors, DescriptorSets::history_tile_errors})
+	{
+		pool_sizes[pool] = { };
+		pool_sizes[pool].type				= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		pool_sizes[pool].descriptorCount	= 1;
+	}
+
+	pool_sizes[DescriptorSets::environment] = { };
+	pool_sizes[DescriptorSets::environment].type			= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[DescriptorSets::environment].descriptorCount	= 1;
 
 	return pool_sizes;
 }
@@ -683,34 +1052,858 @@ void JunkShop::createDescriptorSets()
 
 void JunkShop::createAS()
 {
-	auto ptr_as_builder = std::make_unique<ASBuilder>(getContext());
+	_scene->getModel().updateTransforms();
+
+	updateLods();
+	initVertexBuffersReferences();
+}
 
+void JunkShop::updateLods()
+{
 	auto& model = _scene->getModel();
+
+	_lod_eye = glm::vec3(_scene->getCameraController().getCamera().getInvViewMatrix() * glm::vec4(0, 0, 0, 1));
+
+	const LodPolicy lod_policy
+	{
+		.eye = _lod_eye
+	};
+
+	auto ptr_as_builder = std::make_unique<ASBuilder>(getContext(), model.getTransformHierarchy(), lod_policy);
 	model.visit(ptr_as_builder);
 
-	initVertexBuffersReferences();
+	_scene->selectRayQueryLods(*ptr_as_builder);
 }
 
-void JunkShop::createAccumulationBuffer()
+void JunkShop::createLightSampler()
+{
+	_scene->updateRayQueries();
+
+	const auto light_sampler = _scene->createLightSampler();
+
+	auto createBuffer = [this] <typename T> (std::optional<Buffer>& buffer, std::span<const T> data, std::string_view name)
+	{
+		buffer = Buffer::Builder(getContext())
+			.vkSize(std::max<VkDeviceSize>(data.size_bytes(), sizeof(T)))
+			.vkUsage(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+			.name(std::format("[LightSampler]: {}", name))
+			.build();
+
+		if (!data.empty())
+			Buffer::writeData(*buffer, data);
+	};
+
+	createBuffer(_light_sampler.lights, light_sampler.getLights(), "lights");
+	createBuffer(_light_sampler.alias_table, light_sampler.getAliasTable(), "alias table");
+	createBuffer(_light_sampler.area_pdfs, light_sampler.getAreaPdfs(), "area pdfs");
+
+	const LightSamplerInfo info
+	{
+		.lights			= _light_sampler.lights->getAddress(),
+		.alias_table	= _light_sampler.alias_table->getAddress(),
+		.area_pdfs		= _light_sampler.area_pdfs->getAddress(),
+		.light_count	= static_cast<uint32_t>(light_sampler.getLights().size()),
+		.area_pdf_count	= static_cast<uint32_t>(light_sampler.getAreaPdfs().size())
+	};
+
+	_light_sampler.info = Buffer::Builder(getContext())
+		.vkSize(sizeof(LightSamplerInfo))
+		.vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		.name("[LightSampler]: info")
+		.build();
+
+	Buffer::writeData(*_light_sampler.info, info);
+
+	_light_sampler.light_count = info.light_count;
+}
+
+void JunkShop::createEnvironment()
+{
+	/// То же окружение, что у CpuPathTracer.
+	const auto environment_map = createEnvironmentMap();
+
+	auto createBuffer = [this] <typename T> (std::optional<Buffer>& buffer, std::span<const T> data, std::string_view name)
+	{
+		buffer = Buffer::Builder(getContext())
+			.vkSize(std::max<VkDeviceSize>(data.size_bytes(), sizeof(T)))
+			.vkUsage(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+			.name(std::format("[Environment]: {}", name))
+			.build();
+
+		if (!data.empty())
+			Buffer::writeData(*buffer, data);
+	};
+
+	createBuffer(_environment.pixels, environment_map.getPixels(), "pixels");
+	createBuffer(_environment.marginal, environment_map.getMarginalTable(), "marginal table");
+	createBuffer(_environment.conditional, environment_map.getConditionalTables(), "conditional tables");
+	createBuffer(_environment.pixel_pdfs, environment_map.getPixelPdfs(), "pixel pdfs");
+
+	const auto selection_probability = getEnvironmentSelectionProbability(environment_map, _light_sampler.light_count);
+
+	const EnvironmentInfo info
+	{
+		.pixels					= _environment.pixels->getAddress(),
+		.marginal				= _environment.marginal->getAddress(),
+		.conditional			= _environment.conditional->getAddress(),
+		.pixel_pdfs				= _environment.pixel_pdfs->getAddress(),
+		.width					= environment_map.getWidth(),
+		.height					= environment_map.getHeight(),
+		.selection_probability	= selection_probability
+	};
+
+	_environment.info = Buffer::Builder(getContext())
+		.vkSize(sizeof(EnvironmentInfo))
+		.vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		.name("[Environment]: info")
+		.build();
+
+	Buffer::writeData(*_environment.info, info);
+}
+
+void JunkShop::createSobolDirections()
+{
+	const auto& directions = sobol::getDirections();
+
+	_sobol.directions = Buffer::Builder(getContext())
+		.vkSize(sizeof(directions))
+		.vkUsage(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		.name("[Sobol]: directions")
+		.build();
+
+	Buffer::writeData(*_sobol.directions, std::span<const uint32_t>(directions));
+
+	_sobol.reference = Buffer::Builder(getContext())
+		.vkSize(sizeof(VkDeviceAddress))
+		.vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		.name("[Sobol]: reference")
+		.build();
+
+	Buffer::writeData(*_sobol.reference, _sobol.directions->getAddress());
+}
+
+void JunkShop::createPathStatisticsBuffer()
+{
+	_path_statistics.buffer = Buffer::Builder(getContext())
+		.vkSize(sizeof(PathStatistics))
+		.vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		.isHostVisible(true)
+		.name("Path statistics")
+		.build();
+}
+
+PathStatistics JunkShop::processPathStatistics()
+{
+	constexpr uint32_t path_statistics_log_period = 100;
+
+	PathStatistics statistics;
+
+	void* ptr_memory = nullptr;
+
+	VK_CHECK(
+		vkMapMemory(
+			_context.device_handle,
+			_path_statistics.buffer->memory_handle,
+			0, sizeof(PathStatistics),
+			0,
+			&ptr_memory
+		)
+	);
+
+	/// Память может быть не HOST_COHERENT.
+	const VkMappedMemoryRange memory_range
+	{
+		.sType	= VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+		.memory	= _path_statistics.buffer->memory_handle,
+		.offset	= 0,
+		.size	= VK_WHOLE_SIZE
+	};
+
+	VK_CHECK(vkInvalidateMappedMemoryRanges(_context.device_handle, 1, &memory_range));
+
+	memcpy(&statistics, ptr_memory, sizeof(PathStatistics));
+
+	vkUnmapMemory(_context.device_handle, _path_statistics.buffer->memory_handle);
+
+	_path_statistics.bounce_count			+= statistics.bounce_count;
+	_path_statistics.terminated_path_count	+= statistics.terminated_path_count;
+	_path_statistics.path_count				+= statistics.path_count;
+
+	if (++_path_statistics.frame_count < path_statistics_log_period)
+		return statistics;
+
+	const auto path_count = static_cast<double>(std::max<uint64_t>(_path_statistics.path_count, 1));
+
+	log::info(
+		"[JunkShop] Last {} frames: average path length {:.2f}, terminated by russian roulette {:.1f}%",
+		_path_statistics.frame_count,
+		static_cast<double>(_path_statistics.bounce_count) / path_count,
+		static_cast<double>(_path_statistics.terminated_path_count) / path_count * 100.0
+	);
+
+	_path_statistics.bounce_count			= 0;
+	_path_statistics.terminated_path_count	= 0;
+	_path_statistics.path_count				= 0;
+	_path_statistics.frame_count			= 0;
+
+	return statistics;
+}
+
+void JunkShop::createAccumulationBuffers()
+{
+	auto [width, height] = _window->getSize();
+
+	for (auto i: std::views::iota(0u, static_cast<uint32_t>(_accumulation_buffers.size())))
+	{
+		_accumulation_buffers[i] = Image::Builder(getContext())
+			.generateMipmap(false)
+			.size(width, height)
+			.vkFormat(VK_FORMAT_R32G32B32A32_SFLOAT)
+			.build();
+
+		VkUtils::setName(
+			_context.device_handle, 
+			*_accumulation_buffers[i],
+			VK_OBJECT_TYPE_IMAGE, 
+			std::format("Accumulation buffer {}", i)
+		);
+
+		_depth_buffers[i] = Image::Builder(getContext())
+			.generateMipmap(false)
+			.size(width, height)
+			.vkFormat(VK_FORMAT_R32_SFLOAT)
+			.build();
+
+		VkUtils::setName(
+			_context.device_handle, 
+			*_depth_buffers[i],
+			VK_OBJECT_TYPE_IMAGE, 
+			std::format("Depth buffer {}", i)
+		);
+
+		_moment_buffers[i] = Image::Builder(getContext())
+			.generateMipmap(false)
+			.size(width, height)
+			.vkFormat(VK_FORMAT_R32_SFLOAT)
+			.build();
+
+		VkUtils::setName(
+			_context.device_handle, 
+			*_moment_buffers[i],
+			VK_OBJECT_TYPE_IMAGE, 
+			std::format("Moments buffer {}", i)
+		);
+	}
+}
+
+void JunkShop::createAovImages()
 {
 	auto [width, height] = _window->getSize();
 
-	auto command_buffer = getCommandBuffer();
+	_denoiser.albedo_aov = Image::Builder(getContext())
+		.generateMipmap(false)
+		.size(width, height)
+		.vkFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
+		.build();
 
-	_accumulation_buffer = Image::Builder(getContext())
+	VkUtils::setName(
+		_context.device_handle, 
+		*_denoiser.albedo_aov,
+		VK_OBJECT_TYPE_IMAGE, 
+		"Albedo AOV"
+	);
+
+	_denoiser.normal_aov = Image::Builder(getContext())
 		.generateMipmap(false)
 		.size(width, height)
-		.vkFormat(VK_FORMAT_R32G32B32A32_SFLOAT)
+		.vkFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
 		.build();
 
 	VkUtils::setName(
 		_context.device_handle, 
-		*_accumulation_buffer,
+		*_denoiser.normal_aov,
 		VK_OBJECT_TYPE_IMAGE, 
-		"Accumulation buffer"
+		"Normal AOV"
+	);
+}
+
+void JunkShop::createDenoisePass()
+{
+	auto [width, height] = _window->getSize();
+
+	_denoiser.pass = DenoisePass::Builder(getContext())
+		.size(width, height)
+		.build();
+}
+
+void JunkShop::createWavefrontPass()
+{
+	auto [width, height] = _window->getSize();
+
+	const auto material_count = _scene->getModel().getMaterialManager().getInstanceCount();
+
+	_wavefront.pass = WavefrontPass::Builder(getContext())
+		.sceneDescriptorSetLayout(_descriptor_set_layout_handle)
+		.materialCount(static_cast<uint32_t>(std::max<size_t>(material_count, 1)))
+		.size(width, height)
+		.build();
+}
+
+void JunkShop::processQueueStatistics()
+{
+	constexpr uint32_t queue_statistics_log_period = 100;
+
+	const auto statistics = _wavefront.pass->readQueueStatistics();
+
+	for (auto bounce: std::views::iota(0u, WavefrontPass::max_bounce_count))
+	{
+		_wavefront.ray_counts[bounce]			+= statistics[bounce].ray_count;
+		_wavefront.hit_counts[bounce]			+= statistics[bounce].hit_count;
+		_wavefront.shadow_ray_counts[bounce]	+= statistics[bounce].shadow_ray_count;
+	}
+
+	if (++_wavefront.frame_count < queue_statistics_log_period)
+		return;
+
+	const auto frame_count = static_cast<double>(_wavefront.frame_count);
+
+	log::info("[JunkShop] Last {} frames, average queue sizes per bounce (rays / hits / shadow rays):", _wavefront.frame_count);
+
+	for (auto bounce: std::views::iota(0u, WavefrontPass::max_bounce_count))
+	{
+		log::info(
+			"[JunkShop]     bounce {}: {:.0f} / {:.0f} / {:.0f}",
+			bounce,
+			static_cast<double>(_wavefront.ray_counts[bounce]) / frame_count,
+			static_cast<double>(_wavefront.hit_counts[bounce]) / frame_count,
+			static_cast<double>(_wavefront.shadow_ray_counts[bounce]) / frame_count
+		);
+	}
+
+	_wavefront.ray_counts.fill(0);
+	_wavefront.hit_counts.fill(0);
+	_wavefront.shadow_ray_counts.fill(0);
+	_wavefront.frame_count = 0;
+}
+
+void JunkShop::createReprojectionBuffer()
+{
+	_reprojection.buffer = Buffer::Builder(getContext())
+		.vkSize(sizeof(ReprojectionData))
+		.vkUsage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		.isHostVisible(true)
+		.name("Reprojection data")
+		.build();
+
+	const auto& camera = _scene->getCameraController().getCamera();
+
+	_reprojection.view_projection	= glm::inverse(camera.getInvProjection()) * glm::inverse(camera.getInvViewMatrix());
+	_reprojection.eye				= glm::vec3(camera.getInvViewMatrix() * glm::vec4(0, 0, 0, 1));
+}
+
+void JunkShop::updateReprojection()
+{
+	constexpr uint32_t max_reprojected_history = 16;
+
+	const auto& camera = _scene->getCameraController().getCamera();
+
+	const auto view_projection	= glm::inverse(camera.getInvProjection()) * glm::inverse(camera.getInvViewMatrix());
+	const auto eye				= glm::vec3(camera.getInvViewMatrix() * glm::vec4(0, 0, 0, 1));
+
+	const auto is_camera_moved = view_projection != _reprojection.view_projection;
+
+	_reprojection.is_camera_moved = is_camera_moved;
+
+	const ReprojectionData data
+	{
+		.prev_view_projection	= _reprojection.view_projection,
+		.prev_eye				= glm::vec4(_reprojection.eye, 1.0f),
+		.history_limit			= _reprojection.is_enabled && is_camera_moved ? max_reprojected_history : std::numeric_limits<uint32_t>::max(),
+		.is_enabled				= _reprojection.is_enabled ? 1u : 0u,
+		.is_camera_moved		= is_camera_moved ? 1u : 0u
+	};
+
+	void* ptr_memory = nullptr;
+
+	VK_CHECK(
+		vkMapMemory(
+			_context.device_handle,
+			_reprojection.buffer->memory_handle,
+			0, sizeof(ReprojectionData),
+			0,
+			&ptr_memory
+		)
+	);
+
+	memcpy(ptr_memory, &data, sizeof(ReprojectionData));
+
+	/// Память может быть не HOST_COHERENT.
+	const VkMappedMemoryRange memory_range
+	{
+		.sType	= VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+		.memory	= _reprojection.buffer->memory_handle,
+		.offset	= 0,
+		.size	= VK_WHOLE_SIZE
+	};
+
+	VK_CHECK(vkFlushMappedMemoryRanges(_context.device_handle, 1, &memory_range));
+
+	vkUnmapMemory(_context.device_handle, _reprojection.buffer->memory_handle);
+
+	_reprojection.view_projection	= view_projection;
+	_reprojection.eye				= eye;
+}
+
+void JunkShop::createAdaptiveSamplingBuffers()
+{
+	auto [width, height] = _window->getSize();
+
+	const auto tile_count_x = (width + adaptive_tile_size - 1) / adaptive_tile_size;
+	const auto tile_count_y = (height + adaptive_tile_size - 1) / adaptive_tile_size;
+
+	_adaptive_sampling.tile_count				= tile_count_x * tile_count_y;
+	_adaptive_sampling.settings.tile_count_x	= tile_count_x;
+
+	for (auto i: std::views::iota(0u, static_cast<uint32_t>(_adaptive_sampling.tile_errors.size())))
+	{
+		_adaptive_sampling.tile_errors[i] = Buffer::Builder(getContext())
+			.vkSize(sizeof(uint32_t) * _adaptive_sampling.tile_count)
+			.vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+			.isHostVisible(true)
+			.name(std::format("[AdaptiveSampling]: tile errors {}", i))
+			.build();
+	}
+
+	if (!_adaptive_sampling.data)
+	{
+		_adaptive_sampling.data = Buffer::Builder(getContext())
+			.vkSize(sizeof(AdaptiveSamplingData))
+			.vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+			.name("[AdaptiveSampling]: data")
+			.build();
+	}
+
+	updateAdaptiveSamplingData();
+	restartConvergenceTimer();
+}
+
+void JunkShop::updateAdaptiveSamplingData()
+{
+	Buffer::writeData(*_adaptive_sampling.data, _adaptive_sampling.settings);
+}
+
+void JunkShop::restartConvergenceTimer()
+{
+	_adaptive_sampling.start_time			= std::chrono::steady_clock::now();
+	_adaptive_sampling.frame_count			= 0;
+	_adaptive_sampling.traced_path_count	= 0;
+	_adaptive_sampling.is_target_reached	= false;
+}
+
+void JunkShop::updateRenderScale()
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	const std::chrono::duration<float> frame_time = now - _render_scale.last_frame_time;
+
+	_render_scale.last_frame_time = now;
+
+	const auto& settings	= _render_scale.settings;
+	const auto prev_scale	= _render_scale.scale;
+
+	if (!_render_scale.is_enabled || _wavefront.is_enabled)
+		_render_scale.scale = 1;
+	else if (_reprojection.is_camera_moved)
+	{
+		/// Гистерезис: разрешение поднимается, только когда кадр укладывается в бюджет с запасом.
+		if (frame_time.count() > settings.frame_time_budget)
+			++_render_scale.scale;
+		else if (frame_time.count() < settings.frame_time_budget * 0.5f && _render_scale.scale > 1)
+			--_render_scale.scale;
+
+		_render_scale.scale = std::clamp(_render_scale.scale, std::min(settings.moving_scale, settings.max_scale), settings.max_scale);
+	}
+	else if (_render_scale.scale > 1)
+		--_render_scale.scale;
+
+	if (prev_scale > 1 && _render_scale.scale == 1)
+	{
+		_accumulated_frames_count = 0;
+		restartConvergenceTimer();
+	}
+}
+
+void JunkShop::processTileErrors(const PathStatistics& statistics)
+{
+	++_adaptive_sampling.frame_count;
+	_adaptive_sampling.traced_path_count += statistics.path_count;
+
+	if (_adaptive_sampling.is_target_reached)
+		return ;
+
+	const auto& tile_errors = *_adaptive_sampling.tile_errors[_current_buffer_index];
+
+	void* ptr_memory = nullptr;
+
+	VK_CHECK(
+		vkMapMemory(
+			_context.device_handle,
+			tile_errors.memory_handle,
+			0, VK_WHOLE_SIZE,
+			0,
+			&ptr_memory
+		)
+	);
+
+	const VkMappedMemoryRange memory_range
+	{
+		.sType	= VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+		.memory	= tile_errors.memory_handle,
+		.offset	= 0,
+		.size	= VK_WHOLE_SIZE
+	};
+
+	VK_CHECK(vkInvalidateMappedMemoryRanges(_context.device_handle, 1, &memory_range));
+
+	const auto [width, height] = _window->getSize();
+
+	const auto tile_count_x	= _adaptive_sampling.settings.tile_count_x;
+	const auto errors		= std::span(static_cast<const uint32_t*>(ptr_memory), _adaptive_sampling.tile_count);
+
+	uint32_t converged_tile_count = 0;
+
+	for (auto tile_id: std::views::iota(0u, _adaptive_sampling.tile_count))
+	{
+		const auto x = (tile_id % tile_count_x) * adaptive_tile_size;
+		const auto y = (tile_id / tile_count_x) * adaptive_tile_size;
+
+		const auto pixel_count = std::min(adaptive_tile_size, width - x) * std::min(adaptive_tile_size, height - y);
+
+		const auto error = static_cast<float>(errors[tile_id]) / (tile_error_scale * static_cast<float>(pixel_count));
+
+		if (error <= _adaptive_sampling.settings.target_error)
+			++converged_tile_count;
+	}
+
+	vkUnmapMemory(_context.device_handle, tile_errors.memory_handle);
+
+	if (converged_tile_count < _adaptive_sampling.tile_count)
+		return ;
+
+	_adaptive_sampling.is_target_reached = true;
+
+	const std::chrono::duration<double> time = std::chrono::steady_clock::now() - _adaptive_sampling.start_time;
+
+	const auto full_path_count = static_cast<double>(width) * static_cast<double>(height) * static_cast<double>(_adaptive_sampling.frame_count);
+
+	log::info(
+		"[JunkShop] Target error {} reached in {:.2f} s, {} frames, traced {:.1f}% of paths",
+		_adaptive_sampling.settings.target_error,
+		time.count(),
+		_adaptive_sampling.frame_count,
+		static_cast<double>(_adaptive_sampling.traced_path_count) / std::max(full_path_count, 1.0) * 100.0
 	);
 }
 
+/// Заголовок контрольной точки оффлайн-рендера, за ним width * height пикселей RGBA32F буфера накопления.
+struct CheckpointHeader
+{
+	static constexpr uint32_t current_magic		= 0x4b50434a;	///< "JCPK"
+	static constexpr uint32_t current_version	= 1;
+
+	uint32_t magic			= current_magic;
+	uint32_t version		= current_version;
+	uint32_t width			= 0;
+	uint32_t height			= 0;
+	uint32_t sample_count	= 0;
+};
+
+std::vector<glm::vec4> JunkShop::readAccumulationBuffer() const
+{
+	auto [width, height] = _window->getSize();
+
+	std::vector<glm::vec4> pixels (static_cast<size_t>(width) * height);
+
+	_accumulation_buffers[_current_buffer_index ^ 1]->readData(ImageWriteData
+	{
+		.ptr_data	= reinterpret_cast<uint8_t*>(pixels.data()),
+		.width		= static_cast<int>(width),
+		.height		= static_cast<int>(height),
+		.format		= VK_FORMAT_R32G32B32A32_SFLOAT
+	});
+
+	return pixels;
+}
+
+void JunkShop::saveCheckpoint(const std::filesystem::path& path) const
+{
+	auto [width, height] = _window->getSize();
+
+	const auto pixels = readAccumulationBuffer();
+
+	const CheckpointHeader header
+	{
+		.width			= width,
+		.height			= height,
+		.sample_count	= _accumulated_frames_count
+	};
+
+	/// Сначала во временный файл: прерванная запись не должна испортить прошлую контрольную точку.
+	auto temp_path = path;
+	temp_path += ".tmp";
+
+	{
+		std::ofstream file (temp_path, std::ios::binary);
+
+		if (!file)
+			log::error("[JunkShop] Failed to open checkpoint {}.", temp_path.string());
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(CheckpointHeader));
+		file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size() * sizeof(glm::vec4)));
+
+		if (!file)
+			log::error("[JunkShop] Failed to write checkpoint {}.", temp_path.string());
+	}
+
+	std::filesystem::rename(temp_path, path);
+
+	log::info("[JunkShop] Checkpoint saved: {} spp, {}", _accumulated_frames_count, path.string());
+}
+
+bool JunkShop::loadCheckpoint(const std::filesystem::path& path)
+{
+	std::ifstream file (path, std::ios::binary);
+
+	if (!file)
+		return false;
+
+	auto [width, height] = _window->getSize();
+
+	CheckpointHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(CheckpointHeader));
+
+	if (
+			!file 
+		||	header.magic != CheckpointHeader::current_magic 
+		||	header.version != CheckpointHeader::current_version
+	)
+	{
+		log::warning("[JunkShop] {} is not a checkpoint, rendering from scratch.", path.string());
+		return false;
+	}
+
+	if (header.width != width || header.height != height)
+	{
+		log::warning(
+			"[JunkShop] Checkpoint {} is {}x{}, expected {}x{}, rendering from scratch.", 
+			path.string(), header.width, header.height, width, height
+		);
+		return false;
+	}
+
+	std::vector<glm::vec4> pixels (static_cast<size_t>(width) * height);
+	file.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size() * sizeof(glm::vec4)));
+
+	if (!file)
+	{
+		log::warning("[JunkShop] Checkpoint {} is truncated, rendering from scratch.", path.string());
+		return false;
+	}
+
+	_accumulation_buffers[_current_buffer_index ^ 1]->writeData(ImageWriteData
+	{
+		.ptr_data	= reinterpret_cast<uint8_t*>(pixels.data()),
+		.width		= static_cast<int>(width),
+		.height		= static_cast<int>(height),
+		.format		= VK_FORMAT_R32G32B32A32_SFLOAT
+	});
+
+	_accumulated_frames_count = header.sample_count;
+
+	log::info("[JunkShop] Resumed from checkpoint {}: {} spp", path.string(), header.sample_count);
+
+	return true;
+}
+
+void JunkShop::renderOffline(const OfflineSettings& settings)
+{
+	init();
+
+	SDL_SetWindowSize(static_cast<SDL_Window*>(*_window), static_cast<int>(settings.width), static_cast<int>(settings.height));
+	resizeWindow();
+
+	/// Не структурная привязка: размеры захватываются лямбдой ниже.
+	const auto window_size = _window->getSize();
+
+	const auto width	= window_size.width;
+	const auto height	= window_size.height;
+
+	if (width != settings.width || height != settings.height)
+		log::error("[JunkShop] Offline render needs a {}x{} window, got {}x{}.", settings.width, settings.height, width, height);
+
+	if (settings.tile_size == 0)
+		log::error("[JunkShop] Offline tile size must not be zero.");
+
+	_reprojection.is_enabled				= false;
+	_denoiser.is_enabled					= false;
+	_adaptive_sampling.settings.is_enabled	= 0;
+	_render_scale.is_enabled				= false;
+	_render_scale.scale						= 1;
+
+	updateAdaptiveSamplingData();
+
+	auto result = Image::Builder(getContext())
+		.generateMipmap(false)
+		.size(width, height)
+		.vkFormat(VK_FORMAT_R32G32B32A32_SFLOAT)
+		.build();
+
+	VkUtils::setName(_context.device_handle, result, VK_OBJECT_TYPE_IMAGE, "Offline result");
+
+	_accumulated_frames_count = 0;
+
+	const auto has_checkpoint = !settings.checkpoint_path.empty();
+
+	const auto isCheckpointFrame = [&settings] (uint32_t frame)
+	{
+		return settings.checkpoint_period > 0 && frame % settings.checkpoint_period == 0;
+	};
+
+	if (has_checkpoint && !loadCheckpoint(settings.checkpoint_path))
+		_accumulated_frames_count = 0;
+
+	const auto tile_count_x = (width + settings.tile_size - 1) / settings.tile_size;
+	const auto tile_count_y = (height + settings.tile_size - 1) / settings.tile_size;
+
+	const auto start_time			= std::chrono::steady_clock::now();
+	const auto start_frame_count	= _accumulated_frames_count;
+
+	uint64_t ray_count = 0;
+
+	bool is_interrupted = false;
+
+	while (_accumulated_frames_count < settings.sample_count && !is_interrupted)
+	{
+		updateReprojection();
+		updateDescriptorSet(result.view_handle);
+
+		auto push_constant_data = getPushConstantData();
+		push_constant_data.rgen_consts.is_radiance_accumulated = 1;
+
+		for (auto tile_id: std::views::iota(0u, tile_count_x * tile_count_y))
+		{
+			const auto x = (tile_id % tile_count_x) * settings.tile_size;
+			const auto y = (tile_id / tile_count_x) * settings.tile_size;
+
+			push_constant_data.rgen_consts.tile_offset = glm::ivec2(x, y);
+
+			const auto is_first_tile	= tile_id == 0;
+			const auto is_last_tile		= tile_id + 1 == tile_count_x * tile_count_y;
+
+			/// Тайл на отправку: драйвер не сбросит устройство по таймауту.
+			auto command_buffer = getCommandBuffer();
+
+			command_buffer.write([&] (VkCommandBuffer command_buffer_handle)
+			{
+				if (is_first_tile)
+					clearFrameCounters(command_buffer_handle);
+
+				traceRays(
+					command_buffer_handle, 
+					push_constant_data, 
+					std::min(settings.tile_size, width - x), 
+					std::min(settings.tile_size, height - y)
+				);
+
+				if (!is_last_tile)
+					return ;
+
+				const VkMemoryBarrier read_statistics_barrier
+				{
+					.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+					.srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT,
+					.dstAccessMask	= VK_ACCESS_HOST_READ_BIT
+				};
+
+				vkCmdPipelineBarrier(
+					command_buffer_handle,
+					VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_HOST_BIT, 0,
+					1, &read_statistics_barrier,
+					0, nullptr,
+					0, nullptr
+				);
+			}, "Run offline tile", GpuMarkerColors::run_ray_tracing_pipeline);
+
+			command_buffer.upload(getContext());
+		}
+
+		const auto statistics = processPathStatistics();
+
+		ray_count += static_cast<uint64_t>(statistics.bounce_count) + statistics.shadow_ray_count;
+
+		_current_buffer_index ^= 1;
+		++_accumulated_frames_count;
+
+		_window->setTitle(std::format("JunkShop offline: {} / {} spp", _accumulated_frames_count, settings.sample_count));
+
+		SDL_Event event = { };
+
+		while (SDL_PollEvent(&event))
+		{
+			if (event.type == SDL_QUIT || (event.type == SDL_KEYUP && event.key.keysym.scancode == SDL_SCANCODE_ESCAPE))
+				is_interrupted = true;
+		}
+
+		if (has_checkpoint && (is_interrupted || isCheckpointFrame(_accumulated_frames_count)))
+			saveCheckpoint(settings.checkpoint_path);
+	}
+
+	const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start_time;
+
+	log::info(
+		"[JunkShop] Offline: {} spp in {:.1f} s, {:.2f} Mrays/s including shadow rays",
+		_accumulated_frames_count - start_frame_count,
+		time.count(),
+		static_cast<double>(ray_count) / std::max(time.count(), 1e-6) * 1e-6
+	);
+
+	if (is_interrupted)
+	{
+		log::info("[JunkShop] Offline render interrupted at {} spp", _accumulated_frames_count);
+		return ;
+	}
+
+	if (has_checkpoint && !isCheckpointFrame(_accumulated_frames_count))
+		saveCheckpoint(settings.checkpoint_path);
+
+	const auto accumulation = readAccumulationBuffer();
+
+	std::vector<glm::vec4> tone_mapped (accumulation.size());
+
+	result.readData(ImageWriteData
+	{
+		.ptr_data	= reinterpret_cast<uint8_t*>(tone_mapped.data()),
+		.width		= static_cast<int>(width),
+		.height		= static_cast<int>(height),
+		.format		= VK_FORMAT_R32G32B32A32_SFLOAT
+	});
+
+	const auto to_rgb = [] (const std::vector<glm::vec4>& pixels)
+	{
+		std::vector<glm::vec3> rgb (pixels.size());
+		std::ranges::transform(pixels, std::begin(rgb), [] (const glm::vec4& pixel) { return glm::vec3(pixel); });
+		return rgb;
+	};
+
+	auto exr_path = settings.output_path;
+	auto png_path = settings.output_path;
+
+	image_writer::writeExr(exr_path.replace_extension(".exr"), width, height, to_rgb(accumulation));
+	image_writer::writePng(png_path.replace_extension(".png"), width, height, to_rgb(tone_mapped));
+
+	log::info("[JunkShop] Offline render saved: {}, {}", exr_path.string(), png_path.string());
+}
+
 void JunkShop::importScene()
 {
 	auto [width, height] = _window->getSize();
@@ -734,8 +1927,6 @@ void JunkShop::importScene()
 	);
 
 	_scene->applyTransform(glm::scale(glm::mat4(1), glm::vec3(100)));
-
-	createAS();
 }
 
 void JunkShop::initVertexBuffersReferences()
@@ -779,12 +1970,29 @@ PushConstants JunkShop::getPushConstantData()
 	constants.rgen_consts.camera_data.inv_view_matrix 		= camera.getInvViewMatrix();
 	constants.rgen_consts.camera_data.inv_projection_matrix = camera.getInvProjection();
 	constants.rgen_consts.accumulated_frames_count			= _accumulated_frames_count;
+	constants.rgen_consts.is_aovs_enabled					= _denoiser.is_enabled ? 1 : 0;
+	constants.rgen_consts.render_scale						= _render_scale.scale;
 
-	constants.chit_consts.eye_to_pixel_cone_spread_angle = camera.getEyeToPixelConeSpreadAngle();
+	constants.chit_consts.eye_to_pixel_cone_spread_angle	= camera.getEyeToPixelConeSpreadAngle();
+	constants.chit_consts.russian_roulette_min_bounces		= _russian_roulette_min_bounces;
 
 	return constants; 
 }
 
+WavefrontPass::PushConstants JunkShop::getWavefrontPushConstantData()
+{
+	const auto& camera = _scene->getCameraController().getCamera();
+
+	return WavefrontPass::PushConstants
+	{
+		.inv_view_matrix				= camera.getInvViewMatrix(),
+		.inv_projection_matrix			= camera.getInvProjection(),
+		.accumulated_frames_count		= _accumulated_frames_count,
+		.russian_roulette_min_bounces	= _russian_roulette_min_bounces,
+		.eye_to_pixel_cone_spread_angle	= camera.getEyeToPixelConeSpreadAngle()
+	};
+}
+
 void JunkShop::buildCommandBuffers()
 {
 	/// build command buffers for switch images layout from swapchain
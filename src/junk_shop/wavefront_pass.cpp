@@ -0,0 +1,604 @@
+#include <junk_shop/wavefront_pass.hpp>
+
+#include <base/vulkan/context.hpp>
+#include <base/vulkan/utils.hpp>
+
+#include <base/logger/logger.hpp>
+#include <base/configuration.hpp>
+
+#include <base/shader_compiler.hpp>
+
+#include <ranges>
+#include <cstring>
+#include <cstddef>
+
+namespace vrts::junk_shop
+{
+    /// Все стадии читают то, что записала предыдущая, а косвенный dispatch - размеры очередей.
+    /// Чтения тоже в источнике: сброс очередей и заполнение бинов перезаписывают то, что читали прошлые стадии.
+    static void stageBarrier(VkCommandBuffer command_buffer_handle)
+    {
+        const VkMemoryBarrier stage_barrier
+        {
+            .sType          = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask  =
+                    VK_ACCESS_SHADER_READ_BIT
+                |   VK_ACCESS_SHADER_WRITE_BIT
+                |   VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+                |   VK_ACCESS_TRANSFER_READ_BIT
+                |   VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask  =
+                    VK_ACCESS_SHADER_READ_BIT
+                |   VK_ACCESS_SHADER_WRITE_BIT
+                |   VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+                |   VK_ACCESS_TRANSFER_READ_BIT
+                |   VK_ACCESS_TRANSFER_WRITE_BIT
+        };
+
+        vkCmdPipelineBarrier(
+            command_buffer_handle,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1, &stage_barrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+}
+
+namespace vrts::junk_shop
+{
+    WavefrontPass::WavefrontPass(const Context* ptr_context) :
+        _ptr_context (ptr_context)
+    { }
+
+    WavefrontPass::WavefrontPass(WavefrontPass&& wavefront_pass) :
+        _width              (wavefront_pass._width),
+        _height             (wavefront_pass._height),
+        _material_count     (wavefront_pass._material_count),
+        _buffers            (std::move(wavefront_pass._buffers)),
+        _statistics_buffer  (std::move(wavefront_pass._statistics_buffer)),
+        _ptr_context        (wavefront_pass._ptr_context)
+    {
+        std::swap(_pipeline_handles, wavefront_pass._pipeline_handles);
+        std::swap(_pipeline_layout, wavefront_pass._pipeline_layout);
+        std::swap(_descriptor_set_layout, wavefront_pass._descriptor_set_layout);
+        std::swap(_descriptor_pool_handle, wavefront_pass._descriptor_pool_handle);
+        std::swap(_descriptor_set_handle, wavefront_pass._descriptor_set_handle);
+    }
+
+    WavefrontPass::~WavefrontPass()
+    {
+        if (_descriptor_pool_handle != VK_NULL_HANDLE)
+            vkDestroyDescriptorPool(_ptr_context->device_handle, _descriptor_pool_handle, nullptr);
+
+        if (_descriptor_set_layout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(_ptr_context->device_handle, _descriptor_set_layout, nullptr);
+
+        if (_pipeline_layout != VK_NULL_HANDLE)
+            vkDestroyPipelineLayout(_ptr_context->device_handle, _pipeline_layout, nullptr);
+
+        for (auto pipeline_handle: _pipeline_handles)
+        {
+            if (pipeline_handle != VK_NULL_HANDLE)
+                vkDestroyPipeline(_ptr_context->device_handle, pipeline_handle, nullptr);
+        }
+    }
+
+    WavefrontPass& WavefrontPass::operator = (WavefrontPass&& wavefront_pass)
+    {
+        _width              = wavefront_pass._width;
+        _height             = wavefront_pass._height;
+        _material_count     = wavefront_pass._material_count;
+        _buffers            = std::move(wavefront_pass._buffers);
+        _statistics_buffer  = std::move(wavefront_pass._statistics_buffer);
+        _ptr_context        = wavefront_pass._ptr_context;
+
+        std::swap(_pipeline_handles, wavefront_pass._pipeline_handles);
+        std::swap(_pipeline_layout, wavefront_pass._pipeline_layout);
+        std::swap(_descriptor_set_layout, wavefront_pass._descriptor_set_layout);
+        std::swap(_descriptor_pool_handle, wavefront_pass._descriptor_pool_handle);
+        std::swap(_descriptor_set_handle, wavefront_pass._descriptor_set_handle);
+
+        return *this;
+    }
+
+    void WavefrontPass::createBuffers()
+    {
+        const auto path_count = static_cast<VkDeviceSize>(_width) * _height;
+
+        std::array<VkDeviceSize, Bindings::count> sizes;
+        sizes[Bindings::queues]             = sizeof(Queue) * Queues::count;
+        sizes[Bindings::paths]              = path_size * path_count;
+        sizes[Bindings::hits]               = hit_record_size * path_count;
+        sizes[Bindings::ray_queues]         = sizeof(uint32_t) * path_count * 2;
+        sizes[Bindings::hit_queue]          = sizeof(uint32_t) * path_count;
+        sizes[Bindings::sorted_hit_queue]   = sizeof(uint32_t) * path_count;
+        sizes[Bindings::shadow_queue]       = shadow_ray_size * path_count;
+        sizes[Bindings::material_bins]      = sizeof(MaterialBin) * _material_count;
+
+        constexpr std::array names
+        {
+            "[WavefrontPass] Queues",
+            "[WavefrontPass] Paths",
+            "[WavefrontPass] Hits",
+            "[WavefrontPass] Ray queues",
+            "[WavefrontPass] Hit queue",
+            "[WavefrontPass] Sorted hit queue",
+            "[WavefrontPass] Shadow queue",
+            "[WavefrontPass] Material bins"
+        };
+
+        for (auto i: std::views::iota(0u, _buffers.size()))
+        {
+            VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+            if (i == Bindings::queues)
+                usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+            if (i == Bindings::material_bins)
+                usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+            _buffers[i] = Buffer::Builder(_ptr_context)
+                .vkSize(sizes[i])
+                .vkUsage(usage)
+                .isHostVisible(false)
+                .name(names[i])
+                .build();
+        }
+
+        _statistics_buffer = Buffer::Builder(_ptr_context)
+            .vkSize(sizeof(Queue) * Queues::count * max_bounce_count)
+            .vkUsage(VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+            .isHostVisible(true)
+            .name("[WavefrontPass] Queue statistics")
+            .build();
+    }
+
+    void WavefrontPass::updateDescriptorSet()
+    {
+        std::array<VkDescriptorBufferInfo, Bindings::count> buffers_info;
+        std::array<VkWriteDescriptorSet, Bindings::count>   write_infos;
+
+        for (auto i: std::views::iota(0u, write_infos.size()))
+        {
+            buffers_info[i] = VkDescriptorBufferInfo
+            {
+                .buffer = _buffers[i]->vk_handle,
+                .offset = 0,
+                .range  = VK_WHOLE_SIZE
+            };
+
+            write_infos[i] = { };
+            write_infos[i].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write_infos[i].descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write_infos[i].dstArrayElement  = 0;
+            write_infos[i].dstBinding       = static_cast<uint32_t>(i);
+            write_infos[i].dstSet           = _descriptor_set_handle;
+            write_infos[i].descriptorCount  = 1;
+            write_infos[i].pBufferInfo      = &buffers_info[i];
+        }
+
+        vkUpdateDescriptorSets(
+            _ptr_context->device_handle,
+            static_cast<uint32_t>(write_infos.size()), write_infos.data(),
+            0, nullptr
+        );
+    }
+
+    void WavefrontPass::resize(uint32_t width, uint32_t height)
+    {
+        _width  = width;
+        _height = height;
+
+        createBuffers();
+        updateDescriptorSet();
+    }
+
+    void WavefrontPass::process(
+        VkCommandBuffer         command_buffer_handle,
+        VkDescriptorSet         scene_descriptor_set,
+        const PushConstants&    push_constants
+    ) const
+    {
+        const auto path_count       = _width * _height;
+        const auto path_group_count = (path_count + group_size - 1) / group_size;
+
+        const auto queues_handle = _buffers[Bindings::queues]->vk_handle;
+
+        const std::array descriptor_sets
+        {
+            scene_descriptor_set,
+            _descriptor_set_handle
+        };
+
+        vkCmdBindDescriptorSets(
+            command_buffer_handle,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            _pipeline_layout,
+            0,
+            static_cast<uint32_t>(descriptor_sets.size()), descriptor_sets.data(),
+            0, nullptr
+        );
+
+        const auto resetQueue = [command_buffer_handle, queues_handle] (uint32_t queue)
+        {
+            constexpr Queue empty_queue
+            {
+                .count          = 0,
+                .group_count    = {.x = 0, .y = 1, .z = 1}
+            };
+
+            vkCmdUpdateBuffer(command_buffer_handle, queues_handle, sizeof(Queue) * queue, sizeof(Queue), &empty_queue);
+        };
+
+        const auto bindStage = [this, command_buffer_handle, &push_constants] (size_t stage, uint32_t bounce)
+        {
+            auto stage_push_constants = push_constants;
+
+            stage_push_constants.bounce         = bounce;
+            stage_push_constants.width          = _width;
+            stage_push_constants.height         = _height;
+            stage_push_constants.material_count = _material_count;
+
+            vkCmdBindPipeline(command_buffer_handle, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline_handles[stage]);
+
+            vkCmdPushConstants(
+                command_buffer_handle,
+                _pipeline_layout,
+                VK_SHADER_STAGE_COMPUTE_BIT,
+                0, sizeof(PushConstants), &stage_push_constants
+            );
+        };
+
+        const auto dispatchQueue = [command_buffer_handle, queues_handle] (uint32_t queue)
+        {
+            vkCmdDispatchIndirect(command_buffer_handle, queues_handle, sizeof(Queue) * queue + offsetof(Queue, group_count));
+        };
+
+        /// Прошлый кадр мог ещё читать бины и очереди.
+        stageBarrier(command_buffer_handle);
+
+        vkCmdFillBuffer(command_buffer_handle, _buffers[Bindings::material_bins]->vk_handle, 0, VK_WHOLE_SIZE, 0);
+
+        for (auto queue: std::views::iota(0u, static_cast<uint32_t>(Queues::count)))
+            resetQueue(queue);
+
+        stageBarrier(command_buffer_handle);
+
+        bindStage(Stages::generate, 0);
+        vkCmdDispatch(command_buffer_handle, path_group_count, 1, 1);
+
+        for (auto bounce: std::views::iota(0u, max_bounce_count))
+        {
+            const auto ray_queue = bounce & 1;
+
+            /// Сбросы ждут, пока connect и копирование статистики прошлого отскока дочитают очереди.
+            if (bounce > 0)
+            {
+                stageBarrier(command_buffer_handle);
+
+                resetQueue(ray_queue ^ 1);
+                resetQueue(Queues::hits);
+                resetQueue(Queues::shadow_rays);
+            }
+
+            stageBarrier(command_buffer_handle);
+
+            bindStage(Stages::extend, bounce);
+            dispatchQueue(ray_queue);
+
+            stageBarrier(command_buffer_handle);
+
+            bindStage(Stages::scan, bounce);
+            vkCmdDispatch(command_buffer_handle, 1, 1, 1);
+
+            stageBarrier(command_buffer_handle);
+
+            bindStage(Stages::sort, bounce);
+            dispatchQueue(Queues::hits);
+
+            stageBarrier(command_buffer_handle);
+
+            bindStage(Stages::shade, bounce);
+            dispatchQueue(Queues::hits);
+
+            stageBarrier(command_buffer_handle);
+
+            bindStage(Stages::connect, bounce);
+            dispatchQueue(Queues::shadow_rays);
+
+            /// Очередь лучей этого отскока shade уже не трогает, она ещё цела.
+            const VkBufferCopy statistics_region
+            {
+                .srcOffset  = 0,
+                .dstOffset  = sizeof(Queue) * Queues::count * bounce,
+                .size       = sizeof(Queue) * Queues::count
+            };
+
+            vkCmdCopyBuffer(command_buffer_handle, queues_handle, _statistics_buffer->vk_handle, 1, &statistics_region);
+        }
+
+        stageBarrier(command_buffer_handle);
+
+        bindStage(Stages::resolve, max_bounce_count);
+        vkCmdDispatch(command_buffer_handle, path_group_count, 1, 1);
+
+        const VkMemoryBarrier read_statistics_barrier
+        {
+            .sType          = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask  = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask  = VK_ACCESS_HOST_READ_BIT
+        };
+
+        vkCmdPipelineBarrier(
+            command_buffer_handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+            1, &read_statistics_barrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+
+    auto WavefrontPass::readQueueStatistics() const
+        -> std::array<QueueStatistics, max_bounce_count>
+    {
+        std::array<std::array<Queue, Queues::count>, max_bounce_count> queues;
+
+        void* ptr_memory = nullptr;
+
+        VK_CHECK(
+            vkMapMemory(
+                _ptr_context->device_handle,
+                _statistics_buffer->memory_handle,
+                0, sizeof(queues),
+                0,
+                &ptr_memory
+            )
+        );
+
+        const VkMappedMemoryRange memory_range
+        {
+            .sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .memory = _statistics_buffer->memory_handle,
+            .offset = 0,
+            .size   = VK_WHOLE_SIZE
+        };
+
+        VK_CHECK(vkInvalidateMappedMemoryRanges(_ptr_context->device_handle, 1, &memory_range));
+
+        memcpy(queues.data(), ptr_memory, sizeof(queues));
+
+        vkUnmapMemory(_ptr_context->device_handle, _statistics_buffer->memory_handle);
+
+        std::array<QueueStatistics, max_bounce_count> statistics;
+
+        for (auto bounce: std::views::iota(0u, max_bounce_count))
+        {
+            statistics[bounce] = QueueStatistics
+            {
+                .ray_count          = queues[bounce][bounce & 1].count,
+                .hit_count          = queues[bounce][Queues::hits].count,
+                .shadow_ray_count   = queues[bounce][Queues::shadow_rays].count
+            };
+        }
+
+        return statistics;
+    }
+}
+
+namespace vrts::junk_shop
+{
+    WavefrontPass::Builder::Builder(const Context* ptr_context) :
+        _ptr_context(ptr_context)
+    {
+        if (!ptr_context)
+            log::error("[WavefrontPass::Builder] Vulkan context is null");
+    }
+
+    WavefrontPass::Builder::~Builder()
+    {
+        for (auto shader_handle: _compute_shader_handles)
+            vkDestroyShaderModule(_ptr_context->device_handle, shader_handle, nullptr);
+    }
+
+    WavefrontPass::Builder& WavefrontPass::Builder::sceneDescriptorSetLayout(VkDescriptorSetLayout descriptor_set_layout) noexcept
+    {
+        _scene_descriptor_set_layout = descriptor_set_layout;
+        return *this;
+    }
+
+    WavefrontPass::Builder& WavefrontPass::Builder::materialCount(uint32_t material_count) noexcept
+    {
+        _material_count = material_count;
+        return *this;
+    }
+
+    WavefrontPass::Builder& WavefrontPass::Builder::size(uint32_t width, uint32_t height) noexcept
+    {
+        _width  = width;
+        _height = height;
+        return *this;
+    }
+
+    void WavefrontPass::Builder::createPipelineLayout()
+    {
+        log::info("[WavefrontPass::Builder] Create pipeline layout");
+
+        std::array<VkDescriptorSetLayoutBinding, Bindings::count> bindings_info;
+
+        for (auto i: std::views::iota(0u, bindings_info.size()))
+        {
+            bindings_info[i] = { };
+            bindings_info[i].binding            = static_cast<uint32_t>(i);
+            bindings_info[i].descriptorCount    = 1;
+            bindings_info[i].descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings_info[i].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        const VkDescriptorSetLayoutCreateInfo descriptor_set_info
+        {
+            .sType           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount    = static_cast<uint32_t>(bindings_info.size()),
+            .pBindings       = bindings_info.data()
+        };
+
+        VK_CHECK(vkCreateDescriptorSetLayout(
+            _ptr_context->device_handle,
+            &descriptor_set_info,
+            nullptr,
+            &_descriptor_set_layout
+        ));
+
+        const std::array set_layouts
+        {
+            _scene_descriptor_set_layout,
+            _descriptor_set_layout
+        };
+
+        constexpr VkPushConstantRange push_constant_range
+        {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset     = 0,
+            .size       = sizeof(PushConstants)
+        };
+
+        const VkPipelineLayoutCreateInfo layout_info
+        {
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = static_cast<uint32_t>(set_layouts.size()),
+            .pSetLayouts            = set_layouts.data(),
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &push_constant_range
+        };
+
+        VK_CHECK(vkCreatePipelineLayout(
+            _ptr_context->device_handle,
+            &layout_info,
+            nullptr,
+            &_pipeline_layout
+        ));
+    }
+
+    void WavefrontPass::Builder::createPipelines()
+    {
+        log::info("[WavefrontPass::Builder] Create compute pipelines");
+
+        constexpr std::array shader_names
+        {
+            "shaders/junk_shop/wavefront_generate.glsl.comp",
+            "shaders/junk_shop/wavefront_extend.glsl.comp",
+            "shaders/junk_shop/wavefront_scan.glsl.comp",
+            "shaders/junk_shop/wavefront_sort.glsl.comp",
+            "shaders/junk_shop/wavefront_shade.glsl.comp",
+            "shaders/junk_shop/wavefront_connect.glsl.comp",
+            "shaders/junk_shop/wavefront_resolve.glsl.comp"
+        };
+
+        std::array<VkComputePipelineCreateInfo, Stages::count> pipelines_info;
+
+        for (auto i: std::views::iota(0u, pipelines_info.size()))
+        {
+            _compute_shader_handles[i] = shader::Compiler::createShaderModule(
+                _ptr_context->device_handle,
+                project_dir / shader_names[i],
+                shader::Type::compute
+            );
+
+            const VkPipelineShaderStageCreateInfo stage
+            {
+                .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = _compute_shader_handles[i],
+                .pName  = "main"
+            };
+
+            pipelines_info[i] = VkComputePipelineCreateInfo
+            {
+                .sType     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                .stage     = stage,
+                .layout    = _pipeline_layout
+            };
+        }
+
+        VK_CHECK(vkCreateComputePipelines(
+            _ptr_context->device_handle,
+            VK_NULL_HANDLE,
+            static_cast<uint32_t>(pipelines_info.size()), pipelines_info.data(),
+            nullptr,
+            _pipeline_handles.data()
+        ));
+    }
+
+    void WavefrontPass::Builder::createDescriptorPool()
+    {
+        constexpr VkDescriptorPoolSize descriptor_size
+        {
+            .type               = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount    = Bindings::count
+        };
+
+        const VkDescriptorPoolCreateInfo descriptor_pool_info
+        {
+            .sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets        = 1,
+            .poolSizeCount  = 1,
+            .pPoolSizes     = &descriptor_size
+        };
+
+        VK_CHECK(vkCreateDescriptorPool(
+            _ptr_context->device_handle,
+            &descriptor_pool_info,
+            nullptr,
+            &_descriptor_pool_handle
+        ));
+    }
+
+    void WavefrontPass::Builder::allocateDescriptorSet()
+    {
+        const VkDescriptorSetAllocateInfo allocate_info
+        {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = _descriptor_pool_handle,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &_descriptor_set_layout
+        };
+
+        VK_CHECK(vkAllocateDescriptorSets(_ptr_context->device_handle, &allocate_info, &_descriptor_set_handle));
+
+        VkUtils::setName(
+            _ptr_context->device_handle,
+            _descriptor_set_handle,
+            VK_OBJECT_TYPE_DESCRIPTOR_SET,
+            "[WavefrontPass] Descriptor set"
+        );
+    }
+
+    WavefrontPass WavefrontPass::Builder::build()
+    {
+        if (_scene_descriptor_set_layout == VK_NULL_HANDLE)
+            log::error("[WavefrontPass::Builder] Scene descriptor set layout is null");
+
+        if (_material_count == 0)
+            log::error("[WavefrontPass::Builder] Material count must be positive");
+
+        createPipelineLayout();
+        createPipelines();
+        createDescriptorPool();
+        allocateDescriptorSet();
+
+        WavefrontPass wavefront_pass (_ptr_context);
+
+        wavefront_pass._material_count          = _material_count;
+        wavefront_pass._pipeline_handles        = _pipeline_handles;
+        wavefront_pass._pipeline_layout         = _pipeline_layout;
+        wavefront_pass._descriptor_set_layout   = _descriptor_set_layout;
+        wavefront_pass._descriptor_pool_handle  = _descriptor_pool_handle;
+        wavefront_pass._descriptor_set_handle   = _descriptor_set_handle;
+
+        wavefront_pass.resize(_width, _height);
+
+        return wavefront_pass;
+    }
+}
@@ -0,0 +1,312 @@
+#include <scene_scaling/scene_scaling.hpp>
+
+#include <dancing_penguin/animation_pass.hpp>
+
+#include <base/scene/node.hpp>
+#include <base/scene/visitors/acceleration_structure_builder.hpp>
+#include <base/scene/visitors/scene_geometry_references_getter.hpp>
+
+#include <base/logger/logger.hpp>
+
+#include <ranges>
+#include <format>
+
+using namespace scene_scaling;
+
+namespace vrts::scene_scaling
+{
+    /// Суммирует размеры буферов BLAS и TLAS.
+    class ASSizeCounter final :
+        public NodeVisitor
+    {
+        void add(const Node* ptr_node) noexcept
+        {
+            if (ptr_node->acceleation_structure && ptr_node->acceleation_structure->buffer)
+                _size += static_cast<size_t>(ptr_node->acceleation_structure->buffer->size_in_bytes);
+        }
+
+        void process(Node* ptr_node) override
+        {
+            add(ptr_node);
+
+            for (const auto& child: ptr_node->children)
+                child->visit(this);
+        }
+
+        void process(MeshNode* ptr_node)        override { add(ptr_node); }
+        void process(SkinnedMeshNode* ptr_node) override { add(ptr_node); }
+
+    public:
+        [[nodiscard]]
+        size_t getSize() const noexcept
+        {
+            return _size;
+        }
+
+    private:
+        size_t _size = 0;
+    };
+
+    template<typename Func>
+    [[nodiscard]] Milliseconds measure(Func&& func)
+    {
+        const auto begin = std::chrono::high_resolution_clock::now();
+        func();
+        return std::chrono::high_resolution_clock::now() - begin;
+    }
+}
+
+void SceneScaling::init()
+{
+    RayTracingBase::init("SceneScaling");
+
+    /// Каждая серия меняет одно измерение, остальные берутся из базовой конфигурации.
+    const Configuration base_configuration;
+
+    for (auto instance_count: {16u, 64u, 256u, 1024u, 4096u})
+    {
+        auto& configuration = _configurations.emplace_back(base_configuration);
+        configuration.dimension         = "instances";
+        configuration.instance_count    = instance_count;
+    }
+
+    for (auto triangle_count: {128u, 2048u, 32768u, 131072u})
+    {
+        auto& configuration = _configurations.emplace_back(base_configuration);
+        configuration.dimension         = "triangles";
+        configuration.triangle_count    = triangle_count;
+    }
+
+    for (auto material_count: {1u, 8u, 64u, 512u})
+    {
+        auto& configuration = _configurations.emplace_back(base_configuration);
+        configuration.dimension         = "materials";
+        configuration.instance_count    = std::max(base_configuration.instance_count, material_count);
+        configuration.material_count    = material_count;
+    }
+
+    for (auto skinned_instance_count: {1u, 16u, 64u, 256u})
+    {
+        auto& configuration = _configurations.emplace_back(base_configuration);
+        configuration.dimension                 = "skinned";
+        configuration.skinned_instance_count    = skinned_instance_count;
+    }
+}
+
+void SceneScaling::resizeWindow()
+{ }
+
+Milliseconds SceneScaling::measureReferences(Scene& scene)
+{
+    return measure([this, &scene]
+    {
+        auto ptr_visitor = std::make_unique<SceneGeometryReferencesGetter>(getContext());
+        scene.getModel().visit(ptr_visitor);
+
+        std::ignore = ptr_visitor->getVertexBuffersReferences();
+        std::ignore = ptr_visitor->getIndexBuffersReferences();
+    });
+}
+
+Milliseconds SceneScaling::measureDescriptors(const Scene& scene)
+{
+    /// Как albedos в DancingPenguin: массив дескрипторов на каждый инстанс.
+    const auto& material_manager    = scene.getModel().getMaterialManager();
+    const auto  instance_count      = static_cast<uint32_t>(material_manager.getInstanceCount());
+
+    VkDescriptorSetLayout   descriptor_set_layout_handle    = VK_NULL_HANDLE;
+    VkDescriptorPool        descriptor_pool_handle          = VK_NULL_HANDLE;
+
+    const auto time = measure([&]
+    {
+        const VkDescriptorSetLayoutBinding binding
+        {
+            .binding            = 0,
+            .descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount    = instance_count,
+            .stageFlags         = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR
+        };
+
+        const VkDescriptorSetLayoutCreateInfo set_layout_info
+        {
+            .sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount   = 1,
+            .pBindings      = &binding
+        };
+
+        VK_CHECK(vkCreateDescriptorSetLayout(_context.device_handle, &set_layout_info, nullptr, &descriptor_set_layout_handle));
+
+        const VkDescriptorPoolSize pool_size { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, instance_count };
+
+        const VkDescriptorPoolCreateInfo descriptor_pool_create_info
+        {
+            .sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets        = 1,
+            .poolSizeCount  = 1,
+            .pPoolSizes     = &pool_size
+        };
+
+        VK_CHECK(vkCreateDescriptorPool(_context.device_handle, &descriptor_pool_create_info, nullptr, &descriptor_pool_handle));
+
+        const VkDescriptorSetAllocateInfo descriptor_set_allocate_info
+        {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = descriptor_pool_handle,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &descriptor_set_layout_handle
+        };
+
+        VkDescriptorSet descriptor_set_handle = VK_NULL_HANDLE;
+        VK_CHECK(vkAllocateDescriptorSets(_context.device_handle, &descriptor_set_allocate_info, &descriptor_set_handle));
+
+        std::vector<VkDescriptorImageInfo> albedos_infos (instance_count);
+        for (auto i: std::views::iota(0u, instance_count))
+        {
+            const auto& albedo = material_manager.getInstanceMaterial(i).albedo;
+
+            albedos_infos[i] = { };
+            albedos_infos[i].imageLayout    = VK_IMAGE_LAYOUT_GENERAL;
+            albedos_infos[i].imageView      = albedo->view_handle;
+            albedos_infos[i].sampler        = albedo->sampler_handle;
+        }
+
+        const VkWriteDescriptorSet albedo_write_info
+        {
+            .sType             = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet            = descriptor_set_handle,
+            .dstBinding        = 0,
+            .dstArrayElement   = 0,
+            .descriptorCount   = instance_count,
+            .descriptorType    = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo        = albedos_infos.data(),
+        };
+
+        vkUpdateDescriptorSets(_context.device_handle, 1, &albedo_write_info, 0, nullptr);
+    });
+
+    vkDestroyDescriptorPool(_context.device_handle, descriptor_pool_handle, nullptr);
+    vkDestroyDescriptorSetLayout(_context.device_handle, descriptor_set_layout_handle, nullptr);
+
+    return time;
+}
+
+Result SceneScaling::run(const Configuration& configuration)
+{
+    constexpr auto skinning_palette_type = SkinningPaletteType::affine;
+
+    auto [width, height] = _window->getSize();
+
+    Result result;
+    result.configuration = configuration;
+
+    Scene::Generator generator (getContext());
+
+    auto scene = generator
+        .instanceCount(configuration.instance_count)
+        .triangleCount(configuration.triangle_count)
+        .materialCount(configuration.material_count)
+        .skinnedInstanceCount(configuration.skinned_instance_count)
+        .skinningPalette(skinning_palette_type)
+        .viewport(width, height)
+        .generate();
+
+    result.generator_statistics = generator.getStatistics();
+
+    auto& model = scene.getModel();
+
+    std::optional<dancing_penguin::AnimationPass> animation_pass;
+
+    if (scene.hasAnimator())
+    {
+        result.animation_build_time = measure([this, &model, &animation_pass]
+        {
+            auto ptr_animation_pass_builder = std::make_unique<dancing_penguin::AnimationPass::Builder>(getContext());
+            ptr_animation_pass_builder->skinningPaletteType(skinning_palette_type);
+
+            model.visit(ptr_animation_pass_builder);
+
+            animation_pass = ptr_animation_pass_builder->build();
+        });
+
+        result.animation_process_time = measure([&scene, &animation_pass]
+        {
+            constexpr auto delta_time = 1.0f / 60.0f;
+
+            auto& animator = scene.getAnimator();
+
+            animator.update(delta_time);
+            animation_pass->process(animator.getSkinningPalette());
+        });
+    }
+
+    result.as_build_time = measure([this, &scene, &model]
+    {
+        model.updateTransforms();
+
+        const LodPolicy lod_policy
+        {
+            .eye = glm::vec3(scene.getCameraController().getCamera().getInvViewMatrix() * glm::vec4(0, 0, 0, 1))
+        };
+
+        auto ptr_as_builder = std::make_unique<ASBuilder>(getContext(), model.getTransformHierarchy(), lod_policy);
+        model.visit(ptr_as_builder);
+    });
+
+    auto ptr_as_size_counter = std::make_unique<ASSizeCounter>();
+    model.visit(ptr_as_size_counter);
+
+    result.acceleration_structures_size = ptr_as_size_counter->getSize();
+
+    result.references_time  = measureReferences(scene);
+    result.descriptors_time = measureDescriptors(scene);
+
+    /// Буферы сцены освобождаются на выходе из run().
+    VK_CHECK(vkDeviceWaitIdle(_context.device_handle));
+
+    return result;
+}
+
+void SceneScaling::print(std::span<const Result> results)
+{
+    constexpr auto bytes_per_kilobyte = 1024.0f;
+
+    log::info("[SceneScaling] {:>10} {:>9} {:>10} {:>9} {:>7} | {:>11} {:>9} {:>9} {:>9} {:>9} {:>9} | {:>11} {:>9} {:>9}",
+        "dimension", "instances", "triangles", "materials", "skinned",
+        "generate ms", "AS ms", "refs ms", "descr ms", "anim init", "anim ms",
+        "geometry KB", "AS KB", "mat KB"
+    );
+
+    for (const auto& result: results)
+    {
+        const auto& configuration   = result.configuration;
+        const auto& statistics      = result.generator_statistics;
+
+        log::info("[SceneScaling] {:>10} {:>9} {:>10} {:>9} {:>7} | {:>11.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} | {:>11.1f} {:>9.1f} {:>9.2f}",
+            configuration.dimension,
+            configuration.instance_count,
+            statistics.triangle_count,
+            configuration.material_count,
+            configuration.skinned_instance_count,
+            statistics.generate_time.count(),
+            result.as_build_time.count(),
+            result.references_time.count(),
+            result.descriptors_time.count(),
+            result.animation_build_time.count(),
+            result.animation_process_time.count(),
+            static_cast<float>(statistics.geometry_size) / bytes_per_kilobyte,
+            static_cast<float>(result.acceleration_structures_size) / bytes_per_kilobyte,
+            static_cast<float>(statistics.material_size) / bytes_per_kilobyte
+        );
+    }
+}
+
+void SceneScaling::show()
+{
+    std::vector<Result> results;
+    results.reserve(_configurations.size());
+
+    for (const auto& configuration: _configurations)
+        results.push_back(run(configuration));
+
+    print(results);
+}
@@ -0,0 +1,151 @@
+#include "test.hpp"
+
+#include <junk_shop/atrous_denoiser.hpp>
+
+#include <vector>
+#include <ranges>
+#include <random>
+#include <cmath>
+#include <tuple>
+#include <exception>
+
+namespace vrts::test
+{
+    constexpr uint32_t aov_width    = 128;
+    constexpr uint32_t aov_height   = 64;
+
+    static junk_shop::atrous::FeatureBuffers makeFeatures()
+    {
+        junk_shop::atrous::FeatureBuffers features;
+
+        features.width  = aov_width;
+        features.height = aov_height;
+
+        for (auto y: std::views::iota(0u, aov_height))
+        {
+            for (auto x: std::views::iota(0u, aov_width))
+            {
+                const auto u = (static_cast<float>(x) + 0.5f) / static_cast<float>(aov_width);
+                const auto v = (static_cast<float>(y) + 0.5f) / static_cast<float>(aov_height);
+
+                const auto is_sky   = v < 0.2f;
+                const auto is_floor = v > 0.6f;
+                const auto is_left  = u < 0.5f;
+
+                const auto normal   = is_floor ? glm::vec3(0, 1, 0) : glm::normalize(glm::vec3(is_left ? 1.0f : -1.0f, 0, 1));
+                const auto checker  = (static_cast<uint32_t>(u * 8.0f) + static_cast<uint32_t>(v * 8.0f)) % 2;
+                const auto albedo   = is_floor && checker ? glm::vec3(0.8f) : glm::vec3(0.3f, 0.5f, 0.7f);
+
+                features.albedo.push_back(is_sky ? glm::vec3(0.0f) : albedo);
+                features.normal.push_back(is_sky ? glm::vec3(0.0f) : normal);
+                features.depth.push_back(is_sky ? 0.0f : 10.0f + 5.0f * v + (is_floor ? 0.0f : std::abs(u - 0.5f) * 4.0f));
+            }
+        }
+
+        return features;
+    }
+
+    static std::vector<glm::vec3> makeReference(const junk_shop::atrous::FeatureBuffers& features)
+    {
+        const auto light_dir = glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f));
+
+        std::vector<glm::vec3> reference;
+
+        for (auto i: std::views::iota(0u, features.depth.size()))
+        {
+            reference.push_back(features.depth[i] > 0.0f ?
+                    features.albedo[i] * (0.2f + std::max(glm::dot(features.normal[i], light_dir), 0.0f))
+                :   glm::vec3(0.4f, 0.6f, 0.9f)
+            );
+        }
+
+        return reference;
+    }
+
+    static std::vector<glm::vec3> addNoise(const junk_shop::atrous::FeatureBuffers& features, std::span<const glm::vec3> reference, float sigma)
+    {
+        std::mt19937                    generator (5);
+        std::normal_distribution<float> distribution (0.0f, sigma);
+
+        std::vector<glm::vec3> noisy (std::begin(reference), std::end(reference));
+
+        for (auto i: std::views::iota(0u, noisy.size()))
+        {
+            if (features.depth[i] > 0.0f)
+                noisy[i] += glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+        }
+
+        return noisy;
+    }
+
+    void testAtrousDenoiser(Runner& runner)
+    {
+        runner.run("atrous/noise_reduction", []
+        {
+            constexpr uint32_t sample_count = 4;
+
+            const auto features     = makeFeatures();
+            const auto reference    = makeReference(features);
+            const auto noisy        = addNoise(features, reference, 0.3f / std::sqrt(static_cast<float>(sample_count)));
+            const auto denoised     = junk_shop::atrous::denoise(noisy, static_cast<float>(sample_count), features);
+
+            const auto noisy_rmse       = junk_shop::atrous::getRmse(noisy, reference);
+            const auto denoised_rmse    = junk_shop::atrous::getRmse(denoised, reference);
+
+            check(denoised_rmse < noisy_rmse * 0.5, "RMSE {} -> {}: the filter removes less than half of the noise", noisy_rmse, denoised_rmse);
+
+            for (auto i: std::views::iota(0u, features.depth.size()))
+            {
+                if (features.depth[i] == 0.0f)
+                    check(denoised[i] == noisy[i], "Sky pixel {} is changed", i);
+            }
+        });
+
+        runner.run("atrous/edges", []
+        {
+            const auto features     = makeFeatures();
+            const auto reference    = makeReference(features);
+            const auto denoised     = junk_shop::atrous::denoise(reference, 1.0f, features);
+
+            const auto rmse = junk_shop::atrous::getRmse(denoised, reference);
+            check(rmse < 0.01, "Noise-free image changed by RMSE {}", rmse);
+
+            for (auto i: std::views::iota(0u, reference.size()))
+            {
+                const auto error = glm::length(denoised[i] - reference[i]);
+                check(error < 0.05f, "Pixel ({}, {}) bled by {}", i % aov_width, i / aov_width, error);
+            }
+        });
+
+        runner.run("atrous/converged", []
+        {
+            const auto features     = makeFeatures();
+            const auto reference    = makeReference(features);
+            const auto noisy        = addNoise(features, reference, 0.05f);
+
+            const auto single_frame_change  = junk_shop::atrous::getRmse(junk_shop::atrous::denoise(noisy, 1.0f, features), noisy);
+            const auto converged_change     = junk_shop::atrous::getRmse(junk_shop::atrous::denoise(noisy, 1e6f, features), noisy);
+
+            check(converged_change < single_frame_change * 0.2, "Converged image changed by RMSE {}, single frame - {}", converged_change, single_frame_change);
+        });
+
+        runner.run("atrous/size_mismatch", []
+        {
+            const auto features = makeFeatures();
+            const std::vector<glm::vec3> color (features.depth.size() - 1);
+
+            bool is_thrown = false;
+
+            try
+            {
+                std::ignore = junk_shop::atrous::denoise(color, 1.0f, features);
+            }
+            catch (const std::exception&)
+            {
+                is_thrown = true;
+            }
+
+            check(is_thrown, "Image smaller than AOVs must be rejected");
+        });
+    }
+}
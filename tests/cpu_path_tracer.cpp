@@ -0,0 +1,51 @@
+#include "test.hpp"
+
+#include <junk_shop/cpu_path_tracer.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <algorithm>
+
+namespace vrts::test
+{
+    void testCpuPathTracer(Runner& runner)
+    {
+        runner.run("cpu_path_tracer/rows", []
+        {
+            constexpr uint32_t width    = 16;
+            constexpr uint32_t height   = 9;
+
+            /// Квадрат перекрывает весь кадр, поэтому глубина должна быть записана в каждый пиксель.
+            const auto path = std::filesystem::temp_directory_path() / "vrts_cpu_path_tracer_rows.obj";
+
+            {
+                std::ofstream file (path);
+                file
+                    << "v -50 -50 -1\nv 50 -50 -1\nv -50 50 -1\nv 50 50 -1\n"
+                    << "vt 0 0\nvt 1 0\nvt 0 1\nvt 1 1\n"
+                    << "f 1/1 2/2 3/3\nf 2/2 4/4 3/3\n";
+            }
+
+            const auto scene_data = SceneData::Loader()
+                .path(path)
+                .load();
+
+            std::filesystem::remove(path);
+
+            Camera camera (width, height);
+            camera.lookaAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+            junk_shop::CpuPathTracer path_tracer (scene_data, camera);
+            path_tracer.render(1);
+
+            const auto& depth = path_tracer.getFeatures().depth;
+
+            for (auto y: std::views::iota(0u, height))
+            {
+                const auto row = std::span(depth).subspan(y * width, width);
+                check(std::ranges::all_of(row, [] (float t) { return t > 0.0f; }), "Row {} of {} wasn't written", y, height);
+            }
+        });
+    }
+}
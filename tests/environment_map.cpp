@@ -0,0 +1,158 @@
+#include "test.hpp"
+
+#include <base/scene/environment_map.hpp>
+
+#include <glm/gtc/constants.hpp>
+
+#include <vector>
+#include <ranges>
+#include <random>
+#include <cmath>
+
+namespace vrts::test
+{
+    constexpr uint32_t environment_width    = 64;
+    constexpr uint32_t environment_height   = 32;
+
+    static std::vector<glm::vec3> makePixels()
+    {
+        std::mt19937                            generator (7);
+        std::uniform_real_distribution<float>   distribution (0.0f, 1.0f);
+
+        std::vector<glm::vec3> pixels (environment_width * environment_height);
+
+        for (auto& pixel: pixels)
+            pixel = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+
+        for (auto x: std::views::iota(0u, environment_width))
+            pixels[20 * environment_width + x] = glm::vec3(0.0f);
+
+        pixels[5 * environment_width + 40] = glm::vec3(500.0f, 400.0f, 300.0f);
+
+        return pixels;
+    }
+
+    static std::vector<double> getExpectedPdfs(std::span<const glm::vec3> pixels)
+    {
+        std::vector<double> pdfs (pixels.size());
+
+        double total = 0.0;
+
+        for (auto y: std::views::iota(0u, environment_height))
+        {
+            const auto sin_theta = std::sin((y + 0.5) / environment_height * glm::pi<double>());
+
+            for (auto x: std::views::iota(0u, environment_width))
+            {
+                const auto& color = pixels[y * environment_width + x];
+
+                pdfs[y * environment_width + x] = (0.2126 * color.r + 0.7152 * color.g + 0.0722 * color.b) * sin_theta;
+                total += pdfs[y * environment_width + x];
+            }
+        }
+
+        for (auto& pdf: pdfs)
+            pdf /= total;
+
+        return pdfs;
+    }
+
+    void testEnvironmentMap(Runner& runner)
+    {
+        runner.run("environment_map/pixel_pdfs", []
+        {
+            const auto pixels           = makePixels();
+            const auto expected_pdfs    = getExpectedPdfs(pixels);
+            const auto environment_map  = EnvironmentMap::build(environment_width, environment_height, pixels);
+
+            const auto pdfs = environment_map.getPixelPdfs();
+
+            check(pdfs.size() == expected_pdfs.size(), "{} pixel pdfs for {} pixels", pdfs.size(), expected_pdfs.size());
+
+            double sum = 0.0;
+
+            for (auto pixel: std::views::iota(0u, pdfs.size()))
+            {
+                check(std::abs(pdfs[pixel] - expected_pdfs[pixel]) < 1e-6 + 1e-4 * expected_pdfs[pixel], "Pdf of pixel {}: {} != {}", pixel, pdfs[pixel], expected_pdfs[pixel]);
+                sum += pdfs[pixel];
+            }
+
+            check(std::abs(sum - 1.0) < 1e-4, "Pixel pdfs sum to {}", sum);
+        });
+
+        runner.run("environment_map/histogram", []
+        {
+            const auto pixels           = makePixels();
+            const auto expected_pdfs    = getExpectedPdfs(pixels);
+            const auto environment_map  = EnvironmentMap::build(environment_width, environment_height, pixels);
+
+            constexpr uint32_t sample_count = 1 << 22;
+
+            std::mt19937                            generator (11);
+            std::uniform_real_distribution<float>   distribution (0.0f, 1.0f);
+
+            std::vector<uint32_t> counts (pixels.size(), 0);
+
+            for ([[maybe_unused]] auto i: std::views::iota(0u, sample_count))
+            {
+                const auto sample = environment_map.sample(glm::vec4(distribution(generator), distribution(generator), distribution(generator), distribution(generator)));
+                ++counts[sample.pixel];
+            }
+
+            /// Частота каждого пикселя - биномиальная величина: допускаем 5 стандартных отклонений.
+            for (auto pixel: std::views::iota(0u, pixels.size()))
+            {
+                const auto expected     = expected_pdfs[pixel];
+                const auto frequency    = static_cast<double>(counts[pixel]) / sample_count;
+                const auto tolerance    = 5.0 * std::sqrt(expected * (1.0 - expected) / sample_count) + 1e-6;
+
+                check(std::abs(frequency - expected) < tolerance, "Frequency of pixel {}: {} != {}", pixel, frequency, expected);
+
+                if (expected == 0.0)
+                    check(counts[pixel] == 0, "Black pixel {} is sampled", pixel);
+            }
+        });
+
+        runner.run("environment_map/solid_angle_pdf", []
+        {
+            const auto environment_map = EnvironmentMap::build(environment_width, environment_height, makePixels());
+
+            std::mt19937                            generator (13);
+            std::uniform_real_distribution<float>   distribution (0.02f, 0.98f);
+
+            double expected_integral = 0.0;
+
+            const auto pixels = environment_map.getPixels();
+
+            for (auto y: std::views::iota(0u, environment_height))
+            {
+                const auto theta_0 = static_cast<double>(y) / environment_height * glm::pi<double>();
+                const auto theta_1 = static_cast<double>(y + 1) / environment_height * glm::pi<double>();
+
+                const auto solid_angle = 2.0 * glm::pi<double>() / environment_width * (std::cos(theta_0) - std::cos(theta_1));
+
+                for (auto x: std::views::iota(0u, environment_width))
+                    expected_integral += pixels[y * environment_width + x].g * solid_angle;
+            }
+
+            constexpr uint32_t sample_count = 1 << 18;
+
+            double integral = 0.0;
+
+            for ([[maybe_unused]] auto i: std::views::iota(0u, sample_count))
+            {
+                /// u.zw не у края пикселя, чтобы направление однозначно возвращалось в тот же пиксель.
+                const auto sample = environment_map.sample(glm::vec4(distribution(generator), distribution(generator), distribution(generator), distribution(generator)));
+
+                const auto pdf = environment_map.getPdf(sample.direction);
+
+                check(std::abs(pdf - sample.pdf) <= 1e-4f * sample.pdf, "Pdf of sampled direction {} != {}", pdf, sample.pdf);
+                check(environment_map.getRadiance(sample.direction) == sample.radiance, "Radiance of pixel {} differs", sample.pixel);
+
+                integral += sample.radiance.g / sample.pdf / sample_count;
+            }
+
+            check(std::abs(integral - expected_integral) < 0.02 * expected_integral, "Integral {} != {}", integral, expected_integral);
+        });
+    }
+}
@@ -0,0 +1,187 @@
+#include "test.hpp"
+
+#include <base/job_system.hpp>
+
+#include <vector>
+#include <ranges>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+
+namespace vrts::test
+{
+    constexpr uint32_t stress_thread_count  = 4;
+    constexpr uint32_t stress_round_count   = 200;
+    constexpr uint32_t stress_fan_out       = 8;
+    constexpr size_t   stress_nested_count  = 512;
+
+    static void checkParallelFor(JobSystem& job_system, size_t begin, size_t end, size_t grain_size)
+    {
+        std::vector<std::atomic<uint32_t>> visits (end);
+
+        job_system.parallelFor(begin, end, grain_size, [&visits] (size_t first, size_t last)
+        {
+            for (auto i: std::views::iota(first, last))
+                visits[i].fetch_add(1, std::memory_order_relaxed);
+        });
+
+        for (auto i: std::views::iota(size_t(0), end))
+        {
+            const auto expected = i >= begin ? 1u : 0u;
+            check(visits[i] == expected, "[{}, {}) with grain {}: index {} visited {} times", begin, end, grain_size, i, visits[i].load());
+        }
+    }
+
+    void testJobSystem(Runner& runner)
+    {
+        runner.run("job_system/parallel_for", []
+        {
+            for (auto thread_count: {0u, 1u, 3u, 7u})
+            {
+                JobSystem job_system (thread_count);
+
+                checkParallelFor(job_system, 0, 0, 1);
+                checkParallelFor(job_system, 5, 5, 1);
+                checkParallelFor(job_system, 0, 1, 1);
+                checkParallelFor(job_system, 3, 1000, 1);
+                checkParallelFor(job_system, 0, 1000, 7);
+                checkParallelFor(job_system, 0, 1000, 5000);
+                checkParallelFor(job_system, 17, 100000, 64);
+            }
+        });
+
+        runner.run("job_system/dependencies", []
+        {
+            JobSystem job_system (3);
+
+            constexpr uint32_t chain_length = 256;
+
+            std::atomic<uint32_t> step = 0;
+            std::atomic<bool>     is_ordered = true;
+
+            JobSystem::JobHandle ptr_prev;
+
+            for (auto i: std::views::iota(0u, chain_length))
+            {
+                auto func = [&step, &is_ordered, i]
+                {
+                    if (step.exchange(i + 1) != i)
+                        is_ordered = false;
+                };
+
+                ptr_prev = ptr_prev ? job_system.submit(func, std::span(&ptr_prev, 1)) : job_system.submit(func);
+            }
+
+            job_system.wait(ptr_prev);
+
+            check(is_ordered && step == chain_length, "Chain ran out of order: {} steps", step.load());
+
+            const auto ptr_finished = job_system.submit([] { });
+            job_system.wait(ptr_finished);
+
+            bool is_run = false;
+            job_system.wait(job_system.submit([&is_run] { is_run = true; }, std::span(&ptr_finished, 1)));
+
+            check(is_run, "Job with a finished dependency didn't run");
+        });
+
+        runner.run("job_system/exceptions", []
+        {
+            JobSystem job_system (3);
+
+            bool is_thrown = false;
+
+            try
+            {
+                job_system.wait(job_system.submit([] { throw std::runtime_error("job"); }));
+            }
+            catch (const std::runtime_error&)
+            {
+                is_thrown = true;
+            }
+
+            check(is_thrown, "wait() didn't rethrow the job's exception");
+
+            std::atomic<size_t> visit_count = 0;
+
+            is_thrown = false;
+
+            try
+            {
+                job_system.parallelFor(0, 64, 1, [&visit_count] (size_t first, size_t last)
+                {
+                    visit_count += last - first;
+
+                    if (first <= 32 && 32 < last)
+                        throw std::runtime_error("chunk");
+                });
+            }
+            catch (const std::runtime_error&)
+            {
+                is_thrown = true;
+            }
+
+            check(is_thrown, "parallelFor didn't rethrow the chunk's exception");
+            check(visit_count == 64, "{} of 64 indices visited", visit_count.load());
+        });
+
+        runner.run("job_system/stress", []
+        {
+            JobSystem job_system (3);
+
+            std::atomic<uint64_t> leaf_count = 0;
+            std::atomic<uint32_t> join_count = 0;
+
+            std::vector<std::jthread> threads;
+
+            for ([[maybe_unused]] auto thread_id: std::views::iota(0u, stress_thread_count))
+            {
+                threads.emplace_back([&job_system, &leaf_count, &join_count]
+                {
+                    std::vector<JobSystem::JobHandle> leaves (stress_fan_out);
+
+                    for ([[maybe_unused]] auto round: std::views::iota(0u, stress_round_count))
+                    {
+                        for (auto& ptr_leaf: leaves)
+                        {
+                            ptr_leaf = job_system.submit([&job_system, &leaf_count]
+                            {
+                                job_system.parallelFor(0, stress_nested_count, 16, [&leaf_count] (size_t first, size_t last)
+                                {
+                                    leaf_count += last - first;
+                                });
+                            });
+                        }
+
+                        job_system.wait(job_system.submit([&join_count] { ++join_count; }, leaves));
+                    }
+                });
+            }
+
+            threads.clear();
+
+            const auto expected_leaf_count = static_cast<uint64_t>(stress_thread_count) * stress_round_count * stress_fan_out * stress_nested_count;
+
+            check(leaf_count == expected_leaf_count, "{} of {} nested iterations ran", leaf_count.load(), expected_leaf_count);
+            check(join_count == stress_thread_count * stress_round_count, "{} of {} joins ran", join_count.load(), stress_thread_count * stress_round_count);
+        });
+
+        runner.run("job_system/nested_pools", []
+        {
+            JobSystem outer_pool (7);
+            JobSystem inner_pool (1);
+
+            std::atomic<uint64_t> leaf_count = 0;
+
+            outer_pool.parallelFor(0, 64, 1, [&inner_pool, &leaf_count] (size_t first, size_t last)
+            {
+                inner_pool.parallelFor(first * stress_nested_count, last * stress_nested_count, 16, [&leaf_count] (size_t inner_first, size_t inner_last)
+                {
+                    leaf_count += inner_last - inner_first;
+                });
+            });
+
+            check(leaf_count == 64 * stress_nested_count, "{} of {} inner iterations ran", leaf_count.load(), 64 * stress_nested_count);
+        });
+    }
+}
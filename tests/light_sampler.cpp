@@ -0,0 +1,82 @@
+#include "test.hpp"
+
+#include <base/scene/light_sampler.hpp>
+
+#include <vector>
+#include <ranges>
+#include <cmath>
+
+namespace vrts::test
+{
+    static std::vector<double> getFrequencies(const AliasTable& table, uint32_t sample_count)
+    {
+        std::vector<double> frequencies (table.size(), 0.0);
+
+        for (auto i: std::views::iota(0u, sample_count))
+        {
+            const auto u = (static_cast<float>(i) + 0.5f) / static_cast<float>(sample_count);
+            frequencies[table.sample(u)] += 1.0 / sample_count;
+        }
+
+        return frequencies;
+    }
+
+    void testAliasTable(Runner& runner)
+    {
+        runner.run("alias_table/frequencies", []
+        {
+            const std::vector<float> weights {1.0f, 0.0f, 3.0f, 6.0f, 0.5f, 2.5f, 0.0f, 11.0f};
+
+            const auto table = AliasTable::build(weights);
+
+            check(table.size() == weights.size(), "Table size {} != {}", table.size(), weights.size());
+            check(std::abs(table.getTotalWeight() - 24.0) < 1e-6, "Total weight {} != 24", table.getTotalWeight());
+
+            constexpr uint32_t sample_count = 1 << 20;
+
+            const auto frequencies = getFrequencies(table, sample_count);
+
+            for (auto i: std::views::iota(0u, weights.size()))
+            {
+                const auto expected = weights[i] / table.getTotalWeight();
+
+                check(std::abs(table.getPdf(i) - expected) < 1e-6, "Pdf of {}: {} != {}", i, table.getPdf(i), expected);
+                check(std::abs(frequencies[i] - expected) < 1e-4, "Frequency of {}: {} != {}", i, frequencies[i], expected);
+
+                if (weights[i] == 0.0f)
+                    check(frequencies[i] == 0.0, "Zero weight {} is sampled", i);
+            }
+        });
+
+        runner.run("alias_table/skewed", []
+        {
+            /// Порог сравнивается с дробной частью u * size() во float, поэтому лёгкие веса берём
+            /// заметно больше её шага (size() * 2^-24), иначе частоты упираются в округление, а не в таблицу.
+            std::vector<float> weights (256, 0.1f);
+            weights[100] = 1e3f;
+
+            const auto table        = AliasTable::build(weights);
+            const auto frequencies  = getFrequencies(table, 1 << 22);
+
+            for (auto i: std::views::iota(0u, weights.size()))
+            {
+                const auto expected = static_cast<double>(weights[i]) / table.getTotalWeight();
+                check(std::abs(frequencies[i] - expected) < 1e-5, "Frequency of {}: {} != {}", i, frequencies[i], expected);
+            }
+        });
+
+        runner.run("alias_table/edge_cases", []
+        {
+            check(AliasTable::build(std::vector<float> {0.0f, 0.0f}).empty(), "Zero weights must give an empty table");
+            check(AliasTable::build(std::vector<float> { }).empty(), "No weights must give an empty table");
+
+            const auto single = AliasTable::build(std::vector<float> {2.0f});
+
+            check(single.sample(0.0f) == 0 && single.sample(0.999999f) == 0, "Single entry must always be sampled");
+            check(single.getPdf(0) == 1.0f, "Single entry pdf {} != 1", single.getPdf(0));
+
+            const auto table = AliasTable::build(std::vector<float> {1.0f, 1.0f, 1.0f});
+            check(table.sample(std::nextafter(1.0f, 0.0f)) < 3, "Sample of u -> 1 is out of range");
+        });
+    }
+}
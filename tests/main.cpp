@@ -0,0 +1,24 @@
+#include "test.hpp"
+
+#include <cstdlib>
+
+int main()
+{
+    using namespace vrts;
+
+    test::Runner runner;
+
+    test::testSkinningPalette(runner);
+    test::testJobSystem(runner);
+    test::testMeshLod(runner);
+    test::testAliasTable(runner);
+    test::testSobol(runner);
+    test::testAtrousDenoiser(runner);
+    test::testEnvironmentMap(runner);
+    test::testTransformHierarchy(runner);
+    test::testCpuPathTracer(runner);
+
+    log::info("[Test] Passed: {}, failed: {}", runner.getPassedCount(), runner.getFailedCount());
+
+    return runner.getFailedCount() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
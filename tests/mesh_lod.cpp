@@ -0,0 +1,167 @@
+#include "test.hpp"
+
+#include <base/scene/mesh_lod.hpp>
+#include <base/scene/mesh_data.hpp>
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <ranges>
+#include <limits>
+#include <cmath>
+
+namespace vrts::test
+{
+    static MeshData makeWavyGrid(uint32_t triangle_count)
+    {
+        constexpr auto wave_amplitude = 0.05f;
+        constexpr auto wave_frequency = 3.0f;
+
+        const auto quads_per_side       = std::max(1u, static_cast<uint32_t>(std::sqrt(triangle_count / 2.0f)));
+        const auto vertices_per_side    = quads_per_side + 1;
+
+        const auto omega = glm::two_pi<float>() * wave_frequency;
+
+        MeshData mesh_data;
+
+        for (auto j: std::views::iota(0u, vertices_per_side))
+        {
+            for (auto i: std::views::iota(0u, vertices_per_side))
+            {
+                const auto x = static_cast<float>(i) / static_cast<float>(quads_per_side);
+                const auto y = static_cast<float>(j) / static_cast<float>(quads_per_side);
+
+                const auto z    = wave_amplitude * std::sin(omega * x) * std::sin(omega * y);
+                const auto dzdx = wave_amplitude * omega * std::cos(omega * x) * std::sin(omega * y);
+                const auto dzdy = wave_amplitude * omega * std::sin(omega * x) * std::cos(omega * y);
+
+                Attributes attributes = { };
+                attributes.pos      = glm::vec4(x, y, z, 1.0f);
+                attributes.normal   = glm::vec4(glm::normalize(glm::vec3(-dzdx, -dzdy, 1.0f)), 0.0f);
+                attributes.tangent  = glm::vec4(glm::normalize(glm::vec3(1.0f, 0.0f, dzdx)), 0.0f);
+                attributes.uv       = glm::vec4(x, y, 0.0f, 0.0f);
+
+                mesh_data.attributes.push_back(attributes);
+            }
+        }
+
+        for (auto j: std::views::iota(0u, quads_per_side))
+        {
+            for (auto i: std::views::iota(0u, quads_per_side))
+            {
+                const auto v0 = j * vertices_per_side + i;
+                const auto v1 = v0 + 1;
+                const auto v2 = v0 + vertices_per_side;
+                const auto v3 = v2 + 1;
+
+                mesh_data.indices.insert(mesh_data.indices.end(), {v0, v1, v2, v1, v3, v2});
+            }
+        }
+
+        mesh_data.lods = mesh_lod::buildChain(mesh_data.indices, mesh_data.attributes);
+
+        return mesh_data;
+    }
+
+    static void checkTopology(const mesh_lod::Lod& lod, size_t vertex_count)
+    {
+        check(!lod.indices.empty() && lod.indices.size() % 3 == 0, "LOD has {} indices", lod.indices.size());
+
+        for (size_t i = 0; i < lod.indices.size(); i += 3)
+        {
+            const auto a = lod.indices[i];
+            const auto b = lod.indices[i + 1];
+            const auto c = lod.indices[i + 2];
+
+            check(a < vertex_count && b < vertex_count && c < vertex_count, "Triangle {} references a missing vertex", i / 3);
+            check(a != b && b != c && a != c, "Triangle {} is degenerate", i / 3);
+        }
+    }
+
+    static void checkBounds(const mesh_lod::Lod& lod, std::span<const Attributes> attributes)
+    {
+        glm::vec2 min_pos (std::numeric_limits<float>::max());
+        glm::vec2 max_pos (std::numeric_limits<float>::lowest());
+
+        for (auto index: lod.indices)
+        {
+            min_pos = glm::min(min_pos, glm::vec2(attributes[index].pos));
+            max_pos = glm::max(max_pos, glm::vec2(attributes[index].pos));
+        }
+
+        check(min_pos == glm::vec2(0.0f) && max_pos == glm::vec2(1.0f), "LOD bounds ({}, {}) - ({}, {}) differ from [0, 1]^2", min_pos.x, min_pos.y, max_pos.x, max_pos.y);
+    }
+
+    void testMeshLod(Runner& runner)
+    {
+        runner.run("mesh_lod/chain_error_bound", []
+        {
+            const auto mesh_data = makeWavyGrid(32768);
+
+            const auto& lods        = mesh_data.lods;
+            const auto  max_error   = mesh_lod::getMaxError(mesh_data.attributes);
+
+            check(!lods.empty(), "Grid has no LODs");
+            check(lods.size() < mesh_lod::max_lod_count, "{} LODs, at most {} expected", lods.size(), mesh_lod::max_lod_count - 1);
+
+            auto prev_index_count   = mesh_data.indices.size();
+            auto prev_error         = 0.0f;
+
+            for (auto lod_id: std::views::iota(0u, lods.size()))
+            {
+                const auto& lod = lods[lod_id];
+
+                checkTopology(lod, mesh_data.attributes.size());
+                checkBounds(lod, mesh_data.attributes);
+
+                check(lod.indices.size() < prev_index_count, "LOD {} isn't smaller than the previous one", lod_id + 1);
+                check(lod.error >= prev_error, "LOD {} error {} is less than the previous {}", lod_id + 1, lod.error, prev_error);
+                check(lod.error <= max_error, "LOD {} error {} exceeds {}", lod_id + 1, lod.error, max_error);
+
+                const auto measured_error = mesh_lod::measureError(mesh_data.indices, mesh_data.attributes, lod, 512);
+
+                check(measured_error <= max_error, "LOD {} measured error {} exceeds {}", lod_id + 1, measured_error, max_error);
+
+                prev_index_count    = lod.indices.size();
+                prev_error          = lod.error;
+            }
+        });
+
+        runner.run("mesh_lod/simplify_error_bound", []
+        {
+            const auto mesh_data = makeWavyGrid(8192);
+
+            for (auto max_error: {1e-4f, 1e-3f, 1e-2f})
+            {
+                const auto lod = mesh_lod::simplify(mesh_data.indices, mesh_data.attributes, 3 * 16, max_error);
+
+                checkTopology(lod, mesh_data.attributes.size());
+                checkBounds(lod, mesh_data.attributes);
+
+                check(lod.error <= max_error, "Error {} exceeds {}", lod.error, max_error);
+
+                const auto measured_error = mesh_lod::measureError(mesh_data.indices, mesh_data.attributes, lod, 512);
+
+                check(measured_error <= max_error, "Measured error {} exceeds {}", measured_error, max_error);
+            }
+        });
+
+        runner.run("mesh_lod/flat", []
+        {
+            auto mesh_data = makeWavyGrid(8192);
+
+            for (auto& attributes: mesh_data.attributes)
+                attributes.pos.z = 0.0f;
+
+            constexpr size_t target_index_count = 3 * 64;
+
+            const auto lod = mesh_lod::simplify(mesh_data.indices, mesh_data.attributes, target_index_count, 1e-6f);
+
+            checkTopology(lod, mesh_data.attributes.size());
+            checkBounds(lod, mesh_data.attributes);
+
+            check(lod.indices.size() <= target_index_count, "Flat grid simplified to {} indices, {} expected", lod.indices.size(), target_index_count);
+            check(lod.error <= 1e-6f, "Flat grid error {}", lod.error);
+        });
+    }
+}
@@ -0,0 +1,215 @@
+#include "test.hpp"
+
+#include <base/scene/skinning_palette.hpp>
+
+#include <glm/gtc/constants.hpp>
+
+#include <vector>
+#include <ranges>
+#include <random>
+#include <cmath>
+
+namespace vrts::test
+{
+    static SkinningPalette makePalette(SkinningPaletteType type, std::span<const glm::mat4> matrices)
+    {
+        SkinningPalette palette (type);
+        palette.update(matrices);
+
+        return palette;
+    }
+
+    static Attributes makeVertex(const glm::vec3& pos, const glm::vec3& normal, const glm::vec3& tangent)
+    {
+        Attributes attributes = { };
+
+        attributes.pos      = glm::vec4(pos, 1.0f);
+        attributes.normal   = glm::vec4(normal, 0.0f);
+        attributes.tangent  = glm::vec4(tangent, 0.0f);
+
+        return attributes;
+    }
+
+    static void checkNear(const glm::vec4& value, const glm::vec4& expected, float eps, std::string_view what)
+    {
+        check(glm::length(glm::vec3(value) - glm::vec3(expected)) <= eps, "{}: ({}, {}, {}) != ({}, {}, {})", what, value.x, value.y, value.z, expected.x, expected.y, expected.z);
+    }
+
+    static std::vector<glm::mat4> makeRigidMatrices(uint32_t count, uint32_t seed)
+    {
+        std::mt19937                            generator (seed);
+        std::uniform_real_distribution<float>   distribution (-1.0f, 1.0f);
+
+        std::vector<glm::mat4> matrices;
+
+        for ([[maybe_unused]] auto i: std::views::iota(0u, count))
+        {
+            const auto axis     = glm::normalize(glm::vec3(distribution(generator), distribution(generator), distribution(generator)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+            const auto angle    = distribution(generator) * glm::pi<float>();
+            const auto offset   = 10.0f * glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+
+            matrices.push_back(glm::translate(glm::mat4(1.0f), offset) * glm::rotate(glm::mat4(1.0f), angle, axis));
+        }
+
+        return matrices;
+    }
+
+    void testSkinningPalette(Runner& runner)
+    {
+        const auto vertex = makeVertex(glm::vec3(0.3f, -1.2f, 2.0f), glm::normalize(glm::vec3(1.0f, 2.0f, -0.5f)), glm::normalize(glm::vec3(-2.0f, 1.0f, 0.0f)));
+
+        runner.run("skinning/single_bone", [&vertex]
+        {
+            const auto matrices = makeRigidMatrices(16, 1);
+
+            const auto mat4_palette     = makePalette(SkinningPaletteType::mat4, matrices);
+            const auto affine_palette   = makePalette(SkinningPaletteType::affine, matrices);
+            const auto dq_palette       = makePalette(SkinningPaletteType::dual_quaternion, matrices);
+
+            for (auto bone_id: std::views::iota(0, static_cast<int32_t>(matrices.size())))
+            {
+                const SkinningData skinning_data { .bone_ids = glm::ivec4(bone_id, -1, -1, -1), .weights = glm::vec4(1, 0, 0, 0) };
+
+                const auto& matrix = matrices[static_cast<size_t>(bone_id)];
+
+                const auto expected_pos     = matrix * glm::vec4(glm::vec3(vertex.pos), 1.0f);
+                const auto expected_normal  = glm::vec4(glm::normalize(glm::mat3(matrix) * glm::vec3(vertex.normal)), 0.0f);
+
+                for (const auto* ptr_palette: {&mat4_palette, &affine_palette, &dq_palette})
+                {
+                    const auto skinned = skinning::skin(vertex, skinning_data, *ptr_palette);
+
+                    checkNear(skinned.pos, expected_pos, 1e-4f, "Position");
+                    checkNear(skinned.normal, expected_normal, 1e-4f, "Normal");
+                }
+            }
+        });
+
+        runner.run("skinning/affine_matches_mat4", [&vertex]
+        {
+            auto matrices = makeRigidMatrices(4, 2);
+            matrices[1] = matrices[1] * glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 0.5f, 1.5f));
+
+            const auto mat4_palette     = makePalette(SkinningPaletteType::mat4, matrices);
+            const auto affine_palette   = makePalette(SkinningPaletteType::affine, matrices);
+
+            const SkinningData skinning_data { .bone_ids = glm::ivec4(3, 1, 0, 2), .weights = glm::vec4(0.4f, 0.3f, 0.2f, 0.1f) };
+
+            const auto mat4_result      = skinning::skin(vertex, skinning_data, mat4_palette);
+            const auto affine_result    = skinning::skin(vertex, skinning_data, affine_palette);
+
+            checkNear(affine_result.pos, mat4_result.pos, 1e-4f, "Position");
+            checkNear(affine_result.normal, mat4_result.normal, 1e-5f, "Normal");
+            checkNear(affine_result.tangent, mat4_result.tangent, 1e-5f, "Tangent");
+
+            glm::mat4 blended (0.0f);
+
+            for (auto i: std::views::iota(0, 4))
+                blended += skinning_data.weights[i] * matrices[static_cast<size_t>(skinning_data.bone_ids[i])];
+
+            const auto expected_normal = glm::vec4(glm::normalize(glm::transpose(glm::inverse(glm::mat3(blended))) * glm::vec3(vertex.normal)), 0.0f);
+
+            checkNear(mat4_result.normal, expected_normal, 1e-4f, "Inverse transpose normal");
+        });
+
+        runner.run("skinning/mirrored_bone", [&vertex]
+        {
+            const std::vector<glm::mat4> matrices { glm::scale(glm::rotate(glm::mat4(1.0f), 0.7f, glm::vec3(0, 1, 0)), glm::vec3(-1.0f, 1.0f, 2.0f)) };
+
+            const SkinningData skinning_data { .bone_ids = glm::ivec4(0, -1, -1, -1), .weights = glm::vec4(1, 0, 0, 0) };
+
+            const auto expected_normal = glm::vec4(glm::normalize(glm::transpose(glm::inverse(glm::mat3(matrices[0]))) * glm::vec3(vertex.normal)), 0.0f);
+
+            for (auto type: {SkinningPaletteType::mat4, SkinningPaletteType::affine})
+            {
+                const auto skinned = skinning::skin(vertex, skinning_data, makePalette(type, matrices));
+                checkNear(skinned.normal, expected_normal, 1e-5f, "Mirrored normal");
+            }
+        });
+
+        runner.run("skinning/dual_quaternion_translation_blend", [&vertex]
+        {
+            const auto rotation = glm::rotate(glm::mat4(1.0f), 1.1f, glm::normalize(glm::vec3(1, 1, 0)));
+
+            const std::vector<glm::mat4> matrices
+            {
+                glm::translate(glm::mat4(1.0f), glm::vec3(1, 2, 3)) * rotation,
+                glm::translate(glm::mat4(1.0f), glm::vec3(-4, 0, 2)) * rotation
+            };
+
+            const SkinningData skinning_data { .bone_ids = glm::ivec4(0, 1, -1, -1), .weights = glm::vec4(0.7f, 0.3f, 0, 0) };
+
+            const auto mat4_result  = skinning::skin(vertex, skinning_data, makePalette(SkinningPaletteType::mat4, matrices));
+            const auto dq_result    = skinning::skin(vertex, skinning_data, makePalette(SkinningPaletteType::dual_quaternion, matrices));
+
+            checkNear(dq_result.pos, mat4_result.pos, 1e-4f, "Position");
+            checkNear(dq_result.normal, mat4_result.normal, 1e-5f, "Normal");
+        });
+
+        runner.run("skinning/dual_quaternion_twist", []
+        {
+            const std::vector<glm::mat4> matrices
+            {
+                glm::mat4(1.0f),
+                glm::rotate(glm::mat4(1.0f), glm::half_pi<float>(), glm::vec3(1, 0, 0))
+            };
+
+            const auto vertex = makeVertex(glm::vec3(0.5f, 1.0f, 0.0f), glm::vec3(0, 1, 0), glm::vec3(1, 0, 0));
+
+            const SkinningData skinning_data { .bone_ids = glm::ivec4(0, 1, -1, -1), .weights = glm::vec4(0.5f, 0.5f, 0, 0) };
+
+            const auto mat4_result  = skinning::skin(vertex, skinning_data, makePalette(SkinningPaletteType::mat4, matrices));
+            const auto dq_result    = skinning::skin(vertex, skinning_data, makePalette(SkinningPaletteType::dual_quaternion, matrices));
+
+            const auto expected = glm::rotate(glm::mat4(1.0f), glm::quarter_pi<float>(), glm::vec3(1, 0, 0)) * glm::vec4(glm::vec3(vertex.pos), 1.0f);
+
+            checkNear(dq_result.pos, expected, 1e-5f, "Dual quaternion position");
+
+            const auto mat4_radius = glm::length(glm::vec2(mat4_result.pos.y, mat4_result.pos.z));
+            check(std::abs(mat4_radius - glm::one_over_root_two<float>()) < 1e-5f, "Linear blend radius {} != 1 / sqrt(2)", mat4_radius);
+        });
+
+        runner.run("skinning/dual_quaternion_antipodal", []
+        {
+            /// Повороты на 10 и 200 градусов: кратчайший путь между ними проходит через -75 градусов,
+            /// а смесь кватернионов из разных полусфер без выбора знака ушла бы в 105.
+            const auto axis = glm::vec3(0, 0, 1);
+
+            const std::vector<glm::mat4> matrices
+            {
+                glm::rotate(glm::mat4(1.0f), glm::radians(10.0f), axis),
+                glm::rotate(glm::mat4(1.0f), glm::radians(200.0f), axis)
+            };
+
+            const auto dq_palette = makePalette(SkinningPaletteType::dual_quaternion, matrices);
+            const auto data       = dq_palette.getData();
+
+            check(glm::dot(data[0], data[2]) < 0.0f, "Test setup: quaternions must be in opposite hemispheres");
+
+            const auto vertex = makeVertex(glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(1, 0, 0));
+
+            const SkinningData skinning_data { .bone_ids = glm::ivec4(0, 1, -1, -1), .weights = glm::vec4(0.5f, 0.5f, 0, 0) };
+
+            const auto dq_result = skinning::skin(vertex, skinning_data, dq_palette);
+
+            const auto expected_angle = glm::radians(-75.0f);
+
+            checkNear(dq_result.pos, glm::vec4(std::cos(expected_angle), std::sin(expected_angle), 0, 1), 1e-5f, "Position");
+        });
+
+        runner.run("skinning/unskinned_vertex", [&vertex]
+        {
+            /// Вершина без костей остаётся в позе привязки при любом формате палитры.
+            const auto matrices = makeRigidMatrices(2, 3);
+
+            const SkinningData skinning_data = { };
+
+            for (auto type: {SkinningPaletteType::mat4, SkinningPaletteType::affine, SkinningPaletteType::dual_quaternion})
+            {
+                const auto skinned = skinning::skin(vertex, skinning_data, makePalette(type, matrices));
+
+                check(skinned.pos == vertex.pos && skinned.normal == vertex.normal, "Unskinned vertex moved with palette {}", static_cast<uint32_t>(type));
+            }
+        });
+    }
+}
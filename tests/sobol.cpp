@@ -0,0 +1,104 @@
+#include "test.hpp"
+
+#include <base/sobol.hpp>
+
+#include <vector>
+#include <ranges>
+#include <cmath>
+
+namespace vrts::test
+{
+    /// Каждый элементарный интервал площади 2^-m (2^-k по x на 2^-(m-k) по y) содержит ровно одну из 2^m точек.
+    static void checkNet(std::span<const glm::vec2> points, uint32_t m)
+    {
+        for (auto k: std::views::iota(0u, m + 1))
+        {
+            std::vector<uint32_t> counts (size_t(1) << m, 0);
+
+            for (const auto& point: points)
+            {
+                const auto x = static_cast<uint32_t>(std::floor(point.x * static_cast<float>(1u << k)));
+                const auto y = static_cast<uint32_t>(std::floor(point.y * static_cast<float>(1u << (m - k))));
+
+                ++counts[(x << (m - k)) | y];
+            }
+
+            for (auto cell: std::views::iota(0u, counts.size()))
+                check(counts[cell] == 1, "m = {}, k = {}: interval {} has {} points", m, k, cell, counts[cell]);
+        }
+    }
+
+    void testSobol(Runner& runner)
+    {
+        constexpr uint32_t max_m = 12;
+
+        runner.run("sobol/van_der_corput", []
+        {
+            for (auto i: std::views::iota(0u, 1u << max_m))
+            {
+                uint32_t expected = 0;
+
+                for (auto bit: std::views::iota(0u, sobol::bit_count))
+                    expected |= ((i >> bit) & 1u) << (sobol::bit_count - 1 - bit);
+
+                check(sobol::sample(i, 0) == expected, "Dimension 0 of {}: {} != {}", i, sobol::sample(i, 0), expected);
+            }
+        });
+
+        runner.run("sobol/net", []
+        {
+            for (auto m: std::views::iota(1u, max_m + 1))
+            {
+                std::vector<glm::vec2> points;
+
+                for (auto i: std::views::iota(0u, 1u << m))
+                {
+                    points.emplace_back(
+                        static_cast<float>(sobol::sample(i, 0) >> 8) / static_cast<float>(1u << 24),
+                        static_cast<float>(sobol::sample(i, 1) >> 8) / static_cast<float>(1u << 24)
+                    );
+                }
+
+                checkNet(points, m);
+            }
+        });
+
+        runner.run("sobol/scrambled_net", []
+        {
+            for (auto pixel: std::views::iota(0u, 16u))
+            {
+                const auto pixel_seed = sobol::getPixelSeed(pixel, pixel * 7 + 3);
+
+                for (auto dimension: std::views::iota(0u, 4u))
+                {
+                    const auto seed = sobol::getDimensionSeed(pixel_seed, dimension);
+
+                    for (auto m: std::views::iota(1u, max_m + 1))
+                    {
+                        std::vector<glm::vec2> points;
+                        std::vector<uint32_t>  counts_z (1u << m, 0);
+                        std::vector<uint32_t>  counts_w (1u << m, 0);
+
+                        for (auto i: std::views::iota(0u, 1u << m))
+                        {
+                            const auto sample = sobol::getSample(i, seed);
+
+                            for (auto component: std::views::iota(0, 4))
+                                check(sample[component] >= 0.0f && sample[component] < 1.0f, "Sample {} is out of [0, 1): {}", i, sample[component]);
+
+                            points.emplace_back(sample.x, sample.y);
+
+                            ++counts_z[static_cast<uint32_t>(sample.z * static_cast<float>(1u << m))];
+                            ++counts_w[static_cast<uint32_t>(sample.w * static_cast<float>(1u << m))];
+                        }
+
+                        checkNet(points, m);
+
+                        for (auto cell: std::views::iota(0u, 1u << m))
+                            check(counts_z[cell] == 1 && counts_w[cell] == 1, "m = {}: stratum {} of z/w has {}/{} points", m, cell, counts_z[cell], counts_w[cell]);
+                    }
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,32 @@
+#include "test.hpp"
+
+#include <exception>
+
+namespace vrts::test
+{
+    void Runner::run(std::string_view name, const std::function<void ()>& func)
+    {
+        log::info("[Test] {}", name);
+
+        try
+        {
+            func();
+            ++_passed_count;
+        }
+        catch (const std::exception& exception)
+        {
+            ++_failed_count;
+            log::warning("[Test] {} failed: {}", name, exception.what());
+        }
+    }
+
+    uint32_t Runner::getPassedCount() const noexcept
+    {
+        return _passed_count;
+    }
+
+    uint32_t Runner::getFailedCount() const noexcept
+    {
+        return _failed_count;
+    }
+}
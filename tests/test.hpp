@@ -0,0 +1,46 @@
+#pragma once
+
+#include <base/logger/logger.hpp>
+
+#include <string_view>
+#include <functional>
+
+namespace vrts::test
+{
+    constexpr void check(bool condition, const std::string_view fmt, const auto&... args)
+    {
+        if (!condition)
+            log::error(fmt, args...);
+    }
+
+    class Runner
+    {
+    public:
+        Runner() = default;
+
+        Runner(Runner&& runner)         = delete;
+        Runner(const Runner& runner)    = delete;
+
+        Runner& operator = (Runner&& runner)        = delete;
+        Runner& operator = (const Runner& runner)   = delete;
+
+        void run(std::string_view name, const std::function<void ()>& func);
+
+        [[nodiscard]] uint32_t getPassedCount() const noexcept;
+        [[nodiscard]] uint32_t getFailedCount() const noexcept;
+
+    private:
+        uint32_t _passed_count = 0;
+        uint32_t _failed_count = 0;
+    };
+
+    void testSkinningPalette(Runner& runner);
+    void testJobSystem(Runner& runner);
+    void testMeshLod(Runner& runner);
+    void testAliasTable(Runner& runner);
+    void testSobol(Runner& runner);
+    void testAtrousDenoiser(Runner& runner);
+    void testEnvironmentMap(Runner& runner);
+    void testTransformHierarchy(Runner& runner);
+    void testCpuPathTracer(Runner& runner);
+}
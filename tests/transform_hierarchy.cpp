@@ -0,0 +1,64 @@
+#include "test.hpp"
+
+#include <base/scene/transform_hierarchy.hpp>
+
+#include <vector>
+#include <ranges>
+#include <algorithm>
+
+namespace vrts::test
+{
+    static std::vector<uint32_t> getSorted(std::span<const uint32_t> ids)
+    {
+        std::vector<uint32_t> sorted (ids.begin(), ids.end());
+        std::ranges::sort(sorted);
+        return sorted;
+    }
+
+    void testTransformHierarchy(Runner& runner)
+    {
+        runner.run("transform_hierarchy/changed_nodes", []
+        {
+            /// 0 - корень, 1 и 2 - его дети, 3 - ребёнок 1.
+            TransformHierarchy transforms;
+
+            const auto root     = transforms.add(TransformHierarchy::invalid_id, glm::mat4(1.0f));
+            const auto left     = transforms.add(root, glm::mat4(1.0f));
+            const auto right    = transforms.add(root, glm::mat4(1.0f));
+            const auto leaf     = transforms.add(left, glm::mat4(1.0f));
+
+            check(transforms.update().size() == 4, "All new nodes must be reported as changed");
+            check(transforms.update().empty(), "update() without changes must report nothing");
+            check(transforms.getChangedNodes().empty(), "getChangedNodes() must match the last update()");
+
+            transforms.setLocal(left, glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+
+            const auto changed = getSorted(transforms.update());
+            check(changed == std::vector<uint32_t> { left, leaf }, "Moving a node must report its subtree only, got {} nodes", changed.size());
+            check(getSorted(transforms.getChangedNodes()) == changed, "getChangedNodes() must match update()");
+
+            check(transforms.getWorld(leaf) == transforms.getWorld(left), "Leaf world matrix must follow its parent");
+            check(transforms.getWorld(right) == glm::mat4(1.0f), "Sibling world matrix must not change");
+        });
+
+        runner.run("transform_hierarchy/update_count", []
+        {
+            TransformHierarchy transforms;
+
+            const auto root = transforms.add(TransformHierarchy::invalid_id, glm::mat4(1.0f));
+
+            check(transforms.getUpdateCount() == 0, "Fresh hierarchy must have no updates");
+            check(transforms.isDirty(), "Added node must be dirty");
+
+            transforms.update();
+            transforms.update();
+
+            check(transforms.getUpdateCount() == 2, "Every update() must be counted, including empty ones");
+            check(!transforms.isDirty(), "Hierarchy must be clean after update()");
+
+            transforms.setLocal(root, glm::mat4(2.0f));
+
+            check(transforms.isDirty(), "setLocal() must mark the hierarchy dirty");
+        });
+    }
+}